@@ -28,7 +28,9 @@ struct aws_channel;
 struct aws_channel_slot;
 struct aws_channel_handler;
 struct aws_event_loop;
+struct aws_event_loop_group;
 struct aws_event_loop_local_object;
+struct aws_message_pool_bounds;
 
 typedef void(aws_channel_on_setup_completed_fn)(struct aws_channel *channel, int error_code, void *user_data);
 
@@ -122,6 +124,25 @@ struct aws_channel_handler_vtable {
      * function is called.
      */
     void (*destroy)(struct aws_channel_handler *handler);
+
+    /**
+     * Set if process_write_message() handles message chains (see aws_io_message.next_in_chain), and releases and
+     * completes every message in them. Otherwise, the channel copies a chain into plain messages before passing it
+     * to this handler.
+     */
+    bool accepts_message_chains;
+
+    /**
+     * Optional. Returns false while the handler has more write data queued than it wants, see
+     * aws_channel_slot_downstream_is_writable(). Handlers that leave this NULL are always writable.
+     */
+    bool (*is_writable)(struct aws_channel_handler *handler);
+
+    /**
+     * Optional. Called from the channel's thread when a handler further down the channel that reported itself not
+     * writable can take writes again, see aws_channel_slot_on_writable().
+     */
+    void (*on_writable)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
 };
 
 struct aws_channel_handler {
@@ -242,6 +263,38 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
     enum aws_io_message_type message_type,
     size_t size_hint);
 
+/**
+ * Every event loop keeps one message pool for all the channels on it, and each of its size classes grows or trims
+ * the number of idle messages it keeps according to how often channels find it empty. This sets how far it may go
+ * on every loop in el_group (by default between 4 and 64 messages per size class). The bounds are applied on each
+ * loop's thread shortly after this returns, creating the loop's pool if it doesn't have one yet. If this fails, no
+ * loop's bounds are changed.
+ */
+AWS_IO_API
+int aws_event_loop_group_set_message_pool_bounds(
+    struct aws_event_loop_group *el_group,
+    const struct aws_message_pool_bounds *bounds);
+
+/**
+ * Chains tail, along with anything already chained behind it, onto the end of head's chain. The chain is then sent
+ * and owned as head.
+ */
+AWS_IO_API
+void aws_io_message_chain_append(struct aws_io_message *head, struct aws_io_message *tail);
+
+/**
+ * Returns the total length of message_data across head's chain.
+ */
+AWS_IO_API
+size_t aws_io_message_chain_data_size(const struct aws_io_message *head);
+
+/**
+ * Releases every message in head's chain without invoking their on_completion callbacks. This is how to clean up
+ * after aws_channel_slot_send_message() fails on a chain.
+ */
+AWS_IO_API
+void aws_io_message_chain_release(struct aws_io_message *head);
+
 /**
  * Schedules a task to run on the event loop as soon as possible.
  * This is the ideal way to move a task into the correct thread. It's also handy for context switches.
@@ -320,6 +373,10 @@ int aws_channel_slot_insert_left(struct aws_channel_slot *slot, struct aws_chann
  * back to the pool. If this function returns AWS_OP_SUCCESS, the recipient of the message has taken
  * ownership of the message. So, for example, don't release a message to the pool and then return an error.
  * If you encounter an error condition in this case, shutdown the channel with the appropriate error code.
+ *
+ * Message chains can only be sent in the write direction. If the next handler doesn't accept chains, the chain is
+ * copied into as few messages as possible, and its messages complete once the last copy has been written. If that
+ * fails partway, some of the data has already been passed on, so the channel should be shut down.
  */
 AWS_IO_API
 int aws_channel_slot_send_message(
@@ -362,6 +419,21 @@ int aws_channel_slot_shutdown(
 AWS_IO_API
 size_t aws_channel_slot_downstream_read_window(struct aws_channel_slot *slot);
 
+/**
+ * Returns false if any handler in the write direction from this slot has more write data queued than it wants. This
+ * is advisory, writes still go through, but a handler producing data should hold off until its on_writable vtable
+ * function is called.
+ */
+AWS_IO_API
+bool aws_channel_slot_downstream_is_writable(struct aws_channel_slot *slot);
+
+/**
+ * Called by a handler that reported itself not writable once it can take writes again. Invokes the on_writable vtable
+ * function of every handler in the read direction from this slot that has one.
+ */
+AWS_IO_API
+void aws_channel_slot_on_writable(struct aws_channel_slot *slot);
+
 /** Fetches the current overhead of upstream handlers. This provides a hint to avoid fragmentation if you care. */
 AWS_IO_API
 size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot);
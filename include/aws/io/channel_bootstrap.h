@@ -18,6 +18,7 @@
 #include <aws/common/atomics.h>
 #include <aws/io/channel.h>
 #include <aws/io/host_resolver.h>
+#include <aws/io/socket_channel_handler.h>
 
 struct aws_client_bootstrap;
 struct aws_socket;
@@ -77,6 +78,7 @@ struct aws_client_bootstrap {
     struct aws_host_resolver *host_resolver;
     struct aws_host_resolution_config host_resolver_config;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    struct aws_socket_handler_options socket_handler_options;
     struct aws_atomic_var ref_count;
 };
 
@@ -127,6 +129,7 @@ struct aws_server_bootstrap {
     struct aws_allocator *allocator;
     struct aws_event_loop_group *event_loop_group;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    struct aws_socket_handler_options socket_handler_options;
     struct aws_atomic_var ref_count;
 };
 
@@ -158,6 +161,14 @@ AWS_IO_API int aws_client_bootstrap_set_alpn_callback(
     struct aws_client_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Sets how the socket handlers of channels set up from now on read, see aws_socket_handler_new_with_options(). By
+ * default they read up to g_aws_channel_max_fragment_size per event loop tick, one message per system call.
+ */
+AWS_IO_API int aws_client_bootstrap_set_socket_handler_options(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_socket_handler_options *options);
+
 /**
  * Sets up a client socket channel. If you are planning on using TLS, use `aws_client_bootstrap_new_tls_socket_channel`
  * instead. The connection is made to `host_name` and `port` using socket options `options`. If AWS_SOCKET_LOCAL is
@@ -223,6 +234,14 @@ AWS_IO_API int aws_server_bootstrap_set_alpn_callback(
     struct aws_server_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Sets how the socket handlers of channels accepted from now on read, see aws_socket_handler_new_with_options(). By
+ * default they read up to g_aws_channel_max_fragment_size per event loop tick, one message per system call.
+ */
+AWS_IO_API int aws_server_bootstrap_set_socket_handler_options(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_socket_handler_options *options);
+
 /**
  * Sets up a server socket listener. If you are planning on using TLS, use
  * `aws_server_bootstrap_new_tls_socket_listener` instead. This creates a socket listener bound to `local_endpoint`
@@ -0,0 +1,65 @@
+#ifndef AWS_IO_DEFERRED_LOGGER_H
+#define AWS_IO_DEFERRED_LOGGER_H
+
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/log_channel.h>
+#include <aws/io/logging.h>
+
+/*
+ * A logger that leaves formatting to its background thread.  A log call only records the format string's address,
+ * the level, subject, time and thread, and the raw values of the arguments (copying any strings) and queues that
+ * record.  The background thread turns records into lines in the same layout as the default formatter and writes
+ * them out.
+ *
+ * Since only the address of the format string is kept, format strings must outlive the logger, which string literals
+ * passed to AWS_LOGF_* do.  Calls whose format uses conversions the record can't hold (%n, wide characters and
+ * strings, anything platform-specific) are formatted right away and queued as text.
+ */
+struct aws_logger_deferred_options {
+    enum aws_log_level level;
+    const char *filename;
+    FILE *file;
+
+    /*
+     * How many records can be queued for the background thread, see aws_log_channel_background_options.  If zero,
+     * the channel's default is used.
+     */
+    size_t queue_size;
+
+    /*
+     * Records up to this many bytes are copied into storage preallocated with the queue.  If zero, the channel's
+     * default is used.
+     */
+    size_t record_slot_size;
+
+    enum aws_log_channel_overflow_policy overflow_policy;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/*
+ * Initializes a deferred logger that writes to a file, or to an already open FILE * such as stdout.
+ */
+AWS_IO_API
+int aws_logger_init_deferred(
+    struct aws_logger *logger,
+    struct aws_allocator *allocator,
+    struct aws_logger_deferred_options *options);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DEFERRED_LOGGER_H */
@@ -0,0 +1,106 @@
+#ifndef AWS_IO_DNS_CLIENT_H
+#define AWS_IO_DNS_CLIENT_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/io.h>
+#include <aws/io/socket.h>
+
+struct aws_array_list;
+struct aws_dns_client;
+struct aws_event_loop;
+struct aws_string;
+
+/**
+ * A non-blocking DNS stub client. It sends A and AAAA queries for a host to a single recursive name server over UDP,
+ * with the sockets and all timers running on one event loop. Any number of queries can be in flight at once, each is
+ * resent if no answer comes back in time, and the addresses it returns expire according to the TTLs in the answer.
+ * Every query is sent from a socket of its own, on a port picked by the kernel, with an id from the OS's random
+ * number generator, so that off-path spoofing has both to guess.
+ *
+ * There's no TCP fallback: truncated answers are used as far as they go. No /etc/resolv.conf parsing either, the name
+ * server has to be given explicitly.
+ */
+struct aws_dns_client_options {
+    /* the client's sockets and timers live on this loop, and results are delivered on its thread. It has to outlive the
+     * client. */
+    struct aws_event_loop *event_loop;
+    /* address (an IPv4 or IPv6 literal) and port, usually 53, of the name server to ask */
+    struct aws_socket_endpoint name_server;
+    /* AWS_SOCKET_IPV4 or AWS_SOCKET_IPV6, whichever name_server's address is */
+    enum aws_socket_domain name_server_domain;
+    /* how long to wait for an answer before sending a query again. If zero, 1000ms is used. */
+    uint32_t query_timeout_ms;
+    /* how many times a query is sent, including the first, before giving up. If zero, 3 is used. */
+    uint32_t max_attempts;
+};
+
+/**
+ * Invoked on the client's event-loop thread once a lookup completes. On success, host_addresses holds struct
+ * aws_host_address (by-value) with expiry set from the record TTLs; copy anything you want to keep.
+ * A lookup succeeds if either the A or the AAAA query returned addresses. Otherwise error_code is
+ * AWS_IO_DNS_INVALID_NAME if the host doesn't exist, AWS_IO_DNS_NO_ADDRESS_FOR_HOST if it has no addresses, or
+ * AWS_IO_DNS_QUERY_FAILED if the name server couldn't be reached or couldn't answer.
+ *
+ * Don't destroy the client from inside this callback.
+ */
+typedef void(aws_dns_client_on_resolved_fn)(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data);
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a client. Lookups can be made right away, a name server address that doesn't parse fails each of them with
+ * AWS_IO_DNS_QUERY_FAILED.
+ */
+AWS_IO_API struct aws_dns_client *aws_dns_client_new(
+    struct aws_allocator *allocator,
+    const struct aws_dns_client_options *options);
+
+/**
+ * Fails every outstanding lookup with AWS_ERROR_IO_OPERATION_CANCELLED, closes their sockets and frees the client. If
+ * called off the event-loop thread, this blocks until the loop has done so. No lookups may be started once this has
+ * been called.
+ */
+AWS_IO_API void aws_dns_client_destroy(struct aws_dns_client *client);
+
+/**
+ * Starts looking up host_name, which is copied. Can be called from any thread, on_resolved will be invoked on the
+ * event-loop thread.
+ */
+AWS_IO_API int aws_dns_client_resolve_async(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    aws_dns_client_on_resolved_fn *on_resolved,
+    void *user_data);
+
+/**
+ * An aws_resolve_host_implementation_fn that looks hosts up with the struct aws_dns_client passed as user_data. Set
+ * it, along with the client as impl_data, in aws_host_resolution_config to have the host resolver use the client
+ * instead of getaddrinfo(). It waits for the event loop to finish the lookup, so never call it on that loop's thread.
+ */
+AWS_IO_API int aws_dns_client_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DNS_CLIENT_H */
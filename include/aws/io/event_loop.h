@@ -18,6 +18,7 @@
 
 #include <aws/common/atomics.h>
 #include <aws/common/hash_table.h>
+#include <aws/common/task_scheduler.h>
 #include <aws/io/io.h>
 
 enum aws_io_event_type {
@@ -66,6 +67,56 @@ typedef void(aws_event_loop_on_event_fn)(
 
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
+/* Any function, for recording what a wrapper calls on the loop's behalf, see aws_event_loop_set_current_inner_fn(). */
+typedef void(aws_event_loop_inner_fn)(void);
+
+/**
+ * What an event loop has done since it was created, see aws_event_loop_get_stats(). Every field only goes up, so
+ * sample periodically and look at the differences. Times are in nanoseconds of the loop's clock.
+ */
+struct aws_event_loop_stats {
+    /* passes through the loop: wait, handle io events, run tasks. */
+    uint64_t iteration_count;
+    /* time spent blocked waiting for io events or the next task. */
+    uint64_t wait_time_ns;
+    uint64_t io_event_count;
+    /* time spent in io event callbacks. */
+    uint64_t io_event_time_ns;
+    uint64_t task_count;
+    /* time spent running tasks. */
+    uint64_t task_time_ns;
+    /* the longest any single task has run. */
+    uint64_t max_task_duration_ns;
+    /* tasks scheduled from other threads. */
+    uint64_t cross_thread_task_count;
+
+    /*
+     * Not counters, but a snapshot of what the loop is doing right now. busy_since_ns is when it last woke up, or 0
+     * while it's waiting. The callback it's in the middle of running, if any, is in one of the fields below.
+     */
+    uint64_t busy_since_ns;
+    aws_task_fn *current_task_fn;
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+    aws_event_loop_on_event_fn *current_io_event_fn;
+#endif
+    /* What the callback above is calling on someone else's behalf, if it said: a channel task's task_fn, or the
+     * process_read_message of the handler a socket handler is passing data to. */
+    aws_event_loop_inner_fn *current_inner_fn;
+};
+
+/**
+ * Called from the group's watchdog thread when a loop has been busy for longer than the group's stall budget. stats
+ * is the snapshot that showed the stall, its current_inner_fn (or failing that, current_task_fn /
+ * current_io_event_fn) is most likely the culprit.
+ */
+typedef void(aws_event_loop_on_stall_fn)(
+    struct aws_event_loop *event_loop,
+    uint64_t stalled_for_ns,
+    const struct aws_event_loop_stats *stats,
+    void *user_data);
+
+struct aws_event_loop_watchdog;
+
 struct aws_event_loop_vtable {
     void (*destroy)(struct aws_event_loop *event_loop);
     int (*run)(struct aws_event_loop *event_loop);
@@ -87,6 +138,10 @@ struct aws_event_loop_vtable {
     int (*unsubscribe_from_io_events)(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
     void (*free_io_event_resources)(void *user_data);
     bool (*is_on_callers_thread)(struct aws_event_loop *event_loop);
+    /* optional, see aws_event_loop_get_stats(). */
+    int (*get_stats)(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats);
+    /* optional, see aws_event_loop_set_current_inner_fn(). */
+    aws_event_loop_inner_fn *(*set_current_inner_fn)(struct aws_event_loop *event_loop, aws_event_loop_inner_fn *fn);
 };
 
 struct aws_event_loop {
@@ -95,6 +150,8 @@ struct aws_event_loop {
     aws_io_clock_fn *clock;
     struct aws_hash_table local_data;
     void *impl_data;
+    /* io handles currently subscribed to the loop, see aws_event_loop_get_load_factor(). */
+    struct aws_atomic_var io_handle_count;
 };
 
 struct aws_event_loop_local_object;
@@ -106,6 +163,29 @@ struct aws_event_loop_local_object {
     aws_event_loop_on_local_object_removed_fn *on_object_removed;
 };
 
+/**
+ * Settings for aws_event_loop_new_system_with_options().
+ */
+struct aws_event_loop_options {
+    aws_io_clock_fn *clock;
+
+    /*
+     * If non-zero, whenever the loop runs out of work it polls for io events and cross-thread tasks without blocking
+     * for up to this long before it goes to sleep in the kernel. Work that shows up during that time is picked up
+     * without a wake-up, and cross-thread tasks scheduled during it skip the eventfd write. That trades a core's worth
+     * of spinning for latency, so it's only meant for loops serving latency-critical traffic. Only the epoll loop
+     * supports this.
+     */
+    uint64_t busy_poll_ns;
+
+    /*
+     * If non-zero, SO_BUSY_POLL is set to this many microseconds on each socket subscribed to the loop, so the kernel
+     * polls the device queue for it too. Values above net.core.busy_read need CAP_NET_ADMIN; sockets the option can't
+     * be set on are left as they are. Only the epoll loop supports this.
+     */
+    uint32_t socket_busy_poll_us;
+};
+
 typedef struct aws_event_loop *(
     aws_new_event_loop_fn)(struct aws_allocator *alloc, aws_io_clock_fn *clock, void *new_loop_user_data);
 
@@ -113,6 +193,46 @@ struct aws_event_loop_group {
     struct aws_allocator *allocator;
     struct aws_array_list event_loops;
     struct aws_atomic_var current_index;
+    /* NULL unless a stall budget was set, see aws_event_loop_group_options. */
+    struct aws_event_loop_watchdog *watchdog;
+};
+
+/**
+ * Controls how many loops a group has and which CPUs their threads run on.
+ */
+struct aws_event_loop_group_options {
+    /*
+     * Number of loops in the group. If zero, one per CPU in cpu_ids if that is set, otherwise one per processor.
+     */
+    uint16_t loop_count;
+
+    /*
+     * Optional. Loop i's thread is pinned to cpu_ids[i % cpu_id_count].
+     */
+    const uint16_t *cpu_ids;
+    size_t cpu_id_count;
+
+    /*
+     * Ignored if cpu_ids is set. Loops are dealt out round-robin across the machine's NUMA nodes, and each loop's
+     * thread is pinned to the CPUs of its node. Has no effect on machines with a single node.
+     */
+    bool spread_across_numa_nodes;
+
+    /*
+     * If non-zero, a watchdog thread checks every loop a few times per budget, and calls on_stall once for each pass
+     * through a loop that has been busy (running io callbacks and tasks rather than waiting) for longer than this.
+     * Needs loops that keep aws_event_loop_stats.
+     */
+    uint64_t stall_budget_ns;
+    aws_event_loop_on_stall_fn *on_stall;
+    void *on_stall_user_data;
+
+    /*
+     * Passed on to each loop, see aws_event_loop_options. Setting either means the group uses the system event loop
+     * even in builds where the default is something else.
+     */
+    uint64_t busy_poll_ns;
+    uint32_t socket_busy_poll_us;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -147,6 +267,36 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock);
 
+/**
+ * Same as aws_event_loop_new_system(), with the settings in `options`. Asking for busy polling from a loop that
+ * doesn't support it fails with AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options);
+
+#ifdef AWS_USE_IO_URING
+/**
+ * Creates an instance of the io_uring event loop implementation. I/O readiness is delivered through multishot poll
+ * requests on the ring, so subscriptions, unsubscriptions and the wait for completions for an entire tick are batched
+ * into a single io_uring_enter() call. If the running kernel does not support io_uring (or lacks the features needed),
+ * this falls back to aws_event_loop_new_system().
+ *
+ * This loop only uses io_uring for readiness, like epoll does. Sockets still make their own read, write, accept and
+ * connect system calls once they're told they can, so it saves the epoll_ctl() calls, not the I/O system calls.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock);
+
+/**
+ * Returns true if event_loop is an io_uring loop, false if it is anything else, including the loop
+ * aws_event_loop_new_io_uring() falls back to.
+ */
+AWS_IO_API
+bool aws_event_loop_is_io_uring(const struct aws_event_loop *event_loop);
+#endif /* AWS_USE_IO_URING */
+
 #ifdef AWS_USE_LIBUV
 /**
  * Creates an instance of the libuv event loop implementation (also creates a new uv_loop).
@@ -316,6 +466,9 @@ int aws_event_loop_subscribe_to_io_events(
  * Unsubscribes handle from event-loop notifications.
  * This function is not thread safe and should be called inside the event-loop's thread.
  *
+ * The loop lets go of the handle even if this fails (e.g. the fd was already closed): it is no longer subscribed
+ * afterwards, no longer counted by aws_event_loop_get_load_factor(), and must not be unsubscribed again.
+ *
  * NOTE: if you are using io completion ports, this is a risky call. We use it in places, but only when we're certain
  * there's no pending events. If you want to use it, it's your job to make sure you don't have pending events before
  * calling it.
@@ -326,7 +479,8 @@ int aws_event_loop_unsubscribe_from_io_events(struct aws_event_loop *event_loop,
 /**
  * Cleans up resources (user_data) associated with the I/O eventing subsystem for a given handle. This should only
  * ever be necessary in the case where you are cleaning up an event loop during shutdown and its thread has already
- * been joined.
+ * been joined. It takes the place of unsubscribing the handle, which is no longer counted by
+ * aws_event_loop_get_load_factor() afterwards.
  */
 AWS_IO_API
 void aws_event_loop_free_io_event_resources(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
@@ -343,6 +497,31 @@ bool aws_event_loop_thread_is_callers_thread(struct aws_event_loop *event_loop);
 AWS_IO_API
 int aws_event_loop_current_clock_time(struct aws_event_loop *event_loop, uint64_t *time_nanos);
 
+/**
+ * Returns a rough measure of how busy the loop is, for picking between loops. Currently this is the number of io
+ * handles subscribed to it, which is always 0 for loops using completion ports. This function is thread-safe.
+ */
+AWS_IO_API
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop);
+
+/**
+ * Fills stats with the loop's counters. This function is thread-safe. Raises AWS_ERROR_UNSUPPORTED_OPERATION for loop
+ * implementations that don't keep statistics, currently everything but the epoll and io_uring loops.
+ */
+AWS_IO_API
+int aws_event_loop_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats);
+
+/**
+ * Event-loop thread only. For code that runs other people's code from inside a task or io event callback, e.g. the
+ * channel running its tasks: records fn as the loop's current_inner_fn, so that stall reports name fn rather than the
+ * wrapper. Returns the fn recorded before, which the caller should put back once fn returns. Loops that don't keep
+ * statistics ignore this and return NULL.
+ */
+AWS_IO_API
+aws_event_loop_inner_fn *aws_event_loop_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn);
+
 /**
  * Initializes an event loop group, with clock, number of loops to manage, and the function to call for creating a new
  * event loop.
@@ -367,6 +546,34 @@ int aws_event_loop_group_default_init(
     struct aws_allocator *alloc,
     uint16_t max_threads);
 
+/**
+ * Same as aws_event_loop_group_default_init(), but with control over where the loop threads run, see
+ * aws_event_loop_group_options.
+ *
+ * Pinned loops are started with the calling thread temporarily restricted to the loop's CPUs, so the loop thread runs
+ * there from its first instruction and the memory it touches (its stack, the epoll event array, message pools created
+ * on it later) is placed on its own NUMA node by the kernel's first-touch policy. The caller's affinity is restored
+ * before this returns. Pinning is only supported on Linux, elsewhere asking for cpu_ids fails with
+ * AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+AWS_IO_API
+int aws_event_loop_group_init_with_options(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_group_options *options);
+
+#ifdef AWS_USE_IO_URING
+/**
+ * Same as aws_event_loop_group_default_init(), but each loop is created with aws_event_loop_new_io_uring(). Loops fall
+ * back to epoll on kernels without io_uring support.
+ */
+AWS_IO_API
+int aws_event_loop_group_io_uring_init(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    uint16_t max_threads);
+#endif /* AWS_USE_IO_URING */
+
 /**
  * Destroys each event loop in the event loop group and then cleans up resources.
  */
@@ -381,8 +588,10 @@ size_t aws_event_loop_group_get_loop_count(struct aws_event_loop_group *el_group
 
 /**
  * Fetches the next loop for use. The purpose is to enable load balancing across loops. You should not depend on how
- * this load balancing is done as it is subject to change in the future. Currently it just returns them round-robin
- * style.
+ * this load balancing is done as it is subject to change in the future. Currently it takes the next loop round-robin
+ * style and one other loop at random, and returns whichever has the lower aws_event_loop_get_load_factor(), the
+ * round-robin one on a tie. Idle groups and bursts of new work are therefore still spread evenly, while loops left
+ * with many long-lived connections stop being handed new ones.
  */
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group);
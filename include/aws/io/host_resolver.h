@@ -100,6 +100,24 @@ struct aws_host_resolver {
     struct aws_host_resolver_vtable *vtable;
 };
 
+enum {
+    /* how many worker threads the default resolver resolves and refreshes hosts on, unless told otherwise. */
+    AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT = 4,
+};
+
+/**
+ * Options for aws_host_resolver_init_default_with_options().
+ */
+struct aws_host_resolver_default_options {
+    /* the most host entries kept in the cache. */
+    size_t max_entries;
+    struct aws_event_loop_group *el_group;
+    /* the most worker threads resolving and refreshing hosts, however many hosts there are. They're started as
+     * they're needed and run until the resolver is cleaned up. Zero means the default,
+     * AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT. */
+    size_t max_worker_count;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /**
@@ -164,6 +182,14 @@ AWS_IO_API int aws_host_resolver_init_default(
     size_t max_entries,
     struct aws_event_loop_group *el_group);
 
+/**
+ * Like aws_host_resolver_init_default(), with the resolver's limits spelled out in `options`.
+ */
+AWS_IO_API int aws_host_resolver_init_default_with_options(
+    struct aws_host_resolver *resolver,
+    struct aws_allocator *allocator,
+    const struct aws_host_resolver_default_options *options);
+
 #ifdef AWS_USE_LIBUV
 
 struct uv_loop_s;
@@ -86,6 +86,14 @@ struct aws_io_message {
      */
     void *user_data;
 
+    /**
+     * The next message in a chain, or NULL. A chain is written out in order as if it were one message, so a handler
+     * that adds framing can put a small message of its own in front of a payload instead of copying the payload into
+     * a bigger one. Every message in the chain keeps its own on_completion. Build chains with
+     * aws_io_message_chain_append() and only send them in the write direction.
+     */
+    struct aws_io_message *next_in_chain;
+
     /** it's incredibly likely something is going to need to queue this,
      * go ahead and make sure the list info is part of the original allocation.
      */
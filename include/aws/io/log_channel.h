@@ -33,11 +33,17 @@ struct aws_log_writer;
 struct aws_log_channel;
 
 typedef int(aws_log_channel_send_fn)(struct aws_log_channel *channel, struct aws_string *output);
+typedef int(aws_log_channel_send_line_fn)(struct aws_log_channel *channel, struct aws_byte_cursor line);
 typedef void(aws_log_channel_clean_up_fn)(struct aws_log_channel *channel);
 
 struct aws_log_channel_vtable {
     aws_log_channel_send_fn *send;
     aws_log_channel_clean_up_fn *clean_up;
+    /*
+     * Optional.  Sends a line that the caller keeps ownership of; the channel copies whatever it needs before
+     * returning.
+     */
+    aws_log_channel_send_line_fn *send_line;
 };
 
 struct aws_log_channel {
@@ -47,6 +53,50 @@ struct aws_log_channel {
     void *impl;
 };
 
+/*
+ * What a background channel does with a line sent while its queue is full
+ */
+enum aws_log_channel_overflow_policy {
+    /*
+     * The sender waits for the background thread to make room.  No lines are lost.
+     */
+    AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+
+    /*
+     * The line is thrown away and counted.  The background thread writes how many were dropped once it catches up.
+     */
+    AWS_LOG_CHANNEL_OVERFLOW_DROP,
+};
+
+struct aws_log_channel_background_options {
+    /*
+     * How many lines can be queued for the background thread, rounded up to a power of two.  If zero, 1024 is used.
+     */
+    size_t queue_size;
+
+    /*
+     * Lines up to this many bytes are copied into storage preallocated with the queue, longer ones are queued as they
+     * are.  If zero, 256 is used.
+     */
+    size_t line_slot_size;
+
+    enum aws_log_channel_overflow_policy overflow_policy;
+
+    /*
+     * The background thread hands everything it finds queued to the writer in batches of up to this many bytes (a
+     * longer line goes out on its own).  If zero, 64KB is used.
+     */
+    size_t flush_size;
+
+    /*
+     * After handing a batch to the writer, the background thread waits this long before looking for more lines, so
+     * that lines sent in the meantime go out together.  If the queue fills up in the meantime, senders wait or drop
+     * lines according to the overflow policy, so the queue should be sized for the interval.  If zero, lines are
+     * written as soon as the background thread sees them.
+     */
+    uint64_t flush_interval_ns;
+};
+
 AWS_EXTERN_C_BEGIN
 
 /*
@@ -61,7 +111,9 @@ int aws_log_channel_init_foreground(
     struct aws_log_writer *writer);
 
 /*
- * Simple channel that sends log lines to a background thread.
+ * Simple channel that sends log lines to a background thread.  Lines are passed through a bounded lock-free queue,
+ * so senders on different threads don't serialize on each other.  Uses the default options, which block senders
+ * while the queue is full.  Supports send_line, which copies lines that fit into the queue's preallocated storage.
  *
  * The passed in log writer is not an ownership transfer.  The log channel does not clean up the writer.
  */
@@ -71,6 +123,16 @@ int aws_log_channel_init_background(
     struct aws_allocator *allocator,
     struct aws_log_writer *writer);
 
+/*
+ * Same as aws_log_channel_init_background, with control over the queue's size and what happens when it fills up.
+ */
+AWS_IO_API
+int aws_log_channel_init_background_with_options(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_background_options *options);
+
 /*
  * Channel cleanup function
  */
@@ -26,6 +26,7 @@
 #include <stdio.h>
 
 struct aws_allocator;
+struct aws_byte_buf;
 struct aws_string;
 
 /*
@@ -44,11 +45,28 @@ typedef int(aws_log_formatter_format_fn)(
     const char *format,
     va_list args);
 
+/*
+ * Appends a formatted line to output without allocating.  Fails with AWS_ERROR_SHORT_BUFFER if the line doesn't fit,
+ * leaving output's length as it was, in which case the caller can still fall back to format.
+ */
+typedef int(aws_log_formatter_format_to_buffer_fn)(
+    struct aws_log_formatter *formatter,
+    struct aws_byte_buf *output,
+    enum aws_log_level level,
+    aws_log_subject_t subject,
+    const char *format,
+    va_list args);
+
 typedef void(aws_log_formatter_clean_up_fn)(struct aws_log_formatter *logger);
 
 struct aws_log_formatter_vtable {
     aws_log_formatter_format_fn *format;
     aws_log_formatter_clean_up_fn *clean_up;
+    /*
+     * Optional.  If set, and the channel can take a line as bytes, the pipeline logger formats into a buffer on the
+     * logging thread's stack and skips allocating a string per line.
+     */
+    aws_log_formatter_format_to_buffer_fn *format_to_buffer;
 };
 
 struct aws_log_formatter {
@@ -67,6 +85,8 @@ AWS_EXTERN_C_BEGIN
  * Initializes the default log formatter which outputs lines in the format:
  *
  *   [<LogLevel>] [<Timestamp>] [<ThreadId>] - <User content>\n
+ *
+ * Each thread caches the text of its current timestamp for the second it's in.  Supports format_to_buffer.
  */
 AWS_IO_API
 int aws_log_formatter_init_default(
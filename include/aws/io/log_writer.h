@@ -27,15 +27,25 @@ struct aws_string;
  *
  * A log writer functions as a sink for formatted log lines.  We provide
  * default implementations that go to stdout, stderr, and a specified file.
+ * Where writev() is available, they write a batch of lines with a single call.
  */
 struct aws_log_writer;
 
 typedef int(aws_log_writer_write_fn)(struct aws_log_writer *writer, const struct aws_string *output);
+typedef int(aws_log_writer_write_batch_fn)(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *lines,
+    size_t line_count);
 typedef void(aws_log_writer_clean_up_fn)(struct aws_log_writer *writer);
 
 struct aws_log_writer_vtable {
     aws_log_writer_write_fn *write;
     aws_log_writer_clean_up_fn *clean_up;
+    /*
+     * Optional.  Writes several lines, in order, as if by one write call per line.  The background channel hands
+     * everything it has pending to this at once.
+     */
+    aws_log_writer_write_batch_fn *write_batch;
 };
 
 struct aws_log_writer {
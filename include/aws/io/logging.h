@@ -16,6 +16,7 @@
  * permissions and limitations under the License.
  */
 
+#include <aws/common/atomics.h>
 #include <aws/io/io.h>
 
 struct aws_log_channel;
@@ -100,6 +101,17 @@ struct aws_log_subject_info_list {
     size_t count;
 };
 
+/**
+ * Log levels that can be set per subject, falling back to a default for subjects that have none of their own.  Lookups
+ * index straight into the table and levels can be changed from any thread while logging goes on.
+ */
+struct aws_log_subject_levels {
+    struct aws_allocator *allocator;
+    struct aws_atomic_var default_level;
+    /* 4 bits per subject: 0 if the subject uses default_level, its level + 1 otherwise */
+    struct aws_atomic_var *subject_words;
+};
+
 struct aws_logger;
 
 /**
@@ -122,6 +134,8 @@ struct aws_logger_vtable {
         ;
     enum aws_log_level (*const get_log_level)(struct aws_logger *logger, aws_log_subject_t subject);
     void (*const clean_up)(struct aws_logger *logger);
+    /* Optional.  Loggers that support changing levels at run time return the table get_log_level reads from. */
+    struct aws_log_subject_levels *(*const get_subject_levels)(struct aws_logger *logger);
 };
 
 struct aws_logger {
@@ -142,7 +156,7 @@ struct aws_logger_pipeline {
     struct aws_log_channel *channel;
     struct aws_log_writer *writer;
     struct aws_allocator *allocator;
-    enum aws_log_level level;
+    struct aws_log_subject_levels levels;
 };
 
 /**
@@ -236,6 +250,56 @@ struct aws_logger *aws_logger_get(void);
 AWS_IO_API
 void aws_logger_clean_up(struct aws_logger *logger);
 
+/**
+ * Sets the level of every subject that doesn't have one of its own.  Fails with AWS_ERROR_UNSUPPORTED_OPERATION if the
+ * logger's levels can't be changed at run time.
+ */
+AWS_IO_API
+int aws_logger_set_log_level(struct aws_logger *logger, enum aws_log_level level);
+
+/**
+ * Sets the level of a single subject, e.g. AWS_LL_TRACE for AWS_LS_IO_DNS alone.  Fails with
+ * AWS_ERROR_UNSUPPORTED_OPERATION if the logger's levels can't be changed at run time.
+ */
+AWS_IO_API
+int aws_logger_set_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject, enum aws_log_level level);
+
+/**
+ * Puts a subject back on the logger's default level.
+ */
+AWS_IO_API
+int aws_logger_clear_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject);
+
+/**
+ * Initializes a level table with every subject at default_level.
+ */
+AWS_IO_API
+int aws_log_subject_levels_init(
+    struct aws_log_subject_levels *levels,
+    struct aws_allocator *allocator,
+    enum aws_log_level default_level);
+
+AWS_IO_API
+void aws_log_subject_levels_clean_up(struct aws_log_subject_levels *levels);
+
+/**
+ * Returns the subject's own level if it has one, the default level otherwise.
+ */
+AWS_IO_API
+enum aws_log_level aws_log_subject_levels_get(struct aws_log_subject_levels *levels, aws_log_subject_t subject);
+
+AWS_IO_API
+int aws_log_subject_levels_set_default(struct aws_log_subject_levels *levels, enum aws_log_level level);
+
+AWS_IO_API
+int aws_log_subject_levels_set(
+    struct aws_log_subject_levels *levels,
+    aws_log_subject_t subject,
+    enum aws_log_level level);
+
+AWS_IO_API
+int aws_log_subject_levels_clear(struct aws_log_subject_levels *levels, aws_log_subject_t subject);
+
 /**
  * Converts a log level to a c-string constant.  Intended primarily to support building log lines that
  * include the level in them, i.e.
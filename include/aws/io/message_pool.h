@@ -17,18 +17,60 @@
 #include <aws/common/array_list.h>
 #include <aws/io/io.h>
 
+/*
+ * A free list of equally sized segments. The first slab_segment_count segments are carved out of one allocation (the
+ * slab) made at init time, anything acquired past those is allocated on its own. Up to ideal_segment_count released
+ * segments are kept for reuse, slab segments always are.
+ *
+ * Once bounds are set with aws_memory_pool_set_bounds(), ideal_segment_count follows demand: it grows by however many
+ * acquisitions found the pool empty over a window of acquisitions, and shrinks by half of what sat unused for the
+ * whole window. A window ends after a fixed number of acquisitions, or early with aws_memory_pool_adapt().
+ */
 struct aws_memory_pool {
     struct aws_allocator *alloc;
     struct aws_array_list stack;
     uint16_t ideal_segment_count;
     size_t segment_size;
     void *data_ptr;
+    uint8_t *slab;
+    uint16_t slab_segment_count;
+    bool adaptive;
+    uint16_t min_segment_count;
+    uint16_t max_segment_count;
+    size_t window_acquire_count;
+    size_t window_miss_count;
+    size_t window_low_water;
+};
+
+enum { AWS_MESSAGE_POOL_MAX_SIZE_CLASSES = 8 };
+
+/*
+ * One size class of a message pool. A message is served from the smallest class whose msg_data_size fits its size
+ * hint.
+ */
+struct aws_message_pool_size_class {
+    /* payload capacity of the messages in this class */
+    size_t msg_data_size;
+    /* messages allocated up front, in one slab */
+    uint16_t preallocated_msg_count;
+    /* the class's high-water mark: released messages beyond this many idle ones are freed. Must be at least
+     * preallocated_msg_count. */
+    uint16_t max_retained_msg_count;
 };
 
 struct aws_message_pool {
     struct aws_allocator *alloc;
-    struct aws_memory_pool application_data_pool;
-    struct aws_memory_pool small_block_pool;
+    struct aws_memory_pool size_classes[AWS_MESSAGE_POOL_MAX_SIZE_CLASSES];
+    size_t size_class_count;
+};
+
+/*
+ * Limits on how many idle messages each size class of a message pool can adapt to keeping. A class never keeps fewer
+ * than it preallocated.
+ */
+struct aws_message_pool_bounds {
+    uint16_t min_retained_msg_count;
+    uint16_t max_retained_msg_count;
 };
 
 struct aws_message_pool_creation_args {
@@ -36,10 +78,22 @@ struct aws_message_pool_creation_args {
     uint8_t application_data_msg_count;
     size_t small_block_msg_data_size;
     uint8_t small_block_msg_count;
+    /*
+     * Optional. If set, these classes are used as given (sorted by msg_data_size, smallest first, at most
+     * AWS_MESSAGE_POOL_MAX_SIZE_CLASSES of them) and the four fields above are ignored. Otherwise classes are spread
+     * from small_block_msg_data_size up to application_data_msg_data_size, growing 4x at a time. The smallest and
+     * largest get small_block_msg_count and application_data_msg_count messages up front, the ones in between start
+     * empty and keep up to application_data_msg_count.
+     */
+    const struct aws_message_pool_size_class *size_classes;
+    size_t size_class_count;
 };
 
 AWS_EXTERN_C_BEGIN
 
+/**
+ * Initializes a pool with ideal_segment_count segments of segment_size preallocated in one slab.
+ */
 AWS_IO_API
 int aws_memory_pool_init(
     struct aws_memory_pool *mempool,
@@ -47,9 +101,39 @@ int aws_memory_pool_init(
     uint16_t ideal_segment_count,
     size_t segment_size);
 
+/**
+ * Same as aws_memory_pool_init(), but only slab_segment_count (at most ideal_segment_count) segments are preallocated.
+ * Up to ideal_segment_count released segments are still kept for reuse.
+ */
+AWS_IO_API
+int aws_memory_pool_init_with_slab(
+    struct aws_memory_pool *mempool,
+    struct aws_allocator *alloc,
+    uint16_t slab_segment_count,
+    uint16_t ideal_segment_count,
+    size_t segment_size);
+
 AWS_IO_API
 void aws_memory_pool_clean_up(struct aws_memory_pool *mempool);
 
+/**
+ * Lets the pool grow and shrink the number of segments it keeps between min_segment_count and max_segment_count,
+ * based on how often it's found empty. Anything it keeps beyond max_segment_count is freed right away.
+ */
+AWS_IO_API
+int aws_memory_pool_set_bounds(
+    struct aws_memory_pool *mempool,
+    uint16_t min_segment_count,
+    uint16_t max_segment_count);
+
+/**
+ * Ends the pool's current demand window now, growing or trimming it as if the window had filled up. A pool that stops
+ * being acquired from never fills a window, so call this periodically to have it give back what it no longer needs.
+ * Does nothing if bounds were never set.
+ */
+AWS_IO_API
+void aws_memory_pool_adapt(struct aws_memory_pool *mempool);
+
 /**
  * Acquires memory from the pool if available, otherwise, it attempts to allocate and returns the result.
  */
@@ -74,6 +158,18 @@ int aws_message_pool_init(
 AWS_IO_API
 void aws_message_pool_clean_up(struct aws_message_pool *msg_pool);
 
+/**
+ * Applies `bounds` to every size class of the pool, see aws_memory_pool_set_bounds().
+ */
+AWS_IO_API
+int aws_message_pool_set_bounds(struct aws_message_pool *msg_pool, const struct aws_message_pool_bounds *bounds);
+
+/**
+ * Calls aws_memory_pool_adapt() on every size class of the pool.
+ */
+AWS_IO_API
+void aws_message_pool_adapt(struct aws_message_pool *msg_pool);
+
 /**
  * Acquires a message from the pool if available, otherwise, it attempts to allocate. If a message is acquired,
  * note that size_hint is just a hint. the return value's capacity will be set to the actual buffer size.
@@ -0,0 +1,108 @@
+#ifndef AWS_IO_EVENT_LOOP_STATS_H
+#define AWS_IO_EVENT_LOOP_STATS_H
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/event_loop.h>
+
+#include <aws/common/atomics.h>
+
+struct aws_task;
+struct event_loop_task_record;
+
+/**
+ * The counters behind aws_event_loop_get_stats(), for event loop implementations to embed.
+ *
+ * Only the event-loop thread updates them. They're plain 64-bit fields, so they don't wrap around on 32-bit platforms,
+ * and each update is bracketed by bumps of a sequence number, which is odd while one is in progress. Other threads
+ * copy them in aws_event_loop_stats_tracker_get(), and retry if the sequence number shows an update got in the way.
+ *
+ * The scheduler runs tasks itself, so to time them one at a time the loop calls aws_event_loop_stats_track_task() as
+ * each task goes into its scheduler, and schedules the wrapper task it gets back instead. The wrapper runs the task
+ * with aws_task_run() and times that. The task's fn and arg are never touched, only task->reserved, which points at
+ * the wrapper until it runs or is canceled.
+ */
+struct aws_event_loop_stats_tracker {
+    struct aws_allocator *alloc;
+    aws_io_clock_fn *clock;
+    struct aws_atomic_var sequence;
+    /* event-loop thread writes only, with the sequence number odd. */
+    struct aws_event_loop_stats values;
+    /* records of tasks that ran, kept for reuse. */
+    struct event_loop_task_record *free_records;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API void aws_event_loop_stats_tracker_init(
+    struct aws_event_loop_stats_tracker *tracker,
+    struct aws_allocator *alloc,
+    aws_io_clock_fn *clock);
+
+/**
+ * Must be called after every tracked task has run or been canceled, i.e. after the loop's scheduler is cleaned up.
+ */
+AWS_IO_API void aws_event_loop_stats_tracker_clean_up(struct aws_event_loop_stats_tracker *tracker);
+
+/**
+ * Event-loop thread only. Returns the task to schedule in place of `task` so that its next run is timed. If there's no
+ * memory for that, returns `task` itself, which then just runs untimed.
+ */
+AWS_IO_API struct aws_task *aws_event_loop_stats_track_task(
+    struct aws_event_loop_stats_tracker *tracker,
+    struct aws_task *task);
+
+/**
+ * Event-loop thread only. Returns what aws_event_loop_stats_track_task() had the loop schedule for `task`, the one to
+ * cancel. Only call this for tasks that aren't on the loop's timing wheel themselves, as those use task->reserved too.
+ */
+AWS_IO_API struct aws_task *aws_event_loop_stats_scheduled_task(
+    const struct aws_event_loop_stats_tracker *tracker,
+    struct aws_task *task);
+
+/**
+ * Event-loop thread only. Adds n to one of the counters in tracker->values.
+ */
+AWS_IO_API void aws_event_loop_stats_add(struct aws_event_loop_stats_tracker *tracker, uint64_t *counter, uint64_t n);
+
+/**
+ * Event-loop thread only. Call with the time the loop woke up when it's done waiting, and with 0 right before it goes
+ * back to waiting.
+ */
+AWS_IO_API void aws_event_loop_stats_set_busy_since(struct aws_event_loop_stats_tracker *tracker, uint64_t now_ns);
+
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+/**
+ * Event-loop thread only. Records the io event callback about to run, and NULL once it has returned.
+ */
+AWS_IO_API void aws_event_loop_stats_set_io_event_fn(
+    struct aws_event_loop_stats_tracker *tracker,
+    aws_event_loop_on_event_fn *on_event);
+#endif
+
+/**
+ * Event-loop thread only. Records fn as current_inner_fn and returns the one it replaces, see
+ * aws_event_loop_set_current_inner_fn(). It's cleared along with the task or io event fn it was called from.
+ */
+AWS_IO_API aws_event_loop_inner_fn *aws_event_loop_stats_set_inner_fn(
+    struct aws_event_loop_stats_tracker *tracker,
+    aws_event_loop_inner_fn *fn);
+
+AWS_IO_API void aws_event_loop_stats_tracker_get(
+    const struct aws_event_loop_stats_tracker *tracker,
+    struct aws_event_loop_stats *stats);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_EVENT_LOOP_STATS_H */
@@ -0,0 +1,73 @@
+#ifndef AWS_IO_THREAD_AFFINITY_H
+#define AWS_IO_THREAD_AFFINITY_H
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/io.h>
+
+/*
+ * Helpers the event loop group uses to place its loop threads. Setting affinity and reading the NUMA layout are only
+ * implemented on Linux. Elsewhere the affinity calls fail with AWS_ERROR_UNSUPPORTED_OPERATION and the machine is
+ * reported as a single node.
+ */
+
+enum {
+    AWS_CPU_SET_MAX_CPUS = 1024,
+};
+
+/**
+ * A set of CPU ids below AWS_CPU_SET_MAX_CPUS. Zero it with aws_cpu_set_clear() before use.
+ */
+struct aws_cpu_set {
+    uint64_t bits[AWS_CPU_SET_MAX_CPUS / 64];
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API void aws_cpu_set_clear(struct aws_cpu_set *set);
+
+/**
+ * Adds cpu_id to the set. Raises AWS_ERROR_INVALID_ARGUMENT if it is AWS_CPU_SET_MAX_CPUS or more.
+ */
+AWS_IO_API int aws_cpu_set_add(struct aws_cpu_set *set, size_t cpu_id);
+
+AWS_IO_API bool aws_cpu_set_contains(const struct aws_cpu_set *set, size_t cpu_id);
+
+AWS_IO_API size_t aws_cpu_set_count(const struct aws_cpu_set *set);
+
+AWS_IO_API bool aws_cpu_set_eq(const struct aws_cpu_set *a, const struct aws_cpu_set *b);
+
+/**
+ * Fills `set` with the CPUs the calling thread is allowed to run on.
+ */
+AWS_IO_API int aws_thread_affinity_get_current(struct aws_cpu_set *set);
+
+/**
+ * Restricts the calling thread to the CPUs in `set`. Threads it launches afterwards inherit the restriction.
+ */
+AWS_IO_API int aws_thread_affinity_set_current(const struct aws_cpu_set *set);
+
+/**
+ * Returns how many NUMA nodes the machine has, 1 if that can't be determined.
+ */
+AWS_IO_API size_t aws_numa_node_count(void);
+
+/**
+ * Fills `set` with the CPUs of the node_index'th NUMA node (counting only online nodes, from 0).
+ */
+AWS_IO_API int aws_numa_node_get_cpus(size_t node_index, struct aws_cpu_set *set);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_THREAD_AFFINITY_H */
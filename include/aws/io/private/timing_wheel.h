@@ -0,0 +1,121 @@
+#ifndef AWS_IO_TIMING_WHEEL_H
+#define AWS_IO_TIMING_WHEEL_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/io.h>
+
+#include <aws/common/linked_list.h>
+
+struct aws_task;
+
+/**
+ * Hashed timing wheel used by the event loops to hold far-off future tasks (connect timeouts, TLS negotiation
+ * timeouts, etc...) without paying for a priority queue insert and remove per task.
+ *
+ * The wheel never runs anything itself. Tasks sit in the slot for their tick, linked through task->node, and once the
+ * clock reaches that tick aws_timing_wheel_expire() hands them back to the caller, who then puts them in its
+ * aws_task_scheduler with their original timestamp. Tasks therefore still run at exactly the time they asked for;
+ * the wheel only decides when they enter the scheduler. Insert and cancel are O(1).
+ *
+ * Only tasks at least min_delay_ns past the wheel's current tick are accepted, so short-lived tasks go straight to
+ * the scheduler and don't take two hops.
+ *
+ * Not thread safe, this is meant to be owned and touched only by the event-loop thread.
+ */
+struct aws_timing_wheel {
+    struct aws_allocator *alloc;
+    struct aws_linked_list *slots;
+    /* one bit per slot, set while the slot holds any tasks, so finding the next occupied slot skips empty ones 64 at
+     * a time. */
+    uint64_t *occupied_slots;
+    size_t slot_mask;
+    uint64_t tick_ns;
+    uint64_t min_delay_ns;
+    /* the next tick that hasn't been expired yet */
+    uint64_t current_tick;
+    size_t task_count;
+};
+
+enum {
+    AWS_TIMING_WHEEL_DEFAULT_SLOT_COUNT = 1024,
+};
+
+/* 10ms ticks, and tasks due at least a second out go on the wheel. */
+#define AWS_TIMING_WHEEL_DEFAULT_TICK_NS 10000000ULL
+#define AWS_TIMING_WHEEL_DEFAULT_MIN_DELAY_NS 1000000000ULL
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes the wheel with slot_count slots (must be a power of two) of tick_ns each, starting at now_ns.
+ */
+AWS_IO_API int aws_timing_wheel_init(
+    struct aws_timing_wheel *wheel,
+    struct aws_allocator *alloc,
+    uint64_t tick_ns,
+    size_t slot_count,
+    uint64_t min_delay_ns,
+    uint64_t now_ns);
+
+/**
+ * Releases the slots. The wheel must be empty, use aws_timing_wheel_take_all() first if it isn't.
+ */
+AWS_IO_API void aws_timing_wheel_clean_up(struct aws_timing_wheel *wheel);
+
+/**
+ * Puts task on the wheel if run_at_nanos is far enough out. Returns false, and leaves task alone, if it isn't and it
+ * should be scheduled directly instead. While the task is on the wheel the wheel owns task->node and task->reserved.
+ */
+AWS_IO_API bool aws_timing_wheel_try_schedule(
+    struct aws_timing_wheel *wheel,
+    struct aws_task *task,
+    uint64_t run_at_nanos);
+
+/**
+ * Removes task from the wheel if it is on it. Returns true if it was, in which case the caller is responsible for
+ * running it with AWS_TASK_STATUS_CANCELED.
+ */
+AWS_IO_API bool aws_timing_wheel_remove(struct aws_timing_wheel *wheel, struct aws_task *task);
+
+/**
+ * Advances the wheel to now_ns and moves every task whose tick has been reached onto the back of `expired`.
+ */
+AWS_IO_API void aws_timing_wheel_expire(
+    struct aws_timing_wheel *wheel,
+    uint64_t now_ns,
+    struct aws_linked_list *expired);
+
+/**
+ * Moves every task still on the wheel onto the back of `out`, used on shutdown.
+ */
+AWS_IO_API void aws_timing_wheel_take_all(struct aws_timing_wheel *wheel, struct aws_linked_list *out);
+
+/**
+ * If there's an occupied slot before limit_ns, returns true and sets *next_tick_ns to the start of its tick. That's
+ * when the event loop next needs to wake up and call aws_timing_wheel_expire().
+ */
+AWS_IO_API bool aws_timing_wheel_next_tick_time(
+    const struct aws_timing_wheel *wheel,
+    uint64_t limit_ns,
+    uint64_t *next_tick_ns);
+
+/**
+ * Returns true if there are no tasks on the wheel.
+ */
+AWS_IO_API bool aws_timing_wheel_is_empty(const struct aws_timing_wheel *wheel);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TIMING_WHEEL_H */
@@ -36,6 +36,9 @@ enum aws_socket_type {
     AWS_SOCKET_DGRAM,
 };
 
+/* Room for a congestion control algorithm's name and its terminating NUL, the same as Linux's TCP_CA_NAME_MAX. */
+#define AWS_SOCKET_TCP_CONGESTION_CONTROL_MAX_LEN 16
+
 struct aws_socket_options {
     enum aws_socket_type type;
     enum aws_socket_domain domain;
@@ -49,6 +52,52 @@ struct aws_socket_options {
      * lost. If zero OS defaults are used. On Windows, this option is meaningless until Windows 10 1703.*/
     uint16_t keep_alive_max_failed_probes;
     bool keepalive;
+    /* Linux TCP only. If non-zero, writes of at least this many bytes are sent with MSG_ZEROCOPY, so the kernel
+     * transmits straight out of the caller's buffer instead of copying it. The write's completion callback is then
+     * only invoked once the kernel reports that it is done with the buffer. Closing the socket while it isn't done
+     * resets the connection, so that it stops sending from buffers whose writes complete as cancelled. Copying is
+     * cheaper for small writes, so this is only worth it for sizes in the tens of KB and up. Zero (the default)
+     * disables it, and it is ignored on platforms that don't support it. */
+    size_t zero_copy_threshold;
+    /* TCP only. Set tcp_nodelay to turn off Nagle's algorithm, so small writes go out immediately rather than waiting
+     * for outstanding data to be acknowledged. */
+    bool tcp_nodelay;
+    /* TCP only, TCP_CORK on Linux and TCP_NOPUSH on the BSDs and Apple platforms. Set tcp_cork to hold back partial
+     * segments so that a run of small writes leaves as full ones. Linux sends what's held back after 200ms at the
+     * latest. Ignored elsewhere. */
+    bool tcp_cork;
+    /* TCP only, Linux only. Set tcp_quickack to acknowledge received data right away instead of delaying the ACK. The
+     * kernel drops out of quick ack mode on its own, so it's asked again after every read. Ignored elsewhere. */
+    bool tcp_quickack;
+    /* If non-zero, the kernel's send (SO_SNDBUF) and receive (SO_RCVBUF) buffer sizes in bytes. Linux doubles the
+     * value and caps it at net.core.wmem_max and net.core.rmem_max. Setting the receive buffer turns off Linux's
+     * receive buffer auto-tuning for the socket, and it has to be set before connecting to affect the TCP window
+     * scale, which aws_socket_init() takes care of. */
+    uint32_t send_buffer_size;
+    uint32_t receive_buffer_size;
+    /* TCP only, Linux and Apple platforms. If non-zero, the socket only reports writable while fewer than this many
+     * bytes are waiting in its send buffer without having been sent (TCP_NOTSENT_LOWAT). That keeps the send buffer
+     * from filling up with data that's already stale by the time it goes out. Ignored elsewhere. */
+    uint32_t tcp_not_sent_low_watermark;
+    /* TCP only, Linux only. If non-zero, the connection is dropped when sent data goes unacknowledged for this many
+     * milliseconds (TCP_USER_TIMEOUT), instead of after the kernel's retransmission limit of 15 minutes or so. Ignored
+     * elsewhere. */
+    uint32_t tcp_user_timeout_ms;
+    /* TCP only, Linux only. If not empty, the congestion control algorithm to use, such as "bbr" or "cubic"
+     * (TCP_CONGESTION). It has to be listed in net.ipv4.tcp_available_congestion_control, and unprivileged processes
+     * can only pick those in net.ipv4.tcp_allowed_congestion_control, otherwise the system default stays in place.
+     * Ignored elsewhere. */
+    char tcp_congestion_control[AWS_SOCKET_TCP_CONGESTION_CONTROL_MAX_LEN];
+    /* Linux UDP only (kernel 4.18+). If non-zero, the kernel splits each write into datagrams of this many bytes (the
+     * last one may be shorter), so a single aws_socket_write() or aws_socket_datagram can carry up to 64 segments and
+     * 64 KB in one go. The size has to fit in the path MTU. Zero (the default) sends every write as one datagram.
+     * Initializing the socket fails with AWS_ERROR_UNSUPPORTED_OPERATION where this isn't available. */
+    uint16_t udp_segment_size;
+    /* Linux UDP only (kernel 5.0+). If set, the kernel may coalesce equally sized datagrams from the same sender into
+     * one buffer, up to 64 KB, and aws_socket_read_datagrams() reports the size they were cut into. aws_socket_read()
+     * can't say where the datagrams begin, so only read with aws_socket_read_datagrams() when this is set. It is
+     * ignored where it isn't supported, the datagrams are then just read one at a time. */
+    bool udp_gro;
 };
 
 struct aws_socket;
@@ -95,6 +144,11 @@ typedef void(
  * readable, error_code will be AWS_ERROR_SUCCESS.
  */
 typedef void(aws_socket_on_readable_fn)(struct aws_socket *socket, int error_code, void *user_data);
+/**
+ * Callback for when the bytes queued for writing, having reached the socket's high watermark, have drained down to its
+ * low watermark. See aws_socket_set_write_watermarks().
+ */
+typedef void(aws_socket_on_writable_fn)(struct aws_socket *socket, void *user_data);
 
 #ifdef _WIN32
 #    define AWS_ADDRESS_MAX_LEN 256
@@ -126,6 +180,23 @@ struct aws_socket {
 struct aws_byte_buf;
 struct aws_byte_cursor;
 
+/**
+ * One datagram for aws_socket_read_datagrams() and aws_socket_write_datagrams().
+ */
+struct aws_socket_datagram {
+    /* Reading fills the buffer from len up to capacity and advances len. Writing sends the first len bytes. */
+    struct aws_byte_buf *buffer;
+    /* Reading sets this to the sender's address. Writing sends to this address, or if it is zeroed, to the address
+     * the socket is connected to. */
+    struct aws_socket_endpoint endpoint;
+    /* Set by reading if the datagram didn't fit in the buffer. The part that didn't fit is lost. */
+    bool truncated;
+    /* Reading sets this to the size of each datagram in the buffer, which holds several back to back (the last one
+     * may be shorter) if the socket has udp_gro set. It's the length that was read for a single datagram. Writing
+     * splits the buffer into datagrams of this size, like udp_segment_size does for the whole socket, if non-zero. */
+    size_t segment_size;
+};
+
 /* These are hacks for working around headers and functions we need for IO work but aren't directly includable or
    linkable. these are purposely not exported. These functions only get called internally. The awkward aws_ prefixes are
    just in case someone includes this header somewhere they were able to get these definitions included. */
@@ -272,6 +343,19 @@ AWS_IO_API int aws_socket_subscribe_to_readable_events(
  */
 AWS_IO_API int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
 
+/**
+ * Like aws_socket_read(), but scatters what's read across several buffers in order, filling each one from `len` to
+ * `capacity` before moving on to the next, with a single system call where possible (readv()). `amount_read` is the
+ * total read into all of them, and each buffer's `len` is updated. A short read means the socket is drained for now.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read);
+
 /**
  * Writes to the socket. This call is non-blocking and will attempt to write as much as it can, but will queue any
  * remaining portion of the data for write when available. written_fn will be invoked once the entire cursor has been
@@ -289,6 +373,78 @@ AWS_IO_API int aws_socket_write(
     aws_socket_on_write_completed_fn *written_fn,
     void *user_data);
 
+/**
+ * Like aws_socket_write(), but writes several buffers back to back, gathering as many of them as possible into each
+ * system call. written_fn is invoked once, after the last buffer has been written (bytes_written only counts that
+ * one), or when the write failed or was cancelled. If this returns an error, written_fn will not be invoked.
+ *
+ * The cursors array itself is copied, but the memory the cursors point to must stay valid until written_fn runs.
+ */
+AWS_IO_API int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t cursor_count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data);
+
+/**
+ * Bounds how much data aws_socket_write() and aws_socket_write_vectored() let pile up. Once the bytes waiting in the
+ * socket's write queue reach high_watermark, aws_socket_is_writable() returns false until they have drained down to
+ * low_watermark, at which point on_writable is invoked from the event-loop thread. Writes are still accepted while the
+ * socket isn't writable, it's up to the caller to stop producing. A high_watermark of 0 (the default) turns this off.
+ *
+ * Only supported on POSIX platforms for now. Call it from the event-loop thread once the socket has one.
+ */
+AWS_IO_API int aws_socket_set_write_watermarks(
+    struct aws_socket *socket,
+    size_t low_watermark,
+    size_t high_watermark,
+    aws_socket_on_writable_fn *on_writable,
+    void *user_data);
+
+/**
+ * Returns false while the socket's queued writes are over its high watermark, see aws_socket_set_write_watermarks().
+ */
+AWS_IO_API bool aws_socket_is_writable(const struct aws_socket *socket);
+
+/**
+ * Returns how many bytes passed to aws_socket_write() and aws_socket_write_vectored() haven't been handed to the
+ * kernel yet.
+ */
+AWS_IO_API size_t aws_socket_get_pending_write_bytes(const struct aws_socket *socket);
+
+/**
+ * AWS_SOCKET_DGRAM only. Reads up to datagram_count datagrams, one into each datagram's buffer, in as few system calls
+ * as possible (recvmmsg() where it's available). `datagrams_read` is set to how many were read, which is less than
+ * datagram_count once nothing more is waiting. Fails with `AWS_IO_READ_WOULD_BLOCK` if nothing was waiting at all.
+ *
+ * Unlike aws_socket_read(), this reports where each datagram came from, so it's also useful on sockets that are only
+ * bound.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_read);
+
+/**
+ * AWS_SOCKET_DGRAM only. Sends each datagram to its endpoint, in as few system calls as possible (sendmmsg() where it's
+ * available). This doesn't queue anything: `datagrams_written` is set to how many the kernel took, and is less than
+ * datagram_count if the socket's send buffer filled up. Wait for the next tick and try the rest again.
+ *
+ * The datagrams don't go through the socket's write queue, so they may overtake ones still queued by
+ * aws_socket_write().
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_written);
+
 /**
  * Gets the latest error from the socket. If no error has occurred AWS_OP_SUCCESS will be returned. This function does
  * not raise any errors to the installed error handlers.
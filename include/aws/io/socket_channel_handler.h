@@ -22,6 +22,25 @@ struct aws_channel_handler;
 struct aws_channel_slot;
 struct aws_event_loop;
 
+/**
+ * How a socket handler reads and writes, see aws_socket_handler_new_with_options().
+ */
+struct aws_socket_handler_options {
+    /* The per-tick read budget: the most the handler reads from the socket before it yields to the event loop's other
+     * work (a continuation task will be scheduled). This is aws_socket_handler_new()'s max_read_size. */
+    size_t max_read_size;
+    /* The most pooled messages a single read system call fills (readv() where it's available), as long as the
+     * downstream window and the budget leave room for them. Zero or one reads into one message per system call, which
+     * costs a system call per pooled message's worth of data. */
+    size_t max_messages_per_read;
+    /* If non-zero, the socket's write watermarks (see aws_socket_set_write_watermarks()). While the socket has
+     * write_high_watermark bytes or more waiting to be written, aws_channel_slot_downstream_is_writable() returns false
+     * for the slots above it, and once they've drained to write_low_watermark, aws_channel_slot_on_writable() is
+     * called. POSIX only, creating the handler fails elsewhere. */
+    size_t write_high_watermark;
+    size_t write_low_watermark;
+};
+
 AWS_EXTERN_C_BEGIN
 /**
  * Socket handlers should be the first slot/handler in a channel. It interacts directly with the channel's event loop
@@ -34,6 +53,43 @@ AWS_IO_API struct aws_channel_handler *aws_socket_handler_new(
     struct aws_channel_slot *slot,
     size_t max_read_size);
 
+/**
+ * Like aws_socket_handler_new(), with the read behavior spelled out in `options`, which is copied.
+ */
+AWS_IO_API struct aws_channel_handler *aws_socket_handler_new_with_options(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    const struct aws_socket_handler_options *options);
+
+/**
+ * Like aws_socket_handler_new(), for a connected AWS_SOCKET_DGRAM socket, keeping datagram boundaries intact. Each
+ * datagram read is sent up the channel in a message of its own, and each message written goes out as one datagram.
+ *
+ * Up to max_datagrams_per_read datagrams are read per event loop tick, with as few system calls as
+ * aws_socket_read_datagrams() can manage, but only as many as fit the downstream window at max_datagram_size bytes
+ * each. Datagrams bigger than max_datagram_size (or than the channel's pooled messages) are dropped. Messages written
+ * during a tick are sent together with aws_socket_write_datagrams() after the tick's other tasks have run.
+ *
+ * The handler doesn't report where datagrams came from. Sockets that talk to more than one peer should use
+ * aws_socket_read_datagrams() and aws_socket_write_datagrams() directly.
+ *
+ * If the socket has udp_segment_size set, each message written is split into datagrams of that size. Sockets with
+ * udp_gro set are rejected, since a coalesced read would reach the channel as a single message.
+ *
+ * aws_channel_slot_downstream_is_writable() follows aws_socket_is_writable(), so write watermarks set on the socket
+ * hold back the handlers above this one. Whoever sets them gets the writable callback, and should pass it on with
+ * aws_channel_slot_on_writable().
+ *
+ * POSIX only, elsewhere this fails with AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+AWS_IO_API struct aws_channel_handler *aws_socket_handler_new_datagram(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    size_t max_datagram_size,
+    size_t max_datagrams_per_read);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_SOCKET_CHANNEL_HANDLER_H */
@@ -131,6 +131,20 @@ struct aws_event_loop_vtable s_kqueue_vtable = {
     .is_on_callers_thread = s_is_event_thread,
 };
 
+/* Busy polling is only implemented for epoll. */
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
+
+    if (options->busy_poll_ns || options->socket_busy_poll_us) {
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "static: busy polling is not supported by the kqueue event loop");
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        return NULL;
+    }
+
+    return aws_event_loop_new_system(alloc, options->clock);
+}
+
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
     AWS_ASSERT(alloc);
     AWS_ASSERT(clock);
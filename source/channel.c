@@ -16,6 +16,7 @@
 #include <aws/io/channel.h>
 
 #include <aws/common/atomics.h>
+#include <aws/common/clock.h>
 #include <aws/common/mutex.h>
 
 #include <aws/io/event_loop.h>
@@ -85,107 +86,262 @@ struct channel_setup_args {
     struct aws_task task;
 };
 
+/* how often a loop's message pool re-evaluates its demand even if channels stopped acquiring from it */
+enum { MESSAGE_POOL_ADAPT_INTERVAL_SECS = 5 };
+
+/* a loop's message pool, along with the task that keeps it trimmed while the loop is quiet */
+struct message_pool_local {
+    struct aws_message_pool msg_pool;
+    struct aws_event_loop *loop;
+    struct aws_task adapt_task;
+    bool adapt_task_scheduled;
+};
+
+static void s_message_pool_adapt_task(struct aws_task *task, void *arg, enum aws_task_status status);
+
+static void s_schedule_message_pool_adapt(struct message_pool_local *pool_local) {
+    uint64_t now = 0;
+    if (aws_event_loop_current_clock_time(pool_local->loop, &now)) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: failed to read the clock, message pool %p will only adapt as it's used.",
+            (void *)pool_local->loop,
+            (void *)&pool_local->msg_pool);
+        return;
+    }
+
+    uint64_t run_at = now + aws_timestamp_convert(
+                                MESSAGE_POOL_ADAPT_INTERVAL_SECS, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    aws_task_init(&pool_local->adapt_task, s_message_pool_adapt_task, pool_local);
+    aws_event_loop_schedule_task_future(pool_local->loop, &pool_local->adapt_task, run_at);
+    pool_local->adapt_task_scheduled = true;
+}
+
+static void s_message_pool_adapt_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct message_pool_local *pool_local = arg;
+    pool_local->adapt_task_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_message_pool_adapt(&pool_local->msg_pool);
+        s_schedule_message_pool_adapt(pool_local);
+    }
+}
+
 static void s_on_msg_pool_removed(struct aws_event_loop_local_object *object) {
-    struct aws_message_pool *msg_pool = object->object;
+    struct message_pool_local *pool_local = object->object;
     AWS_LOGF_TRACE(
         AWS_LS_IO_CHANNEL,
         "static: message pool %p has been purged "
         "from the event-loop: likely because of shutdown",
-        (void *)msg_pool);
-    struct aws_allocator *alloc = msg_pool->alloc;
-    aws_message_pool_clean_up(msg_pool);
-    aws_mem_release(alloc, msg_pool);
+        (void *)&pool_local->msg_pool);
+
+    /* when the loop is being destroyed, its tasks have already been canceled by now */
+    if (pool_local->adapt_task_scheduled) {
+        aws_event_loop_cancel_task(pool_local->loop, &pool_local->adapt_task);
+    }
+
+    struct aws_allocator *alloc = pool_local->msg_pool.alloc;
+    aws_message_pool_clean_up(&pool_local->msg_pool);
+    aws_mem_release(alloc, pool_local);
     aws_mem_release(alloc, object);
 }
 
-static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+/* how many idle messages each size class of a loop's pool may adapt to keeping, unless the group says otherwise */
+static const struct aws_message_pool_bounds s_default_message_pool_bounds = {
+    .min_retained_msg_count = 4,
+    .max_retained_msg_count = 64,
+};
 
-    (void)task;
-    struct channel_setup_args *setup_args = arg;
-    struct aws_message_pool *message_pool = NULL;
-    struct aws_event_loop_local_object *local_object = NULL;
+/* returns the message pool in the loop's local storage, creating it first if there isn't one. Loop thread only. */
+static struct aws_message_pool *s_fetch_or_create_message_pool(
+    struct aws_event_loop *loop,
+    struct aws_allocator *alloc) {
 
-    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
-    if (task_status == AWS_TASK_STATUS_RUN_READY) {
-        struct aws_event_loop_local_object stack_obj;
-        AWS_ZERO_STRUCT(stack_obj);
-        local_object = &stack_obj;
+    struct aws_event_loop_local_object stack_obj;
+    AWS_ZERO_STRUCT(stack_obj);
 
-        if (aws_event_loop_fetch_local_object(setup_args->channel->loop, &s_message_pool_key, local_object)) {
+    if (!aws_event_loop_fetch_local_object(loop, &s_message_pool_key, &stack_obj)) {
+        struct message_pool_local *pool_local = stack_obj.object;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: message pool %p found in event-loop local storage: using it.",
+            (void *)loop,
+            (void *)&pool_local->msg_pool)
+        return &pool_local->msg_pool;
+    }
 
-            local_object = aws_mem_acquire(setup_args->alloc, sizeof(struct aws_event_loop_local_object));
+    struct aws_event_loop_local_object *local_object =
+        aws_mem_acquire(alloc, sizeof(struct aws_event_loop_local_object));
 
-            if (!local_object) {
-                goto cleanup_setup_args;
-            }
+    if (!local_object) {
+        return NULL;
+    }
 
-            message_pool = aws_mem_acquire(setup_args->alloc, sizeof(struct aws_message_pool));
+    struct message_pool_local *pool_local = aws_mem_acquire(alloc, sizeof(struct message_pool_local));
 
-            if (!message_pool) {
-                goto cleanup_local_obj;
-            }
+    if (!pool_local) {
+        goto cleanup_local_obj;
+    }
 
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: no message pool is currently stored in the event-loop "
-                "local storage, adding %p with max message size %llu, "
-                "message count 4, with 4 small blocks of 128 bytes.",
-                (void *)setup_args->channel,
-                (void *)message_pool,
-                (unsigned long long)g_aws_channel_max_fragment_size);
-
-            struct aws_message_pool_creation_args creation_args = {
-                .application_data_msg_data_size = g_aws_channel_max_fragment_size,
-                .application_data_msg_count = 4,
-                .small_block_msg_count = 4,
-                .small_block_msg_data_size = 128,
-            };
-
-            if (aws_message_pool_init(message_pool, setup_args->alloc, &creation_args)) {
-                goto cleanup_msg_pool_mem;
-            }
+    AWS_ZERO_STRUCT(*pool_local);
+    pool_local->loop = loop;
+    struct aws_message_pool *message_pool = &pool_local->msg_pool;
 
-            local_object->key = &s_message_pool_key;
-            local_object->object = message_pool;
-            local_object->on_object_removed = s_on_msg_pool_removed;
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: no message pool is currently stored in the event-loop "
+        "local storage, adding %p with max message size %llu, "
+        "message count 4, with 4 small blocks of 128 bytes.",
+        (void *)loop,
+        (void *)message_pool,
+        (unsigned long long)g_aws_channel_max_fragment_size);
+
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = g_aws_channel_max_fragment_size,
+        .application_data_msg_count = 4,
+        .small_block_msg_count = 4,
+        .small_block_msg_data_size = 128,
+    };
+
+    if (aws_message_pool_init(message_pool, alloc, &creation_args)) {
+        goto cleanup_msg_pool_mem;
+    }
 
-            if (aws_event_loop_put_local_object(setup_args->channel->loop, local_object)) {
-                goto cleanup_msg_pool;
-            }
-        } else {
-            message_pool = local_object->object;
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: message pool %p found in event-loop local storage: using it.",
-                (void *)setup_args->channel,
-                (void *)message_pool)
-        }
+    if (aws_message_pool_set_bounds(message_pool, &s_default_message_pool_bounds)) {
+        goto cleanup_msg_pool;
+    }
 
-        setup_args->channel->msg_pool = message_pool;
-        setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
-        setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
-        aws_channel_release_hold(setup_args->channel);
-        aws_mem_release(setup_args->alloc, setup_args);
-        return;
+    local_object->key = &s_message_pool_key;
+    local_object->object = pool_local;
+    local_object->on_object_removed = s_on_msg_pool_removed;
+
+    if (aws_event_loop_put_local_object(loop, local_object)) {
+        goto cleanup_msg_pool;
     }
 
-    goto cleanup_setup_args;
+    s_schedule_message_pool_adapt(pool_local);
+
+    return message_pool;
 
 cleanup_msg_pool:
     aws_message_pool_clean_up(message_pool);
 
 cleanup_msg_pool_mem:
-    aws_mem_release(setup_args->alloc, message_pool);
+    aws_mem_release(alloc, pool_local);
 
 cleanup_local_obj:
-    aws_mem_release(setup_args->alloc, local_object);
+    aws_mem_release(alloc, local_object);
+
+    return NULL;
+}
+
+static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+
+    (void)task;
+    struct channel_setup_args *setup_args = arg;
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
+    if (task_status == AWS_TASK_STATUS_RUN_READY) {
+        struct aws_message_pool *message_pool =
+            s_fetch_or_create_message_pool(setup_args->channel->loop, setup_args->alloc);
+
+        if (message_pool) {
+            setup_args->channel->msg_pool = message_pool;
+            setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
+            setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
+            aws_channel_release_hold(setup_args->channel);
+            aws_mem_release(setup_args->alloc, setup_args);
+            return;
+        }
+    }
 
-cleanup_setup_args:
     setup_args->on_setup_completed(setup_args->channel, AWS_OP_ERR, setup_args->user_data);
     aws_channel_release_hold(setup_args->channel);
     aws_mem_release(setup_args->alloc, setup_args);
 }
 
+struct message_pool_bounds_update;
+
+struct message_pool_bounds_args {
+    struct message_pool_bounds_update *update;
+    struct aws_event_loop *loop;
+    struct aws_task task;
+};
+
+/* one allocation holds the task for every loop, so scheduling them can't fail halfway through the group. */
+struct message_pool_bounds_update {
+    struct aws_allocator *alloc;
+    struct aws_message_pool_bounds bounds;
+    /* tasks that haven't run yet, the last one to finish frees the update */
+    struct aws_atomic_var pending_loops;
+    struct message_pool_bounds_args loops[1];
+};
+
+static void s_set_message_pool_bounds_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct message_pool_bounds_args *bounds_args = arg;
+    struct message_pool_bounds_update *update = bounds_args->update;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        struct aws_message_pool *message_pool = s_fetch_or_create_message_pool(bounds_args->loop, update->alloc);
+
+        if (!message_pool || aws_message_pool_set_bounds(message_pool, &update->bounds)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: failed to set message pool bounds with error %d (%s).",
+                (void *)bounds_args->loop,
+                aws_last_error(),
+                aws_error_name(aws_last_error()));
+        }
+    }
+
+    if (aws_atomic_fetch_sub(&update->pending_loops, 1) == 1) {
+        aws_mem_release(update->alloc, update);
+    }
+}
+
+int aws_event_loop_group_set_message_pool_bounds(
+    struct aws_event_loop_group *el_group,
+    const struct aws_message_pool_bounds *bounds) {
+
+    if (bounds->min_retained_msg_count > bounds->max_retained_msg_count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    size_t loop_count = aws_event_loop_group_get_loop_count(el_group);
+    if (!loop_count) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct message_pool_bounds_update *update = aws_mem_acquire(
+        el_group->allocator,
+        sizeof(struct message_pool_bounds_update) + (loop_count - 1) * sizeof(struct message_pool_bounds_args));
+
+    if (!update) {
+        return AWS_OP_ERR;
+    }
+
+    update->alloc = el_group->allocator;
+    update->bounds = *bounds;
+    aws_atomic_init_int(&update->pending_loops, loop_count);
+
+    for (size_t i = 0; i < loop_count; ++i) {
+        struct message_pool_bounds_args *bounds_args = &update->loops[i];
+        bounds_args->update = update;
+        bounds_args->loop = aws_event_loop_group_get_loop_at(el_group, i);
+        aws_task_init(&bounds_args->task, s_set_message_pool_bounds_task, bounds_args);
+    }
+
+    /* the update may be freed by the last task, so don't touch it once that's scheduled */
+    for (size_t i = 0; i < loop_count; ++i) {
+        struct message_pool_bounds_args *bounds_args = &update->loops[i];
+        aws_event_loop_schedule_task_now(bounds_args->loop, &bounds_args->task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum aws_task_status status);
 
 struct aws_channel *aws_channel_new(
@@ -379,6 +535,29 @@ int aws_channel_shutdown(struct aws_channel *channel, int error_code) {
     return AWS_OP_SUCCESS;
 }
 
+void aws_io_message_chain_append(struct aws_io_message *head, struct aws_io_message *tail) {
+    while (head->next_in_chain) {
+        head = head->next_in_chain;
+    }
+    head->next_in_chain = tail;
+}
+
+size_t aws_io_message_chain_data_size(const struct aws_io_message *head) {
+    size_t data_size = 0;
+    for (; head; head = head->next_in_chain) {
+        data_size += head->message_data.len;
+    }
+    return data_size;
+}
+
+void aws_io_message_chain_release(struct aws_io_message *head) {
+    while (head) {
+        struct aws_io_message *next = head->next_in_chain;
+        aws_mem_release(head->allocator, head);
+        head = next;
+    }
+}
+
 struct aws_io_message *aws_channel_acquire_message_from_pool(
     struct aws_channel *channel,
     enum aws_io_message_type message_type,
@@ -452,6 +631,25 @@ int aws_channel_remove_local_object(
     return aws_event_loop_remove_local_object(channel->loop, (void *)key, removed_obj);
 }
 
+/* Runs the user's task fn, recording it so that a stall report names the task rather than the wrapper it's run from. */
+static void s_run_channel_task(
+    struct aws_channel *channel,
+    struct aws_channel_task *channel_task,
+    enum aws_task_status status) {
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        channel_task->task_fn(channel_task, channel_task->arg, status);
+        return;
+    }
+
+    /* the task may destroy the channel, the loop outlives it. */
+    struct aws_event_loop *loop = channel->loop;
+    aws_event_loop_inner_fn *previous_fn =
+        aws_event_loop_set_current_inner_fn(loop, (aws_event_loop_inner_fn *)channel_task->task_fn);
+    channel_task->task_fn(channel_task, channel_task->arg, status);
+    aws_event_loop_set_current_inner_fn(loop, previous_fn);
+}
+
 static void s_channel_task_run(struct aws_task *task, void *arg, enum aws_task_status status) {
     struct aws_channel_task *channel_task = AWS_CONTAINER_OF(task, struct aws_channel_task, wrapper_task);
     struct aws_channel *channel = arg;
@@ -462,7 +660,7 @@ static void s_channel_task_run(struct aws_task *task, void *arg, enum aws_task_s
     }
 
     aws_linked_list_remove(&channel_task->node);
-    channel_task->task_fn(channel_task, channel_task->arg, status);
+    s_run_channel_task(channel, channel_task, status);
 }
 
 static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum aws_task_status status) {
@@ -488,7 +686,7 @@ static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum
 
         if ((channel_task->wrapper_task.timestamp == 0) || (status == AWS_TASK_STATUS_CANCELED)) {
             /* Run "now" tasks, and canceled tasks, immediately */
-            channel_task->task_fn(channel_task, channel_task->arg, status);
+            s_run_channel_task(channel, channel_task, status);
         } else {
             /* "Future" tasks are scheduled with the event-loop. */
             aws_linked_list_push_back(&channel->channel_thread_tasks.list, &channel_task->node);
@@ -696,6 +894,79 @@ int aws_channel_slot_insert_left(struct aws_channel_slot *slot, struct aws_chann
     return AWS_OP_SUCCESS;
 }
 
+/* invoked once the last copy of a flattened chain is written, which is when the chain's own messages are done */
+static void s_on_flattened_chain_written(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+
+    struct aws_io_message *chain = user_data;
+    while (chain) {
+        struct aws_io_message *next = chain->next_in_chain;
+        if (chain->on_completion) {
+            chain->on_completion(chain->owning_channel, chain, err_code, chain->user_data);
+        }
+        aws_mem_release(chain->allocator, chain);
+        chain = next;
+    }
+}
+
+/* copies a chain into plain messages for a handler that doesn't take chains, and hands those to it in order. */
+static int s_send_flattened_chain(struct aws_channel_slot *slot, struct aws_io_message *chain) {
+    struct aws_channel_slot *target = slot->adj_left;
+    size_t remaining = aws_io_message_chain_data_size(chain);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: handler %p doesn't accept message chains, copying chain of size %llu",
+        (void *)slot->channel,
+        (void *)target->handler,
+        (unsigned long long)remaining);
+
+    struct aws_io_message *source = chain;
+    struct aws_byte_cursor source_cursor = aws_byte_cursor_from_buf(&source->message_data);
+
+    do {
+        struct aws_io_message *flattened =
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, remaining);
+        if (!flattened) {
+            return AWS_OP_ERR;
+        }
+
+        struct aws_byte_buf *dest = &flattened->message_data;
+        while (remaining && dest->len < dest->capacity) {
+            if (!source_cursor.len) {
+                source = source->next_in_chain;
+                source_cursor = aws_byte_cursor_from_buf(&source->message_data);
+                continue;
+            }
+
+            size_t to_copy = dest->capacity - dest->len;
+            if (to_copy > source_cursor.len) {
+                to_copy = source_cursor.len;
+            }
+            struct aws_byte_cursor piece = aws_byte_cursor_advance(&source_cursor, to_copy);
+            aws_byte_buf_append(dest, &piece);
+            remaining -= to_copy;
+        }
+
+        if (!remaining) {
+            flattened->on_completion = s_on_flattened_chain_written;
+            flattened->user_data = chain;
+        }
+
+        if (aws_channel_handler_process_write_message(target->handler, target, flattened)) {
+            aws_mem_release(flattened->allocator, flattened);
+            return AWS_OP_ERR;
+        }
+    } while (remaining);
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_channel_slot_send_message(
     struct aws_channel_slot *slot,
     struct aws_io_message *message,
@@ -705,6 +976,14 @@ int aws_channel_slot_send_message(
         AWS_ASSERT(slot->adj_right);
         AWS_ASSERT(slot->adj_right->handler);
 
+        if (message->next_in_chain) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: message chains can only be sent in the write direction, this is always a programming error.",
+                (void *)slot->channel);
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
         if (slot->adj_right->window_size >= message->message_data.len) {
             AWS_LOGF_TRACE(
                 AWS_LS_IO_CHANNEL,
@@ -733,6 +1012,11 @@ int aws_channel_slot_send_message(
 
     AWS_ASSERT(slot->adj_left);
     AWS_ASSERT(slot->adj_left->handler);
+
+    if (message->next_in_chain && !slot->adj_left->handler->vtable->accepts_message_chains) {
+        return s_send_flattened_chain(slot, message);
+    }
+
     AWS_LOGF_TRACE(
         AWS_LS_IO_CHANNEL,
         "id=%p: sending write message of size %llu, "
@@ -899,6 +1183,30 @@ size_t aws_channel_slot_downstream_read_window(struct aws_channel_slot *slot) {
     return slot->adj_right->window_size;
 }
 
+bool aws_channel_slot_downstream_is_writable(struct aws_channel_slot *slot) {
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(slot->channel));
+
+    for (struct aws_channel_slot *current = slot->adj_left; current; current = current->adj_left) {
+        struct aws_channel_handler *handler = current->handler;
+        if (handler && handler->vtable->is_writable && !handler->vtable->is_writable(handler)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void aws_channel_slot_on_writable(struct aws_channel_slot *slot) {
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(slot->channel));
+
+    for (struct aws_channel_slot *current = slot->adj_right; current; current = current->adj_right) {
+        struct aws_channel_handler *handler = current->handler;
+        if (handler && handler->vtable->on_writable) {
+            handler->vtable->on_writable(handler, current);
+        }
+    }
+}
+
 size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot) {
     return slot->upstream_message_overhead;
 }
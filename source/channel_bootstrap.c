@@ -128,6 +128,8 @@ struct aws_client_bootstrap *aws_client_bootstrap_new(
     bootstrap->allocator = allocator;
     bootstrap->event_loop_group = el_group;
     bootstrap->on_protocol_negotiated = NULL;
+    bootstrap->socket_handler_options.max_read_size = g_aws_channel_max_fragment_size;
+    bootstrap->socket_handler_options.max_messages_per_read = 1;
     aws_atomic_init_int(&bootstrap->ref_count, 1);
     bootstrap->host_resolver = host_resolver;
 
@@ -154,6 +156,21 @@ int aws_client_bootstrap_set_alpn_callback(
     return AWS_OP_SUCCESS;
 }
 
+int aws_client_bootstrap_set_socket_handler_options(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_socket_handler_options *options) {
+    AWS_ASSERT(options);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: Setting socket handler max_read_size to %llu and max_messages_per_read to %llu",
+        (void *)bootstrap,
+        (unsigned long long)options->max_read_size,
+        (unsigned long long)options->max_messages_per_read);
+    bootstrap->socket_handler_options = *options;
+    return AWS_OP_SUCCESS;
+}
+
 void aws_client_bootstrap_release(struct aws_client_bootstrap *bootstrap) {
     AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: releasing bootstrap reference", (void *)bootstrap);
 
@@ -361,11 +378,11 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
             goto error;
         }
 
-        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
+        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new_with_options(
             connection_args->bootstrap->allocator,
             connection_args->channel_data.socket,
             socket_slot,
-            g_aws_channel_max_fragment_size);
+            &connection_args->bootstrap->socket_handler_options);
 
         if (!socket_channel_handler) {
             err_code = aws_last_error();
@@ -829,9 +846,12 @@ struct aws_server_bootstrap *aws_server_bootstrap_new(
         (void *)bootstrap,
         (void *)el_group);
 
+    AWS_ZERO_STRUCT(*bootstrap);
     bootstrap->allocator = allocator;
     bootstrap->event_loop_group = el_group;
     bootstrap->on_protocol_negotiated = NULL;
+    bootstrap->socket_handler_options.max_read_size = g_aws_channel_max_fragment_size;
+    bootstrap->socket_handler_options.max_messages_per_read = 1;
     aws_atomic_init_int(&bootstrap->ref_count, 1);
 
     return bootstrap;
@@ -1006,11 +1026,11 @@ static void s_on_server_channel_on_setup_completed(struct aws_channel *channel,
             goto error;
         }
 
-        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
+        struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new_with_options(
             channel_data->server_connection_args->bootstrap->allocator,
             channel_data->socket,
             socket_slot,
-            g_aws_channel_max_fragment_size);
+            &channel_data->server_connection_args->bootstrap->socket_handler_options);
 
         if (!socket_channel_handler) {
             err_code = aws_last_error();
@@ -1319,3 +1339,18 @@ int aws_server_bootstrap_set_alpn_callback(
     bootstrap->on_protocol_negotiated = on_protocol_negotiated;
     return AWS_OP_SUCCESS;
 }
+
+int aws_server_bootstrap_set_socket_handler_options(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_socket_handler_options *options) {
+    AWS_ASSERT(options);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: Setting socket handler max_read_size to %llu and max_messages_per_read to %llu",
+        (void *)bootstrap,
+        (unsigned long long)options->max_read_size,
+        (unsigned long long)options->max_messages_per_read);
+    bootstrap->socket_handler_options = *options;
+    return AWS_OP_SUCCESS;
+}
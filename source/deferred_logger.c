@@ -0,0 +1,958 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/deferred_logger.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/date_time.h>
+#include <aws/common/string.h>
+#include <aws/common/thread.h>
+#include <aws/io/log_writer.h>
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+/*
+ * A log call is turned into a record: a header, then the value of each argument in the order the format string
+ * consumes them, in the argument's own representation.  Strings are copied as a 32-bit length, the bytes and a
+ * terminator.  Records are queued through a background channel, whose thread decodes them by walking the format
+ * string again and formatting one conversion at a time.
+ */
+enum {
+    /* records up to this size are encoded on the logging thread's stack, larger ones get a buffer of their own */
+    MAX_STACK_RECORD_SIZE = 2048,
+    /* conversion specifications longer than this, e.g. with absurd widths, are formatted right away */
+    MAX_CONVERSION_SPEC_SIZE = 32,
+    INITIAL_TEXT_CAPACITY = 16 * 1024,
+};
+
+/* tells records apart from lines the channel writes itself, like its dropped lines notice */
+static const uint32_t s_record_magic = 0x41574c52;
+
+/* what a call formatted right away is recorded as */
+static const char s_preformatted_format[] = "%s";
+
+static const uint32_t s_null_string_len = UINT32_MAX;
+
+struct deferred_log_record_header {
+    uint32_t magic;
+    uint32_t level;
+    aws_log_subject_t subject;
+    uint64_t timestamp_ns;
+    uint64_t thread_id;
+    const char *format;
+};
+
+enum deferred_arg_kind {
+    DEFERRED_ARG_NONE,
+    DEFERRED_ARG_INT,
+    DEFERRED_ARG_LONG,
+    DEFERRED_ARG_LONG_LONG,
+    DEFERRED_ARG_INTMAX,
+    DEFERRED_ARG_SIZE,
+    DEFERRED_ARG_PTRDIFF,
+    DEFERRED_ARG_DOUBLE,
+    DEFERRED_ARG_LONG_DOUBLE,
+    DEFERRED_ARG_POINTER,
+    DEFERRED_ARG_STRING,
+    DEFERRED_ARG_UNSUPPORTED,
+};
+
+enum conversion_length {
+    CONVERSION_LENGTH_NONE,
+    CONVERSION_LENGTH_HH,
+    CONVERSION_LENGTH_H,
+    CONVERSION_LENGTH_L,
+    CONVERSION_LENGTH_LL,
+    CONVERSION_LENGTH_J,
+    CONVERSION_LENGTH_Z,
+    CONVERSION_LENGTH_T,
+    CONVERSION_LENGTH_BIG_L,
+};
+
+/*
+ * One conversion specification, split up so that '*' widths and precisions can be replaced by the recorded values:
+ *
+ *   %<flags><width><.precision><length><conversion>
+ *   ^start ^flags_end ^width_end ^precision_end   ^end
+ */
+struct conversion_spec {
+    const char *start;
+    const char *flags_end;
+    const char *width_end;
+    const char *precision_end;
+    const char *end;
+    bool width_star;
+    bool precision_star;
+    /* -1 if there isn't one, or if it's given by '*' */
+    int precision;
+    enum deferred_arg_kind kind;
+};
+
+static enum deferred_arg_kind s_integer_kind(enum conversion_length length) {
+    switch (length) {
+        case CONVERSION_LENGTH_NONE:
+        case CONVERSION_LENGTH_HH:
+        case CONVERSION_LENGTH_H:
+            return DEFERRED_ARG_INT;
+        case CONVERSION_LENGTH_L:
+            return DEFERRED_ARG_LONG;
+        case CONVERSION_LENGTH_LL:
+            return DEFERRED_ARG_LONG_LONG;
+        case CONVERSION_LENGTH_J:
+            return DEFERRED_ARG_INTMAX;
+        case CONVERSION_LENGTH_Z:
+            return DEFERRED_ARG_SIZE;
+        case CONVERSION_LENGTH_T:
+            return DEFERRED_ARG_PTRDIFF;
+        default:
+            return DEFERRED_ARG_UNSUPPORTED;
+    }
+}
+
+static const char *s_parse_length(const char *p, enum conversion_length *length) {
+    switch (*p) {
+        case 'h':
+            if (p[1] == 'h') {
+                *length = CONVERSION_LENGTH_HH;
+                return p + 2;
+            }
+            *length = CONVERSION_LENGTH_H;
+            return p + 1;
+        case 'l':
+            if (p[1] == 'l') {
+                *length = CONVERSION_LENGTH_LL;
+                return p + 2;
+            }
+            *length = CONVERSION_LENGTH_L;
+            return p + 1;
+        case 'j':
+            *length = CONVERSION_LENGTH_J;
+            return p + 1;
+        case 'z':
+            *length = CONVERSION_LENGTH_Z;
+            return p + 1;
+        case 't':
+            *length = CONVERSION_LENGTH_T;
+            return p + 1;
+        case 'L':
+            *length = CONVERSION_LENGTH_BIG_L;
+            return p + 1;
+        default:
+            *length = CONVERSION_LENGTH_NONE;
+            return p;
+    }
+}
+
+/*
+ * Parses the conversion specification starting at the '%' at start.  Both the encoder and the decoder go through this,
+ * so they always agree on what a format string consumes.
+ */
+static void s_parse_conversion(const char *start, struct conversion_spec *spec) {
+    AWS_ZERO_STRUCT(*spec);
+    spec->start = start;
+    spec->precision = -1;
+    spec->kind = DEFERRED_ARG_UNSUPPORTED;
+
+    const char *p = start + 1;
+    if (*p == '%') {
+        spec->flags_end = spec->width_end = spec->precision_end = p;
+        spec->end = p + 1;
+        spec->kind = DEFERRED_ARG_NONE;
+        return;
+    }
+
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) {
+        ++p;
+    }
+    spec->flags_end = p;
+
+    if (*p == '*') {
+        spec->width_star = true;
+        ++p;
+    } else {
+        while (isdigit((unsigned char)*p)) {
+            ++p;
+        }
+    }
+    spec->width_end = p;
+
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec->precision_star = true;
+            ++p;
+        } else {
+            spec->precision = 0;
+            while (isdigit((unsigned char)*p)) {
+                /* anything past INT_MAX is left to vsnprintf, along with its complaints */
+                spec->precision = spec->precision <= (INT_MAX - 9) / 10 ? spec->precision * 10 + (*p - '0') : INT_MAX;
+                ++p;
+            }
+        }
+    }
+    spec->precision_end = p;
+
+    enum conversion_length length = CONVERSION_LENGTH_NONE;
+    p = s_parse_length(p, &length);
+
+    char conversion = *p;
+    spec->end = conversion != '\0' ? p + 1 : p;
+
+    if (spec->end - spec->start > MAX_CONVERSION_SPEC_SIZE || spec->precision == INT_MAX) {
+        return;
+    }
+
+    switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec->kind = s_integer_kind(length);
+            break;
+        case 'c':
+            if (length == CONVERSION_LENGTH_NONE) {
+                spec->kind = DEFERRED_ARG_INT;
+            }
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (length == CONVERSION_LENGTH_NONE || length == CONVERSION_LENGTH_L) {
+                spec->kind = DEFERRED_ARG_DOUBLE;
+            } else if (length == CONVERSION_LENGTH_BIG_L) {
+                spec->kind = DEFERRED_ARG_LONG_DOUBLE;
+            }
+            break;
+        case 's':
+            if (length == CONVERSION_LENGTH_NONE) {
+                spec->kind = DEFERRED_ARG_STRING;
+            }
+            break;
+        case 'p':
+            if (length == CONVERSION_LENGTH_NONE) {
+                spec->kind = DEFERRED_ARG_POINTER;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Encoding
+ */
+struct record_buffer {
+    uint8_t *buffer;
+    size_t capacity;
+    /* how many bytes the record needs, which is more than capacity if it didn't fit */
+    size_t len;
+};
+
+static void s_record_append(struct record_buffer *record, const void *data, size_t size) {
+    if (record->len + size <= record->capacity) {
+        memcpy(record->buffer + record->len, data, size);
+    }
+
+    record->len += size;
+}
+
+#define RECORD_APPEND_ARG(record, args, type)                                                                          \
+    do {                                                                                                               \
+        type value = va_arg(args, type);                                                                               \
+        s_record_append((record), &value, sizeof(value));                                                              \
+    } while (0)
+
+static void s_record_append_string(struct record_buffer *record, const char *str, int precision) {
+    if (str == NULL) {
+        s_record_append(record, &s_null_string_len, sizeof(s_null_string_len));
+        return;
+    }
+
+    /* with a precision, the argument doesn't have to be terminated, e.g. "%.*s" with a byte cursor */
+    size_t str_len = 0;
+    if (precision >= 0) {
+        const char *terminator = memchr(str, '\0', (size_t)precision);
+        str_len = terminator != NULL ? (size_t)(terminator - str) : (size_t)precision;
+    } else {
+        str_len = strlen(str);
+    }
+
+    uint32_t recorded_len = (uint32_t)aws_min_size(str_len, UINT32_MAX - 1);
+    const char terminator = '\0';
+
+    s_record_append(record, &recorded_len, sizeof(recorded_len));
+    s_record_append(record, str, recorded_len);
+    s_record_append(record, &terminator, sizeof(terminator));
+}
+
+/*
+ * Records the header and then every argument the format string consumes.  Returns false, leaving the record
+ * incomplete, if the format uses a conversion a record can't hold.
+ */
+static bool s_encode_record(
+    struct record_buffer *record,
+    const struct deferred_log_record_header *header,
+    va_list args) {
+
+    s_record_append(record, header, sizeof(*header));
+
+    const char *next = header->format;
+    while ((next = strchr(next, '%')) != NULL) {
+        struct conversion_spec spec;
+        s_parse_conversion(next, &spec);
+        next = spec.end;
+
+        if (spec.width_star) {
+            RECORD_APPEND_ARG(record, args, int);
+        }
+
+        int precision = spec.precision;
+        if (spec.precision_star) {
+            precision = va_arg(args, int);
+            s_record_append(record, &precision, sizeof(precision));
+        }
+
+        switch (spec.kind) {
+            case DEFERRED_ARG_NONE:
+                break;
+            case DEFERRED_ARG_INT:
+                RECORD_APPEND_ARG(record, args, int);
+                break;
+            case DEFERRED_ARG_LONG:
+                RECORD_APPEND_ARG(record, args, long);
+                break;
+            case DEFERRED_ARG_LONG_LONG:
+                RECORD_APPEND_ARG(record, args, long long);
+                break;
+            case DEFERRED_ARG_INTMAX:
+                RECORD_APPEND_ARG(record, args, intmax_t);
+                break;
+            case DEFERRED_ARG_SIZE:
+                RECORD_APPEND_ARG(record, args, size_t);
+                break;
+            case DEFERRED_ARG_PTRDIFF:
+                RECORD_APPEND_ARG(record, args, ptrdiff_t);
+                break;
+            case DEFERRED_ARG_DOUBLE:
+                RECORD_APPEND_ARG(record, args, double);
+                break;
+            case DEFERRED_ARG_LONG_DOUBLE:
+                RECORD_APPEND_ARG(record, args, long double);
+                break;
+            case DEFERRED_ARG_POINTER:
+                RECORD_APPEND_ARG(record, args, void *);
+                break;
+            case DEFERRED_ARG_STRING:
+                s_record_append_string(record, va_arg(args, const char *), precision);
+                break;
+            case DEFERRED_ARG_UNSUPPORTED:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static int s_record_move_to_heap(struct aws_allocator *allocator, struct record_buffer *record) {
+    uint8_t *buffer = aws_mem_acquire(allocator, record->len);
+    if (buffer == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    record->buffer = buffer;
+    record->capacity = record->len;
+    record->len = 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Formats the call right away and records the text as the argument of s_preformatted_format
+ */
+static int s_encode_preformatted(
+    struct aws_allocator *allocator,
+    struct record_buffer *record,
+    struct deferred_log_record_header *header,
+    const char *format,
+    va_list args) {
+
+    va_list measure_args;
+    va_copy(measure_args, args);
+    int text_len = vsnprintf(NULL, 0, format, measure_args);
+    va_end(measure_args);
+
+    if (text_len < 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    header->format = s_preformatted_format;
+    uint32_t recorded_len = (uint32_t)text_len;
+
+    record->len = sizeof(*header) + sizeof(recorded_len) + recorded_len + 1;
+    if (record->len > record->capacity) {
+        if (s_record_move_to_heap(allocator, record)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    record->len = 0;
+    s_record_append(record, header, sizeof(*header));
+    s_record_append(record, &recorded_len, sizeof(recorded_len));
+
+    va_list format_args;
+    va_copy(format_args, args);
+    vsnprintf((char *)record->buffer + record->len, recorded_len + 1, format, format_args);
+    va_end(format_args);
+
+    record->len += recorded_len + 1;
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Encodes a log call into record, which starts out as a buffer on the caller's stack.  If the record doesn't fit, it's
+ * encoded again into a buffer allocated for it, which the caller releases.
+ */
+static int s_encode_log_call(
+    struct aws_allocator *allocator,
+    struct record_buffer *record,
+    struct deferred_log_record_header *header,
+    va_list args) {
+
+    const char *format = header->format;
+
+    va_list encode_args;
+    va_copy(encode_args, args);
+    bool encoded = s_encode_record(record, header, encode_args);
+    va_end(encode_args);
+
+    if (!encoded) {
+        return s_encode_preformatted(allocator, record, header, format, args);
+    }
+
+    if (record->len <= record->capacity) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (s_record_move_to_heap(allocator, record)) {
+        return AWS_OP_ERR;
+    }
+
+    va_copy(encode_args, args);
+    s_encode_record(record, header, encode_args);
+    va_end(encode_args);
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Decoding
+ */
+
+/*
+ * Laid out like struct aws_string, like the background channel's line storage, so decoded text can be handed to the
+ * file writer as one.
+ */
+struct deferred_log_text {
+    struct aws_allocator *allocator;
+    size_t len;
+    uint8_t bytes[1];
+};
+
+struct deferred_log_decoder {
+    struct aws_allocator *allocator;
+    struct aws_log_writer *target;
+    struct deferred_log_text *text;
+    size_t text_capacity;
+    /* the text of the last timestamp decoded, which records mostly share */
+    bool timestamp_valid;
+    uint64_t timestamp_secs;
+    size_t timestamp_len;
+    char timestamp[AWS_DATE_TIME_STR_MAX_LEN];
+};
+
+static int s_append_printf(struct aws_byte_buf *output, const char *format, ...) {
+    size_t room = output->capacity - output->len;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf((char *)output->buffer + output->len, room, format, args);
+    va_end(args);
+
+    if (written < 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* vsnprintf needs room for a terminator too */
+    if ((size_t)written >= room) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    output->len += (size_t)written;
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_byte_cursor s_decode_timestamp(struct deferred_log_decoder *decoder, uint64_t timestamp_ns) {
+    uint64_t timestamp_secs = aws_timestamp_convert(timestamp_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+
+    if (!decoder->timestamp_valid || decoder->timestamp_secs != timestamp_secs) {
+        struct aws_date_time record_time;
+        aws_date_time_init_epoch_secs(&record_time, (double)timestamp_secs);
+
+        struct aws_byte_buf timestamp_buffer = {
+            .allocator = NULL,
+            .buffer = (uint8_t *)decoder->timestamp,
+            .capacity = sizeof(decoder->timestamp),
+            .len = 0,
+        };
+
+        decoder->timestamp_valid =
+            aws_date_time_to_utc_time_str(&record_time, AWS_DATE_FORMAT_ISO_8601, &timestamp_buffer) == AWS_OP_SUCCESS;
+        decoder->timestamp_len = decoder->timestamp_valid ? timestamp_buffer.len : 0;
+        decoder->timestamp_secs = timestamp_secs;
+    }
+
+    return aws_byte_cursor_from_array(decoder->timestamp, decoder->timestamp_len);
+}
+
+#define DECODE_ARG(output, spec_text, values, type)                                                                    \
+    do {                                                                                                               \
+        type value;                                                                                                    \
+        if (!aws_byte_cursor_read((values), &value, sizeof(value))) {                                                  \
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);                                                        \
+        }                                                                                                              \
+        return s_append_printf((output), (spec_text), value);                                                          \
+    } while (0)
+
+static int s_decode_conversion(
+    struct aws_byte_buf *output,
+    const struct conversion_spec *spec,
+    struct aws_byte_cursor *values) {
+
+    if (spec->kind == DEFERRED_ARG_NONE) {
+        return s_append_printf(output, "%%");
+    }
+
+    int width = 0;
+    if (spec->width_star && !aws_byte_cursor_read(values, &width, sizeof(width))) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    int precision = 0;
+    if (spec->precision_star && !aws_byte_cursor_read(values, &precision, sizeof(precision))) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* the specification as written, with any '*' replaced by the value that was passed for it */
+    char spec_text[MAX_CONVERSION_SPEC_SIZE + 32];
+    struct aws_byte_buf spec_buffer = aws_byte_buf_from_empty_array(spec_text, sizeof(spec_text));
+
+    struct aws_byte_cursor flags = aws_byte_cursor_from_array(spec->start, spec->flags_end - spec->start);
+    aws_byte_buf_append(&spec_buffer, &flags);
+
+    if (spec->width_star) {
+        /* a negative width reads as the '-' flag followed by a width, as it does for '*' */
+        s_append_printf(&spec_buffer, "%d", width);
+    } else {
+        struct aws_byte_cursor width_text =
+            aws_byte_cursor_from_array(spec->flags_end, spec->width_end - spec->flags_end);
+        aws_byte_buf_append(&spec_buffer, &width_text);
+    }
+
+    if (spec->precision_star) {
+        /* a negative precision is taken as if there were none */
+        if (precision >= 0) {
+            s_append_printf(&spec_buffer, ".%d", precision);
+        }
+    } else {
+        struct aws_byte_cursor precision_text =
+            aws_byte_cursor_from_array(spec->width_end, spec->precision_end - spec->width_end);
+        aws_byte_buf_append(&spec_buffer, &precision_text);
+    }
+
+    struct aws_byte_cursor conversion =
+        aws_byte_cursor_from_array(spec->precision_end, spec->end - spec->precision_end);
+    if (s_append_printf(&spec_buffer, "%.*s", (int)conversion.len, (const char *)conversion.ptr)) {
+        return AWS_OP_ERR;
+    }
+
+    switch (spec->kind) {
+        case DEFERRED_ARG_INT:
+            DECODE_ARG(output, spec_text, values, int);
+        case DEFERRED_ARG_LONG:
+            DECODE_ARG(output, spec_text, values, long);
+        case DEFERRED_ARG_LONG_LONG:
+            DECODE_ARG(output, spec_text, values, long long);
+        case DEFERRED_ARG_INTMAX:
+            DECODE_ARG(output, spec_text, values, intmax_t);
+        case DEFERRED_ARG_SIZE:
+            DECODE_ARG(output, spec_text, values, size_t);
+        case DEFERRED_ARG_PTRDIFF:
+            DECODE_ARG(output, spec_text, values, ptrdiff_t);
+        case DEFERRED_ARG_DOUBLE:
+            DECODE_ARG(output, spec_text, values, double);
+        case DEFERRED_ARG_LONG_DOUBLE:
+            DECODE_ARG(output, spec_text, values, long double);
+        case DEFERRED_ARG_POINTER:
+            DECODE_ARG(output, spec_text, values, void *);
+        case DEFERRED_ARG_STRING: {
+            uint32_t str_len = 0;
+            if (!aws_byte_cursor_read(values, &str_len, sizeof(str_len))) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+
+            if (str_len == s_null_string_len) {
+                return s_append_printf(output, spec_text, "(null)");
+            }
+
+            struct aws_byte_cursor str = aws_byte_cursor_advance(values, (size_t)str_len + 1);
+            if (str.ptr == NULL) {
+                return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            }
+
+            return s_append_printf(output, spec_text, (const char *)str.ptr);
+        }
+        default:
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+}
+
+static int s_decode_content(struct aws_byte_buf *output, const char *format, struct aws_byte_cursor *values) {
+    const char *next = format;
+
+    while (*next != '\0') {
+        const char *conversion_start = strchr(next, '%');
+
+        size_t literal_len = conversion_start != NULL ? (size_t)(conversion_start - next) : strlen(next);
+        struct aws_byte_cursor literal = aws_byte_cursor_from_array(next, literal_len);
+        if (aws_byte_buf_append(output, &literal)) {
+            return AWS_OP_ERR;
+        }
+
+        if (conversion_start == NULL) {
+            break;
+        }
+
+        struct conversion_spec spec;
+        s_parse_conversion(conversion_start, &spec);
+        next = spec.end;
+
+        if (s_decode_conversion(output, &spec, values)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Appends the line for a record to output, in the default formatter's layout.  Anything that isn't a record is
+ * appended as it is.  If the line doesn't fit, fails with AWS_ERROR_SHORT_BUFFER and leaves output as it was.
+ */
+static int s_decode_record(
+    struct deferred_log_decoder *decoder,
+    struct aws_byte_buf *output,
+    struct aws_byte_cursor record) {
+
+    struct deferred_log_record_header header;
+    if (record.len < sizeof(header) || memcmp(record.ptr, &s_record_magic, sizeof(s_record_magic)) != 0) {
+        return aws_byte_buf_append(output, &record);
+    }
+
+    aws_byte_cursor_read(&record, &header, sizeof(header));
+
+    const char *level_string = NULL;
+    if (aws_log_level_to_string((enum aws_log_level)header.level, &level_string)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor timestamp = s_decode_timestamp(decoder, header.timestamp_ns);
+    const char *subject_name = aws_log_subject_name(header.subject);
+
+    size_t starting_len = output->len;
+
+    if (s_append_printf(
+            output,
+            "[%s] [%.*s] [%" PRIu64 "] ",
+            level_string,
+            (int)timestamp.len,
+            (const char *)timestamp.ptr,
+            header.thread_id) ||
+        (subject_name != NULL && s_append_printf(output, "[%s]", subject_name)) ||
+        s_append_printf(output, " - ") || s_decode_content(output, header.format, &record) ||
+        s_append_printf(output, "\n")) {
+
+        output->len = starting_len;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_decoder_reserve_text(struct deferred_log_decoder *decoder, size_t capacity) {
+    struct deferred_log_text *text =
+        aws_mem_acquire(decoder->allocator, offsetof(struct deferred_log_text, bytes) + capacity + 1);
+    if (text == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    text->allocator = NULL;
+    text->len = 0;
+
+    if (decoder->text != NULL) {
+        aws_mem_release(decoder->allocator, decoder->text);
+    }
+
+    decoder->text = text;
+    decoder->text_capacity = capacity;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_decoder_flush(struct deferred_log_decoder *decoder, struct aws_byte_buf *output) {
+    if (output->len == 0) {
+        return;
+    }
+
+    decoder->text->len = output->len;
+    decoder->text->bytes[output->len] = 0;
+    (decoder->target->vtable->write)(decoder->target, (const struct aws_string *)(void *)decoder->text);
+
+    output->len = 0;
+}
+
+/*
+ * Decodes a batch of records into one piece of text, which goes to the file writer in a single write.  The text
+ * buffer is kept between batches and only grows when a single line doesn't fit in it.
+ */
+static int s_deferred_log_decoder_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *records,
+    size_t record_count) {
+
+    struct deferred_log_decoder *decoder = writer->impl;
+    struct aws_byte_buf output = aws_byte_buf_from_empty_array(decoder->text->bytes, decoder->text_capacity);
+
+    for (size_t i = 0; i < record_count; ++i) {
+        struct aws_byte_cursor record = aws_byte_cursor_from_string(records[i]);
+
+        while (s_decode_record(decoder, &output, record)) {
+            if (aws_last_error() != AWS_ERROR_SHORT_BUFFER) {
+                /* malformed, most likely cut short when the channel couldn't copy it all, so skip it */
+                break;
+            }
+
+            if (output.len > 0) {
+                s_decoder_flush(decoder, &output);
+                continue;
+            }
+
+            if (s_decoder_reserve_text(decoder, decoder->text_capacity * 2)) {
+                break;
+            }
+
+            output = aws_byte_buf_from_empty_array(decoder->text->bytes, decoder->text_capacity);
+        }
+    }
+
+    s_decoder_flush(decoder, &output);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_deferred_log_decoder_write(struct aws_log_writer *writer, const struct aws_string *record) {
+    return s_deferred_log_decoder_write_batch(writer, &record, 1);
+}
+
+static void s_deferred_log_decoder_clean_up(struct aws_log_writer *writer) {
+    struct deferred_log_decoder *decoder = writer->impl;
+
+    aws_mem_release(decoder->allocator, decoder->text);
+}
+
+static struct aws_log_writer_vtable s_deferred_log_decoder_vtable = {
+    .write = s_deferred_log_decoder_write,
+    .clean_up = s_deferred_log_decoder_clean_up,
+    .write_batch = s_deferred_log_decoder_write_batch,
+};
+
+/*
+ * Deferred logger
+ */
+struct aws_logger_deferred {
+    struct aws_allocator *allocator;
+    struct aws_log_subject_levels levels;
+    struct aws_log_writer file_writer;
+    struct deferred_log_decoder decoder;
+    struct aws_log_writer decoder_writer;
+    struct aws_log_channel channel;
+};
+
+static int s_deferred_logger_log(
+    struct aws_logger *logger,
+    enum aws_log_level log_level,
+    aws_log_subject_t subject,
+    const char *format,
+    ...) {
+
+    struct aws_logger_deferred *impl = logger->p_impl;
+
+    struct deferred_log_record_header header = {
+        .magic = s_record_magic,
+        .level = (uint32_t)log_level,
+        .subject = subject,
+        .timestamp_ns = 0,
+        .thread_id = aws_thread_current_thread_id(),
+        .format = format,
+    };
+    aws_sys_clock_get_ticks(&header.timestamp_ns);
+
+    uint8_t stack_record[MAX_STACK_RECORD_SIZE];
+    struct record_buffer record = {.buffer = stack_record, .capacity = sizeof(stack_record), .len = 0};
+
+    va_list format_args;
+    va_start(format_args, format);
+    int result = s_encode_log_call(impl->allocator, &record, &header, format_args);
+    va_end(format_args);
+
+    if (result == AWS_OP_SUCCESS) {
+        AWS_ASSERT(impl->channel.vtable->send_line != NULL);
+        result =
+            (impl->channel.vtable->send_line)(&impl->channel, aws_byte_cursor_from_array(record.buffer, record.len));
+    }
+
+    if (record.buffer != stack_record) {
+        aws_mem_release(impl->allocator, record.buffer);
+    }
+
+    return result;
+}
+
+static enum aws_log_level s_deferred_logger_get_log_level(struct aws_logger *logger, aws_log_subject_t subject) {
+    struct aws_logger_deferred *impl = logger->p_impl;
+
+    return aws_log_subject_levels_get(&impl->levels, subject);
+}
+
+static struct aws_log_subject_levels *s_deferred_logger_get_subject_levels(struct aws_logger *logger) {
+    struct aws_logger_deferred *impl = logger->p_impl;
+
+    return &impl->levels;
+}
+
+static void s_deferred_logger_clean_up(struct aws_logger *logger) {
+    struct aws_logger_deferred *impl = logger->p_impl;
+
+    /* the channel writes out whatever is still queued before it goes */
+    aws_log_channel_clean_up(&impl->channel);
+    aws_log_writer_clean_up(&impl->decoder_writer);
+    aws_log_writer_clean_up(&impl->file_writer);
+    aws_log_subject_levels_clean_up(&impl->levels);
+
+    aws_mem_release(impl->allocator, impl);
+}
+
+static struct aws_logger_vtable s_deferred_logger_vtable = {
+    .get_log_level = s_deferred_logger_get_log_level,
+    .log = s_deferred_logger_log,
+    .clean_up = s_deferred_logger_clean_up,
+    .get_subject_levels = s_deferred_logger_get_subject_levels,
+};
+
+int aws_logger_init_deferred(
+    struct aws_logger *logger,
+    struct aws_allocator *allocator,
+    struct aws_logger_deferred_options *options) {
+
+    struct aws_logger_deferred *impl = aws_mem_acquire(allocator, sizeof(struct aws_logger_deferred));
+    if (impl == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->allocator = allocator;
+
+    if (aws_log_subject_levels_init(&impl->levels, allocator, options->level)) {
+        goto on_init_levels_failure;
+    }
+
+    struct aws_log_writer_file_options file_writer_options = {
+        .filename = options->filename,
+        .file = options->file,
+    };
+
+    if (aws_log_writer_init_file(&impl->file_writer, allocator, &file_writer_options)) {
+        goto on_init_file_writer_failure;
+    }
+
+    impl->decoder.allocator = allocator;
+    impl->decoder.target = &impl->file_writer;
+
+    if (s_decoder_reserve_text(&impl->decoder, INITIAL_TEXT_CAPACITY)) {
+        goto on_reserve_text_failure;
+    }
+
+    impl->decoder_writer.vtable = &s_deferred_log_decoder_vtable;
+    impl->decoder_writer.allocator = allocator;
+    impl->decoder_writer.impl = &impl->decoder;
+
+    struct aws_log_channel_background_options channel_options = {
+        .queue_size = options->queue_size,
+        .line_slot_size = options->record_slot_size,
+        .overflow_policy = options->overflow_policy,
+    };
+
+    if (aws_log_channel_init_background_with_options(
+            &impl->channel, allocator, &impl->decoder_writer, &channel_options)) {
+        goto on_init_channel_failure;
+    }
+
+    logger->vtable = &s_deferred_logger_vtable;
+    logger->allocator = allocator;
+    logger->p_impl = impl;
+
+    return AWS_OP_SUCCESS;
+
+on_init_channel_failure:
+    aws_log_writer_clean_up(&impl->decoder_writer);
+
+on_reserve_text_failure:
+    aws_log_writer_clean_up(&impl->file_writer);
+
+on_init_file_writer_failure:
+    aws_log_subject_levels_clean_up(&impl->levels);
+
+on_init_levels_failure:
+    aws_mem_release(allocator, impl);
+
+    return AWS_OP_ERR;
+}
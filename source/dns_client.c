@@ -0,0 +1,1099 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/io/dns_client.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/byte_buf.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/device_random.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/common/task_scheduler.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/logging.h>
+
+#include <stdio.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+enum {
+    DNS_HEADER_LEN = 12,
+    DNS_MAX_NAME_LEN = 253,
+    DNS_MAX_LABEL_LEN = 63,
+    /* caps how many compression pointers we follow, so a malicious answer can't send us around in circles */
+    DNS_MAX_NAME_JUMPS = 16,
+    /* plenty for the A and AAAA records of any sane host, we don't do EDNS0 so the server won't send more than 512 */
+    DNS_READ_BUFFER_SIZE = 4096,
+
+    DNS_FLAG_QR = 0x8000,
+    DNS_FLAG_TC = 0x0200,
+    DNS_FLAG_RD = 0x0100,
+    DNS_RCODE_MASK = 0x000F,
+    DNS_RCODE_NXDOMAIN = 3,
+
+    DNS_TYPE_A = 1,
+    DNS_TYPE_AAAA = 28,
+    DNS_CLASS_IN = 1,
+
+    DNS_DEFAULT_QUERY_TIMEOUT_MS = 1000,
+    DNS_DEFAULT_MAX_ATTEMPTS = 3,
+};
+
+enum dns_client_state {
+    DNS_CLIENT_READY,
+    DNS_CLIENT_SHUT_DOWN,
+};
+
+struct dns_lookup;
+
+/* one question (a single record type) for one lookup. Lives inside the lookup. */
+struct dns_query {
+    struct dns_lookup *lookup;
+    uint16_t record_type;
+    uint16_t id;
+    /* every query gets a socket of its own, so that besides the random id, a spoofed answer has to guess which of
+     * the ephemeral ports the kernel picked it was sent from. Only its answers arrive here. */
+    struct aws_socket socket;
+    bool socket_open;
+    uint32_t attempts;
+    struct aws_task timeout_task;
+    bool timeout_scheduled;
+};
+
+struct dns_lookup {
+    struct aws_allocator *allocator;
+    struct aws_dns_client *client;
+    struct aws_string *host_name;
+    aws_dns_client_on_resolved_fn *on_resolved;
+    void *user_data;
+    struct aws_linked_list_node node;
+    struct dns_query queries[2];
+    size_t outstanding_queries;
+    /* first error any of the queries ran into, only reported if none of them found anything */
+    int error_code;
+    /* struct aws_host_address, by-value */
+    struct aws_array_list addresses;
+};
+
+struct aws_dns_client {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
+    struct aws_socket_endpoint name_server;
+    enum aws_socket_domain name_server_domain;
+    uint64_t query_timeout_ns;
+    uint32_t max_attempts;
+
+    /* everything from here to synced_data is only touched on the event-loop thread */
+    enum dns_client_state state;
+    struct aws_linked_list active_lookups;
+    struct aws_byte_buf read_buffer;
+    struct aws_task submit_task;
+    struct aws_task shutdown_task;
+
+    struct {
+        struct aws_mutex lock;
+        struct aws_condition_variable signal;
+        /* lookups from aws_dns_client_resolve_async() that haven't made it to the event-loop thread yet */
+        struct aws_linked_list pending_lookups;
+        bool submit_task_scheduled;
+        bool shut_down;
+        bool shutdown_complete;
+        /* the client was destroyed on its own loop while submit_task was still queued, so that task frees it */
+        bool release_in_submit_task;
+    } synced_data;
+};
+
+/* a sent packet, which the socket needs to hold onto until the write completes */
+struct dns_packet {
+    struct aws_allocator *allocator;
+    struct aws_byte_buf buffer;
+};
+
+static inline uint8_t s_to_lower(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c - 'A' + 'a') : c;
+}
+
+/* the name without its trailing dot, if it has one. */
+static struct aws_byte_cursor s_host_name_cursor(const struct aws_string *host_name) {
+    struct aws_byte_cursor name = aws_byte_cursor_from_array(aws_string_bytes(host_name), host_name->len);
+    if (name.len && name.ptr[name.len - 1] == '.') {
+        name.len -= 1;
+    }
+    return name;
+}
+
+static bool s_is_valid_host_name(const struct aws_string *host_name) {
+    struct aws_byte_cursor name = s_host_name_cursor(host_name);
+    if (name.len == 0 || name.len > DNS_MAX_NAME_LEN) {
+        return false;
+    }
+
+    size_t label_len = 0;
+    for (size_t i = 0; i < name.len; ++i) {
+        if (name.ptr[i] == '.') {
+            if (label_len == 0) {
+                return false;
+            }
+            label_len = 0;
+        } else if (++label_len > DNS_MAX_LABEL_LEN) {
+            return false;
+        }
+    }
+
+    return label_len > 0;
+}
+
+static int s_write_query_packet(struct aws_byte_buf *buffer, const struct dns_query *query) {
+    struct aws_byte_cursor name = s_host_name_cursor(query->lookup->host_name);
+
+    bool written = aws_byte_buf_write_be16(buffer, query->id) && aws_byte_buf_write_be16(buffer, DNS_FLAG_RD) &&
+                   aws_byte_buf_write_be16(buffer, 1) && aws_byte_buf_write_be16(buffer, 0) &&
+                   aws_byte_buf_write_be16(buffer, 0) && aws_byte_buf_write_be16(buffer, 0);
+
+    /* www.example.com goes out as \3www\7example\3com\0 */
+    size_t label_start = 0;
+    for (size_t i = 0; written && i <= name.len; ++i) {
+        if (i == name.len || name.ptr[i] == '.') {
+            written = aws_byte_buf_write_u8(buffer, (uint8_t)(i - label_start)) &&
+                      aws_byte_buf_write(buffer, name.ptr + label_start, i - label_start);
+            label_start = i + 1;
+        }
+    }
+
+    written = written && aws_byte_buf_write_u8(buffer, 0) && aws_byte_buf_write_be16(buffer, query->record_type) &&
+              aws_byte_buf_write_be16(buffer, DNS_CLASS_IN);
+
+    return written ? AWS_OP_SUCCESS : aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+}
+
+/* reads the (possibly compressed) name at cursor into name as lower-case dotted text and moves cursor past it.
+ * name must have room for DNS_MAX_NAME_LEN bytes. */
+static bool s_read_name(
+    struct aws_byte_cursor packet,
+    struct aws_byte_cursor *cursor,
+    uint8_t *name,
+    size_t *name_len) {
+    struct aws_byte_cursor reader = *cursor;
+    bool jumped = false;
+    size_t len = 0;
+
+    for (size_t jumps = 0; jumps <= DNS_MAX_NAME_JUMPS;) {
+        uint8_t label_len = 0;
+        if (!aws_byte_cursor_read_u8(&reader, &label_len)) {
+            return false;
+        }
+
+        if ((label_len & 0xC0) == 0xC0) {
+            uint8_t offset_low = 0;
+            if (!aws_byte_cursor_read_u8(&reader, &offset_low)) {
+                return false;
+            }
+
+            size_t offset = ((size_t)(label_len & 0x3F) << 8) | offset_low;
+            if (offset >= packet.len) {
+                return false;
+            }
+
+            /* the name's own bytes end at the first pointer, the rest of it lives elsewhere in the packet */
+            if (!jumped) {
+                *cursor = reader;
+                jumped = true;
+            }
+            reader = aws_byte_cursor_from_array(packet.ptr + offset, packet.len - offset);
+            ++jumps;
+            continue;
+        }
+
+        /* 0x40 and 0x80 are reserved label types */
+        if (label_len & 0xC0) {
+            return false;
+        }
+
+        if (label_len == 0) {
+            if (!jumped) {
+                *cursor = reader;
+            }
+            *name_len = len;
+            return true;
+        }
+
+        size_t separator_len = len ? 1 : 0;
+        struct aws_byte_cursor label = aws_byte_cursor_advance(&reader, label_len);
+        if (label.len != label_len || len + separator_len + label_len > DNS_MAX_NAME_LEN) {
+            return false;
+        }
+
+        if (separator_len) {
+            name[len++] = '.';
+        }
+        for (size_t i = 0; i < label.len; ++i) {
+            name[len++] = s_to_lower(label.ptr[i]);
+        }
+    }
+
+    return false;
+}
+
+static bool s_name_matches(const uint8_t *name, size_t name_len, const struct aws_string *host_name) {
+    struct aws_byte_cursor expected = s_host_name_cursor(host_name);
+    if (expected.len != name_len) {
+        return false;
+    }
+
+    for (size_t i = 0; i < name_len; ++i) {
+        if (s_to_lower(expected.ptr[i]) != name[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* RFC 5952 text form: lower-case hex, no leading zeros, and the longest run of two or more zero groups (the first,
+ * on a tie) shortened to "::" */
+static void s_format_ipv6(const uint8_t *bytes, char *output, size_t output_size) {
+    uint16_t groups[8];
+    for (size_t i = 0; i < 8; ++i) {
+        groups[i] = (uint16_t)((bytes[i * 2] << 8) | bytes[i * 2 + 1]);
+    }
+
+    size_t zeros_start = 8;
+    size_t zeros_len = 1;
+    for (size_t i = 0; i < 8;) {
+        if (groups[i]) {
+            ++i;
+            continue;
+        }
+
+        size_t run_end = i;
+        while (run_end < 8 && !groups[run_end]) {
+            ++run_end;
+        }
+        if (run_end - i > zeros_len) {
+            zeros_start = i;
+            zeros_len = run_end - i;
+        }
+        i = run_end;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        if (i == zeros_start) {
+            written += (size_t)snprintf(output + written, output_size - written, "::");
+            i += zeros_len - 1;
+            continue;
+        }
+
+        bool needs_separator = i > 0 && i != zeros_start + zeros_len;
+        written +=
+            (size_t)snprintf(output + written, output_size - written, "%s%x", needs_separator ? ":" : "", groups[i]);
+    }
+}
+
+static int s_add_address(struct dns_lookup *lookup, uint16_t record_type, const uint8_t *rdata, uint32_t ttl) {
+    /* enough for a full ipv6 address */
+    char address_buffer[48];
+    AWS_ZERO_ARRAY(address_buffer);
+
+    if (record_type == DNS_TYPE_A) {
+        snprintf(address_buffer, sizeof(address_buffer), "%u.%u.%u.%u", rdata[0], rdata[1], rdata[2], rdata[3]);
+    } else {
+        s_format_ipv6(rdata, address_buffer, sizeof(address_buffer));
+    }
+
+    /* a TTL of zero means "don't cache", but the caller needs the address to stay around long enough to be used. */
+    if (ttl == 0) {
+        ttl = 1;
+    }
+
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+
+    struct aws_host_address host_address;
+    AWS_ZERO_STRUCT(host_address);
+    host_address.allocator = lookup->allocator;
+    host_address.record_type = record_type == DNS_TYPE_AAAA ? AWS_ADDRESS_RECORD_TYPE_AAAA : AWS_ADDRESS_RECORD_TYPE_A;
+    host_address.expiry = now + aws_timestamp_convert(ttl, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    host_address.address = aws_string_new_from_c_str(lookup->allocator, address_buffer);
+    host_address.host = aws_string_new_from_string(lookup->allocator, lookup->host_name);
+
+    if (!host_address.address || !host_address.host) {
+        aws_host_address_clean_up(&host_address);
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: resolved record %s for host %s, ttl %u",
+        (void *)lookup->client,
+        address_buffer,
+        (const char *)aws_string_bytes(lookup->host_name),
+        (unsigned)ttl);
+
+    if (aws_array_list_push_back(&lookup->addresses, &host_address)) {
+        aws_host_address_clean_up(&host_address);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_lookup_destroy(struct dns_lookup *lookup) {
+    for (size_t i = 0; i < aws_array_list_length(&lookup->addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(&lookup->addresses, (void **)&address, i);
+        aws_host_address_clean_up(address);
+    }
+
+    aws_array_list_clean_up(&lookup->addresses);
+    aws_string_destroy(lookup->host_name);
+    aws_mem_release(lookup->allocator, lookup);
+}
+
+/* hands the lookup's result to the user and frees it. If error_code is zero, the result depends on what the queries
+ * found. */
+static void s_complete_lookup(struct dns_lookup *lookup, int error_code) {
+    if (!error_code && aws_array_list_length(&lookup->addresses) == 0) {
+        error_code = lookup->error_code ? lookup->error_code : AWS_IO_DNS_NO_ADDRESS_FOR_HOST;
+    }
+
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: lookup for %s failed with error %d (%s)",
+            (void *)lookup->client,
+            (const char *)aws_string_bytes(lookup->host_name),
+            error_code,
+            aws_error_str(error_code));
+    }
+
+    aws_linked_list_remove(&lookup->node);
+    lookup->on_resolved(lookup->client, lookup->host_name, error_code, &lookup->addresses, lookup->user_data);
+    s_lookup_destroy(lookup);
+}
+
+static void s_unregister_query(struct dns_query *query) {
+    struct aws_dns_client *client = query->lookup->client;
+
+    if (query->timeout_scheduled) {
+        aws_event_loop_cancel_task(client->event_loop, &query->timeout_task);
+    }
+
+    /* this can happen from inside the socket's own readable callback, clean up lets the socket finish that first. */
+    if (query->socket_open) {
+        aws_socket_close(&query->socket);
+        aws_socket_clean_up(&query->socket);
+        query->socket_open = false;
+    }
+}
+
+static void s_finish_query(struct dns_query *query, int error_code) {
+    struct dns_lookup *lookup = query->lookup;
+
+    s_unregister_query(query);
+
+    if (error_code && !lookup->error_code) {
+        lookup->error_code = error_code;
+    }
+
+    AWS_ASSERT(lookup->outstanding_queries > 0);
+    if (--lookup->outstanding_queries == 0) {
+        s_complete_lookup(lookup, AWS_OP_SUCCESS);
+    }
+}
+
+static void s_cancel_lookup(struct dns_lookup *lookup) {
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lookup->queries); ++i) {
+        s_unregister_query(&lookup->queries[i]);
+    }
+
+    s_complete_lookup(lookup, AWS_ERROR_IO_OPERATION_CANCELLED);
+}
+
+static void s_on_packet_written(struct aws_socket *socket, int error_code, size_t bytes_written, void *user_data) {
+    (void)bytes_written;
+    struct dns_packet *packet = user_data;
+
+    /* a lost query is handled by its timeout, just like a lost answer */
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: failed to send query with error %d (%s)",
+            (void *)socket,
+            error_code,
+            aws_error_str(error_code));
+    }
+
+    aws_byte_buf_clean_up(&packet->buffer);
+    aws_mem_release(packet->allocator, packet);
+}
+
+/* sends the query (again) and arms its timeout. A failed send counts as an attempt, the timeout retries it. */
+static void s_send_query(struct dns_query *query) {
+    struct aws_dns_client *client = query->lookup->client;
+    ++query->attempts;
+
+    struct aws_byte_cursor name = s_host_name_cursor(query->lookup->host_name);
+    struct dns_packet *packet = aws_mem_acquire(client->allocator, sizeof(struct dns_packet));
+    if (packet) {
+        packet->allocator = client->allocator;
+        /* the header, a length byte per label plus the terminating zero, then type and class */
+        if (aws_byte_buf_init(&packet->buffer, client->allocator, DNS_HEADER_LEN + name.len + 2 + 4)) {
+            aws_mem_release(client->allocator, packet);
+            packet = NULL;
+        }
+    }
+
+    if (packet) {
+        int result = s_write_query_packet(&packet->buffer, query);
+        if (!result) {
+            struct aws_byte_cursor to_send = aws_byte_cursor_from_buf(&packet->buffer);
+            result = aws_socket_write(&query->socket, &to_send, s_on_packet_written, packet);
+        }
+
+        /* on failure the write callback isn't invoked, it's still ours */
+        if (result) {
+            aws_byte_buf_clean_up(&packet->buffer);
+            aws_mem_release(client->allocator, packet);
+            packet = NULL;
+        }
+    }
+
+    if (!packet) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: failed to send query %u for %s with error %d (%s)",
+            (void *)client,
+            (unsigned)query->id,
+            (const char *)aws_string_bytes(query->lookup->host_name),
+            aws_last_error(),
+            aws_error_str(aws_last_error()));
+    }
+
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(client->event_loop, &now);
+    query->timeout_scheduled = true;
+    aws_event_loop_schedule_task_future(client->event_loop, &query->timeout_task, now + client->query_timeout_ns);
+}
+
+static void s_query_timeout_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct dns_query *query = arg;
+    query->timeout_scheduled = false;
+
+    /* cancellation only happens when the query is being torn down, whoever did that takes care of the rest */
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    struct aws_dns_client *client = query->lookup->client;
+    if (query->attempts < client->max_attempts) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: query %u for %s timed out, sending it again",
+            (void *)client,
+            (unsigned)query->id,
+            (const char *)aws_string_bytes(query->lookup->host_name));
+        s_send_query(query);
+        return;
+    }
+
+    AWS_LOGF_WARN(
+        AWS_LS_IO_DNS,
+        "id=%p: query %u for %s timed out after %u attempts",
+        (void *)client,
+        (unsigned)query->id,
+        (const char *)aws_string_bytes(query->lookup->host_name),
+        (unsigned)query->attempts);
+    s_finish_query(query, AWS_IO_DNS_QUERY_FAILED);
+}
+
+static void s_on_query_connected(struct aws_socket *socket, int error_code, void *user_data);
+
+/* picks the query's id and starts connecting its socket, the first attempt goes out once that's done. Both the id and
+ * the port have to be unpredictable, so the id comes from the OS's CSPRNG and the port is left to the kernel, which
+ * picks a random ephemeral one. */
+static int s_open_query_socket(struct aws_dns_client *client, struct dns_query *query) {
+    if (aws_device_random_u16(&query->id)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_socket_options socket_options;
+    AWS_ZERO_STRUCT(socket_options);
+    socket_options.type = AWS_SOCKET_DGRAM;
+    socket_options.domain = client->name_server_domain;
+    socket_options.connect_timeout_ms = 3000;
+
+    if (aws_socket_init(&query->socket, client->allocator, &socket_options)) {
+        return AWS_OP_ERR;
+    }
+
+    /* a UDP connect() just pins the peer address, it succeeds or fails right away. */
+    if (aws_socket_connect(&query->socket, &client->name_server, client->event_loop, s_on_query_connected, query)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS,
+            "id=%p: failed to connect to name server %s:%d with error %d (%s)",
+            (void *)client,
+            client->name_server.address,
+            (int)client->name_server.port,
+            aws_last_error(),
+            aws_error_str(aws_last_error()));
+        aws_socket_clean_up(&query->socket);
+        return AWS_OP_ERR;
+    }
+
+    query->socket_open = true;
+    return AWS_OP_SUCCESS;
+}
+
+/* puts the lookup on the client's list and, if it's possible, sends its queries. */
+static void s_start_lookup(struct aws_dns_client *client, struct dns_lookup *lookup) {
+    switch (client->state) {
+        case DNS_CLIENT_SHUT_DOWN:
+            aws_linked_list_push_back(&client->active_lookups, &lookup->node);
+            s_complete_lookup(lookup, AWS_ERROR_IO_OPERATION_CANCELLED);
+            return;
+        case DNS_CLIENT_READY:
+            break;
+    }
+
+    aws_linked_list_push_back(&client->active_lookups, &lookup->node);
+    lookup->outstanding_queries = AWS_ARRAY_SIZE(lookup->queries);
+
+    /* both queries go out as soon as their sockets are connected, and whichever answer comes first is processed
+     * first */
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lookup->queries); ++i) {
+        struct dns_query *query = &lookup->queries[i];
+
+        if (s_open_query_socket(client, query)) {
+            s_finish_query(query, AWS_IO_DNS_QUERY_FAILED);
+        }
+    }
+}
+
+/* returns true if the packet finished the query, which closes its socket and may free it. */
+static bool s_process_response(struct aws_dns_client *client, struct dns_query *query, struct aws_byte_cursor packet) {
+    struct aws_byte_cursor reader = packet;
+    uint16_t id = 0;
+    uint16_t flags = 0;
+    uint16_t question_count = 0;
+    uint16_t answer_count = 0;
+    uint16_t authority_count = 0;
+    uint16_t additional_count = 0;
+
+    if (!aws_byte_cursor_read_be16(&reader, &id) || !aws_byte_cursor_read_be16(&reader, &flags) ||
+        !aws_byte_cursor_read_be16(&reader, &question_count) || !aws_byte_cursor_read_be16(&reader, &answer_count) ||
+        !aws_byte_cursor_read_be16(&reader, &authority_count) ||
+        !aws_byte_cursor_read_be16(&reader, &additional_count)) {
+        AWS_LOGF_DEBUG(AWS_LS_IO_DNS, "id=%p: dropping runt packet of %d bytes", (void *)client, (int)packet.len);
+        return false;
+    }
+
+    if (id != query->id) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: dropping answer with id %u to query %u",
+            (void *)client,
+            (unsigned)id,
+            (unsigned)query->id);
+        return false;
+    }
+
+    struct dns_lookup *lookup = query->lookup;
+
+    /* it has to be an answer to the exact question we asked, otherwise it's junk or an attempt at spoofing. Either
+     * way, it's dropped and the query's timeout keeps running. */
+    uint8_t name[DNS_MAX_NAME_LEN];
+    size_t name_len = 0;
+    uint16_t question_type = 0;
+    uint16_t question_class = 0;
+    if (!(flags & DNS_FLAG_QR) || question_count != 1 || !s_read_name(packet, &reader, name, &name_len) ||
+        !aws_byte_cursor_read_be16(&reader, &question_type) || !aws_byte_cursor_read_be16(&reader, &question_class) ||
+        question_type != query->record_type || question_class != DNS_CLASS_IN ||
+        !s_name_matches(name, name_len, lookup->host_name)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS, "id=%p: dropping answer that doesn't match query %u", (void *)client, (unsigned)id);
+        return false;
+    }
+
+    uint16_t rcode = flags & DNS_RCODE_MASK;
+    if (rcode) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: query %u for %s failed with rcode %u",
+            (void *)client,
+            (unsigned)id,
+            (const char *)aws_string_bytes(lookup->host_name),
+            (unsigned)rcode);
+        s_finish_query(query, rcode == DNS_RCODE_NXDOMAIN ? AWS_IO_DNS_INVALID_NAME : AWS_IO_DNS_QUERY_FAILED);
+        return true;
+    }
+
+    if (flags & DNS_FLAG_TC) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: answer to query %u for %s is truncated, using the records that fit",
+            (void *)client,
+            (unsigned)id,
+            (const char *)aws_string_bytes(lookup->host_name));
+    }
+
+    int error_code = AWS_OP_SUCCESS;
+    size_t address_len = query->record_type == DNS_TYPE_AAAA ? 16 : 4;
+
+    /* a CNAME chain comes first, followed by the records for wherever it ends up. The recursive server has already
+     * followed it for us, so every record of the type we asked for is an address for this host. */
+    for (uint16_t i = 0; i < answer_count; ++i) {
+        uint16_t record_type = 0;
+        uint16_t record_class = 0;
+        uint32_t ttl = 0;
+        uint16_t data_len = 0;
+        if (!s_read_name(packet, &reader, name, &name_len) || !aws_byte_cursor_read_be16(&reader, &record_type) ||
+            !aws_byte_cursor_read_be16(&reader, &record_class) || !aws_byte_cursor_read_be32(&reader, &ttl) ||
+            !aws_byte_cursor_read_be16(&reader, &data_len)) {
+            break;
+        }
+
+        struct aws_byte_cursor data = aws_byte_cursor_advance(&reader, data_len);
+        if (data.len != data_len) {
+            break;
+        }
+
+        if (record_type == query->record_type && record_class == DNS_CLASS_IN && data_len == address_len) {
+            /* the top bit is reserved, RFC 2181 says to treat such TTLs as zero */
+            if (ttl & 0x80000000) {
+                ttl = 0;
+            }
+            if (s_add_address(lookup, record_type, data.ptr, ttl)) {
+                error_code = aws_last_error();
+                break;
+            }
+        }
+    }
+
+    s_finish_query(query, error_code);
+    return true;
+}
+
+static void s_on_query_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_query *query = user_data;
+    struct aws_dns_client *client = query->lookup->client;
+
+    /* usually an ICMP port unreachable from the name server. The socket is still fine, and reading below clears the
+     * error, the query will just time out. */
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: socket for query %u reported error %d (%s)",
+            (void *)client,
+            (unsigned)query->id,
+            error_code,
+            aws_error_str(error_code));
+    }
+
+    /* edge-triggered, so keep going until the socket is empty. Errors are from earlier packets (or empty datagrams),
+     * but two in a row means something's actually wrong and we'd only be spinning. */
+    size_t consecutive_errors = 0;
+    while (consecutive_errors < 2) {
+        client->read_buffer.len = 0;
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &client->read_buffer, &amount_read)) {
+            if (aws_last_error() == AWS_IO_READ_WOULD_BLOCK) {
+                return;
+            }
+            ++consecutive_errors;
+            continue;
+        }
+
+        consecutive_errors = 0;
+        if (s_process_response(client, query, aws_byte_cursor_from_buf(&client->read_buffer))) {
+            return;
+        }
+    }
+}
+
+static void s_on_query_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_query *query = user_data;
+    struct aws_dns_client *client = query->lookup->client;
+
+    if (!error_code && aws_socket_subscribe_to_readable_events(socket, s_on_query_readable, query)) {
+        error_code = aws_last_error();
+    }
+
+    /* the socket can't be torn down from inside its connect callback. Sending on it fails and counts as an attempt,
+     * so the query's timeout takes care of giving up. */
+    if (error_code) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS,
+            "id=%p: failed to set up socket to name server %s:%d with error %d (%s)",
+            (void *)client,
+            socket->remote_endpoint.address,
+            (int)socket->remote_endpoint.port,
+            error_code,
+            aws_error_str(error_code));
+    } else {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_DNS,
+            "id=%p: sending query %u, type %u for %s from port %d",
+            (void *)client,
+            (unsigned)query->id,
+            (unsigned)query->record_type,
+            (const char *)aws_string_bytes(query->lookup->host_name),
+            (int)socket->local_endpoint.port);
+    }
+
+    s_send_query(query);
+}
+
+static void s_client_release(struct aws_dns_client *client) {
+    aws_condition_variable_clean_up(&client->synced_data.signal);
+    aws_mutex_clean_up(&client->synced_data.lock);
+    aws_mem_release(client->allocator, client);
+}
+
+static void s_submit_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct aws_dns_client *client = arg;
+
+    struct aws_linked_list lookups;
+    aws_linked_list_init(&lookups);
+
+    aws_mutex_lock(&client->synced_data.lock);
+    aws_linked_list_swap_contents(&client->synced_data.pending_lookups, &lookups);
+    bool shut_down = client->synced_data.shut_down;
+    if (!shut_down) {
+        client->synced_data.submit_task_scheduled = false;
+    }
+    aws_mutex_unlock(&client->synced_data.lock);
+
+    /* after shutdown, the state takes care of cancelling them */
+    while (!aws_linked_list_empty(&lookups)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&lookups);
+        s_start_lookup(client, AWS_CONTAINER_OF(node, struct dns_lookup, node));
+    }
+
+    if (shut_down) {
+        /* someone is waiting for this task to be done with the client, so after this it's hands off. */
+        aws_mutex_lock(&client->synced_data.lock);
+        client->synced_data.submit_task_scheduled = false;
+        bool release = client->synced_data.release_in_submit_task;
+        aws_condition_variable_notify_all(&client->synced_data.signal);
+        aws_mutex_unlock(&client->synced_data.lock);
+
+        if (release) {
+            s_client_release(client);
+        }
+    }
+}
+
+/* fails everything outstanding, which closes the queries' sockets. Only the memory and lock are left afterwards. */
+static void s_shut_down(struct aws_dns_client *client) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_DNS, "id=%p: shutting down", (void *)client);
+    client->state = DNS_CLIENT_SHUT_DOWN;
+
+    while (!aws_linked_list_empty(&client->active_lookups)) {
+        s_cancel_lookup(AWS_CONTAINER_OF(aws_linked_list_front(&client->active_lookups), struct dns_lookup, node));
+    }
+
+    struct aws_linked_list lookups;
+    aws_linked_list_init(&lookups);
+
+    aws_mutex_lock(&client->synced_data.lock);
+    client->synced_data.shut_down = true;
+    aws_linked_list_swap_contents(&client->synced_data.pending_lookups, &lookups);
+    aws_mutex_unlock(&client->synced_data.lock);
+
+    while (!aws_linked_list_empty(&lookups)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&lookups);
+        s_start_lookup(client, AWS_CONTAINER_OF(node, struct dns_lookup, node));
+    }
+
+    aws_byte_buf_clean_up(&client->read_buffer);
+}
+
+static void s_shutdown_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct aws_dns_client *client = arg;
+
+    s_shut_down(client);
+
+    aws_mutex_lock(&client->synced_data.lock);
+    client->synced_data.shutdown_complete = true;
+    aws_condition_variable_notify_all(&client->synced_data.signal);
+    aws_mutex_unlock(&client->synced_data.lock);
+}
+
+static bool s_is_client_released_pred(void *arg) {
+    struct aws_dns_client *client = arg;
+    return client->synced_data.shutdown_complete && !client->synced_data.submit_task_scheduled;
+}
+
+struct aws_dns_client *aws_dns_client_new(
+    struct aws_allocator *allocator,
+    const struct aws_dns_client_options *options) {
+    AWS_ASSERT(options->event_loop);
+
+    if (options->name_server_domain != AWS_SOCKET_IPV4 && options->name_server_domain != AWS_SOCKET_IPV6) {
+        AWS_LOGF_ERROR(AWS_LS_IO_DNS, "static: name server has to be an IPv4 or IPv6 address");
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_dns_client *client = aws_mem_acquire(allocator, sizeof(struct aws_dns_client));
+    if (!client) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*client);
+    client->allocator = allocator;
+    client->event_loop = options->event_loop;
+    uint32_t query_timeout_ms = options->query_timeout_ms ? options->query_timeout_ms : DNS_DEFAULT_QUERY_TIMEOUT_MS;
+    client->query_timeout_ns = aws_timestamp_convert(query_timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    client->max_attempts = options->max_attempts ? options->max_attempts : DNS_DEFAULT_MAX_ATTEMPTS;
+    client->name_server = options->name_server;
+    client->name_server_domain = options->name_server_domain;
+    client->state = DNS_CLIENT_READY;
+    aws_linked_list_init(&client->active_lookups);
+    aws_linked_list_init(&client->synced_data.pending_lookups);
+    aws_task_init(&client->submit_task, s_submit_task, client);
+    aws_task_init(&client->shutdown_task, s_shutdown_task, client);
+
+    if (aws_mutex_init(&client->synced_data.lock)) {
+        goto clean_up_client;
+    }
+
+    if (aws_condition_variable_init(&client->synced_data.signal)) {
+        goto clean_up_mutex;
+    }
+
+    if (aws_byte_buf_init(&client->read_buffer, allocator, DNS_READ_BUFFER_SIZE)) {
+        goto clean_up_signal;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: created client for name server %s:%d",
+        (void *)client,
+        options->name_server.address,
+        (int)options->name_server.port);
+
+    return client;
+
+clean_up_signal:
+    aws_condition_variable_clean_up(&client->synced_data.signal);
+
+clean_up_mutex:
+    aws_mutex_clean_up(&client->synced_data.lock);
+
+clean_up_client:
+    aws_mem_release(allocator, client);
+
+    return NULL;
+}
+
+void aws_dns_client_destroy(struct aws_dns_client *client) {
+    if (aws_event_loop_thread_is_callers_thread(client->event_loop)) {
+        s_shut_down(client);
+
+        /* there may still be a submit task in the loop's queue, it'll need the client to find out there's nothing
+         * left to do. */
+        aws_mutex_lock(&client->synced_data.lock);
+        bool submit_task_scheduled = client->synced_data.submit_task_scheduled;
+        client->synced_data.release_in_submit_task = submit_task_scheduled;
+        aws_mutex_unlock(&client->synced_data.lock);
+
+        if (!submit_task_scheduled) {
+            s_client_release(client);
+        }
+        return;
+    }
+
+    aws_event_loop_schedule_task_now(client->event_loop, &client->shutdown_task);
+
+    aws_mutex_lock(&client->synced_data.lock);
+    aws_condition_variable_wait_pred(
+        &client->synced_data.signal, &client->synced_data.lock, s_is_client_released_pred, client);
+    aws_mutex_unlock(&client->synced_data.lock);
+
+    s_client_release(client);
+}
+
+int aws_dns_client_resolve_async(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    aws_dns_client_on_resolved_fn *on_resolved,
+    void *user_data) {
+    AWS_ASSERT(on_resolved);
+
+    if (!s_is_valid_host_name(host_name)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS,
+            "id=%p: %s is not a valid host name",
+            (void *)client,
+            (const char *)aws_string_bytes(host_name));
+        return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+    }
+
+    struct dns_lookup *lookup = aws_mem_acquire(client->allocator, sizeof(struct dns_lookup));
+    if (!lookup) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*lookup);
+    lookup->allocator = client->allocator;
+    lookup->client = client;
+    lookup->on_resolved = on_resolved;
+    lookup->user_data = user_data;
+    lookup->queries[0].record_type = DNS_TYPE_A;
+    lookup->queries[1].record_type = DNS_TYPE_AAAA;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lookup->queries); ++i) {
+        lookup->queries[i].lookup = lookup;
+        aws_task_init(&lookup->queries[i].timeout_task, s_query_timeout_task, &lookup->queries[i]);
+    }
+
+    lookup->host_name = aws_string_new_from_string(client->allocator, host_name);
+    if (!lookup->host_name) {
+        goto error;
+    }
+
+    if (aws_array_list_init_dynamic(&lookup->addresses, client->allocator, 4, sizeof(struct aws_host_address))) {
+        goto error;
+    }
+
+    aws_mutex_lock(&client->synced_data.lock);
+    if (client->synced_data.shut_down) {
+        aws_mutex_unlock(&client->synced_data.lock);
+        aws_raise_error(AWS_ERROR_INVALID_STATE);
+        goto error;
+    }
+
+    aws_linked_list_push_back(&client->synced_data.pending_lookups, &lookup->node);
+    bool schedule_submit_task = !client->synced_data.submit_task_scheduled;
+    client->synced_data.submit_task_scheduled = true;
+    aws_mutex_unlock(&client->synced_data.lock);
+
+    if (schedule_submit_task) {
+        aws_event_loop_schedule_task_now(client->event_loop, &client->submit_task);
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    if (lookup->host_name) {
+        aws_array_list_clean_up(&lookup->addresses);
+        aws_string_destroy(lookup->host_name);
+    }
+    aws_mem_release(client->allocator, lookup);
+    return AWS_OP_ERR;
+}
+
+struct dns_blocking_lookup {
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+    struct aws_array_list *output_addresses;
+    int error_code;
+    bool completed;
+};
+
+static void s_on_blocking_lookup_resolved(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)client;
+    (void)host_name;
+    struct dns_blocking_lookup *blocking_lookup = user_data;
+
+    for (size_t i = 0; !error_code && i < aws_array_list_length(host_addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(host_addresses, (void **)&address, i);
+
+        struct aws_host_address address_copy;
+        if (aws_host_address_copy(address, &address_copy)) {
+            error_code = aws_last_error();
+        } else if (aws_array_list_push_back(blocking_lookup->output_addresses, &address_copy)) {
+            aws_host_address_clean_up(&address_copy);
+            error_code = aws_last_error();
+        }
+    }
+
+    aws_mutex_lock(&blocking_lookup->lock);
+    blocking_lookup->error_code = error_code;
+    blocking_lookup->completed = true;
+    aws_condition_variable_notify_one(&blocking_lookup->signal);
+    aws_mutex_unlock(&blocking_lookup->lock);
+}
+
+static bool s_is_blocking_lookup_completed_pred(void *arg) {
+    struct dns_blocking_lookup *blocking_lookup = arg;
+    return blocking_lookup->completed;
+}
+
+int aws_dns_client_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+    (void)allocator;
+    struct aws_dns_client *client = user_data;
+    AWS_ASSERT(client);
+
+    /* the loop can't finish the lookup while we sit on its thread waiting for it */
+    if (aws_event_loop_thread_is_callers_thread(client->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS, "id=%p: blocking resolve called from the client's event-loop thread", (void *)client);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct dns_blocking_lookup blocking_lookup;
+    AWS_ZERO_STRUCT(blocking_lookup);
+    blocking_lookup.output_addresses = output_addresses;
+
+    if (aws_mutex_init(&blocking_lookup.lock)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_condition_variable_init(&blocking_lookup.signal)) {
+        aws_mutex_clean_up(&blocking_lookup.lock);
+        return AWS_OP_ERR;
+    }
+
+    int result = aws_dns_client_resolve_async(client, host_name, s_on_blocking_lookup_resolved, &blocking_lookup);
+
+    if (!result) {
+        aws_mutex_lock(&blocking_lookup.lock);
+        aws_condition_variable_wait_pred(
+            &blocking_lookup.signal, &blocking_lookup.lock, s_is_blocking_lookup_completed_pred, &blocking_lookup);
+        aws_mutex_unlock(&blocking_lookup.lock);
+
+        if (blocking_lookup.error_code) {
+            result = aws_raise_error(blocking_lookup.error_code);
+        }
+    }
+
+    aws_condition_variable_clean_up(&blocking_lookup.signal);
+    aws_mutex_clean_up(&blocking_lookup.lock);
+
+    return result;
+}
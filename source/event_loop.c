@@ -15,27 +15,260 @@
 
 #include <aws/io/event_loop.h>
 
+#include <aws/io/logging.h>
+#include <aws/io/private/thread_affinity.h>
+
 #include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
 #include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+
+/* the watchdog looks at each loop this many times per stall budget. */
+#define WATCHDOG_CHECKS_PER_BUDGET 4
+#define WATCHDOG_MIN_CHECK_INTERVAL_NS 1000000ULL
+
+struct aws_event_loop_watchdog {
+    struct aws_allocator *alloc;
+    struct aws_event_loop_group *el_group;
+    struct aws_thread thread;
+    struct aws_mutex mutex;
+    struct aws_condition_variable signal;
+    /* protected by mutex */
+    bool should_stop;
+    uint64_t budget_ns;
+    aws_event_loop_on_stall_fn *on_stall;
+    void *on_stall_user_data;
+    /* busy_since_ns of the last stall reported for each loop, so each pass through a loop is reported only once. */
+    uint64_t *reported_busy_since_ns;
+};
+
+static void s_watchdog_check_loops(struct aws_event_loop_watchdog *watchdog) {
+    size_t loop_count = aws_event_loop_group_get_loop_count(watchdog->el_group);
+
+    for (size_t i = 0; i < loop_count; ++i) {
+        struct aws_event_loop *loop = aws_event_loop_group_get_loop_at(watchdog->el_group, i);
+
+        struct aws_event_loop_stats stats;
+        if (aws_event_loop_get_stats(loop, &stats) || stats.busy_since_ns == 0) {
+            continue;
+        }
 
-int aws_event_loop_group_init(
+        uint64_t now_ns = 0;
+        if (aws_event_loop_current_clock_time(loop, &now_ns) || now_ns <= stats.busy_since_ns) {
+            continue;
+        }
+
+        uint64_t busy_ns = now_ns - stats.busy_since_ns;
+        if (busy_ns <= watchdog->budget_ns || watchdog->reported_busy_since_ns[i] == stats.busy_since_ns) {
+            continue;
+        }
+
+        watchdog->reported_busy_since_ns[i] = stats.busy_since_ns;
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+        AWS_LOGF_WARN(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: event loop has been busy for %llu ns without going back to waiting, current task fn 0x%llx, "
+            "current io event fn 0x%llx, called from it: fn 0x%llx.",
+            (void *)loop,
+            (unsigned long long)busy_ns,
+            (unsigned long long)(uintptr_t)stats.current_task_fn,
+            (unsigned long long)(uintptr_t)stats.current_io_event_fn,
+            (unsigned long long)(uintptr_t)stats.current_inner_fn);
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: event loop has been busy for %llu ns without going back to waiting, current task fn 0x%llx, "
+            "called from it: fn 0x%llx.",
+            (void *)loop,
+            (unsigned long long)busy_ns,
+            (unsigned long long)(uintptr_t)stats.current_task_fn,
+            (unsigned long long)(uintptr_t)stats.current_inner_fn);
+#endif
+
+        if (watchdog->on_stall) {
+            watchdog->on_stall(loop, busy_ns, &stats, watchdog->on_stall_user_data);
+        }
+    }
+}
+
+static bool s_watchdog_should_stop(void *arg) {
+    struct aws_event_loop_watchdog *watchdog = arg;
+    return watchdog->should_stop;
+}
+
+static void s_watchdog_main(void *arg) {
+    struct aws_event_loop_watchdog *watchdog = arg;
+
+    uint64_t interval_ns = watchdog->budget_ns / WATCHDOG_CHECKS_PER_BUDGET;
+    if (interval_ns < WATCHDOG_MIN_CHECK_INTERVAL_NS) {
+        interval_ns = WATCHDOG_MIN_CHECK_INTERVAL_NS;
+    } else if (interval_ns > INT64_MAX) {
+        interval_ns = INT64_MAX;
+    }
+
+    aws_mutex_lock(&watchdog->mutex);
+    while (!watchdog->should_stop) {
+        aws_condition_variable_wait_for_pred(
+            &watchdog->signal, &watchdog->mutex, (int64_t)interval_ns, s_watchdog_should_stop, watchdog);
+
+        if (watchdog->should_stop) {
+            break;
+        }
+
+        aws_mutex_unlock(&watchdog->mutex);
+        s_watchdog_check_loops(watchdog);
+        aws_mutex_lock(&watchdog->mutex);
+    }
+    aws_mutex_unlock(&watchdog->mutex);
+}
+
+static struct aws_event_loop_watchdog *s_watchdog_new(
+    struct aws_allocator *alloc,
+    struct aws_event_loop_group *el_group,
+    const struct aws_event_loop_group_options *options) {
+
+    /* there's nothing to watch without stats, so refuse rather than silently never reporting anything. */
+    struct aws_event_loop_stats stats;
+    if (aws_event_loop_get_stats(aws_event_loop_group_get_loop_at(el_group, 0), &stats)) {
+        return NULL;
+    }
+
+    struct aws_event_loop_watchdog *watchdog = aws_mem_acquire(alloc, sizeof(struct aws_event_loop_watchdog));
+    if (!watchdog) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*watchdog);
+    watchdog->alloc = alloc;
+    watchdog->el_group = el_group;
+    watchdog->mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    watchdog->signal = (struct aws_condition_variable)AWS_CONDITION_VARIABLE_INIT;
+    watchdog->budget_ns = options->stall_budget_ns;
+    watchdog->on_stall = options->on_stall;
+    watchdog->on_stall_user_data = options->on_stall_user_data;
+
+    size_t loop_count = aws_event_loop_group_get_loop_count(el_group);
+    watchdog->reported_busy_since_ns = aws_mem_acquire(alloc, sizeof(uint64_t) * loop_count);
+    if (!watchdog->reported_busy_since_ns) {
+        goto clean_up_watchdog;
+    }
+    memset(watchdog->reported_busy_since_ns, 0, sizeof(uint64_t) * loop_count);
+
+    if (aws_thread_init(&watchdog->thread, alloc)) {
+        goto clean_up_reported;
+    }
+
+    if (aws_thread_launch(&watchdog->thread, s_watchdog_main, watchdog, NULL)) {
+        goto clean_up_thread;
+    }
+
+    return watchdog;
+
+clean_up_thread:
+    aws_thread_clean_up(&watchdog->thread);
+
+clean_up_reported:
+    aws_mem_release(alloc, watchdog->reported_busy_since_ns);
+
+clean_up_watchdog:
+    aws_mem_release(alloc, watchdog);
+    return NULL;
+}
+
+static void s_watchdog_destroy(struct aws_event_loop_watchdog *watchdog) {
+    aws_mutex_lock(&watchdog->mutex);
+    watchdog->should_stop = true;
+    aws_condition_variable_notify_one(&watchdog->signal);
+    aws_mutex_unlock(&watchdog->mutex);
+
+    aws_thread_join(&watchdog->thread);
+    aws_thread_clean_up(&watchdog->thread);
+
+    aws_mem_release(watchdog->alloc, watchdog->reported_busy_since_ns);
+    aws_mem_release(watchdog->alloc, watchdog);
+}
+
+/*
+ * Works out which CPUs loop loop_index should be pinned to. Sets *pin to false if the loop should be left wherever
+ * the scheduler puts it.
+ */
+static int s_get_loop_cpus(
+    const struct aws_event_loop_group_options *options,
+    size_t numa_node_count,
+    size_t loop_index,
+    struct aws_cpu_set *loop_cpus,
+    bool *pin) {
+
+    *pin = false;
+    if (!options) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (options->cpu_id_count) {
+        *pin = true;
+        aws_cpu_set_clear(loop_cpus);
+        return aws_cpu_set_add(loop_cpus, options->cpu_ids[loop_index % options->cpu_id_count]);
+    }
+
+    if (options->spread_across_numa_nodes && numa_node_count > 1) {
+        *pin = true;
+        return aws_numa_node_get_cpus(loop_index % numa_node_count, loop_cpus);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_event_loop_group_init(
     struct aws_event_loop_group *el_group,
     struct aws_allocator *alloc,
     aws_io_clock_fn *clock,
     uint16_t el_count,
     aws_new_event_loop_fn *new_loop_fn,
-    void *new_loop_user_data) {
+    void *new_loop_user_data,
+    const struct aws_event_loop_group_options *options) {
 
     AWS_ASSERT(new_loop_fn);
 
     el_group->allocator = alloc;
+    el_group->watchdog = NULL;
     aws_atomic_init_int(&el_group->current_index, 0);
 
     if (aws_array_list_init_dynamic(&el_group->event_loops, alloc, el_count, sizeof(struct aws_event_loop *))) {
         return AWS_OP_ERR;
     }
 
+    size_t numa_node_count = 1;
+    if (options && !options->cpu_id_count && options->spread_across_numa_nodes) {
+        numa_node_count = aws_numa_node_count();
+    }
+
+    /* loop threads inherit the affinity of the thread that launches them, so the caller's is swapped out while each
+     * pinned loop is created and started, and put back once they all are. */
+    struct aws_cpu_set callers_cpus;
+    bool callers_cpus_saved = false;
+
     for (uint16_t i = 0; i < el_count; ++i) {
+        struct aws_cpu_set loop_cpus;
+        bool pin = false;
+
+        if (s_get_loop_cpus(options, numa_node_count, i, &loop_cpus, &pin)) {
+            goto cleanup_error;
+        }
+
+        if (pin) {
+            if (!callers_cpus_saved) {
+                if (aws_thread_affinity_get_current(&callers_cpus)) {
+                    goto cleanup_error;
+                }
+                callers_cpus_saved = true;
+            }
+
+            if (aws_thread_affinity_set_current(&loop_cpus)) {
+                goto cleanup_error;
+            }
+        }
+
         struct aws_event_loop *loop = new_loop_fn(alloc, clock, new_loop_user_data);
 
         if (!loop) {
@@ -52,13 +285,42 @@ int aws_event_loop_group_init(
         }
     }
 
+    if (callers_cpus_saved && aws_thread_affinity_set_current(&callers_cpus)) {
+        callers_cpus_saved = false;
+        goto cleanup_error;
+    }
+
+    if (options && options->stall_budget_ns && el_count > 0) {
+        el_group->watchdog = s_watchdog_new(alloc, el_group, options);
+        if (!el_group->watchdog) {
+            goto cleanup_error;
+        }
+    }
+
     return AWS_OP_SUCCESS;
 
 cleanup_error:
+    if (callers_cpus_saved) {
+        int error_code = aws_last_error();
+        aws_thread_affinity_set_current(&callers_cpus);
+        aws_raise_error(error_code);
+    }
+
     aws_event_loop_group_clean_up(el_group);
     return AWS_OP_ERR;
 }
 
+int aws_event_loop_group_init(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    aws_io_clock_fn *clock,
+    uint16_t el_count,
+    aws_new_event_loop_fn *new_loop_fn,
+    void *new_loop_user_data) {
+
+    return s_event_loop_group_init(el_group, alloc, clock, el_count, new_loop_fn, new_loop_user_data, NULL);
+}
+
 static struct aws_event_loop *default_new_event_loop(
     struct aws_allocator *allocator,
     aws_io_clock_fn *clock,
@@ -80,7 +342,80 @@ int aws_event_loop_group_default_init(
         el_group, alloc, aws_high_res_clock_get_ticks, max_threads, default_new_event_loop, NULL);
 }
 
+static struct aws_event_loop *s_new_busy_poll_event_loop(
+    struct aws_allocator *allocator,
+    aws_io_clock_fn *clock,
+    void *user_data) {
+
+    const struct aws_event_loop_group_options *group_options = user_data;
+    struct aws_event_loop_options options = {
+        .clock = clock,
+        .busy_poll_ns = group_options->busy_poll_ns,
+        .socket_busy_poll_us = group_options->socket_busy_poll_us,
+    };
+
+    return aws_event_loop_new_system_with_options(allocator, &options);
+}
+
+int aws_event_loop_group_init_with_options(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_group_options *options) {
+
+    AWS_ASSERT(options);
+    AWS_ASSERT(!options->cpu_id_count || options->cpu_ids);
+
+    uint16_t el_count = options->loop_count;
+    if (!el_count) {
+        el_count = options->cpu_id_count ? (uint16_t)options->cpu_id_count
+                                         : (uint16_t)aws_system_info_processor_count();
+    }
+
+    /* options only needs to outlive the loops' creation, which happens before this returns. */
+    if (options->busy_poll_ns || options->socket_busy_poll_us) {
+        return s_event_loop_group_init(
+            el_group,
+            alloc,
+            aws_high_res_clock_get_ticks,
+            el_count,
+            s_new_busy_poll_event_loop,
+            (void *)options,
+            options);
+    }
+
+    return s_event_loop_group_init(
+        el_group, alloc, aws_high_res_clock_get_ticks, el_count, default_new_event_loop, NULL, options);
+}
+
+#ifdef AWS_USE_IO_URING
+static struct aws_event_loop *s_io_uring_new_event_loop(
+    struct aws_allocator *allocator,
+    aws_io_clock_fn *clock,
+    void *user_data) {
+
+    (void)user_data;
+    return aws_event_loop_new_io_uring(allocator, clock);
+}
+
+int aws_event_loop_group_io_uring_init(
+    struct aws_event_loop_group *el_group,
+    struct aws_allocator *alloc,
+    uint16_t max_threads) {
+    if (!max_threads) {
+        max_threads = (uint16_t)aws_system_info_processor_count();
+    }
+
+    return aws_event_loop_group_init(
+        el_group, alloc, aws_high_res_clock_get_ticks, max_threads, s_io_uring_new_event_loop, NULL);
+}
+#endif /* AWS_USE_IO_URING */
+
 void aws_event_loop_group_clean_up(struct aws_event_loop_group *el_group) {
+    if (el_group->watchdog) {
+        s_watchdog_destroy(el_group->watchdog);
+        el_group->watchdog = NULL;
+    }
+
     while (aws_array_list_length(&el_group->event_loops) > 0) {
         struct aws_event_loop *loop = NULL;
 
@@ -104,6 +439,26 @@ struct aws_event_loop *aws_event_loop_group_get_loop_at(struct aws_event_loop_gr
     return el;
 }
 
+static AWS_THREAD_LOCAL uint32_t tl_random_state;
+
+/* xorshift32, only used to pick a second candidate loop so there's no need for anything stronger. */
+static uint32_t s_next_random(void) {
+    uint32_t x = tl_random_state;
+    if (!x) {
+        uint64_t seed = aws_thread_current_thread_id();
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
+        seed ^= now;
+        x = (uint32_t)(seed ^ (seed >> 32)) | 1;
+    }
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tl_random_state = x;
+    return x;
+}
+
 struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group) {
     size_t loop_count = aws_array_list_length(&el_group->event_loops);
     AWS_ASSERT(loop_count > 0);
@@ -123,6 +478,20 @@ struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_
 
     /* if the fetch fails, we don't really care since loop will be NULL and error code will already be set. */
     aws_array_list_get_at(&el_group->event_loops, &loop, old_index);
+    if (!loop || loop_count < 2) {
+        return loop;
+    }
+
+    /* power of two choices: compare against one other loop picked at random, which is enough to keep a loop that's
+     * much busier than the rest from being picked, without scanning every loop on each call. */
+    size_t other_index = (old_index + 1 + s_next_random() % (loop_count - 1)) % loop_count;
+    struct aws_event_loop *other_loop = NULL;
+    aws_array_list_get_at(&el_group->event_loops, &other_loop, other_index);
+
+    if (other_loop && aws_event_loop_get_load_factor(other_loop) < aws_event_loop_get_load_factor(loop)) {
+        return other_loop;
+    }
+
     return loop;
 }
 
@@ -146,6 +515,7 @@ int aws_event_loop_init_base(struct aws_event_loop *event_loop, struct aws_alloc
 
     event_loop->alloc = alloc;
     event_loop->clock = clock;
+    aws_atomic_init_int(&event_loop->io_handle_count, 0);
 
     if (aws_hash_table_init(&event_loop->local_data, alloc, 20, aws_hash_ptr, aws_ptr_eq, NULL, s_object_removed)) {
         return AWS_OP_ERR;
@@ -280,19 +650,63 @@ int aws_event_loop_subscribe_to_io_events(
     void *user_data) {
 
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->subscribe_to_io_events);
-    return event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data);
+    if (event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_atomic_fetch_add(&event_loop->io_handle_count, 1);
+    return AWS_OP_SUCCESS;
 }
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 int aws_event_loop_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->unsubscribe_from_io_events);
-    return event_loop->vtable->unsubscribe_from_io_events(event_loop, handle);
+    int result = event_loop->vtable->unsubscribe_from_io_events(event_loop, handle);
+
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+    /* the loop lets go of the handle even when it fails to tell the kernel, so it stops counting either way.
+     * Completion port handles are never counted, see aws_event_loop_get_load_factor(). */
+    aws_atomic_fetch_sub(&event_loop->io_handle_count, 1);
+#endif
+    return result;
+}
+
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop) {
+    return aws_atomic_load_int(&event_loop->io_handle_count);
+}
+
+int aws_event_loop_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats) {
+    AWS_ASSERT(event_loop->vtable);
+    AWS_ASSERT(stats);
+
+    if (!event_loop->vtable->get_stats) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    return event_loop->vtable->get_stats(event_loop, stats);
+}
+
+aws_event_loop_inner_fn *aws_event_loop_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn) {
+    AWS_ASSERT(event_loop->vtable);
+
+    if (!event_loop->vtable->set_current_inner_fn) {
+        return NULL;
+    }
+
+    return event_loop->vtable->set_current_inner_fn(event_loop, fn);
 }
 
 void aws_event_loop_free_io_event_resources(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     AWS_ASSERT(event_loop && event_loop->vtable->free_io_event_resources);
     event_loop->vtable->free_io_event_resources(handle->additional_data);
+
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+    /* this stands in for unsubscribing a handle the loop's thread is no longer around to unsubscribe. */
+    aws_atomic_fetch_sub(&event_loop->io_handle_count, 1);
+#endif
 }
 
 bool aws_event_loop_thread_is_callers_thread(struct aws_event_loop *event_loop) {
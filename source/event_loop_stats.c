@@ -0,0 +1,185 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/event_loop_stats.h>
+
+#include <aws/common/task_scheduler.h>
+
+/* The task the loop actually schedules in place of a tracked one, so that the owner's task is left as it was. */
+struct event_loop_task_record {
+    struct aws_task wrapper;
+    struct aws_event_loop_stats_tracker *tracker;
+    struct aws_task *task;
+    struct event_loop_task_record *next_free;
+};
+
+void aws_event_loop_stats_tracker_init(
+    struct aws_event_loop_stats_tracker *tracker,
+    struct aws_allocator *alloc,
+    aws_io_clock_fn *clock) {
+
+    AWS_ZERO_STRUCT(*tracker);
+    tracker->alloc = alloc;
+    tracker->clock = clock;
+    aws_atomic_init_int(&tracker->sequence, 0);
+}
+
+void aws_event_loop_stats_tracker_clean_up(struct aws_event_loop_stats_tracker *tracker) {
+    while (tracker->free_records) {
+        struct event_loop_task_record *record = tracker->free_records;
+        tracker->free_records = record->next_free;
+        aws_mem_release(tracker->alloc, record);
+    }
+}
+
+/* a seqlock with the event-loop thread as its only writer, see aws_event_loop_stats_tracker_get() */
+static void s_begin_update(struct aws_event_loop_stats_tracker *tracker) {
+    size_t sequence = aws_atomic_load_int_explicit(&tracker->sequence, aws_memory_order_relaxed);
+    aws_atomic_store_int_explicit(&tracker->sequence, sequence + 1, aws_memory_order_relaxed);
+    aws_atomic_thread_fence(aws_memory_order_release);
+}
+
+static void s_end_update(struct aws_event_loop_stats_tracker *tracker) {
+    size_t sequence = aws_atomic_load_int_explicit(&tracker->sequence, aws_memory_order_relaxed);
+    aws_atomic_store_int_explicit(&tracker->sequence, sequence + 1, aws_memory_order_release);
+}
+
+void aws_event_loop_stats_add(struct aws_event_loop_stats_tracker *tracker, uint64_t *counter, uint64_t n) {
+    s_begin_update(tracker);
+    *counter += n;
+    s_end_update(tracker);
+}
+
+static void s_run_tracked_task(struct aws_task *wrapper, void *arg, enum aws_task_status status) {
+    (void)wrapper;
+    struct event_loop_task_record *record = arg;
+    struct aws_event_loop_stats_tracker *tracker = record->tracker;
+    struct aws_task *task = record->task;
+
+    /* the task may free itself, or schedule itself again and get a fresh record, so neither is touched after it runs
+     * and the record goes back on the free list up front. */
+    task->reserved = 0;
+    record->next_free = tracker->free_records;
+    tracker->free_records = record;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        aws_task_run(task, status);
+        return;
+    }
+
+    uint64_t start_ns = 0;
+    tracker->clock(&start_ns);
+
+    s_begin_update(tracker);
+    tracker->values.current_task_fn = task->fn;
+    s_end_update(tracker);
+
+    aws_task_run(task, status);
+
+    uint64_t end_ns = 0;
+    tracker->clock(&end_ns);
+    uint64_t duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+
+    s_begin_update(tracker);
+    tracker->values.current_task_fn = NULL;
+    tracker->values.current_inner_fn = NULL;
+    tracker->values.task_count++;
+    tracker->values.task_time_ns += duration_ns;
+    if (duration_ns > tracker->values.max_task_duration_ns) {
+        tracker->values.max_task_duration_ns = duration_ns;
+    }
+    s_end_update(tracker);
+}
+
+struct aws_task *aws_event_loop_stats_track_task(struct aws_event_loop_stats_tracker *tracker, struct aws_task *task) {
+    struct event_loop_task_record *record = tracker->free_records;
+    if (record) {
+        tracker->free_records = record->next_free;
+    } else {
+        record = aws_mem_acquire(tracker->alloc, sizeof(struct event_loop_task_record));
+        if (!record) {
+            aws_reset_error();
+            return task;
+        }
+    }
+
+    aws_task_init(&record->wrapper, s_run_tracked_task, record);
+    record->tracker = tracker;
+    record->task = task;
+    record->next_free = NULL;
+    task->reserved = (size_t)(uintptr_t)record;
+
+    return &record->wrapper;
+}
+
+struct aws_task *aws_event_loop_stats_scheduled_task(
+    const struct aws_event_loop_stats_tracker *tracker,
+    struct aws_task *task) {
+
+    if (!task->reserved) {
+        return task;
+    }
+
+    struct event_loop_task_record *record = (struct event_loop_task_record *)(uintptr_t)task->reserved;
+    AWS_ASSERT(record->tracker == tracker && record->task == task);
+    (void)tracker;
+    return &record->wrapper;
+}
+
+void aws_event_loop_stats_set_busy_since(struct aws_event_loop_stats_tracker *tracker, uint64_t now_ns) {
+    s_begin_update(tracker);
+    tracker->values.busy_since_ns = now_ns;
+    s_end_update(tracker);
+}
+
+#ifndef AWS_USE_IO_COMPLETION_PORTS
+void aws_event_loop_stats_set_io_event_fn(
+    struct aws_event_loop_stats_tracker *tracker,
+    aws_event_loop_on_event_fn *on_event) {
+
+    s_begin_update(tracker);
+    tracker->values.current_io_event_fn = on_event;
+    tracker->values.current_inner_fn = NULL;
+    s_end_update(tracker);
+}
+#endif
+
+aws_event_loop_inner_fn *aws_event_loop_stats_set_inner_fn(
+    struct aws_event_loop_stats_tracker *tracker,
+    aws_event_loop_inner_fn *fn) {
+
+    aws_event_loop_inner_fn *previous_fn = tracker->values.current_inner_fn;
+    if (previous_fn != fn) {
+        s_begin_update(tracker);
+        tracker->values.current_inner_fn = fn;
+        s_end_update(tracker);
+    }
+
+    return previous_fn;
+}
+
+void aws_event_loop_stats_tracker_get(
+    const struct aws_event_loop_stats_tracker *tracker,
+    struct aws_event_loop_stats *stats) {
+
+    size_t sequence_before = 0;
+    size_t sequence_after = 0;
+    do {
+        sequence_before = aws_atomic_load_int_explicit(&tracker->sequence, aws_memory_order_acquire);
+        *stats = tracker->values;
+        aws_atomic_thread_fence(aws_memory_order_acquire);
+        sequence_after = aws_atomic_load_int_explicit(&tracker->sequence, aws_memory_order_relaxed);
+    } while ((sequence_before & 1) || sequence_before != sequence_after);
+}
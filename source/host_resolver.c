@@ -19,6 +19,7 @@
 #include <aws/common/hash_table.h>
 #include <aws/common/lru_cache.h>
 #include <aws/common/mutex.h>
+#include <aws/common/priority_queue.h>
 #include <aws/common/rw_lock.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
@@ -98,23 +99,42 @@ int aws_host_resolver_record_connection_failure(struct aws_host_resolver *resolv
     return resolver->vtable->record_connection_failure(resolver, address);
 }
 
+/*
+ * Every host entry of a resolver gets refreshed by the same small set of worker threads. Entries that are being kept
+ * fresh wait in refresh_queue, ordered by when they are next due, and whichever worker is free takes the next one due.
+ * Workers are started on demand, up to max_worker_count, and run until the resolver is destroyed.
+ */
+struct resolver_worker_pool {
+    struct aws_allocator *allocator;
+    struct aws_mutex lock;
+    /* wakes workers for new work or shutdown */
+    struct aws_condition_variable work_signal;
+    /* signaled every time a worker is done with an entry */
+    struct aws_condition_variable refresh_done_signal;
+    /* of struct host_entry *, ordered by next_refresh_time */
+    struct aws_priority_queue refresh_queue;
+    struct aws_thread *workers;
+    size_t max_worker_count;
+    size_t worker_count;
+    size_t idle_worker_count;
+    bool shutting_down;
+};
+
 struct default_host_resolver {
     struct aws_allocator *allocator;
     struct aws_lru_cache host_table;
     struct aws_rw_lock host_lock;
+    struct resolver_worker_pool worker_pool;
 };
 
 struct host_entry {
     struct aws_allocator *allocator;
     struct aws_host_resolver *resolver;
-    struct aws_thread resolver_thread;
     struct aws_rw_lock entry_lock;
     struct aws_lru_cache aaaa_records;
     struct aws_lru_cache a_records;
     struct aws_lru_cache failed_connection_aaaa_records;
     struct aws_lru_cache failed_connection_a_records;
-    struct aws_mutex semaphore_mutex;
-    struct aws_condition_variable resolver_thread_semaphore;
     const struct aws_string *host_name;
     struct aws_host_resolution_config resolution_config;
     struct aws_linked_list pending_resolution_callbacks;
@@ -124,9 +144,75 @@ struct host_entry {
        for the target architecture, which these days is a fairly safe assumption. Where it's not a safe assumption, we
        probably don't have multiple cores available anyways. */
     volatile uint64_t last_use;
+    /* true while the entry is in the worker pool's refresh rotation. Only changed with the pool's lock held. */
     volatile bool keep_active;
+    /* the rest are owned by the worker pool, and guarded by its lock */
+    struct aws_priority_queue_node refresh_queue_node;
+    uint64_t next_refresh_time;
+    /* last_use as of the last refresh, a change means someone asked for this host since */
+    uint64_t last_refreshed_use;
+    size_t unsolicited_resolve_count;
+    bool refresh_queued;
+    bool refresh_in_flight;
+    /* someone is waiting on a result, refresh again as soon as the in-flight one finishes */
+    bool refresh_requested;
 };
 
+static int s_compare_refresh_times(const void *a, const void *b) {
+    const struct host_entry *entry_a = *(const struct host_entry **)a;
+    const struct host_entry *entry_b = *(const struct host_entry **)b;
+
+    if (entry_a->next_refresh_time < entry_b->next_refresh_time) {
+        return -1;
+    }
+
+    return entry_a->next_refresh_time > entry_b->next_refresh_time;
+}
+
+static int s_resolver_worker_pool_init(
+    struct resolver_worker_pool *pool,
+    struct aws_allocator *allocator,
+    size_t max_worker_count) {
+    AWS_ZERO_STRUCT(*pool);
+
+    pool->workers = aws_mem_acquire(allocator, sizeof(struct aws_thread) * max_worker_count);
+    if (!pool->workers) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_priority_queue_init_dynamic(
+            &pool->refresh_queue, allocator, 16, sizeof(struct host_entry *), s_compare_refresh_times)) {
+        aws_mem_release(allocator, pool->workers);
+        return AWS_OP_ERR;
+    }
+
+    pool->allocator = allocator;
+    pool->max_worker_count = max_worker_count;
+    aws_mutex_init(&pool->lock);
+    aws_condition_variable_init(&pool->work_signal);
+    aws_condition_variable_init(&pool->refresh_done_signal);
+    return AWS_OP_SUCCESS;
+}
+
+/* every host entry has to be gone by now, so all that's left is idle workers. */
+static void s_resolver_worker_pool_clean_up(struct resolver_worker_pool *pool) {
+    aws_mutex_lock(&pool->lock);
+    pool->shutting_down = true;
+    aws_condition_variable_notify_all(&pool->work_signal);
+    aws_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->worker_count; ++i) {
+        aws_thread_join(&pool->workers[i]);
+        aws_thread_clean_up(&pool->workers[i]);
+    }
+
+    aws_mem_release(pool->allocator, pool->workers);
+    aws_priority_queue_clean_up(&pool->refresh_queue);
+    aws_condition_variable_clean_up(&pool->refresh_done_signal);
+    aws_condition_variable_clean_up(&pool->work_signal);
+    aws_mutex_clean_up(&pool->lock);
+}
+
 static int resolver_purge_cache(struct aws_host_resolver *resolver) {
     struct default_host_resolver *default_host_resolver = resolver->impl;
     aws_rw_lock_wlock(&default_host_resolver->host_lock);
@@ -139,6 +225,7 @@ static int resolver_purge_cache(struct aws_host_resolver *resolver) {
 static void resolver_destroy(struct aws_host_resolver *resolver) {
     struct default_host_resolver *default_host_resolver = resolver->impl;
     aws_lru_cache_clean_up(&default_host_resolver->host_table);
+    s_resolver_worker_pool_clean_up(&default_host_resolver->worker_pool);
     aws_mem_release(resolver->allocator, default_host_resolver);
     AWS_ZERO_STRUCT(*resolver);
 }
@@ -292,52 +379,58 @@ struct pending_callback {
     struct aws_linked_list_node node;
 };
 
-static void resolver_thread_fn(void *arg) {
-    struct host_entry *host_entry = arg;
-
-    uint64_t last_updated = 0;
-    size_t unsolicited_resolve_count = 0;
-    size_t unsolicited_resolve_max = host_entry->resolution_config.max_ttl;
-    struct aws_array_list address_list;
-    if (aws_array_list_init_dynamic(&address_list, host_entry->allocator, 4, sizeof(struct aws_host_address))) {
-        return;
-    }
-
-    while (host_entry->keep_active && unsolicited_resolve_count < unsolicited_resolve_max) {
-        if (last_updated != host_entry->last_use) {
-            unsolicited_resolve_count = 0;
-        }
+/* resolves host_entry once, updates its records and answers everyone waiting on it. address_list is the worker's
+ * scratch space. */
+static void s_refresh_host_entry(struct host_entry *host_entry, struct aws_array_list *address_list) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_DNS,
+        "static, resolving %s, unsolicited resolve count %d",
+        (const char *)aws_string_bytes(host_entry->host_name),
+        (int)host_entry->unsolicited_resolve_count);
 
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_DNS,
-            "static, resolving %s, unsolicited resolve count %d",
-            (const char *)aws_string_bytes(host_entry->host_name),
-            (int)unsolicited_resolve_count);
+    /* resolve and then process each record */
+    int err_code = host_entry->resolution_config.impl(
+        host_entry->allocator, host_entry->host_name, address_list, host_entry->resolution_config.impl_data);
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
 
-        ++unsolicited_resolve_count;
-        last_updated = host_entry->last_use;
+    if (!err_code) {
+        uint64_t max_expiry = timestamp + (host_entry->resolution_config.max_ttl * NS_PER_SEC);
 
-        /* resolve and then process each record */
-        int err_code = host_entry->resolution_config.impl(
-            host_entry->allocator, host_entry->host_name, &address_list, host_entry->resolution_config.impl_data);
-        uint64_t timestamp = 0;
-        aws_sys_clock_get_ticks(&timestamp);
+        for (size_t i = 0; i < aws_array_list_length(address_list); ++i) {
+            struct aws_host_address *fresh_resolved_address = NULL;
+            aws_array_list_get_at_ptr(address_list, (void **)&fresh_resolved_address, i);
 
-        if (!err_code) {
-            uint64_t new_expiry = timestamp + (host_entry->resolution_config.max_ttl * NS_PER_SEC);
+            /* implementations that know the record's TTL (e.g. aws_dns_client_resolve) set expiry, max_ttl caps it. */
+            uint64_t new_expiry = max_expiry;
+            if (fresh_resolved_address->expiry && fresh_resolved_address->expiry < max_expiry) {
+                new_expiry = fresh_resolved_address->expiry;
+            }
 
-            for (size_t i = 0; i < aws_array_list_length(&address_list); ++i) {
-                struct aws_host_address *fresh_resolved_address = NULL;
-                aws_array_list_get_at_ptr(&address_list, (void **)&fresh_resolved_address, i);
+            struct aws_lru_cache *address_table =
+                fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &host_entry->aaaa_records
+                                                                                    : &host_entry->a_records;
 
-                struct aws_lru_cache *address_table =
-                    fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &host_entry->aaaa_records
-                                                                                        : &host_entry->a_records;
+            aws_rw_lock_wlock(&host_entry->entry_lock);
+            struct aws_host_address *address_to_cache = NULL;
+            /* we only care if we found it, who cares if there was an error. */
+            aws_lru_cache_find(address_table, fresh_resolved_address->address, (void **)&address_to_cache);
 
-                aws_rw_lock_wlock(&host_entry->entry_lock);
-                struct aws_host_address *address_to_cache = NULL;
+            if (address_to_cache) {
+                address_to_cache->expiry = new_expiry;
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "static: updating expiry for %s for host %s to %llu",
+                    address_to_cache->address->bytes,
+                    host_entry->host_name->bytes,
+                    (unsigned long long)new_expiry);
+            } else {
+                struct aws_lru_cache *failed_address_table =
+                    fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
+                        ? &host_entry->failed_connection_aaaa_records
+                        : &host_entry->failed_connection_a_records;
                 /* we only care if we found it, who cares if there was an error. */
-                aws_lru_cache_find(address_table, fresh_resolved_address->address, (void **)&address_to_cache);
+                aws_lru_cache_find(failed_address_table, fresh_resolved_address->address, (void **)&address_to_cache);
 
                 if (address_to_cache) {
                     address_to_cache->expiry = new_expiry;
@@ -347,134 +440,270 @@ static void resolver_thread_fn(void *arg) {
                         address_to_cache->address->bytes,
                         host_entry->host_name->bytes,
                         (unsigned long long)new_expiry);
-                } else {
-                    struct aws_lru_cache *failed_address_table =
-                        fresh_resolved_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
-                            ? &host_entry->failed_connection_aaaa_records
-                            : &host_entry->failed_connection_a_records;
-                    /* we only care if we found it, who cares if there was an error. */
-                    aws_lru_cache_find(
-                        failed_address_table, fresh_resolved_address->address, (void **)&address_to_cache);
-
-                    if (address_to_cache) {
-                        address_to_cache->expiry = new_expiry;
-                        AWS_LOGF_TRACE(
-                            AWS_LS_IO_DNS,
-                            "static: updating expiry for %s for host %s to %llu",
-                            address_to_cache->address->bytes,
-                            host_entry->host_name->bytes,
-                            (unsigned long long)new_expiry);
-                    }
                 }
+            }
 
-                if (!address_to_cache) {
-                    address_to_cache = aws_mem_acquire(host_entry->allocator, sizeof(struct aws_host_address));
+            if (!address_to_cache) {
+                address_to_cache = aws_mem_acquire(host_entry->allocator, sizeof(struct aws_host_address));
 
-                    if (address_to_cache) {
-                        aws_host_address_move(fresh_resolved_address, address_to_cache);
-                        address_to_cache->expiry = new_expiry;
-                        aws_lru_cache_put(address_table, address_to_cache->address, address_to_cache);
+                if (address_to_cache) {
+                    aws_host_address_move(fresh_resolved_address, address_to_cache);
+                    address_to_cache->expiry = new_expiry;
+                    aws_lru_cache_put(address_table, address_to_cache->address, address_to_cache);
 
-                        AWS_LOGF_DEBUG(
-                            AWS_LS_IO_DNS,
-                            "static: new address resolved %s for host %s caching",
-                            address_to_cache->address->bytes,
-                            host_entry->host_name->bytes);
-                    }
+                    AWS_LOGF_DEBUG(
+                        AWS_LS_IO_DNS,
+                        "static: new address resolved %s for host %s caching",
+                        address_to_cache->address->bytes,
+                        host_entry->host_name->bytes);
                 }
-                aws_rw_lock_wunlock(&host_entry->entry_lock);
-
-                aws_host_address_clean_up(fresh_resolved_address);
             }
+            aws_rw_lock_wunlock(&host_entry->entry_lock);
 
-            aws_array_list_clear(&address_list);
+            aws_host_address_clean_up(fresh_resolved_address);
         }
 
-        /* process and clean_up records in the entry. occasionally, failed connect records will be upgraded
-         * for retry. */
-        aws_rw_lock_wlock(&host_entry->entry_lock);
-        process_records(host_entry->allocator, &host_entry->aaaa_records, &host_entry->failed_connection_aaaa_records);
-        process_records(host_entry->allocator, &host_entry->a_records, &host_entry->failed_connection_a_records);
-        aws_rw_lock_wunlock(&host_entry->entry_lock);
+        aws_array_list_clear(address_list);
+    }
+
+    /* process and clean_up records in the entry. occasionally, failed connect records will be upgraded
+     * for retry. */
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    process_records(host_entry->allocator, &host_entry->aaaa_records, &host_entry->failed_connection_aaaa_records);
+    process_records(host_entry->allocator, &host_entry->a_records, &host_entry->failed_connection_a_records);
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
+
+    /* now notify any subscribers that are waiting on resolutions. */
+    struct aws_linked_list pending_resolve_copy;
+    aws_linked_list_init(&pending_resolve_copy);
+    aws_rw_lock_wlock(&host_entry->entry_lock);
+    aws_linked_list_swap_contents(&host_entry->pending_resolution_callbacks, &pending_resolve_copy);
+    aws_rw_lock_wunlock(&host_entry->entry_lock);
+
+    while (!aws_linked_list_empty(&pending_resolve_copy)) {
+        struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
+        struct pending_callback *pending_callback =
+            AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
 
-        /* now notify any subscribers that are waiting on resolutions. */
-        struct aws_linked_list pending_resolve_copy;
-        aws_linked_list_init(&pending_resolve_copy);
         aws_rw_lock_wlock(&host_entry->entry_lock);
-        aws_linked_list_swap_contents(&host_entry->pending_resolution_callbacks, &pending_resolve_copy);
+        struct aws_host_address *aaaa_address = aws_lru_cache_use_lru_element(&host_entry->aaaa_records);
+        struct aws_host_address *a_address = aws_lru_cache_use_lru_element(&host_entry->a_records);
         aws_rw_lock_wunlock(&host_entry->entry_lock);
 
-        while (!aws_linked_list_empty(&pending_resolve_copy)) {
-            struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
-            struct pending_callback *pending_callback =
-                AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
+        if ((aaaa_address || a_address) && host_entry->keep_active) {
+            struct aws_host_address address_array[2];
+            AWS_ZERO_ARRAY(address_array);
+            struct aws_array_list callback_address_list;
+            aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
 
-            aws_rw_lock_wlock(&host_entry->entry_lock);
-            struct aws_host_address *aaaa_address = aws_lru_cache_use_lru_element(&host_entry->aaaa_records);
-            struct aws_host_address *a_address = aws_lru_cache_use_lru_element(&host_entry->a_records);
-            aws_rw_lock_wunlock(&host_entry->entry_lock);
+            if (aaaa_address) {
+                aaaa_address->use_count += 1;
+                aws_array_list_push_back(&callback_address_list, aaaa_address);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "static: vending address %s for host %s to caller",
+                    aaaa_address->address->bytes,
+                    host_entry->host_name->bytes);
+            }
+            if (a_address) {
+                a_address->use_count += 1;
+                aws_array_list_push_back(&callback_address_list, a_address);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "static: vending address %s for host %s to caller",
+                    a_address->address->bytes,
+                    host_entry->host_name->bytes);
+            }
 
-            if ((aaaa_address || a_address) && host_entry->keep_active) {
-                struct aws_host_address address_array[2];
-                AWS_ZERO_ARRAY(address_array);
-                struct aws_array_list callback_address_list;
-                aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+            pending_callback->callback(
+                host_entry->resolver,
+                host_entry->host_name,
+                AWS_OP_SUCCESS,
+                &callback_address_list,
+                pending_callback->user_data);
+            aws_array_list_clean_up(&callback_address_list);
+        } else {
 
-                if (aaaa_address) {
-                    aaaa_address->use_count += 1;
-                    aws_array_list_push_back(&callback_address_list, aaaa_address);
-                    AWS_LOGF_TRACE(
-                        AWS_LS_IO_DNS,
-                        "static: vending address %s for host %s to caller",
-                        aaaa_address->address->bytes,
-                        host_entry->host_name->bytes);
-                }
-                if (a_address) {
-                    a_address->use_count += 1;
-                    aws_array_list_push_back(&callback_address_list, a_address);
-                    AWS_LOGF_TRACE(
-                        AWS_LS_IO_DNS,
-                        "static: vending address %s for host %s to caller",
-                        a_address->address->bytes,
-                        host_entry->host_name->bytes);
-                }
+            if (!host_entry->keep_active && !err_code) {
+                aws_raise_error(AWS_ERROR_IO_OPERATION_CANCELLED);
+                err_code = AWS_ERROR_IO_OPERATION_CANCELLED;
+            }
 
-                pending_callback->callback(
-                    host_entry->resolver,
-                    host_entry->host_name,
-                    AWS_OP_SUCCESS,
-                    &callback_address_list,
-                    pending_callback->user_data);
-                aws_array_list_clean_up(&callback_address_list);
-            } else {
+            pending_callback->callback(
+                host_entry->resolver, host_entry->host_name, err_code, NULL, pending_callback->user_data);
+        }
+        aws_mem_release(host_entry->allocator, pending_callback);
+    }
+}
 
-                if (!host_entry->keep_active && !err_code) {
-                    aws_raise_error(AWS_ERROR_IO_OPERATION_CANCELLED);
-                    err_code = AWS_ERROR_IO_OPERATION_CANCELLED;
-                }
+static void s_resolver_worker_fn(void *arg);
 
-                pending_callback->callback(
-                    host_entry->resolver, host_entry->host_name, err_code, NULL, pending_callback->user_data);
-            }
-            aws_mem_release(host_entry->allocator, pending_callback);
+/* wakes an idle worker to look at the queue, or starts a new one if they're all busy and there's room. Fails only if
+ * there is no worker at all to do the job. */
+static int s_wake_worker_synced(struct default_host_resolver *default_host_resolver) {
+    struct resolver_worker_pool *pool = &default_host_resolver->worker_pool;
+
+    if (pool->idle_worker_count) {
+        aws_condition_variable_notify_one(&pool->work_signal);
+        return AWS_OP_SUCCESS;
+    }
+
+    if (pool->worker_count < pool->max_worker_count) {
+        struct aws_thread *worker = &pool->workers[pool->worker_count];
+        aws_thread_init(worker, pool->allocator);
+        if (!aws_thread_launch(worker, s_resolver_worker_fn, default_host_resolver, NULL)) {
+            pool->worker_count++;
+            return AWS_OP_SUCCESS;
         }
-        aws_mutex_lock(&host_entry->semaphore_mutex);
 
-        /* we don't actually care about spurious wakeups here. */
-        aws_condition_variable_wait_for(
-            &host_entry->resolver_thread_semaphore, &host_entry->semaphore_mutex, host_entry->resolve_frequency_ns);
+        AWS_LOGF_WARN(
+            AWS_LS_IO_DNS,
+            "static: failed to start a resolver worker thread with error %d, %llu workers running",
+            aws_last_error(),
+            (unsigned long long)pool->worker_count);
+        aws_thread_clean_up(worker);
+        if (!pool->worker_count) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    /* the next worker to finish will get to it */
+    return AWS_OP_SUCCESS;
+}
 
-        aws_mutex_unlock(&host_entry->semaphore_mutex);
+/* puts host_entry in the refresh queue to be resolved at refresh_time, or earlier if it's already queued for later. */
+static int s_schedule_refresh_synced(
+    struct resolver_worker_pool *pool,
+    struct host_entry *host_entry,
+    uint64_t refresh_time) {
+
+    if (host_entry->refresh_in_flight) {
+        /* the worker resolving it right now re-queues it when it's done, just not for another resolve_frequency. */
+        host_entry->refresh_requested = true;
+        return AWS_OP_SUCCESS;
     }
 
-    AWS_LOGF_DEBUG(
-        AWS_LS_IO_DNS,
-        "static: Either no requests have been made for an address for %s for the duration "
-        "of the ttl, or this thread is being forcibly shutdown. Killing thead.",
-        host_entry->host_name->bytes)
+    if (host_entry->refresh_queued) {
+        if (host_entry->next_refresh_time <= refresh_time) {
+            return AWS_OP_SUCCESS;
+        }
+
+        struct host_entry *removed = NULL;
+        aws_priority_queue_remove(&pool->refresh_queue, &removed, &host_entry->refresh_queue_node);
+        host_entry->refresh_queued = false;
+    }
+
+    host_entry->next_refresh_time = refresh_time;
+    if (aws_priority_queue_push_ref(&pool->refresh_queue, &host_entry, &host_entry->refresh_queue_node)) {
+        return AWS_OP_ERR;
+    }
+
+    host_entry->refresh_queued = true;
+    return AWS_OP_SUCCESS;
+}
+
+/* someone wants an answer for host_entry: put it (back) in the rotation and get it resolved as soon as possible. */
+static int s_request_refresh(
+    struct default_host_resolver *default_host_resolver,
+    struct host_entry *host_entry,
+    uint64_t timestamp) {
+
+    struct resolver_worker_pool *pool = &default_host_resolver->worker_pool;
+
+    aws_mutex_lock(&pool->lock);
+    int result = s_schedule_refresh_synced(pool, host_entry, timestamp);
+    if (!result) {
+        host_entry->keep_active = true;
+        result = s_wake_worker_synced(default_host_resolver);
+    }
+    aws_mutex_unlock(&pool->lock);
+
+    return result;
+}
+
+static void s_resolver_worker_fn(void *arg) {
+    struct default_host_resolver *default_host_resolver = arg;
+    struct resolver_worker_pool *pool = &default_host_resolver->worker_pool;
+
+    struct aws_array_list address_list;
+    if (aws_array_list_init_dynamic(&address_list, pool->allocator, 4, sizeof(struct aws_host_address))) {
+        return;
+    }
+
+    aws_mutex_lock(&pool->lock);
+
+    while (!pool->shutting_down) {
+        struct host_entry **next_entry = NULL;
+        if (aws_priority_queue_top(&pool->refresh_queue, (void **)&next_entry)) {
+            pool->idle_worker_count++;
+            aws_condition_variable_wait(&pool->work_signal, &pool->lock);
+            pool->idle_worker_count--;
+            continue;
+        }
+
+        uint64_t timestamp = 0;
+        aws_sys_clock_get_ticks(&timestamp);
+
+        struct host_entry *host_entry = *next_entry;
+        if (host_entry->next_refresh_time > timestamp) {
+            /* we don't actually care about spurious wakeups here. */
+            pool->idle_worker_count++;
+            aws_condition_variable_wait_for(
+                &pool->work_signal, &pool->lock, (int64_t)(host_entry->next_refresh_time - timestamp));
+            pool->idle_worker_count--;
+            continue;
+        }
+
+        aws_priority_queue_pop(&pool->refresh_queue, &host_entry);
+        host_entry->refresh_queued = false;
+
+        if (host_entry->last_refreshed_use != host_entry->last_use) {
+            host_entry->unsolicited_resolve_count = 0;
+        }
+
+        if (!host_entry->keep_active ||
+            host_entry->unsolicited_resolve_count >= host_entry->resolution_config.max_ttl) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_DNS,
+                "static: no requests have been made for an address for %s for the duration of the ttl, "
+                "no longer refreshing it.",
+                host_entry->host_name->bytes);
+            host_entry->keep_active = false;
+            continue;
+        }
 
+        ++host_entry->unsolicited_resolve_count;
+        host_entry->last_refreshed_use = host_entry->last_use;
+        host_entry->refresh_in_flight = true;
+        host_entry->refresh_requested = false;
+        aws_mutex_unlock(&pool->lock);
+
+        s_refresh_host_entry(host_entry, &address_list);
+
+        aws_sys_clock_get_ticks(&timestamp);
+
+        aws_mutex_lock(&pool->lock);
+        host_entry->refresh_in_flight = false;
+
+        /* if the entry is being removed, it isn't active anymore and whoever is removing it is waiting on us. */
+        if (host_entry->keep_active) {
+            uint64_t refresh_time =
+                host_entry->refresh_requested ? timestamp : timestamp + host_entry->resolve_frequency_ns;
+            if (s_schedule_refresh_synced(pool, host_entry, refresh_time)) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_IO_DNS,
+                    "static: failed to schedule the next refresh for %s with error %d",
+                    host_entry->host_name->bytes,
+                    aws_last_error());
+                host_entry->keep_active = false;
+            }
+        }
+
+        aws_condition_variable_notify_all(&pool->refresh_done_signal);
+    }
+
+    aws_mutex_unlock(&pool->lock);
     aws_array_list_clean_up(&address_list);
-    host_entry->keep_active = false;
 }
 
 static void on_host_key_removed(void *key) {
@@ -489,12 +718,22 @@ static void on_host_value_removed(void *value) {
         "the cache due to cache size or shutdown",
         host_entry->host_name->bytes);
 
-    if (host_entry->keep_active) {
-        host_entry->keep_active = false;
-        aws_condition_variable_notify_one(&host_entry->resolver_thread_semaphore);
-        aws_thread_join(&host_entry->resolver_thread);
-        aws_thread_clean_up(&host_entry->resolver_thread);
+    /* take it out of the refresh rotation, and if a worker is resolving it right now, wait for it to let go. */
+    struct default_host_resolver *default_host_resolver = host_entry->resolver->impl;
+    struct resolver_worker_pool *pool = &default_host_resolver->worker_pool;
+    aws_mutex_lock(&pool->lock);
+    host_entry->keep_active = false;
+
+    if (host_entry->refresh_queued) {
+        struct host_entry *removed = NULL;
+        aws_priority_queue_remove(&pool->refresh_queue, &removed, &host_entry->refresh_queue_node);
+        host_entry->refresh_queued = false;
+    }
+
+    while (host_entry->refresh_in_flight) {
+        aws_condition_variable_wait(&pool->refresh_done_signal, &pool->lock);
     }
+    aws_mutex_unlock(&pool->lock);
 
     if (!aws_linked_list_empty(&host_entry->pending_resolution_callbacks)) {
         aws_raise_error(AWS_IO_DNS_HOST_REMOVED_FROM_CACHE);
@@ -557,7 +796,7 @@ static inline int create_and_init_host_entry(
     new_host_entry->resolve_frequency_ns = NS_PER_SEC;
 
     bool a_records_init = false, aaaa_records_init = false, failed_a_records_init = false,
-         failed_aaaa_records_init = false, thread_init = false;
+         failed_aaaa_records_init = false;
     struct pending_callback *pending_callback = NULL;
     const struct aws_string *host_string_copy =
         aws_string_new_from_array(resolver->allocator, aws_string_bytes(host_name), host_name->len);
@@ -631,12 +870,15 @@ static inline int create_and_init_host_entry(
     aws_rw_lock_init(&new_host_entry->entry_lock);
     new_host_entry->keep_active = false;
     new_host_entry->resolution_config = *config;
-    aws_mutex_init(&new_host_entry->semaphore_mutex);
-    aws_condition_variable_init(&new_host_entry->resolver_thread_semaphore);
+    new_host_entry->refresh_queue_node.current_index = SIZE_MAX;
+    new_host_entry->next_refresh_time = 0;
+    new_host_entry->last_refreshed_use = 0;
+    new_host_entry->unsolicited_resolve_count = 0;
+    new_host_entry->refresh_queued = false;
+    new_host_entry->refresh_in_flight = false;
+    new_host_entry->refresh_requested = false;
 
     struct default_host_resolver *default_host_resolver = resolver->impl;
-    aws_thread_init(&new_host_entry->resolver_thread, default_host_resolver->allocator);
-    thread_init = true;
     aws_rw_lock_wlock(&default_host_resolver->host_lock);
 
     struct host_entry *race_condition_entry = NULL;
@@ -645,33 +887,39 @@ static inline int create_and_init_host_entry(
 
     if (race_condition_entry) {
         aws_rw_lock_wlock(&race_condition_entry->entry_lock);
+        aws_linked_list_remove(&pending_callback->node);
         aws_linked_list_push_back(&race_condition_entry->pending_resolution_callbacks, &pending_callback->node);
+        race_condition_entry->last_use = timestamp;
 
-        if (!race_condition_entry->keep_active) {
-            race_condition_entry->keep_active = true;
-            aws_thread_clean_up(&race_condition_entry->resolver_thread);
-            aws_thread_init(&race_condition_entry->resolver_thread, resolver->allocator);
-            aws_thread_launch(&race_condition_entry->resolver_thread, resolver_thread_fn, race_condition_entry, NULL);
+        int result = s_request_refresh(default_host_resolver, race_condition_entry, timestamp);
+        if (result) {
+            aws_linked_list_remove(&pending_callback->node);
+            aws_mem_release(resolver->allocator, pending_callback);
         }
 
-        race_condition_entry->last_use = timestamp;
-
         aws_rw_lock_wunlock(&race_condition_entry->entry_lock);
 
-        aws_linked_list_remove(&pending_callback->node);
         on_host_value_removed(new_host_entry);
         aws_rw_lock_wunlock(&default_host_resolver->host_lock);
-        return AWS_OP_SUCCESS;
+        return result;
     }
 
     host_entry = new_host_entry;
-    host_entry->keep_active = true;
 
     if (AWS_UNLIKELY(aws_lru_cache_put(&default_host_resolver->host_table, host_string_copy, host_entry))) {
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
         goto setup_host_entry_error;
     }
 
-    aws_thread_launch(&new_host_entry->resolver_thread, resolver_thread_fn, host_entry, NULL);
+    if (AWS_UNLIKELY(s_request_refresh(default_host_resolver, host_entry, timestamp))) {
+        /* nobody will be told about this one but the caller */
+        aws_linked_list_remove(&pending_callback->node);
+        aws_mem_release(resolver->allocator, pending_callback);
+        aws_lru_cache_remove(&default_host_resolver->host_table, host_string_copy);
+        aws_rw_lock_wunlock(&default_host_resolver->host_lock);
+        return AWS_OP_ERR;
+    }
+
     aws_rw_lock_wunlock(&default_host_resolver->host_lock);
     return AWS_OP_SUCCESS;
 
@@ -700,10 +948,6 @@ setup_host_entry_error:
         aws_lru_cache_clean_up(&new_host_entry->failed_connection_a_records);
     }
 
-    if (thread_init) {
-        aws_thread_clean_up(&new_host_entry->resolver_thread);
-    }
-
     aws_mem_release(resolver->allocator, new_host_entry);
     return AWS_OP_ERR;
 }
@@ -809,17 +1053,17 @@ static int default_resolve_host(
     pending_callback->callback = res;
     aws_linked_list_push_back(&host_entry->pending_resolution_callbacks, &pending_callback->node);
 
-    if (!host_entry->keep_active) {
-        aws_thread_clean_up(&host_entry->resolver_thread);
-        aws_thread_init(&host_entry->resolver_thread, default_host_resolver->allocator);
-        host_entry->keep_active = true;
-        aws_thread_launch(&host_entry->resolver_thread, resolver_thread_fn, host_entry, NULL);
+    /* nothing usable is cached, so don't make the caller wait for the next scheduled refresh. */
+    int result = s_request_refresh(default_host_resolver, host_entry, timestamp);
+    if (result) {
+        aws_linked_list_remove(&pending_callback->node);
+        aws_mem_release(default_host_resolver->allocator, pending_callback);
     }
 
     aws_rw_lock_wunlock(&host_entry->entry_lock);
     aws_rw_lock_runlock(&default_host_resolver->host_lock);
 
-    return AWS_OP_SUCCESS;
+    return result;
 }
 
 static struct aws_host_resolver_vtable s_vtable = {
@@ -835,11 +1079,27 @@ int aws_host_resolver_init_default(
     size_t max_entries,
     struct aws_event_loop_group *el_group) {
 
+    struct aws_host_resolver_default_options options = {
+        .max_entries = max_entries,
+        .el_group = el_group,
+        .max_worker_count = AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT,
+    };
+
+    return aws_host_resolver_init_default_with_options(resolver, allocator, &options);
+}
+
+int aws_host_resolver_init_default_with_options(
+    struct aws_host_resolver *resolver,
+    struct aws_allocator *allocator,
+    const struct aws_host_resolver_default_options *options) {
+
     /* NOTE: we don't use el_group yet, but we will in the future. Also, we
       don't want host resolvers getting cleaned up after el_groups; this will force that
       in bindings, and encourage it in C land. */
-    (void)el_group;
-    AWS_ASSERT(el_group);
+    AWS_ASSERT(options->el_group);
+    size_t max_entries = options->max_entries;
+    size_t max_worker_count =
+        options->max_worker_count ? options->max_worker_count : AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT;
     struct default_host_resolver *default_host_resolver =
         aws_mem_acquire(allocator, sizeof(struct default_host_resolver));
 
@@ -849,12 +1109,18 @@ int aws_host_resolver_init_default(
 
     AWS_LOGF_INFO(
         AWS_LS_IO_DNS,
-        "id=%p: Initializing default host resolver with %llu max host entries.",
+        "id=%p: Initializing default host resolver with %llu max host entries and up to %llu worker threads.",
         (void *)resolver,
-        (unsigned long long)max_entries);
+        (unsigned long long)max_entries,
+        (unsigned long long)max_worker_count);
 
     default_host_resolver->allocator = allocator;
     aws_rw_lock_init(&default_host_resolver->host_lock);
+    if (s_resolver_worker_pool_init(&default_host_resolver->worker_pool, allocator, max_worker_count)) {
+        aws_mem_release(allocator, default_host_resolver);
+        return AWS_OP_ERR;
+    }
+
     if (aws_lru_cache_init(
             &default_host_resolver->host_table,
             allocator,
@@ -863,6 +1129,7 @@ int aws_host_resolver_init_default(
             on_host_key_removed,
             on_host_value_removed,
             max_entries)) {
+        s_resolver_worker_pool_clean_up(&default_host_resolver->worker_pool);
         aws_mem_release(allocator, default_host_resolver);
         return AWS_OP_ERR;
     }
@@ -947,6 +1214,12 @@ int aws_host_resolver_init_uv(
     uv_host_resolver->uv_loop = uv_loop;
     uv_host_resolver->impl.allocator = allocator;
     aws_rw_lock_init(&uv_host_resolver->impl.host_lock);
+    if (s_resolver_worker_pool_init(
+            &uv_host_resolver->impl.worker_pool, allocator, AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT)) {
+        aws_mem_release(allocator, uv_host_resolver);
+        return AWS_OP_ERR;
+    }
+
     if (aws_lru_cache_init(
             &uv_host_resolver->impl.host_table,
             allocator,
@@ -955,6 +1228,7 @@ int aws_host_resolver_init_uv(
             on_host_key_removed,
             on_host_value_removed,
             max_entries)) {
+        s_resolver_worker_pool_clean_up(&uv_host_resolver->impl.worker_pool);
         aws_mem_release(allocator, uv_host_resolver);
         return AWS_OP_ERR;
     }
@@ -15,6 +15,8 @@
 
 #include <aws/io/event_loop.h>
 
+#include <aws/io/private/timing_wheel.h>
+
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
 #include <aws/common/mutex.h>
@@ -89,6 +91,12 @@ struct libuv_loop {
         struct aws_mutex mutex;
         /* Map of aws_task * -> task_data * */
         struct aws_hash_table running_tasks;
+        /* Far-off future tasks wait here, without a uv timer of their own, until they're close to due */
+        struct aws_timing_wheel timing_wheel;
+        /* Single timer that fires when the next occupied wheel tick comes around */
+        uv_timer_t wheel_timer;
+        /* Start of the tick wheel_timer is armed for, 0 if it isn't armed */
+        uint64_t wheel_timer_due;
         /* List of aws_io_handle * */
         struct aws_linked_list open_subscriptions;
     } active_thread_data;
@@ -333,6 +341,17 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     aws_hash_table_foreach(&impl->active_thread_data.running_tasks, s_running_tasks_destroy, NULL);
     aws_hash_table_clean_up(&impl->active_thread_data.running_tasks);
 
+    /* As do the ones still on the wheel */
+    struct aws_linked_list wheel_tasks;
+    aws_linked_list_init(&wheel_tasks);
+    aws_timing_wheel_take_all(&impl->active_thread_data.timing_wheel, &wheel_tasks);
+    while (!aws_linked_list_empty(&wheel_tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&wheel_tasks);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+    }
+    aws_timing_wheel_clean_up(&impl->active_thread_data.timing_wheel);
+
     if (impl->owns_uv_loop) {
 #if UV_VERSION_MAJOR == 0
         uv_loop_delete(impl->uv_loop);
@@ -393,12 +412,42 @@ static void s_uv_task_timer_cb(uv_timer_t *handle UV_STATUS_PARAM) {
     uv_close((uv_handle_t *)handle, s_uv_close_timer);
 }
 
+static void s_uv_wheel_timer_cb(uv_timer_t *handle UV_STATUS_PARAM);
+
+/* Arms the wheel timer for tick_start_ns, unless it's already armed for something sooner. */
+static void s_arm_wheel_timer(struct libuv_loop *impl, uint64_t tick_start_ns) {
+    if (impl->active_thread_data.wheel_timer_due && impl->active_thread_data.wheel_timer_due <= tick_start_ns) {
+        return;
+    }
+
+    impl->active_thread_data.wheel_timer_due = tick_start_ns;
+    uv_timer_start(
+        &impl->active_thread_data.wheel_timer,
+        s_uv_wheel_timer_cb,
+        s_timestamp_to_uv_millis(s_loop_from_impl(impl), tick_start_ns),
+        0);
+}
+
+static void s_arm_wheel_timer_for_next_tick(struct libuv_loop *impl) {
+    uint64_t next_tick_ns = 0;
+    if (aws_timing_wheel_next_tick_time(&impl->active_thread_data.timing_wheel, UINT64_MAX, &next_tick_ns)) {
+        s_arm_wheel_timer(impl, next_tick_ns);
+    }
+}
+
 static void s_schedule_task_impl(struct libuv_loop *impl, struct aws_task *task) {
 
     struct aws_event_loop *event_loop = s_loop_from_impl(impl);
     /* This function should only be called from the uv thread or an async */
     AWS_ASSERT(s_is_on_callers_thread(event_loop));
 
+    /* Coarse timeouts share the wheel's timer instead of getting one each */
+    struct aws_timing_wheel *wheel = &impl->active_thread_data.timing_wheel;
+    if (task->timestamp && aws_timing_wheel_try_schedule(wheel, task, task->timestamp)) {
+        s_arm_wheel_timer(impl, task->timestamp - task->timestamp % wheel->tick_ns);
+        return;
+    }
+
     aws_atomic_fetch_add(&impl->num_open_handles, 1);
 
     /* Allocate and initalize timer */
@@ -416,6 +465,34 @@ static void s_schedule_task_impl(struct libuv_loop *impl, struct aws_task *task)
     AWS_ASSERT(was_created == 1);
 }
 
+/* Hands wheel tasks whose tick has come to their own timers, which fire at their exact timestamp */
+static void s_uv_wheel_timer_cb(uv_timer_t *handle UV_STATUS_PARAM) {
+    UV_STATUS_PARAM_UNUSED;
+
+    struct libuv_loop *impl = handle->data;
+
+    uint64_t now = 0;
+    s_loop_from_impl(impl)->clock(&now);
+    /* uv timers only have millisecond resolution and can fire a hair early, treat that as the tick having come */
+    if (now < impl->active_thread_data.wheel_timer_due) {
+        now = impl->active_thread_data.wheel_timer_due;
+    }
+    impl->active_thread_data.wheel_timer_due = 0;
+
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+    aws_timing_wheel_expire(&impl->active_thread_data.timing_wheel, now, &expired);
+
+    while (!aws_linked_list_empty(&expired)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&expired);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+
+        s_schedule_task_impl(impl, task);
+    }
+
+    s_arm_wheel_timer_for_next_tick(impl);
+}
+
 /* Wakes up the event loop and passes pending tasks to the real task scheduler */
 static void s_uv_async_schedule_tasks(uv_async_t *request UV_STATUS_PARAM) {
     UV_STATUS_PARAM_UNUSED;
@@ -479,6 +556,9 @@ static void s_uv_async_stop_loop(uv_async_t *request UV_STATUS_PARAM) {
 
     /* Stop all open timers */
     aws_hash_table_foreach(&impl->active_thread_data.running_tasks, s_running_tasks_stop, NULL);
+    uv_timer_stop(&impl->active_thread_data.wheel_timer);
+    impl->active_thread_data.wheel_timer_due = 0;
+    uv_close((uv_handle_t *)&impl->active_thread_data.wheel_timer, s_uv_close_handle);
 
     uv_close((uv_handle_t *)&impl->stop_async, s_uv_close_handle);
     uv_close((uv_handle_t *)&impl->pending_tasks.schedule_async, s_uv_close_handle);
@@ -545,6 +625,12 @@ static int s_run(struct aws_event_loop *event_loop) {
     aws_hash_table_foreach(&impl->active_thread_data.running_tasks, s_running_tasks_start, impl);
     cleanup_timers = true;
 
+    /* Tasks left on the wheel by a previous stop wait for the next tick as usual */
+    uv_timer_init(impl->uv_loop, &impl->active_thread_data.wheel_timer);
+    impl->active_thread_data.wheel_timer.data = impl;
+    aws_atomic_fetch_add(&impl->num_open_handles, 1);
+    s_arm_wheel_timer_for_next_tick(impl);
+
     if (impl->owns_uv_loop) {
         AWS_ASSERT(s_owned(impl)->state == EVENT_THREAD_STATE_READY_TO_RUN);
 
@@ -566,6 +652,9 @@ static int s_run(struct aws_event_loop *event_loop) {
 clean_up:
     if (cleanup_timers) {
         aws_hash_table_foreach(&impl->active_thread_data.running_tasks, s_running_tasks_stop, impl);
+        uv_timer_stop(&impl->active_thread_data.wheel_timer);
+        impl->active_thread_data.wheel_timer_due = 0;
+        uv_close((uv_handle_t *)&impl->active_thread_data.wheel_timer, s_uv_close_handle);
     }
     if (cleanup_polls) {
         struct aws_linked_list_node *open_subs_it = aws_linked_list_begin(&impl->active_thread_data.open_subscriptions);
@@ -651,6 +740,12 @@ static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *ta
 
     AWS_ASSERT(s_is_on_callers_thread(event_loop));
 
+    /* Not worth stopping the wheel timer for, if the tick ends up empty it just re-arms */
+    if (aws_timing_wheel_remove(&impl->active_thread_data.timing_wheel, task)) {
+        aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+        return;
+    }
+
     struct aws_hash_element *elem = NULL;
     aws_hash_table_find(&impl->active_thread_data.running_tasks, task, &elem);
     if (elem) {
@@ -841,6 +936,19 @@ static int s_libuv_loop_init(
     }
     aws_linked_list_init(&impl->active_thread_data.open_subscriptions);
 
+    uint64_t now = 0;
+    clock(&now);
+    if (aws_timing_wheel_init(
+            &impl->active_thread_data.timing_wheel,
+            alloc,
+            AWS_TIMING_WHEEL_DEFAULT_TICK_NS,
+            AWS_TIMING_WHEEL_DEFAULT_SLOT_COUNT,
+            AWS_TIMING_WHEEL_DEFAULT_MIN_DELAY_NS,
+            now)) {
+        aws_hash_table_clean_up(&impl->active_thread_data.running_tasks);
+        goto clean_up;
+    }
+
     event_loop->impl_data = impl;
     event_loop->vtable = &s_libuv_vtable;
 
@@ -15,15 +15,18 @@
 
 #include <aws/io/event_loop.h>
 
+#include <aws/io/private/event_loop_stats.h>
+#include <aws/io/private/timing_wheel.h>
+
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
-#include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
 
 #include <aws/io/logging.h>
 
 #include <sys/epoll.h>
+#include <sys/socket.h>
 
 #include <errno.h>
 #include <limits.h>
@@ -53,6 +56,11 @@
 #    define EPOLLRDHUP 0x2000
 #endif
 
+/* Same story as EPOLLRDHUP, older headers don't have this one. */
+#ifndef SO_BUSY_POLL
+#    define SO_BUSY_POLL 46
+#endif
+
 static void s_destroy(struct aws_event_loop *event_loop);
 static int s_run(struct aws_event_loop *event_loop);
 static int s_stop(struct aws_event_loop *event_loop);
@@ -69,6 +77,10 @@ static int s_subscribe_to_io_events(
 static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
 static void s_free_io_event_resources(void *user_data);
 static bool s_is_on_callers_thread(struct aws_event_loop *event_loop);
+static int s_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats);
+static aws_event_loop_inner_fn *s_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn);
 
 static void s_main_loop(void *args);
 
@@ -84,17 +96,28 @@ static struct aws_event_loop_vtable s_vtable = {
     .unsubscribe_from_io_events = s_unsubscribe_from_io_events,
     .free_io_event_resources = s_free_io_event_resources,
     .is_on_callers_thread = s_is_on_callers_thread,
+    .get_stats = s_get_stats,
+    .set_current_inner_fn = s_set_current_inner_fn,
 };
 
 struct epoll_loop {
     struct aws_task_scheduler scheduler;
+    /* Far-off future tasks wait here and only move into the scheduler once they're close to due. */
+    struct aws_timing_wheel timing_wheel;
     struct aws_thread thread;
     struct aws_atomic_var thread_id;
     struct aws_io_handle read_task_handle;
     struct aws_io_handle write_task_handle;
-    struct aws_mutex task_pre_queue_mutex;
-    struct aws_linked_list task_pre_queue;
+    /* Intrusive MPSC stack of cross-thread tasks, linked through task->node.next. Producers push with a CAS, and the
+     * event-loop thread takes the whole stack with a single exchange, so no lock is needed on either side. */
+    struct aws_atomic_var task_pre_queue_head;
+    /* Set by the first producer to write to the eventfd/pipe since the event-loop thread last drained the queue. */
+    struct aws_atomic_var task_pre_queue_signaled;
     struct aws_task stop_task;
+    struct aws_event_loop_stats_tracker stats;
+    /* see aws_event_loop_options. */
+    uint64_t busy_poll_ns;
+    int socket_busy_poll_us;
     int epoll_fd;
     bool should_process_task_pre_queue;
     bool should_continue;
@@ -119,6 +142,18 @@ int aws_open_nonblocking_posix_pipe(int pipe_fds[2]);
 
 /* Setup edge triggered epoll with a scheduler. */
 struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    return aws_event_loop_new_system_with_options(alloc, &options);
+}
+
+struct aws_event_loop *aws_event_loop_new_system_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
+
+    aws_io_clock_fn *clock = options->clock;
     struct aws_event_loop *loop = aws_mem_acquire(alloc, sizeof(struct aws_event_loop));
 
     if (!loop) {
@@ -140,8 +175,12 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
     /* initialize thread id to 0, it should be updated when the event loop thread starts. */
     aws_atomic_init_int(&epoll_loop->thread_id, 0);
 
-    aws_linked_list_init(&epoll_loop->task_pre_queue);
-    epoll_loop->task_pre_queue_mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    aws_atomic_init_ptr(&epoll_loop->task_pre_queue_head, NULL);
+    aws_atomic_init_int(&epoll_loop->task_pre_queue_signaled, 0);
+    aws_event_loop_stats_tracker_init(&epoll_loop->stats, alloc, clock);
+    epoll_loop->busy_poll_ns = options->busy_poll_ns;
+    epoll_loop->socket_busy_poll_us =
+        options->socket_busy_poll_us > INT_MAX ? INT_MAX : (int)options->socket_busy_poll_us;
 
     epoll_loop->epoll_fd = epoll_create(100);
     if (epoll_loop->epoll_fd < 0) {
@@ -190,6 +229,18 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
         goto clean_up_pipe;
     }
 
+    uint64_t now_ns = 0;
+    clock(&now_ns);
+    if (aws_timing_wheel_init(
+            &epoll_loop->timing_wheel,
+            alloc,
+            AWS_TIMING_WHEEL_DEFAULT_TICK_NS,
+            AWS_TIMING_WHEEL_DEFAULT_SLOT_COUNT,
+            AWS_TIMING_WHEEL_DEFAULT_MIN_DELAY_NS,
+            now_ns)) {
+        goto clean_up_scheduler;
+    }
+
     epoll_loop->should_continue = false;
 
     loop->impl_data = epoll_loop;
@@ -197,6 +248,9 @@ struct aws_event_loop *aws_event_loop_new_system(struct aws_allocator *alloc, aw
 
     return loop;
 
+clean_up_scheduler:
+    aws_task_scheduler_clean_up(&epoll_loop->scheduler);
+
 clean_up_pipe:
 #if USE_EFD
     close(epoll_loop->write_task_handle.data.fd);
@@ -226,6 +280,20 @@ clean_up_loop:
     return NULL;
 }
 
+/* Takes everything producers have pushed so far, and puts it in `out` in the order it was scheduled. */
+static void s_take_task_pre_queue(struct epoll_loop *epoll_loop, struct aws_linked_list *out) {
+    aws_linked_list_init(out);
+
+    struct aws_linked_list_node *node = aws_atomic_exchange_ptr(&epoll_loop->task_pre_queue_head, NULL);
+
+    /* the stack is newest first, pushing each one on the front restores submission order. */
+    while (node) {
+        struct aws_linked_list_node *next = node->next;
+        aws_linked_list_push_front(out, node);
+        node = next;
+    }
+}
+
 static void s_destroy(struct aws_event_loop *event_loop) {
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Destroying event_loop", (void *)event_loop);
 
@@ -238,10 +306,26 @@ static void s_destroy(struct aws_event_loop *event_loop) {
 
     /* setting this so that canceled tasks don't blow up when asking if they're on the event-loop thread. */
     aws_atomic_store_int(&epoll_loop->thread_id, (size_t)aws_thread_current_thread_id());
+
+    /* hand whatever is still on the wheel to the scheduler so that everything gets canceled in timestamp order. */
+    struct aws_linked_list wheel_tasks;
+    aws_linked_list_init(&wheel_tasks);
+    aws_timing_wheel_take_all(&epoll_loop->timing_wheel, &wheel_tasks);
+    while (!aws_linked_list_empty(&wheel_tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&wheel_tasks);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+    }
+    aws_timing_wheel_clean_up(&epoll_loop->timing_wheel);
+
     aws_task_scheduler_clean_up(&epoll_loop->scheduler);
+    aws_event_loop_stats_tracker_clean_up(&epoll_loop->stats);
+
+    struct aws_linked_list task_pre_queue;
+    s_take_task_pre_queue(epoll_loop, &task_pre_queue);
 
-    while (!aws_linked_list_empty(&epoll_loop->task_pre_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&epoll_loop->task_pre_queue);
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
         struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
         task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
     }
@@ -306,6 +390,18 @@ static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return aws_thread_join(&epoll_loop->thread);
 }
 
+/* Must be called from the event-loop thread. Coarse timeouts go on the timing wheel, the rest to the scheduler. */
+static void s_schedule_task_in_thread(struct epoll_loop *epoll_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    task = aws_event_loop_stats_track_task(&epoll_loop->stats, task);
+
+    if (run_at_nanos == 0) {
+        /* zero denotes "now" task */
+        aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
+    } else if (!aws_timing_wheel_try_schedule(&epoll_loop->timing_wheel, task, run_at_nanos)) {
+        aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
+    }
+}
+
 static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
     struct epoll_loop *epoll_loop = event_loop->impl_data;
 
@@ -317,12 +413,7 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
             (void *)event_loop,
             (void *)task,
             (unsigned long long)run_at_nanos);
-        if (run_at_nanos == 0) {
-            /* zero denotes "now" task */
-            aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
-        }
+        s_schedule_task_in_thread(epoll_loop, task, run_at_nanos);
         return;
     }
 
@@ -333,25 +424,25 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         (void *)task,
         (unsigned long long)run_at_nanos);
     task->timestamp = run_at_nanos;
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
-
-    uint64_t counter = 1;
-
-    bool is_first_task = aws_linked_list_empty(&epoll_loop->task_pre_queue);
 
-    aws_linked_list_push_back(&epoll_loop->task_pre_queue, &task->node);
+    void *head = aws_atomic_load_ptr(&epoll_loop->task_pre_queue_head);
+    do {
+        task->node.next = head;
+        task->node.prev = NULL;
+    } while (!aws_atomic_compare_exchange_ptr(&epoll_loop->task_pre_queue_head, &head, &task->node));
 
-    /* if the list was not empty, we already have a pending read on the pipe/eventfd, no need to write again. */
-    if (is_first_task) {
+    /* if someone already signaled since the last drain, there's a pending read on the pipe/eventfd, and the event loop
+     * will pick this task up along with theirs. */
+    if (aws_atomic_exchange_int(&epoll_loop->task_pre_queue_signaled, 1) == 0) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
 
+        uint64_t counter = 1;
+
         /* If the write fails because the buffer is full, we don't actually care because that means there's a pending
          * read on the pipe/eventfd and thus the event loop will end up checking to see if something has been queued.*/
         ssize_t do_not_care = write(epoll_loop->write_task_handle.data.fd, (void *)&counter, sizeof(counter));
         (void)do_not_care;
     }
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
 }
 
 static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
@@ -365,7 +456,33 @@ static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws
 static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
     struct epoll_loop *epoll_loop = event_loop->impl_data;
-    aws_task_scheduler_cancel_task(&epoll_loop->scheduler, task);
+    /* a task that couldn't be tracked sits on the wheel itself, otherwise it's the wrapper the stats scheduled. */
+    if (aws_timing_wheel_remove(&epoll_loop->timing_wheel, task)) {
+        aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+        return;
+    }
+
+    struct aws_task *scheduled_task = aws_event_loop_stats_scheduled_task(&epoll_loop->stats, task);
+    if (aws_timing_wheel_remove(&epoll_loop->timing_wheel, scheduled_task)) {
+        aws_task_run(scheduled_task, AWS_TASK_STATUS_CANCELED);
+        return;
+    }
+    aws_task_scheduler_cancel_task(&epoll_loop->scheduler, scheduled_task);
+}
+
+/* Best effort: the handle may not be a socket (the loop's own eventfd isn't), or the process may lack CAP_NET_ADMIN
+ * for the value asked for. Either way the handle works as it did, just without the kernel's busy polling. */
+static void s_set_socket_busy_poll(struct aws_event_loop *event_loop, int fd) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &epoll_loop->socket_busy_poll_us, sizeof(int)) && errno != ENOTSOCK) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to set SO_BUSY_POLL on fd %d, errno %d. Continuing without it.",
+            (void *)event_loop,
+            fd,
+            errno);
+    }
 }
 
 static int s_subscribe_to_io_events(
@@ -418,6 +535,10 @@ static int s_subscribe_to_io_events(
 
     handle->additional_data = epoll_event_data;
 
+    if (epoll_loop->socket_busy_poll_us) {
+        s_set_socket_busy_poll(event_loop, handle->data.fd);
+    }
+
     return AWS_OP_SUCCESS;
 }
 
@@ -443,13 +564,17 @@ static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struc
 
     struct epoll_event dummy_event;
 
+    /* this fails when the fd was already closed or never made it into the epoll set, and the kernel isn't watching it
+     * then either. So the handle is let go of regardless, and the error just reports that. */
+    int result = AWS_OP_SUCCESS;
     if (AWS_UNLIKELY(epoll_ctl(epoll_loop->epoll_fd, EPOLL_CTL_DEL, handle->data.fd, &dummy_event /*ignored*/))) {
         AWS_LOGF_ERROR(
             AWS_LS_IO_EVENT_LOOP,
-            "id=%p: failed to un-subscribe from events on fd %d",
+            "id=%p: failed to un-subscribe from events on fd %d with errno %d",
             (void *)event_loop,
-            handle->data.fd);
-        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+            handle->data.fd,
+            errno);
+        result = aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
     }
 
     /* We can't clean up yet, because we have schedule tasks and more events to process,
@@ -460,7 +585,7 @@ static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struc
     s_schedule_task_now(event_loop, &additional_handle_data->cleanup_task);
 
     handle->additional_data = NULL;
-    return AWS_OP_SUCCESS;
+    return result;
 }
 
 static bool s_is_on_callers_thread(struct aws_event_loop *event_loop) {
@@ -498,21 +623,19 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: processing cross-thread tasks", (void *)event_loop);
     epoll_loop->should_process_task_pre_queue = false;
 
-    struct aws_linked_list task_pre_queue;
-    aws_linked_list_init(&task_pre_queue);
-
     uint64_t count_ignore = 0;
 
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
+    /* Clear the flag before draining and taking the queue: anything pushed after this point signals again, anything
+     * pushed before it is guaranteed to be in the stack we take below. */
+    aws_atomic_store_int(&epoll_loop->task_pre_queue_signaled, 0);
 
     /* several tasks could theoretically have been written (though this should never happen), make sure we drain the
      * eventfd/pipe. */
     while (read(epoll_loop->read_task_handle.data.fd, &count_ignore, sizeof(count_ignore)) > -1) {
     }
 
-    aws_linked_list_swap_contents(&epoll_loop->task_pre_queue, &task_pre_queue);
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
+    struct aws_linked_list task_pre_queue;
+    s_take_task_pre_queue(epoll_loop, &task_pre_queue);
 
     while (!aws_linked_list_empty(&task_pre_queue)) {
         struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
@@ -522,13 +645,94 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
             "id=%p: task %p pulled to event-loop, scheduling now.",
             (void *)event_loop,
             (void *)task);
-        /* Timestamp 0 is used to denote "now" tasks */
-        if (task->timestamp == 0) {
-            aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
-        } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+        s_schedule_task_in_thread(epoll_loop, task, task->timestamp);
+        aws_event_loop_stats_add(&epoll_loop->stats, &epoll_loop->stats.values.cross_thread_task_count, 1);
+    }
+}
+
+/* Moves wheel tasks whose tick has come into the scheduler, which runs them at their exact timestamp. */
+static void s_expire_timing_wheel(struct epoll_loop *epoll_loop, uint64_t now_ns) {
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+    aws_timing_wheel_expire(&epoll_loop->timing_wheel, now_ns, &expired);
+
+    while (!aws_linked_list_empty(&expired)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&expired);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+    }
+}
+
+static int s_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+    aws_event_loop_stats_tracker_get(&epoll_loop->stats, stats);
+    return AWS_OP_SUCCESS;
+}
+
+static aws_event_loop_inner_fn *s_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+    return aws_event_loop_stats_set_inner_fn(&epoll_loop->stats, fn);
+}
+
+/*
+ * Polls without blocking until there's something to do, busy_poll_ns have passed, or *timeout_ms (the time until the
+ * next task is due) is up. Returns like epoll_wait(), and takes the time spent off *timeout_ms so the caller can block
+ * for whatever is left.
+ *
+ * While it spins, task_pre_queue_signaled is held at 1 so that cross-thread producers skip the eventfd write, and the
+ * pre-queue is checked directly instead.
+ */
+static int s_busy_poll(struct aws_event_loop *event_loop, struct epoll_event *events, int *timeout_ms) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    uint64_t start_ns = 0;
+    if (event_loop->clock(&start_ns)) {
+        return 0;
+    }
+
+    uint64_t spin_ns = epoll_loop->busy_poll_ns;
+    uint64_t timeout_ns = aws_timestamp_convert((uint64_t)*timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    if (timeout_ns < spin_ns) {
+        spin_ns = timeout_ns;
+    }
+
+    /* if it was already set, someone has written to the eventfd since the last drain, and epoll_wait() reports it. */
+    aws_atomic_exchange_int(&epoll_loop->task_pre_queue_signaled, 1);
+
+    int event_count = 0;
+    uint64_t now_ns = start_ns;
+    while (true) {
+        event_count = epoll_wait(epoll_loop->epoll_fd, events, MAX_EVENTS, 0);
+        if (event_count != 0) {
+            break;
+        }
+
+        if (aws_atomic_load_ptr(&epoll_loop->task_pre_queue_head)) {
+            epoll_loop->should_process_task_pre_queue = true;
+            break;
+        }
+
+        if (event_loop->clock(&now_ns) || now_ns - start_ns >= spin_ns) {
+            break;
+        }
+    }
+
+    if (!epoll_loop->should_process_task_pre_queue) {
+        /* tasks pushed while the flag was held weren't signaled for, so they have to be caught here. Anything pushed
+         * after the flag is cleared signals as usual. */
+        aws_atomic_store_int(&epoll_loop->task_pre_queue_signaled, 0);
+        if (aws_atomic_load_ptr(&epoll_loop->task_pre_queue_head)) {
+            epoll_loop->should_process_task_pre_queue = true;
         }
     }
+
+    uint64_t spent_ns = now_ns > start_ns ? now_ns - start_ns : 0;
+    uint64_t spent_ms = aws_timestamp_convert(spent_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
+    *timeout_ms = spent_ms >= (uint64_t)*timeout_ms ? 0 : *timeout_ms - (int)spent_ms;
+
+    return event_count;
 }
 
 static void s_main_loop(void *args) {
@@ -556,6 +760,14 @@ static void s_main_loop(void *args) {
         timeout,
         MAX_EVENTS);
 
+    if (epoll_loop->busy_poll_ns) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: busy polling for up to %llu ns before each wait",
+            (void *)event_loop,
+            (unsigned long long)epoll_loop->busy_poll_ns);
+    }
+
     /*
      * until stop is called,
      * call epoll_wait, if a task is scheduled, or a file descriptor has activity, it will
@@ -569,7 +781,26 @@ static void s_main_loop(void *args) {
      */
     while (epoll_loop->should_continue) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout);
-        int event_count = epoll_wait(epoll_loop->epoll_fd, events, MAX_EVENTS, timeout);
+        uint64_t wait_start_ns = 0;
+        event_loop->clock(&wait_start_ns);
+        aws_event_loop_stats_set_busy_since(&epoll_loop->stats, 0);
+
+        int event_count = 0;
+        if (epoll_loop->busy_poll_ns && timeout > 0) {
+            event_count = s_busy_poll(event_loop, events, &timeout);
+        }
+
+        if (event_count == 0 && !epoll_loop->should_process_task_pre_queue) {
+            event_count = epoll_wait(epoll_loop->epoll_fd, events, MAX_EVENTS, timeout);
+        }
+
+        uint64_t wait_end_ns = 0;
+        event_loop->clock(&wait_end_ns);
+        aws_event_loop_stats_add(
+            &epoll_loop->stats,
+            &epoll_loop->stats.values.wait_time_ns,
+            wait_end_ns > wait_start_ns ? wait_end_ns - wait_start_ns : 0);
+        aws_event_loop_stats_set_busy_since(&epoll_loop->stats, wait_end_ns);
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %d events to process.", (void *)event_loop, event_count);
@@ -603,10 +834,23 @@ static void s_main_loop(void *args) {
                     "id=%p: activity on fd %d, invoking handler.",
                     (void *)event_loop,
                     event_data->handle->data.fd);
+                aws_event_loop_stats_set_io_event_fn(&epoll_loop->stats, event_data->on_event);
                 event_data->on_event(event_loop, event_data->handle, event_mask, event_data->user_data);
+                aws_event_loop_stats_set_io_event_fn(&epoll_loop->stats, NULL);
             }
         }
 
+        if (event_count > 0) {
+            uint64_t io_end_ns = 0;
+            event_loop->clock(&io_end_ns);
+            aws_event_loop_stats_add(
+                &epoll_loop->stats, &epoll_loop->stats.values.io_event_count, (uint64_t)event_count);
+            aws_event_loop_stats_add(
+                &epoll_loop->stats,
+                &epoll_loop->stats.values.io_event_time_ns,
+                io_end_ns > wait_end_ns ? io_end_ns - wait_end_ns : 0);
+        }
+
         /* run scheduled tasks */
         s_process_task_pre_queue(event_loop);
 
@@ -614,6 +858,7 @@ static void s_main_loop(void *args) {
         event_loop->clock(&now_ns); /* if clock fails, now_ns will be 0 and tasks scheduled for a specific time
                                        will not be run. That's ok, we'll handle them next time around. */
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
+        s_expire_timing_wheel(epoll_loop, now_ns);
         aws_task_scheduler_run_all(&epoll_loop->scheduler, now_ns);
 
         /* set timeout for next epoll_wait() call.
@@ -624,8 +869,18 @@ static void s_main_loop(void *args) {
             use_default_timeout = true;
         }
 
-        uint64_t next_run_time_ns;
-        if (!aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns)) {
+        uint64_t next_run_time_ns = UINT64_MAX;
+        bool scheduler_has_tasks = aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns);
+
+        /* wake up in time to move the next wheel tick into the scheduler, if that comes first. */
+        uint64_t next_tick_ns = 0;
+        bool wheel_has_tick =
+            aws_timing_wheel_next_tick_time(&epoll_loop->timing_wheel, next_run_time_ns, &next_tick_ns);
+        if (wheel_has_tick && next_tick_ns < next_run_time_ns) {
+            next_run_time_ns = next_tick_ns;
+        }
+
+        if (!scheduler_has_tasks && !wheel_has_tick) {
             use_default_timeout = true;
         }
 
@@ -646,9 +901,12 @@ static void s_main_loop(void *args) {
                 (unsigned long long)timeout_ns,
                 timeout);
         }
+
+        aws_event_loop_stats_add(&epoll_loop->stats, &epoll_loop->stats.values.iteration_count, 1);
     }
 
     AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+    aws_event_loop_stats_set_busy_since(&epoll_loop->stats, 0);
     s_unsubscribe_from_io_events(event_loop, &epoll_loop->read_task_handle);
     /* set thread id back to 0. This should be updated again in destroy, before tasks are canceled. */
     aws_atomic_store_int(&epoll_loop->thread_id, (size_t)0);
@@ -0,0 +1,1167 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/event_loop.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/mutex.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/common/thread.h>
+
+#include <aws/io/logging.h>
+#include <aws/io/private/event_loop_stats.h>
+#include <aws/io/private/timing_wheel.h>
+
+#include <linux/io_uring.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Same story as EPOLLRDHUP in the epoll implementation: old libc headers don't always expose this. */
+#ifndef POLLRDHUP
+#    define POLLRDHUP 0x2000
+#endif
+
+/* io_uring syscall numbers are shared across architectures (except alpha), but older libc headers don't have them. */
+#ifndef __NR_io_uring_setup
+#    define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+#    define __NR_io_uring_enter 426
+#endif
+
+static void s_destroy(struct aws_event_loop *event_loop);
+static int s_run(struct aws_event_loop *event_loop);
+static int s_stop(struct aws_event_loop *event_loop);
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop);
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task);
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos);
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task);
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data);
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
+static void s_free_io_event_resources(void *user_data);
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop);
+static int s_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats);
+static aws_event_loop_inner_fn *s_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn);
+
+static void s_main_loop(void *args);
+
+struct io_uring_event_data;
+static void s_report_poll_failure(struct aws_event_loop *event_loop, struct io_uring_event_data *event_data);
+
+static struct aws_event_loop_vtable s_vtable = {
+    .destroy = s_destroy,
+    .run = s_run,
+    .stop = s_stop,
+    .wait_for_stop_completion = s_wait_for_stop_completion,
+    .schedule_task_now = s_schedule_task_now,
+    .schedule_task_future = s_schedule_task_future,
+    .cancel_task = s_cancel_task,
+    .subscribe_to_io_events = s_subscribe_to_io_events,
+    .unsubscribe_from_io_events = s_unsubscribe_from_io_events,
+    .free_io_event_resources = s_free_io_event_resources,
+    .is_on_callers_thread = s_is_on_callers_thread,
+    .get_stats = s_get_stats,
+    .set_current_inner_fn = s_set_current_inner_fn,
+};
+
+/* Pointers into the submission queue ring shared with the kernel. */
+struct io_uring_submission_queue {
+    unsigned *head;
+    unsigned *tail;
+    unsigned *ring_mask;
+    unsigned *ring_entries;
+    unsigned *array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    /* tail as seen by this thread, published to the kernel before each io_uring_enter(). */
+    unsigned local_tail;
+};
+
+/* Pointers into the completion queue ring shared with the kernel. */
+struct io_uring_completion_queue {
+    unsigned *head;
+    unsigned *tail;
+    unsigned *ring_mask;
+    struct io_uring_cqe *cqes;
+};
+
+struct io_uring_loop {
+    struct aws_task_scheduler scheduler;
+    /* Far-off future tasks wait here and only move into the scheduler once they're close to due. */
+    struct aws_timing_wheel timing_wheel;
+    struct aws_thread thread;
+    struct aws_atomic_var thread_id;
+    struct aws_io_handle read_task_handle;
+    struct aws_io_handle write_task_handle;
+    struct aws_mutex task_pre_queue_mutex;
+    struct aws_linked_list task_pre_queue;
+    /* subscriptions that have been removed, but whose poll request hasn't produced its final completion yet. */
+    struct aws_linked_list pending_free_list;
+    struct aws_task stop_task;
+    struct aws_event_loop_stats_tracker stats;
+    struct io_uring_submission_queue sq;
+    struct io_uring_completion_queue cq;
+    void *ring_ptr;
+    size_t ring_size;
+    int ring_fd;
+    bool should_process_task_pre_queue;
+    bool should_continue;
+};
+
+struct io_uring_event_data {
+    struct aws_allocator *alloc;
+    struct aws_event_loop *event_loop;
+    struct aws_io_handle *handle;
+    aws_event_loop_on_event_fn *on_event;
+    void *user_data;
+    struct aws_task arm_task;
+    struct aws_task cleanup_task;
+    struct aws_linked_list_node node;
+    uint32_t poll_mask;
+    bool is_subscribed; /* false when handle is unsubscribed, but this struct hasn't been cleaned up yet */
+    bool arm_pending;   /* a cross-thread subscription is waiting for the event-loop thread to submit its poll */
+    bool poll_in_flight;
+};
+
+/* default timeout is 100 seconds */
+enum {
+    DEFAULT_TIMEOUT_SECS = 100,
+    RING_ENTRIES = 256,
+};
+
+/* user_data tag for requests whose completions we don't care about (e.g. poll removal). */
+static const uint64_t s_ignore_completion_tag = 0;
+
+static int s_io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int s_io_uring_enter(
+    int fd,
+    unsigned to_submit,
+    unsigned min_complete,
+    unsigned flags,
+    void *arg,
+    size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/*
+ * Sets up the ring and maps it into our address space. Returns AWS_OP_ERR with AWS_ERROR_UNSUPPORTED_OPERATION raised
+ * when the running kernel can't give us what we need, so that the caller can fall back to epoll.
+ */
+static int s_ring_init(struct aws_event_loop *loop, struct io_uring_loop *io_uring_loop) {
+    struct io_uring_params params;
+    AWS_ZERO_STRUCT(params);
+
+    io_uring_loop->ring_fd = s_io_uring_setup(RING_ENTRIES, &params);
+    if (io_uring_loop->ring_fd < 0) {
+        int errno_value = errno;
+        AWS_LOGF_WARN(AWS_LS_IO_EVENT_LOOP, "id=%p: io_uring_setup() failed with errno %d.", (void *)loop, errno_value);
+        if (errno_value == ENOSYS || errno_value == EPERM || errno_value == EINVAL) {
+            return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        }
+
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    /* single mmap (5.4) and extended enter args for timeouts (5.11) are required. Multishot poll shipped in the same
+     * release as resource tags (5.13), and there's no way to probe for the flag itself, so use that as the marker. */
+    const uint32_t required_features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG |
+                                       IORING_FEAT_RSRC_TAGS;
+    if ((params.features & required_features) != required_features) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: io_uring is missing required features (have 0x%x, need 0x%x).",
+            (void *)loop,
+            params.features,
+            required_features);
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        goto clean_up_fd;
+    }
+
+    size_t sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    io_uring_loop->ring_size = sq_ring_size > cq_ring_size ? sq_ring_size : cq_ring_size;
+
+    io_uring_loop->ring_ptr = mmap(
+        NULL,
+        io_uring_loop->ring_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        io_uring_loop->ring_fd,
+        IORING_OFF_SQ_RING);
+    if (io_uring_loop->ring_ptr == MAP_FAILED) {
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "id=%p: failed to map io_uring rings.", (void *)loop);
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto clean_up_fd;
+    }
+
+    io_uring_loop->sq.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    io_uring_loop->sq.sqes = mmap(
+        NULL,
+        io_uring_loop->sq.sqes_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        io_uring_loop->ring_fd,
+        IORING_OFF_SQES);
+    if (io_uring_loop->sq.sqes == MAP_FAILED) {
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "id=%p: failed to map io_uring submission entries.", (void *)loop);
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto clean_up_ring;
+    }
+
+    uint8_t *ring = io_uring_loop->ring_ptr;
+    io_uring_loop->sq.head = (unsigned *)(ring + params.sq_off.head);
+    io_uring_loop->sq.tail = (unsigned *)(ring + params.sq_off.tail);
+    io_uring_loop->sq.ring_mask = (unsigned *)(ring + params.sq_off.ring_mask);
+    io_uring_loop->sq.ring_entries = (unsigned *)(ring + params.sq_off.ring_entries);
+    io_uring_loop->sq.array = (unsigned *)(ring + params.sq_off.array);
+    io_uring_loop->sq.local_tail = *io_uring_loop->sq.tail;
+
+    io_uring_loop->cq.head = (unsigned *)(ring + params.cq_off.head);
+    io_uring_loop->cq.tail = (unsigned *)(ring + params.cq_off.tail);
+    io_uring_loop->cq.ring_mask = (unsigned *)(ring + params.cq_off.ring_mask);
+    io_uring_loop->cq.cqes = (struct io_uring_cqe *)(ring + params.cq_off.cqes);
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: io_uring descriptor %d with %u submission and %u completion entries.",
+        (void *)loop,
+        io_uring_loop->ring_fd,
+        params.sq_entries,
+        params.cq_entries);
+
+    return AWS_OP_SUCCESS;
+
+clean_up_ring:
+    munmap(io_uring_loop->ring_ptr, io_uring_loop->ring_size);
+    io_uring_loop->ring_ptr = NULL;
+
+clean_up_fd:
+    close(io_uring_loop->ring_fd);
+    io_uring_loop->ring_fd = -1;
+    return AWS_OP_ERR;
+}
+
+static void s_ring_clean_up(struct io_uring_loop *io_uring_loop) {
+    munmap(io_uring_loop->sq.sqes, io_uring_loop->sq.sqes_size);
+    munmap(io_uring_loop->ring_ptr, io_uring_loop->ring_size);
+    close(io_uring_loop->ring_fd);
+    io_uring_loop->ring_fd = -1;
+}
+
+/*
+ * Publishes everything queued so far to the kernel. If timeout is non-null, also waits for at least one completion
+ * or for the timeout to expire.
+ */
+static int s_submit(struct io_uring_loop *io_uring_loop, struct __kernel_timespec *timeout) {
+    __atomic_store_n(io_uring_loop->sq.tail, io_uring_loop->sq.local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = io_uring_loop->sq.local_tail - __atomic_load_n(io_uring_loop->sq.head, __ATOMIC_ACQUIRE);
+
+    if (!timeout) {
+        if (to_submit == 0) {
+            return AWS_OP_SUCCESS;
+        }
+
+        if (s_io_uring_enter(io_uring_loop->ring_fd, to_submit, 0, 0, NULL, 0) < 0 && errno != EINTR &&
+            errno != EBUSY && errno != EAGAIN) {
+            return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        }
+
+        return AWS_OP_SUCCESS;
+    }
+
+    struct io_uring_getevents_arg arg = {
+        .sigmask = 0,
+        .sigmask_sz = _NSIG / 8,
+        .ts = (uint64_t)(uintptr_t)timeout,
+    };
+
+    if (s_io_uring_enter(
+            io_uring_loop->ring_fd,
+            to_submit,
+            1,
+            IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+            &arg,
+            sizeof(arg)) < 0 &&
+        errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Grabs the next free submission entry, flushing the queue to the kernel if it's full. */
+static struct io_uring_sqe *s_get_sqe(struct io_uring_loop *io_uring_loop) {
+    unsigned entries = *io_uring_loop->sq.ring_entries;
+
+    if (io_uring_loop->sq.local_tail - __atomic_load_n(io_uring_loop->sq.head, __ATOMIC_ACQUIRE) >= entries) {
+        if (s_submit(io_uring_loop, NULL)) {
+            return NULL;
+        }
+
+        if (io_uring_loop->sq.local_tail - __atomic_load_n(io_uring_loop->sq.head, __ATOMIC_ACQUIRE) >= entries) {
+            aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+            return NULL;
+        }
+    }
+
+    unsigned index = io_uring_loop->sq.local_tail & *io_uring_loop->sq.ring_mask;
+    struct io_uring_sqe *sqe = &io_uring_loop->sq.sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    io_uring_loop->sq.array[index] = index;
+    io_uring_loop->sq.local_tail++;
+
+    return sqe;
+}
+
+/*
+ * Opens edge-triggered (multishot) poll on the handle. Must be called on the event-loop thread. The ring is only used
+ * for readiness: the handle's owner still does its own I/O system calls when it's told the handle is ready.
+ */
+static int s_arm_poll(struct io_uring_loop *io_uring_loop, struct io_uring_event_data *event_data) {
+    struct io_uring_sqe *sqe = s_get_sqe(io_uring_loop);
+    if (!sqe) {
+        return AWS_OP_ERR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = event_data->handle->data.fd;
+    sqe->poll32_events = event_data->poll_mask;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = (uint64_t)(uintptr_t)event_data;
+
+    event_data->poll_in_flight = true;
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_event_loop *s_io_uring_loop_new(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop *loop = aws_mem_acquire(alloc, sizeof(struct aws_event_loop));
+
+    if (!loop) {
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Initializing io_uring", (void *)loop);
+    if (aws_event_loop_init_base(loop, alloc, clock)) {
+        goto clean_up_loop;
+    }
+
+    struct io_uring_loop *io_uring_loop = aws_mem_acquire(alloc, sizeof(struct io_uring_loop));
+
+    if (!io_uring_loop) {
+        goto cleanup_base_loop;
+    }
+
+    AWS_ZERO_STRUCT(*io_uring_loop);
+    /* initialize thread id to 0, it should be updated when the event loop thread starts. */
+    aws_atomic_init_int(&io_uring_loop->thread_id, 0);
+
+    aws_linked_list_init(&io_uring_loop->task_pre_queue);
+    aws_linked_list_init(&io_uring_loop->pending_free_list);
+    io_uring_loop->task_pre_queue_mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    aws_event_loop_stats_tracker_init(&io_uring_loop->stats, alloc, clock);
+
+    if (s_ring_init(loop, io_uring_loop)) {
+        goto clean_up_io_uring;
+    }
+
+    if (aws_thread_init(&io_uring_loop->thread, alloc)) {
+        goto clean_up_ring;
+    }
+
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (fd < 0) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: Failed to open eventfd handle.", (void *)loop);
+        aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+        goto clean_up_thread;
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: eventfd descriptor %d.", (void *)loop, fd);
+    io_uring_loop->write_task_handle = (struct aws_io_handle){.data.fd = fd, .additional_data = NULL};
+    io_uring_loop->read_task_handle = (struct aws_io_handle){.data.fd = fd, .additional_data = NULL};
+
+    if (aws_task_scheduler_init(&io_uring_loop->scheduler, alloc)) {
+        goto clean_up_eventfd;
+    }
+
+    uint64_t now_ns = 0;
+    clock(&now_ns);
+    if (aws_timing_wheel_init(
+            &io_uring_loop->timing_wheel,
+            alloc,
+            AWS_TIMING_WHEEL_DEFAULT_TICK_NS,
+            AWS_TIMING_WHEEL_DEFAULT_SLOT_COUNT,
+            AWS_TIMING_WHEEL_DEFAULT_MIN_DELAY_NS,
+            now_ns)) {
+        goto clean_up_scheduler;
+    }
+
+    io_uring_loop->should_continue = false;
+
+    loop->impl_data = io_uring_loop;
+    loop->vtable = &s_vtable;
+
+    return loop;
+
+clean_up_scheduler:
+    aws_task_scheduler_clean_up(&io_uring_loop->scheduler);
+
+clean_up_eventfd:
+    close(fd);
+
+clean_up_thread:
+    aws_thread_clean_up(&io_uring_loop->thread);
+
+clean_up_ring:
+    s_ring_clean_up(io_uring_loop);
+
+clean_up_io_uring:
+    aws_mem_release(alloc, io_uring_loop);
+
+cleanup_base_loop:
+    aws_event_loop_clean_up_base(loop);
+
+clean_up_loop:
+    aws_mem_release(alloc, loop);
+
+    return NULL;
+}
+
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop *loop = s_io_uring_loop_new(alloc, clock);
+
+    if (!loop && aws_last_error() == AWS_ERROR_UNSUPPORTED_OPERATION) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_EVENT_LOOP, "static: io_uring is not supported by this kernel, falling back to epoll.");
+        return aws_event_loop_new_system(alloc, clock);
+    }
+
+    return loop;
+}
+
+bool aws_event_loop_is_io_uring(const struct aws_event_loop *event_loop) {
+    return event_loop->vtable == &s_vtable;
+}
+
+static void s_destroy(struct aws_event_loop *event_loop) {
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Destroying event_loop", (void *)event_loop);
+
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    /* we don't know if stop() has been called by someone else,
+     * just call stop() again and wait for event-loop to finish. */
+    aws_event_loop_stop(event_loop);
+    s_wait_for_stop_completion(event_loop);
+
+    /* setting this so that canceled tasks don't blow up when asking if they're on the event-loop thread. */
+    aws_atomic_store_int(&io_uring_loop->thread_id, (size_t)aws_thread_current_thread_id());
+
+    /* hand whatever is still on the wheel to the scheduler so that everything gets canceled in timestamp order. */
+    struct aws_linked_list wheel_tasks;
+    aws_linked_list_init(&wheel_tasks);
+    aws_timing_wheel_take_all(&io_uring_loop->timing_wheel, &wheel_tasks);
+    while (!aws_linked_list_empty(&wheel_tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&wheel_tasks);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_scheduler_schedule_future(&io_uring_loop->scheduler, task, task->timestamp);
+    }
+    aws_timing_wheel_clean_up(&io_uring_loop->timing_wheel);
+
+    aws_task_scheduler_clean_up(&io_uring_loop->scheduler);
+    aws_event_loop_stats_tracker_clean_up(&io_uring_loop->stats);
+
+    while (!aws_linked_list_empty(&io_uring_loop->task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&io_uring_loop->task_pre_queue);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+    }
+
+    /* closing the ring cancels every outstanding poll, so nothing in the kernel references these anymore. */
+    s_ring_clean_up(io_uring_loop);
+
+    while (!aws_linked_list_empty(&io_uring_loop->pending_free_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&io_uring_loop->pending_free_list);
+        struct io_uring_event_data *event_data = AWS_CONTAINER_OF(node, struct io_uring_event_data, node);
+        s_free_io_event_resources(event_data);
+    }
+
+    aws_thread_clean_up(&io_uring_loop->thread);
+    close(io_uring_loop->write_task_handle.data.fd);
+    io_uring_loop->write_task_handle.data.fd = -1;
+    io_uring_loop->read_task_handle.data.fd = -1;
+
+    aws_mem_release(event_loop->alloc, io_uring_loop);
+    aws_event_loop_clean_up_base(event_loop);
+    aws_mem_release(event_loop->alloc, event_loop);
+}
+
+static int s_run(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Starting event-loop thread.", (void *)event_loop);
+
+    io_uring_loop->should_continue = true;
+    if (aws_thread_launch(&io_uring_loop->thread, &s_main_loop, event_loop, NULL)) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
+        io_uring_loop->should_continue = false;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_stop_task(struct aws_task *task, void *args, enum aws_task_status status) {
+
+    (void)task;
+    struct aws_event_loop *event_loop = args;
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        /*
+         * this allows the event loop to invoke the callback once the event loop has completed.
+         */
+        io_uring_loop->should_continue = false;
+    }
+}
+
+static int s_stop(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Stopping event-loop thread.", (void *)event_loop);
+    aws_task_init(&io_uring_loop->stop_task, s_stop_task, event_loop);
+    s_schedule_task_now(event_loop, &io_uring_loop->stop_task);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    return aws_thread_join(&io_uring_loop->thread);
+}
+
+/* Must be called from the event-loop thread. Coarse timeouts go on the timing wheel, the rest to the scheduler. */
+static void s_schedule_task_in_thread(
+    struct io_uring_loop *io_uring_loop,
+    struct aws_task *task,
+    uint64_t run_at_nanos) {
+
+    task = aws_event_loop_stats_track_task(&io_uring_loop->stats, task);
+
+    if (run_at_nanos == 0) {
+        /* zero denotes "now" task */
+        aws_task_scheduler_schedule_now(&io_uring_loop->scheduler, task);
+    } else if (!aws_timing_wheel_try_schedule(&io_uring_loop->timing_wheel, task, run_at_nanos)) {
+        aws_task_scheduler_schedule_future(&io_uring_loop->scheduler, task, run_at_nanos);
+    }
+}
+
+static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    /* if event loop and the caller are the same thread, just schedule and be done with it. */
+    if (s_is_on_callers_thread(event_loop)) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: scheduling task %p in-thread for timestamp %llu",
+            (void *)event_loop,
+            (void *)task,
+            (unsigned long long)run_at_nanos);
+        s_schedule_task_in_thread(io_uring_loop, task, run_at_nanos);
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: Scheduling task %p cross-thread for timestamp %llu",
+        (void *)event_loop,
+        (void *)task,
+        (unsigned long long)run_at_nanos);
+    task->timestamp = run_at_nanos;
+    aws_mutex_lock(&io_uring_loop->task_pre_queue_mutex);
+
+    uint64_t counter = 1;
+
+    bool is_first_task = aws_linked_list_empty(&io_uring_loop->task_pre_queue);
+
+    aws_linked_list_push_back(&io_uring_loop->task_pre_queue, &task->node);
+
+    /* if the list was not empty, we already have a pending read on the eventfd, no need to write again. */
+    if (is_first_task) {
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
+
+        /* If the write fails because the counter is saturated, we don't actually care because that means there's a
+         * pending read on the eventfd and thus the event loop will end up checking to see if something has been
+         * queued.*/
+        ssize_t do_not_care = write(io_uring_loop->write_task_handle.data.fd, (void *)&counter, sizeof(counter));
+        (void)do_not_care;
+    }
+
+    aws_mutex_unlock(&io_uring_loop->task_pre_queue_mutex);
+}
+
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
+    s_schedule_task_common(event_loop, task, 0 /* zero denotes "now" task */);
+}
+
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    s_schedule_task_common(event_loop, task, run_at_nanos);
+}
+
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    /* a task that couldn't be tracked sits on the wheel itself, otherwise it's the wrapper the stats scheduled. */
+    if (aws_timing_wheel_remove(&io_uring_loop->timing_wheel, task)) {
+        aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+        return;
+    }
+
+    struct aws_task *scheduled_task = aws_event_loop_stats_scheduled_task(&io_uring_loop->stats, task);
+    if (aws_timing_wheel_remove(&io_uring_loop->timing_wheel, scheduled_task)) {
+        aws_task_run(scheduled_task, AWS_TASK_STATUS_CANCELED);
+        return;
+    }
+    aws_task_scheduler_cancel_task(&io_uring_loop->scheduler, scheduled_task);
+}
+
+static void s_free_io_event_resources(void *user_data) {
+    struct io_uring_event_data *event_data = user_data;
+    aws_mem_release(event_data->alloc, (void *)event_data);
+}
+
+/* The submission queue is only ever touched from the event-loop thread, cross-thread subscriptions end up here. */
+static void s_arm_poll_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct io_uring_event_data *event_data = arg;
+    event_data->arm_pending = false;
+
+    if (!event_data->is_subscribed) {
+        /* unsubscribed before we ever got to submit the poll, nobody else will clean this up. */
+        s_free_io_event_resources(event_data);
+        return;
+    }
+
+    struct io_uring_loop *io_uring_loop = event_data->event_loop->impl_data;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        /* the loop is being destroyed, so the handle can't be unsubscribed anymore. Let destroy free this along with
+         * the other leftover subscriptions. */
+        event_data->is_subscribed = false;
+        event_data->handle->additional_data = NULL;
+        aws_linked_list_push_back(&io_uring_loop->pending_free_list, &event_data->node);
+        return;
+    }
+
+    if (s_arm_poll(io_uring_loop, event_data) != AWS_OP_SUCCESS) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to subscribe to events on fd %d",
+            (void *)event_data->event_loop,
+            event_data->handle->data.fd);
+        s_report_poll_failure(event_data->event_loop, event_data);
+    }
+}
+
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data) {
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: subscribing to events on fd %d", (void *)event_loop, handle->data.fd);
+    struct io_uring_event_data *event_data = aws_mem_acquire(event_loop->alloc, sizeof(struct io_uring_event_data));
+    handle->additional_data = NULL;
+
+    if (!event_data) {
+        return AWS_OP_ERR;
+    }
+
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    AWS_ZERO_STRUCT(*event_data);
+    event_data->alloc = event_loop->alloc;
+    event_data->event_loop = event_loop;
+    event_data->user_data = user_data;
+    event_data->handle = handle;
+    event_data->on_event = on_event;
+    event_data->is_subscribed = true;
+
+    /* everyone is always registered for hang up, remote hang up, errors. Multishot poll is edge-triggered. */
+    event_data->poll_mask = POLLHUP | POLLRDHUP | POLLERR;
+
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        event_data->poll_mask |= POLLIN;
+    }
+
+    if (events & AWS_IO_EVENT_TYPE_WRITABLE) {
+        event_data->poll_mask |= POLLOUT;
+    }
+
+    if (s_is_on_callers_thread(event_loop)) {
+        if (s_arm_poll(io_uring_loop, event_data)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to subscribe to events on fd %d",
+                (void *)event_loop,
+                handle->data.fd);
+            aws_mem_release(event_loop->alloc, event_data);
+            return AWS_OP_ERR;
+        }
+    } else {
+        event_data->arm_pending = true;
+        aws_task_init(&event_data->arm_task, s_arm_poll_task, event_data);
+        s_schedule_task_now(event_loop, &event_data->arm_task);
+    }
+
+    handle->additional_data = event_data;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_unsubscribe_cleanup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct io_uring_event_data *event_data = (struct io_uring_event_data *)arg;
+    s_free_io_event_resources(event_data);
+}
+
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: un-subscribing from events on fd %d", (void *)event_loop, handle->data.fd);
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    AWS_ASSERT(handle->additional_data);
+    struct io_uring_event_data *additional_handle_data = handle->additional_data;
+
+    int result = AWS_OP_SUCCESS;
+    if (additional_handle_data->poll_in_flight) {
+        struct io_uring_sqe *sqe = s_get_sqe(io_uring_loop);
+        if (AWS_UNLIKELY(!sqe)) {
+            /* the handle is let go of anyway, its poll just stays armed, with events ignored, until it ends on its
+             * own or the loop is destroyed. */
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to un-subscribe from events on fd %d",
+                (void *)event_loop,
+                handle->data.fd);
+            result = AWS_OP_ERR;
+        } else {
+            sqe->opcode = IORING_OP_POLL_REMOVE;
+            sqe->fd = -1;
+            sqe->addr = (uint64_t)(uintptr_t)additional_handle_data;
+            sqe->user_data = s_ignore_completion_tag;
+        }
+
+        /* The kernel still owns a reference to this via the poll request. It gets freed once the poll's final
+         * completion shows up. */
+        aws_linked_list_push_back(&io_uring_loop->pending_free_list, &additional_handle_data->node);
+    } else if (!additional_handle_data->arm_pending) {
+        /* We can't clean up yet, because we may be inside this handle's event callback, schedule a cleanup task. */
+        aws_task_init(&additional_handle_data->cleanup_task, s_unsubscribe_cleanup_task, additional_handle_data);
+        s_schedule_task_now(event_loop, &additional_handle_data->cleanup_task);
+    }
+
+    additional_handle_data->is_subscribed = false;
+    handle->additional_data = NULL;
+    return result;
+}
+
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    uint64_t thread_id = aws_atomic_load_int(&io_uring_loop->thread_id);
+    return aws_thread_current_thread_id() == thread_id;
+}
+
+/* We treat the eventfd with a subscription to io events just like any other managed file descriptor.
+ * This is the event handler for events on that eventfd.*/
+static void s_on_tasks_to_schedule(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+
+    (void)handle;
+    (void)user_data;
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: notified of cross-thread tasks to schedule", (void *)event_loop);
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        io_uring_loop->should_process_task_pre_queue = true;
+    }
+}
+
+static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    if (!io_uring_loop->should_process_task_pre_queue) {
+        return;
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: processing cross-thread tasks", (void *)event_loop);
+    io_uring_loop->should_process_task_pre_queue = false;
+
+    struct aws_linked_list task_pre_queue;
+    aws_linked_list_init(&task_pre_queue);
+
+    uint64_t count_ignore = 0;
+
+    aws_mutex_lock(&io_uring_loop->task_pre_queue_mutex);
+
+    /* drain the eventfd so the edge-triggered poll fires again on the next write. */
+    while (read(io_uring_loop->read_task_handle.data.fd, &count_ignore, sizeof(count_ignore)) > -1) {
+    }
+
+    aws_linked_list_swap_contents(&io_uring_loop->task_pre_queue, &task_pre_queue);
+
+    aws_mutex_unlock(&io_uring_loop->task_pre_queue_mutex);
+
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: task %p pulled to event-loop, scheduling now.",
+            (void *)event_loop,
+            (void *)task);
+        s_schedule_task_in_thread(io_uring_loop, task, task->timestamp);
+        aws_event_loop_stats_add(&io_uring_loop->stats, &io_uring_loop->stats.values.cross_thread_task_count, 1);
+    }
+}
+
+/* Moves wheel tasks whose tick has come into the scheduler, which runs them at their exact timestamp. */
+static void s_expire_timing_wheel(struct io_uring_loop *io_uring_loop, uint64_t now_ns) {
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+    aws_timing_wheel_expire(&io_uring_loop->timing_wheel, now_ns, &expired);
+
+    while (!aws_linked_list_empty(&expired)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&expired);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_scheduler_schedule_future(&io_uring_loop->scheduler, task, task->timestamp);
+    }
+}
+
+/* errors a multishot poll can end with that say nothing about the descriptor itself. */
+static bool s_is_transient_poll_error(int error) {
+    switch (error) {
+        case ECANCELED:
+        case ENOMEM:
+        case EAGAIN:
+        case EINTR:
+        case EBUSY:
+        case EOVERFLOW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* the handle's poll is gone for good, let its owner know so that it can close the handle. */
+static void s_report_poll_failure(struct aws_event_loop *event_loop, struct io_uring_event_data *event_data) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: no more events can be delivered for fd %d, reporting an error.",
+        (void *)event_loop,
+        event_data->handle->data.fd);
+    aws_event_loop_stats_set_io_event_fn(&io_uring_loop->stats, event_data->on_event);
+    event_data->on_event(event_loop, event_data->handle, AWS_IO_EVENT_TYPE_ERROR, event_data->user_data);
+    aws_event_loop_stats_set_io_event_fn(&io_uring_loop->stats, NULL);
+}
+
+static void s_process_completion(
+    struct aws_event_loop *event_loop,
+    struct io_uring_event_data *event_data,
+    int32_t res,
+    uint32_t flags) {
+
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    /* no more completions will be posted for this poll request. */
+    bool poll_done = !(flags & IORING_CQE_F_MORE);
+    if (poll_done) {
+        event_data->poll_in_flight = false;
+    }
+
+    if (!event_data->is_subscribed) {
+        if (poll_done) {
+            aws_linked_list_remove(&event_data->node);
+            s_free_io_event_resources(event_data);
+        }
+        return;
+    }
+
+    if (res > 0) {
+        int event_mask = 0;
+        if (res & POLLIN) {
+            event_mask |= AWS_IO_EVENT_TYPE_READABLE;
+        }
+
+        if (res & POLLOUT) {
+            event_mask |= AWS_IO_EVENT_TYPE_WRITABLE;
+        }
+
+        if (res & POLLRDHUP) {
+            event_mask |= AWS_IO_EVENT_TYPE_REMOTE_HANG_UP;
+        }
+
+        if (res & POLLHUP) {
+            event_mask |= AWS_IO_EVENT_TYPE_CLOSED;
+        }
+
+        if (res & POLLERR) {
+            event_mask |= AWS_IO_EVENT_TYPE_ERROR;
+        }
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: activity on fd %d, invoking handler.",
+            (void *)event_loop,
+            event_data->handle->data.fd);
+        aws_event_loop_stats_set_io_event_fn(&io_uring_loop->stats, event_data->on_event);
+        event_data->on_event(event_loop, event_data->handle, event_mask, event_data->user_data);
+        aws_event_loop_stats_set_io_event_fn(&io_uring_loop->stats, NULL);
+    } else if (res < 0) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: poll on fd %d completed with error %d.",
+            (void *)event_loop,
+            event_data->handle->data.fd,
+            (int)-res);
+    }
+
+    if (!poll_done || !event_data->is_subscribed) {
+        return;
+    }
+
+    /* the kernel can terminate a multishot poll on its own (e.g. when the completion queue overflows or it's short on
+     * memory), keep it going while the handle is still subscribed. Anything else (e.g. a closed descriptor) won't go
+     * away by retrying, so tell the owner, who would otherwise never hear from this handle again. */
+    if (res < 0 && !s_is_transient_poll_error(-res)) {
+        s_report_poll_failure(event_loop, event_data);
+        return;
+    }
+
+    if (s_arm_poll(io_uring_loop, event_data)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to re-arm poll on fd %d",
+            (void *)event_loop,
+            event_data->handle->data.fd);
+        s_report_poll_failure(event_loop, event_data);
+    }
+}
+
+static int s_process_completions(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    int processed = 0;
+
+    unsigned head = *io_uring_loop->cq.head;
+    unsigned tail = __atomic_load_n(io_uring_loop->cq.tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        struct io_uring_cqe *cqe = &io_uring_loop->cq.cqes[head & *io_uring_loop->cq.ring_mask];
+        uint64_t user_data = cqe->user_data;
+        int32_t res = cqe->res;
+        uint32_t flags = cqe->flags;
+
+        /* hand the slot back to the kernel before running any callbacks, they may generate more completions. */
+        head++;
+        __atomic_store_n(io_uring_loop->cq.head, head, __ATOMIC_RELEASE);
+
+        if (user_data != s_ignore_completion_tag) {
+            s_process_completion(event_loop, (struct io_uring_event_data *)(uintptr_t)user_data, res, flags);
+        }
+
+        processed++;
+
+        if (head == tail) {
+            tail = __atomic_load_n(io_uring_loop->cq.tail, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    return processed;
+}
+
+static int s_get_stats(struct aws_event_loop *event_loop, struct aws_event_loop_stats *stats) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    aws_event_loop_stats_tracker_get(&io_uring_loop->stats, stats);
+    return AWS_OP_SUCCESS;
+}
+
+static aws_event_loop_inner_fn *s_set_current_inner_fn(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_inner_fn *fn) {
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+    return aws_event_loop_stats_set_inner_fn(&io_uring_loop->stats, fn);
+}
+
+static void s_main_loop(void *args) {
+    struct aws_event_loop *event_loop = args;
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: main loop started", (void *)event_loop);
+    struct io_uring_loop *io_uring_loop = event_loop->impl_data;
+
+    /* set thread id to the thread of the event loop */
+    aws_atomic_store_int(&io_uring_loop->thread_id, (size_t)aws_thread_current_thread_id());
+
+    int err = s_subscribe_to_io_events(
+        event_loop, &io_uring_loop->read_task_handle, AWS_IO_EVENT_TYPE_READABLE, s_on_tasks_to_schedule, NULL);
+    if (err) {
+        return;
+    }
+
+    struct __kernel_timespec timeout = {.tv_sec = DEFAULT_TIMEOUT_SECS, .tv_nsec = 0};
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: default timeout %ds", (void *)event_loop, (int)DEFAULT_TIMEOUT_SECS);
+
+    /*
+     * until stop is called,
+     * submit every queued poll (un)subscription and wait in a single io_uring_enter() call,
+     * if a task is scheduled, or a file descriptor has activity, it will return.
+     *
+     * process all completions,
+     *
+     * run all scheduled tasks.
+     */
+    while (io_uring_loop->should_continue) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: waiting for a maximum of %llds %lldns",
+            (void *)event_loop,
+            (long long)timeout.tv_sec,
+            (long long)timeout.tv_nsec);
+        uint64_t wait_start_ns = 0;
+        event_loop->clock(&wait_start_ns);
+        aws_event_loop_stats_set_busy_since(&io_uring_loop->stats, 0);
+
+        if (s_submit(io_uring_loop, &timeout)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: io_uring_enter() failed with error %d",
+                (void *)event_loop,
+                aws_last_error());
+        }
+
+        /* this includes submitting the queued polls, which is part of the same syscall. */
+        uint64_t wait_end_ns = 0;
+        event_loop->clock(&wait_end_ns);
+        aws_event_loop_stats_add(
+            &io_uring_loop->stats,
+            &io_uring_loop->stats.values.wait_time_ns,
+            wait_end_ns > wait_start_ns ? wait_end_ns - wait_start_ns : 0);
+        aws_event_loop_stats_set_busy_since(&io_uring_loop->stats, wait_end_ns);
+
+        int completion_count = s_process_completions(event_loop);
+
+        if (completion_count > 0) {
+            uint64_t io_end_ns = 0;
+            event_loop->clock(&io_end_ns);
+            aws_event_loop_stats_add(
+                &io_uring_loop->stats, &io_uring_loop->stats.values.io_event_count, (uint64_t)completion_count);
+            aws_event_loop_stats_add(
+                &io_uring_loop->stats,
+                &io_uring_loop->stats.values.io_event_time_ns,
+                io_end_ns > wait_end_ns ? io_end_ns - wait_end_ns : 0);
+        }
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: wake up with %d completions to process.",
+            (void *)event_loop,
+            completion_count);
+
+        /* run scheduled tasks */
+        s_process_task_pre_queue(event_loop);
+
+        uint64_t now_ns = 0;
+        event_loop->clock(&now_ns); /* if clock fails, now_ns will be 0 and tasks scheduled for a specific time
+                                       will not be run. That's ok, we'll handle them next time around. */
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
+        s_expire_timing_wheel(io_uring_loop, now_ns);
+        aws_task_scheduler_run_all(&io_uring_loop->scheduler, now_ns);
+
+        /* set timeout for next io_uring_enter() call.
+         * if clock fails, or scheduler has no tasks, use default timeout */
+        bool use_default_timeout = false;
+
+        if (event_loop->clock(&now_ns)) {
+            use_default_timeout = true;
+        }
+
+        uint64_t next_run_time_ns = UINT64_MAX;
+        bool scheduler_has_tasks = aws_task_scheduler_has_tasks(&io_uring_loop->scheduler, &next_run_time_ns);
+
+        /* wake up in time to move the next wheel tick into the scheduler, if that comes first. */
+        uint64_t next_tick_ns = 0;
+        bool wheel_has_tick =
+            aws_timing_wheel_next_tick_time(&io_uring_loop->timing_wheel, next_run_time_ns, &next_tick_ns);
+        if (wheel_has_tick && next_tick_ns < next_run_time_ns) {
+            next_run_time_ns = next_tick_ns;
+        }
+
+        if (!scheduler_has_tasks && !wheel_has_tick) {
+            use_default_timeout = true;
+        }
+
+        if (use_default_timeout) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP, "id=%p: no more scheduled tasks using default timeout.", (void *)event_loop);
+            timeout.tv_sec = DEFAULT_TIMEOUT_SECS;
+            timeout.tv_nsec = 0;
+        } else {
+            uint64_t timeout_ns = (next_run_time_ns > now_ns) ? (next_run_time_ns - now_ns) : 0;
+            uint64_t remainder_ns = 0;
+            timeout.tv_sec =
+                (long long)aws_timestamp_convert(timeout_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, &remainder_ns);
+            timeout.tv_nsec = (long long)remainder_ns;
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: detected more scheduled tasks with the next occurring at "
+                "%llu, using timeout of %llu ns.",
+                (void *)event_loop,
+                (unsigned long long)next_run_time_ns,
+                (unsigned long long)timeout_ns);
+        }
+
+        aws_event_loop_stats_add(&io_uring_loop->stats, &io_uring_loop->stats.values.iteration_count, 1);
+    }
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+    aws_event_loop_stats_set_busy_since(&io_uring_loop->stats, 0);
+    s_unsubscribe_from_io_events(event_loop, &io_uring_loop->read_task_handle);
+    /* set thread id back to 0. This should be updated again in destroy, before tasks are canceled. */
+    aws_atomic_store_int(&io_uring_loop->thread_id, (size_t)0);
+}
@@ -21,6 +21,7 @@
 #include <aws/common/thread.h>
 #include <aws/io/log_writer.h>
 
+#include <stddef.h>
 #include <stdio.h>
 
 /*
@@ -85,22 +86,170 @@ int aws_log_channel_init_foreground(
     return AWS_OP_SUCCESS;
 }
 
+/*
+ * The background channel queues lines in a bounded multi-producer, single-consumer ring.  Senders claim a slot by
+ * bumping the tail with a compare-and-swap and publish it through the slot's sequence number, so they never take a
+ * lock unless the background thread is asleep and has to be woken up.
+ */
+enum {
+    DEFAULT_QUEUE_SIZE = 1024,
+    DEFAULT_LINE_SLOT_SIZE = 256,
+    /* how long a blocked sender sleeps between looks at a full queue */
+    OVERFLOW_BACKOFF_NS = 50000,
+    DEFAULT_FLUSH_SIZE = 64 * 1024,
+    /* the most lines handed to the writer at once */
+    MAX_BATCH_LINE_COUNT = 64,
+};
+
+/*
+ * Laid out like struct aws_string, with a NULL allocator like a static string, so that a line copied in here can be
+ * handed to the writer as one.
+ */
+struct log_line_storage {
+    struct aws_allocator *allocator;
+    size_t len;
+    uint8_t bytes[1];
+};
+
+struct log_line_slot {
+    /*
+     * equal to the slot's position while it's free to claim, position + 1 once a line has been published to it
+     */
+    struct aws_atomic_var sequence;
+    /* set if the line was too long for the slot's storage and was queued as it came */
+    struct aws_string *line;
+    struct log_line_storage *storage;
+};
+
 struct aws_log_background_channel {
     struct aws_mutex sync;
     struct aws_thread background_thread;
-    struct aws_array_list pending_log_lines;
     struct aws_condition_variable pending_line_signal;
+    struct log_line_slot *slots;
+    void *line_storage;
+    size_t slot_mask;
+    size_t line_slot_size;
+    enum aws_log_channel_overflow_policy overflow_policy;
+    size_t flush_size;
+    uint64_t flush_interval_ns;
+    struct aws_atomic_var tail;
+    /* only the background thread touches this */
+    size_t head;
+    /* set while the background thread waits on pending_line_signal */
+    struct aws_atomic_var waiting;
+    struct aws_atomic_var dropped_count;
     bool finished;
 };
 
+/*
+ * Claims the next slot for a sender, waiting for room or giving up according to the overflow policy.  Returns NULL
+ * if the line is to be dropped.
+ */
+static struct log_line_slot *s_background_claim_slot(struct aws_log_background_channel *impl, size_t *position_out) {
+    size_t position = aws_atomic_load_int(&impl->tail);
+
+    while (true) {
+        struct log_line_slot *slot = &impl->slots[position & impl->slot_mask];
+        size_t sequence = aws_atomic_load_int(&slot->sequence);
+
+        if (sequence == position) {
+            if (aws_atomic_compare_exchange_int(&impl->tail, &position, position + 1)) {
+                *position_out = position;
+                return slot;
+            }
+            /* someone else claimed it, position has been updated to the current tail */
+            continue;
+        }
+
+        if ((intptr_t)(sequence - position) < 0) {
+            /* the slot still holds a line from the last time around, so the queue is full */
+            if (impl->overflow_policy == AWS_LOG_CHANNEL_OVERFLOW_DROP) {
+                aws_atomic_fetch_add(&impl->dropped_count, 1);
+                return NULL;
+            }
+
+            aws_thread_current_sleep(OVERFLOW_BACKOFF_NS);
+        }
+
+        position = aws_atomic_load_int(&impl->tail);
+    }
+}
+
+static void s_background_publish_slot(
+    struct aws_log_background_channel *impl,
+    struct log_line_slot *slot,
+    size_t position) {
+
+    aws_atomic_store_int(&slot->sequence, position + 1);
+
+    /*
+     * The background thread sets waiting before it looks at the queue one last time, and this looks at waiting after
+     * publishing, so at least one of the two sees the other.
+     */
+    if (aws_atomic_load_int(&impl->waiting)) {
+        aws_mutex_lock(&impl->sync);
+        aws_condition_variable_notify_one(&impl->pending_line_signal);
+        aws_mutex_unlock(&impl->sync);
+    }
+}
+
+static void s_background_copy_to_slot(struct log_line_slot *slot, struct aws_byte_cursor line) {
+    slot->line = NULL;
+    slot->storage->len = line.len;
+    memcpy(slot->storage->bytes, line.ptr, line.len);
+    slot->storage->bytes[line.len] = 0;
+}
+
 static int s_background_channel_send(struct aws_log_channel *channel, struct aws_string *log_line) {
 
     struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
 
-    aws_mutex_lock(&impl->sync);
-    aws_array_list_push_back(&impl->pending_log_lines, &log_line);
-    aws_condition_variable_notify_one(&impl->pending_line_signal);
-    aws_mutex_unlock(&impl->sync);
+    size_t position = 0;
+    struct log_line_slot *slot = s_background_claim_slot(impl, &position);
+    if (slot == NULL) {
+        aws_string_destroy(log_line);
+        return AWS_OP_SUCCESS;
+    }
+
+    if (log_line->len <= impl->line_slot_size) {
+        s_background_copy_to_slot(slot, aws_byte_cursor_from_string(log_line));
+
+        /*
+         * send is considered a transfer of ownership.  Once copied, the line is no longer needed.
+         */
+        aws_string_destroy(log_line);
+    } else {
+        slot->line = log_line;
+    }
+
+    s_background_publish_slot(impl, slot, position);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_background_channel_send_line(struct aws_log_channel *channel, struct aws_byte_cursor line) {
+
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
+
+    size_t position = 0;
+    struct log_line_slot *slot = s_background_claim_slot(impl, &position);
+    if (slot == NULL) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (line.len > impl->line_slot_size) {
+        slot->line = aws_string_new_from_array(channel->allocator, line.ptr, line.len);
+        if (slot->line == NULL) {
+            /* the slot's already claimed, so rather than lose the line entirely, send as much as fits */
+            line.len = impl->line_slot_size;
+        }
+    }
+
+    if (slot->line == NULL) {
+        s_background_copy_to_slot(slot, line);
+    }
+
+    s_background_publish_slot(impl, slot, position);
 
     return AWS_OP_SUCCESS;
 }
@@ -117,13 +266,33 @@ static void s_background_channel_clean_up(struct aws_log_channel *channel) {
 
     aws_thread_clean_up(&impl->background_thread);
     aws_condition_variable_clean_up(&impl->pending_line_signal);
-    aws_array_list_clean_up(&impl->pending_log_lines);
     aws_mutex_clean_up(&impl->sync);
+    aws_mem_release(channel->allocator, impl->line_storage);
+    aws_mem_release(channel->allocator, impl->slots);
     aws_mem_release(channel->allocator, impl);
 }
 
-static struct aws_log_channel_vtable s_background_channel_vtable = {.send = s_background_channel_send,
-                                                                    .clean_up = s_background_channel_clean_up};
+static struct aws_log_channel_vtable s_background_channel_vtable = {
+    .send = s_background_channel_send,
+    .clean_up = s_background_channel_clean_up,
+    .send_line = s_background_channel_send_line,
+};
+
+static bool s_background_is_published(struct aws_log_background_channel *impl, size_t position) {
+    struct log_line_slot *slot = &impl->slots[position & impl->slot_mask];
+
+    return aws_atomic_load_int(&slot->sequence) == position + 1;
+}
+
+static bool s_background_has_pending_line(struct aws_log_background_channel *impl) {
+    return s_background_is_published(impl, impl->head);
+}
+
+static bool s_background_finished(void *context) {
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)context;
+
+    return impl->finished;
+}
 
 static bool s_background_wait(void *context) {
     struct aws_log_background_channel *impl = (struct aws_log_background_channel *)context;
@@ -131,84 +300,193 @@ static bool s_background_wait(void *context) {
     /*
      * Condition variable predicates are checked under mutex protection
      */
-    return impl->finished || aws_array_list_length(&impl->pending_log_lines) > 0;
+    return impl->finished || s_background_has_pending_line(impl);
 }
 
-static void s_background_thread_writer(void *thread_data) {
-    (void)thread_data;
+static void s_background_write_dropped_count(struct aws_log_channel *channel) {
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
 
-    struct aws_log_channel *channel = (struct aws_log_channel *)thread_data;
-    AWS_ASSERT(channel->writer->vtable->write);
+    size_t dropped_count = aws_atomic_exchange_int(&impl->dropped_count, 0);
+    if (dropped_count == 0) {
+        return;
+    }
 
-    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
+    char notice[64];
+    snprintf(notice, sizeof(notice), "[%llu log lines dropped]\n", (unsigned long long)dropped_count);
 
-    struct aws_array_list log_lines;
+    struct aws_string *notice_line = aws_string_new_from_c_str(channel->allocator, notice);
+    if (notice_line != NULL) {
+        (channel->writer->vtable->write)(channel->writer, notice_line);
+        aws_string_destroy(notice_line);
+    }
+}
 
-    AWS_FATAL_ASSERT(aws_array_list_init_dynamic(&log_lines, channel->allocator, 10, sizeof(struct aws_string *)) == 0);
+static const struct aws_string *s_background_slot_line(struct log_line_slot *slot) {
+    return slot->line != NULL ? slot->line : (const struct aws_string *)(void *)slot->storage;
+}
 
-    while (true) {
-        aws_mutex_lock(&impl->sync);
-        aws_condition_variable_wait_pred(&impl->pending_line_signal, &impl->sync, s_background_wait, impl);
+static void s_background_write_batch(
+    struct aws_log_channel *channel,
+    const struct aws_string *const *lines,
+    size_t line_count) {
 
-        size_t line_count = aws_array_list_length(&impl->pending_log_lines);
-        bool finished = impl->finished;
+    if (channel->writer->vtable->write_batch != NULL) {
+        (channel->writer->vtable->write_batch)(channel->writer, lines, line_count);
+        return;
+    }
+
+    for (size_t i = 0; i < line_count; ++i) {
+        (channel->writer->vtable->write)(channel->writer, lines[i]);
+    }
+}
+
+/*
+ * Writes out everything that's been published, in order, a batch at a time.  A batch's slots are handed back to
+ * senders once it has been written.
+ */
+static void s_background_drain(struct aws_log_channel *channel) {
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
+
+    while (s_background_has_pending_line(impl)) {
+        const struct aws_string *batch[MAX_BATCH_LINE_COUNT];
+        size_t batch_count = 0;
+        size_t batch_size = 0;
+
+        while (batch_count < MAX_BATCH_LINE_COUNT && s_background_is_published(impl, impl->head + batch_count)) {
+            const struct aws_string *log_line =
+                s_background_slot_line(&impl->slots[(impl->head + batch_count) & impl->slot_mask]);
 
-        if (line_count == 0) {
-            aws_mutex_unlock(&impl->sync);
-            if (finished) {
+            /* a line longer than flush_size still goes out, on its own */
+            if (batch_count > 0 && batch_size + log_line->len > impl->flush_size) {
                 break;
             }
-            continue;
+
+            batch[batch_count++] = log_line;
+            batch_size += log_line->len;
         }
 
-        aws_array_list_swap_contents(&impl->pending_log_lines, &log_lines);
-        aws_mutex_unlock(&impl->sync);
+        s_background_write_batch(channel, batch, batch_count);
 
-        /*
-         * Consider copying these into a page-sized stack buffer (string) and then making the write calls
-         * against it rather than the individual strings.  Might be a savings when > 1 lines (cut down on
-         * write calls).
-         */
-        for (size_t i = 0; i < line_count; ++i) {
-            struct aws_string *log_line = NULL;
-            if (aws_array_list_get_at(&log_lines, &log_line, i)) {
-                continue;
+        for (size_t i = 0; i < batch_count; ++i) {
+            struct log_line_slot *slot = &impl->slots[impl->head & impl->slot_mask];
+
+            /*
+             * write is not a transfer of ownership, so lines that were queued as they came are the channel's to clean
+             * up.
+             */
+            if (slot->line != NULL) {
+                aws_string_destroy(slot->line);
+                slot->line = NULL;
             }
 
-            (channel->writer->vtable->write)(channel->writer, log_line);
+            aws_atomic_store_int(&slot->sequence, impl->head + impl->slot_mask + 1);
+            ++impl->head;
+        }
+    }
 
+    s_background_write_dropped_count(channel);
+}
+
+static void s_background_thread_writer(void *thread_data) {
+    (void)thread_data;
+
+    struct aws_log_channel *channel = (struct aws_log_channel *)thread_data;
+    AWS_ASSERT(channel->writer->vtable->write);
+
+    struct aws_log_background_channel *impl = (struct aws_log_background_channel *)channel->impl;
+
+    while (true) {
+        s_background_drain(channel);
+
+        aws_mutex_lock(&impl->sync);
+        if (impl->flush_interval_ns > 0) {
             /*
-             * send is considered a transfer of ownership.  write is not a transfer of ownership.
-             * So it's always the channel's responsibility to clean up all log lines that enter
-             * it as soon as they are no longer needed.
+             * Let lines pile up.  waiting isn't set, so senders don't wake the thread early, only clean up does.
              */
-            aws_string_destroy(log_line);
+            aws_condition_variable_wait_for_pred(
+                &impl->pending_line_signal, &impl->sync, (int64_t)impl->flush_interval_ns, s_background_finished, impl);
         }
 
-        aws_array_list_clear(&log_lines);
-    }
+        aws_atomic_store_int(&impl->waiting, 1);
+        aws_condition_variable_wait_pred(&impl->pending_line_signal, &impl->sync, s_background_wait, impl);
+        aws_atomic_store_int(&impl->waiting, 0);
+        bool finished = impl->finished;
+        aws_mutex_unlock(&impl->sync);
 
-    aws_array_list_clean_up(&log_lines);
+        if (finished) {
+            s_background_drain(channel);
+            break;
+        }
+    }
 }
 
 int aws_log_channel_init_background(
     struct aws_log_channel *channel,
     struct aws_allocator *allocator,
     struct aws_log_writer *writer) {
+
+    struct aws_log_channel_background_options options = {
+        .queue_size = DEFAULT_QUEUE_SIZE,
+        .line_slot_size = DEFAULT_LINE_SLOT_SIZE,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+    };
+
+    return aws_log_channel_init_background_with_options(channel, allocator, writer, &options);
+}
+
+int aws_log_channel_init_background_with_options(
+    struct aws_log_channel *channel,
+    struct aws_allocator *allocator,
+    struct aws_log_writer *writer,
+    const struct aws_log_channel_background_options *options) {
+
     struct aws_log_background_channel *impl = aws_mem_acquire(allocator, sizeof(struct aws_log_background_channel));
 
     if (impl == NULL) {
         return AWS_OP_ERR;
     }
 
-    impl->finished = false;
+    AWS_ZERO_STRUCT(*impl);
+    impl->overflow_policy = options->overflow_policy;
+    impl->line_slot_size = options->line_slot_size ? options->line_slot_size : DEFAULT_LINE_SLOT_SIZE;
+    impl->flush_size = options->flush_size ? options->flush_size : DEFAULT_FLUSH_SIZE;
+    impl->flush_interval_ns = options->flush_interval_ns;
 
-    if (aws_mutex_init(&impl->sync)) {
-        goto clean_up_sync_init_fail;
+    size_t queue_size = 1;
+    size_t requested_queue_size = options->queue_size ? options->queue_size : DEFAULT_QUEUE_SIZE;
+    while (queue_size < requested_queue_size) {
+        queue_size <<= 1;
+    }
+    impl->slot_mask = queue_size - 1;
+
+    impl->slots = aws_mem_acquire(allocator, queue_size * sizeof(struct log_line_slot));
+    if (impl->slots == NULL) {
+        goto clean_up_slots_alloc_fail;
+    }
+
+    /* room for the string header, the line and its terminator, padded to keep the next header aligned */
+    size_t storage_stride = offsetof(struct log_line_storage, bytes) + impl->line_slot_size + 1;
+    storage_stride = (storage_stride + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    impl->line_storage = aws_mem_acquire(allocator, queue_size * storage_stride);
+    if (impl->line_storage == NULL) {
+        goto clean_up_line_storage_alloc_fail;
     }
 
-    if (aws_array_list_init_dynamic(&impl->pending_log_lines, allocator, 10, sizeof(struct aws_string *))) {
-        goto clean_up_pending_log_lines_init_fail;
+    for (size_t i = 0; i < queue_size; ++i) {
+        struct log_line_slot *slot = &impl->slots[i];
+        aws_atomic_init_int(&slot->sequence, i);
+        slot->line = NULL;
+        slot->storage = (struct log_line_storage *)(void *)((uint8_t *)impl->line_storage + i * storage_stride);
+        slot->storage->allocator = NULL;
+    }
+
+    aws_atomic_init_int(&impl->tail, 0);
+    aws_atomic_init_int(&impl->waiting, 0);
+    aws_atomic_init_int(&impl->dropped_count, 0);
+
+    if (aws_mutex_init(&impl->sync)) {
+        goto clean_up_sync_init_fail;
     }
 
     if (aws_condition_variable_init(&impl->pending_line_signal)) {
@@ -240,12 +518,15 @@ clean_up_background_thread_init_fail:
     aws_condition_variable_clean_up(&impl->pending_line_signal);
 
 clean_up_pending_line_signal_init_fail:
-    aws_array_list_clean_up(&impl->pending_log_lines);
-
-clean_up_pending_log_lines_init_fail:
     aws_mutex_clean_up(&impl->sync);
 
 clean_up_sync_init_fail:
+    aws_mem_release(allocator, impl->line_storage);
+
+clean_up_line_storage_alloc_fail:
+    aws_mem_release(allocator, impl->slots);
+
+clean_up_slots_alloc_fail:
     aws_mem_release(allocator, impl);
 
     return AWS_OP_ERR;
@@ -15,6 +15,7 @@
 
 #include <aws/io/log_formatter.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/date_time.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
@@ -47,6 +48,138 @@ struct aws_default_log_formatter_impl {
     enum aws_date_format date_format;
 };
 
+/*
+ * Each thread remembers the last timestamp it formatted, so the date only has to be converted to text once a second,
+ * along with its own thread id, which never changes.
+ */
+struct log_prefix_cache {
+    bool timestamp_valid;
+    enum aws_date_format date_format;
+    uint64_t timestamp_secs;
+    size_t timestamp_len;
+    char timestamp[AWS_DATE_TIME_STR_MAX_LEN];
+    bool thread_id_valid;
+    size_t thread_id_len;
+    char thread_id[THREAD_ID_PREFIX_PADDING];
+};
+
+static AWS_THREAD_LOCAL struct log_prefix_cache tl_log_prefix_cache;
+
+static struct aws_byte_cursor s_cached_timestamp(enum aws_date_format date_format) {
+    struct log_prefix_cache *cache = &tl_log_prefix_cache;
+
+    uint64_t now_ns = 0;
+    aws_sys_clock_get_ticks(&now_ns);
+    uint64_t now_secs = aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+
+    if (!cache->timestamp_valid || cache->timestamp_secs != now_secs || cache->date_format != date_format) {
+        struct aws_date_time current_time;
+        aws_date_time_init_epoch_secs(&current_time, (double)now_secs);
+
+        struct aws_byte_buf timestamp_buffer = {
+            .allocator = NULL,
+            .buffer = (uint8_t *)cache->timestamp,
+            .capacity = sizeof(cache->timestamp),
+            .len = 0,
+        };
+
+        cache->timestamp_valid =
+            aws_date_time_to_utc_time_str(&current_time, date_format, &timestamp_buffer) == AWS_OP_SUCCESS;
+        cache->timestamp_len = cache->timestamp_valid ? timestamp_buffer.len : 0;
+        cache->timestamp_secs = now_secs;
+        cache->date_format = date_format;
+    }
+
+    return aws_byte_cursor_from_array(cache->timestamp, cache->timestamp_len);
+}
+
+static struct aws_byte_cursor s_cached_thread_id(void) {
+    struct log_prefix_cache *cache = &tl_log_prefix_cache;
+
+    if (!cache->thread_id_valid) {
+        int written =
+            snprintf(cache->thread_id, sizeof(cache->thread_id), "%" PRIu64, aws_thread_current_thread_id());
+        cache->thread_id_len = written > 0 ? (size_t)written : 0;
+        cache->thread_id_valid = true;
+    }
+
+    return aws_byte_cursor_from_array(cache->thread_id, cache->thread_id_len);
+}
+
+static void s_append_c_str(struct aws_byte_buf *output, const char *str) {
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_c_str(str);
+    aws_byte_buf_append(output, &cursor);
+}
+
+/*
+ * Appends "[<LogLevel>] [<Timestamp>] [<ThreadId>] [<Subject>] - " to output.  output must have room for
+ * MAX_LOG_LINE_PREFIX_SIZE plus the subject name.
+ */
+static int s_append_log_line_prefix(
+    struct aws_default_log_formatter_impl *impl,
+    struct aws_byte_buf *output,
+    enum aws_log_level level,
+    const char *subject_name) {
+
+    const char *level_string = NULL;
+    if (aws_log_level_to_string(level, &level_string)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor timestamp = s_cached_timestamp(impl->date_format);
+    struct aws_byte_cursor thread_id = s_cached_thread_id();
+
+    s_append_c_str(output, "[");
+    s_append_c_str(output, level_string);
+    s_append_c_str(output, "] [");
+    aws_byte_buf_append(output, &timestamp);
+    s_append_c_str(output, "] [");
+    aws_byte_buf_append(output, &thread_id);
+    s_append_c_str(output, "] ");
+
+    if (subject_name) {
+        s_append_c_str(output, "[");
+        s_append_c_str(output, subject_name);
+        s_append_c_str(output, "]");
+    }
+
+    s_append_c_str(output, " - ");
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Appends the user content and the final newline.  If they don't fit, fails with AWS_ERROR_SHORT_BUFFER and leaves
+ * output as it was.  output must have room for at least the newline.
+ */
+static int s_append_log_line_content(struct aws_byte_buf *output, const char *format, va_list args) {
+    char *content_start = (char *)output->buffer + output->len;
+    size_t content_room = output->capacity - output->len;
+
+#ifdef WIN32
+    int written_count = vsnprintf_s(content_start, content_room, _TRUNCATE, format, args);
+    if (written_count < 0 && strlen(content_start) == content_room - 1) {
+        /* vsnprintf_s reports truncation as an error */
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+#else
+    int written_count = vsnprintf(content_start, content_room, format, args);
+#endif /* WIN32 */
+    if (written_count < 0) {
+        return AWS_OP_ERR;
+    }
+
+    /* the newline takes the place of the terminator vsnprintf wrote */
+    if ((size_t)written_count > content_room - 1) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
+    }
+
+    output->len += (size_t)written_count;
+    s_append_c_str(output, "\n");
+
+    return AWS_OP_SUCCESS;
+}
+
 static int s_default_aws_log_formatter_format(
     struct aws_log_formatter *formatter,
     struct aws_string **formatted_output,
@@ -55,8 +188,6 @@ static int s_default_aws_log_formatter_format(
     const char *format,
     va_list args) {
 
-    (void)subject;
-
     struct aws_default_log_formatter_impl *impl = formatter->impl;
 
     if (formatted_output == NULL) {
@@ -94,109 +225,67 @@ static int s_default_aws_log_formatter_format(
         goto error_clean_up;
     }
 
-    char *log_line_buffer = (char *)raw_string->bytes;
-    size_t current_index = 0;
+    struct aws_byte_buf log_line_buffer = {
+        .allocator = NULL,
+        .buffer = (uint8_t *)raw_string->bytes,
+        .capacity = total_length,
+        .len = 0,
+    };
 
-    /*
-     * Begin the log line with "[<Log Level>] ["
-     */
-    const char *level_string = NULL;
-    if (aws_log_level_to_string(level, &level_string)) {
+    if (s_append_log_line_prefix(impl, &log_line_buffer, level, subject_name)) {
         goto error_clean_up;
     }
 
-    int log_level_length = snprintf(log_line_buffer, total_length, "[%s] [", level_string);
-    if (log_level_length < 0) {
+    if (s_append_log_line_content(&log_line_buffer, format, args)) {
         goto error_clean_up;
     }
 
-    current_index += log_level_length;
+    /* there's always room for the terminator: the content was measured with one, and the newline took none of it */
+    log_line_buffer.buffer[log_line_buffer.len] = 0;
 
-    /*
-     * Add the timestamp.  To avoid copies and allocations, do some byte buffer tomfoolery.
-     *
-     * First, make a byte_buf that points to the current position in the output string
-     */
-    struct aws_byte_buf timestamp_buffer = {.allocator = formatter->allocator,
-                                            .buffer = (uint8_t *)log_line_buffer + current_index,
-                                            .capacity = total_length - current_index,
-                                            .len = 0};
+    *(struct aws_allocator **)(&raw_string->allocator) = formatter->allocator;
+    *(size_t *)(&raw_string->len) = log_line_buffer.len;
 
-    /*
-     * Output the current time to the byte_buf
-     */
-    struct aws_date_time current_time;
-    aws_date_time_init_now(&current_time);
+    *formatted_output = raw_string;
 
-    int result = aws_date_time_to_utc_time_str(&current_time, impl->date_format, &timestamp_buffer);
-    if (result != AWS_OP_SUCCESS) {
-        goto error_clean_up;
-    }
+    return AWS_OP_SUCCESS;
 
-    current_index += timestamp_buffer.len;
+error_clean_up:
 
-    /*
-     * Add thread id and user content separator (" - ")
-     */
-    uint64_t current_thread_id = aws_thread_current_thread_id();
-    int thread_id_written =
-        snprintf(log_line_buffer + current_index, total_length - current_index, "] [%" PRIu64 "] ", current_thread_id);
-    if (thread_id_written < 0) {
-        goto error_clean_up;
+    if (raw_string != NULL) {
+        aws_mem_release(formatter->allocator, raw_string);
     }
 
-    current_index += thread_id_written;
-
-    /* output subject name */
-    if (subject_name) {
-        int subject_written =
-            snprintf(log_line_buffer + current_index, total_length - current_index, "[%s]", subject_name);
-
-        if (subject_written < 0) {
-            goto error_clean_up;
-        }
+    return AWS_OP_ERR;
+}
 
-        current_index += subject_written;
-    }
+static int s_default_aws_log_formatter_format_to_buffer(
+    struct aws_log_formatter *formatter,
+    struct aws_byte_buf *output,
+    enum aws_log_level level,
+    aws_log_subject_t subject,
+    const char *format,
+    va_list args) {
 
-    current_index += snprintf(log_line_buffer + current_index, total_length - current_index, " - ");
+    struct aws_default_log_formatter_impl *impl = formatter->impl;
 
-    /*
-     * Now write the actual data requested by the user
-     */
-#ifdef WIN32
-    int written_count =
-        vsnprintf_s(log_line_buffer + current_index, total_length - current_index, _TRUNCATE, format, args);
-#else
-    int written_count = vsnprintf(log_line_buffer + current_index, total_length - current_index, format, args);
-#endif /* WIN32 */
-    if (written_count < 0) {
-        goto error_clean_up;
-    }
+    const char *subject_name = aws_log_subject_name(subject);
+    size_t subject_name_len = subject_name ? strlen(subject_name) : 0;
 
-    /*
-     * End with a newline.
-     */
-    current_index += written_count;
-    written_count = snprintf(log_line_buffer + current_index, total_length - current_index, "\n");
-    if (written_count < 0) {
-        goto error_clean_up;
+    /* the prefix, a terminator for vsnprintf to write, and nothing less */
+    if (output->capacity - output->len < MAX_LOG_LINE_PREFIX_SIZE + subject_name_len + 1) {
+        return aws_raise_error(AWS_ERROR_SHORT_BUFFER);
     }
 
-    *(struct aws_allocator **)(&raw_string->allocator) = formatter->allocator;
-    *(size_t *)(&raw_string->len) = current_index + written_count;
-
-    *formatted_output = raw_string;
-
-    return AWS_OP_SUCCESS;
-
-error_clean_up:
+    size_t starting_len = output->len;
 
-    if (raw_string != NULL) {
-        aws_mem_release(formatter->allocator, raw_string);
+    if (s_append_log_line_prefix(impl, output, level, subject_name) ||
+        s_append_log_line_content(output, format, args)) {
+        output->len = starting_len;
+        return AWS_OP_ERR;
     }
 
-    return AWS_OP_ERR;
+    return AWS_OP_SUCCESS;
 }
 
 static void s_default_aws_log_formatter_clean_up(struct aws_log_formatter *formatter) {
@@ -206,6 +295,7 @@ static void s_default_aws_log_formatter_clean_up(struct aws_log_formatter *forma
 static struct aws_log_formatter_vtable s_default_log_formatter_vtable = {
     .format = s_default_aws_log_formatter_format,
     .clean_up = s_default_aws_log_formatter_clean_up,
+    .format_to_buffer = s_default_aws_log_formatter_format_to_buffer,
 };
 
 int aws_log_formatter_init_default(
@@ -21,6 +21,10 @@
 #include <errno.h>
 #include <stdio.h>
 
+#ifndef WIN32
+#    include <sys/uio.h>
+#endif /* WIN32 */
+
 #ifdef _MSC_VER
 #    pragma warning(disable : 4996) /* Disable warnings about fopen() being insecure */
 #endif                              /* _MSC_VER */
@@ -47,6 +51,75 @@ static int s_aws_file_writer_write(struct aws_log_writer *writer, const struct a
     return AWS_OP_SUCCESS;
 }
 
+#ifndef WIN32
+
+/* how many lines go into one writev() call; well under any system's IOV_MAX */
+enum { MAX_WRITEV_LINE_COUNT = 64 };
+
+static int s_writev_all(int fd, struct iovec *iov, size_t iov_count) {
+    while (iov_count > 0) {
+        ssize_t written = writev(fd, iov, (int)iov_count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return aws_io_translate_and_raise_io_error(errno);
+        }
+
+        /* skip past whatever was written, which may end partway through a line */
+        size_t remaining = (size_t)written;
+        while (iov_count > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --iov_count;
+        }
+
+        if (iov_count > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_file_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *lines,
+    size_t line_count) {
+    struct aws_file_writer *impl = (struct aws_file_writer *)writer->impl;
+
+    /* anything still buffered by C library IO has to go out first to keep lines in order */
+    if (fflush(impl->log_file)) {
+        return aws_io_translate_and_raise_io_error(errno);
+    }
+
+    int fd = fileno(impl->log_file);
+
+    size_t written_count = 0;
+    while (written_count < line_count) {
+        struct iovec iov[MAX_WRITEV_LINE_COUNT];
+        size_t iov_count = 0;
+
+        while (iov_count < MAX_WRITEV_LINE_COUNT && written_count + iov_count < line_count) {
+            const struct aws_string *line = lines[written_count + iov_count];
+            iov[iov_count].iov_base = (void *)line->bytes;
+            iov[iov_count].iov_len = line->len;
+            ++iov_count;
+        }
+
+        if (s_writev_all(fd, iov, iov_count)) {
+            return AWS_OP_ERR;
+        }
+
+        written_count += iov_count;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* WIN32 */
+
 static void s_aws_file_writer_clean_up(struct aws_log_writer *writer) {
     struct aws_file_writer *impl = (struct aws_file_writer *)writer->impl;
 
@@ -57,8 +130,13 @@ static void s_aws_file_writer_clean_up(struct aws_log_writer *writer) {
     aws_mem_release(writer->allocator, impl);
 }
 
-static struct aws_log_writer_vtable s_aws_file_writer_vtable = {.write = s_aws_file_writer_write,
-                                                                .clean_up = s_aws_file_writer_clean_up};
+static struct aws_log_writer_vtable s_aws_file_writer_vtable = {
+    .write = s_aws_file_writer_write,
+    .clean_up = s_aws_file_writer_clean_up,
+#ifndef WIN32
+    .write_batch = s_aws_file_writer_write_batch,
+#endif /* WIN32 */
+};
 
 /*
  * Shared internal init implementation
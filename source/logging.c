@@ -80,6 +80,42 @@ void aws_logger_clean_up(struct aws_logger *logger) {
     logger->vtable->clean_up(logger);
 }
 
+static struct aws_log_subject_levels *s_get_subject_levels(struct aws_logger *logger) {
+    if (logger->vtable->get_subject_levels == NULL) {
+        aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+        return NULL;
+    }
+
+    return logger->vtable->get_subject_levels(logger);
+}
+
+int aws_logger_set_log_level(struct aws_logger *logger, enum aws_log_level level) {
+    struct aws_log_subject_levels *levels = s_get_subject_levels(logger);
+    if (levels == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_log_subject_levels_set_default(levels, level);
+}
+
+int aws_logger_set_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject, enum aws_log_level level) {
+    struct aws_log_subject_levels *levels = s_get_subject_levels(logger);
+    if (levels == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_log_subject_levels_set(levels, subject, level);
+}
+
+int aws_logger_clear_subject_log_level(struct aws_logger *logger, aws_log_subject_t subject) {
+    struct aws_log_subject_levels *levels = s_get_subject_levels(logger);
+    if (levels == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    return aws_log_subject_levels_clear(levels, subject);
+}
+
 static const char *s_log_level_strings[AWS_LL_COUNT] = {"NONE ", "FATAL", "ERROR", "WARN ", "INFO ", "DEBUG", "TRACE"};
 
 int aws_log_level_to_string(enum aws_log_level log_level, const char **level_string) {
@@ -110,12 +146,17 @@ static void s_aws_logger_pipeline_owned_clean_up(struct aws_logger *logger) {
     aws_mem_release(impl->allocator, impl->formatter);
     aws_mem_release(impl->allocator, impl->writer);
 
+    aws_log_subject_levels_clean_up(&impl->levels);
     aws_mem_release(impl->allocator, impl);
 }
 
 /*
  * Pipeline logger implementation
  */
+
+/* lines formatted on the logging thread's stack can be this long, anything longer gets a string of its own */
+enum { MAX_STACK_LOG_LINE_SIZE = 2048 };
+
 static int s_aws_logger_pipeline_log(
     struct aws_logger *logger,
     enum aws_log_level log_level,
@@ -128,6 +169,23 @@ static int s_aws_logger_pipeline_log(
     struct aws_logger_pipeline *impl = logger->p_impl;
     struct aws_string *output = NULL;
 
+    if (impl->formatter->vtable->format_to_buffer != NULL && impl->channel->vtable->send_line != NULL) {
+        uint8_t line_storage[MAX_STACK_LOG_LINE_SIZE];
+        struct aws_byte_buf line = aws_byte_buf_from_empty_array(line_storage, sizeof(line_storage));
+
+        /* if it doesn't fit, the arguments are needed again below */
+        va_list buffer_args;
+        va_copy(buffer_args, format_args);
+        int buffer_result = (impl->formatter->vtable->format_to_buffer)(
+            impl->formatter, &line, log_level, subject, format, buffer_args);
+        va_end(buffer_args);
+
+        if (buffer_result == AWS_OP_SUCCESS) {
+            va_end(format_args);
+            return (impl->channel->vtable->send_line)(impl->channel, aws_byte_cursor_from_buf(&line));
+        }
+    }
+
     AWS_ASSERT(impl->formatter->vtable->format != NULL);
     int result = (impl->formatter->vtable->format)(impl->formatter, &output, log_level, subject, format, format_args);
 
@@ -150,17 +208,22 @@ static int s_aws_logger_pipeline_log(
 }
 
 static enum aws_log_level s_aws_logger_pipeline_get_log_level(struct aws_logger *logger, aws_log_subject_t subject) {
-    (void)subject;
+    struct aws_logger_pipeline *impl = logger->p_impl;
+
+    return aws_log_subject_levels_get(&impl->levels, subject);
+}
 
+static struct aws_log_subject_levels *s_aws_logger_pipeline_get_subject_levels(struct aws_logger *logger) {
     struct aws_logger_pipeline *impl = logger->p_impl;
 
-    return impl->level;
+    return &impl->levels;
 }
 
 struct aws_logger_vtable g_pipeline_logger_owned_vtable = {
     .get_log_level = s_aws_logger_pipeline_get_log_level,
     .log = s_aws_logger_pipeline_log,
     .clean_up = s_aws_logger_pipeline_owned_clean_up,
+    .get_subject_levels = s_aws_logger_pipeline_get_subject_levels,
 };
 
 int aws_logger_init_standard(
@@ -174,6 +237,10 @@ int aws_logger_init_standard(
         return AWS_OP_ERR;
     }
 
+    if (aws_log_subject_levels_init(&impl->levels, allocator, options->level)) {
+        goto on_init_levels_failure;
+    }
+
     struct aws_log_writer *writer = aws_mem_acquire(allocator, sizeof(struct aws_log_writer));
 
     if (writer == NULL) {
@@ -212,7 +279,6 @@ int aws_logger_init_standard(
         impl->channel = channel;
         impl->writer = writer;
         impl->allocator = allocator;
-        impl->level = options->level;
 
         logger->vtable = &g_pipeline_logger_owned_vtable;
         logger->allocator = allocator;
@@ -236,6 +302,9 @@ on_init_writer_failure:
     aws_mem_release(allocator, writer);
 
 on_allocate_writer_failure:
+    aws_log_subject_levels_clean_up(&impl->levels);
+
+on_init_levels_failure:
     aws_mem_release(allocator, impl);
 
     return AWS_OP_ERR;
@@ -248,6 +317,7 @@ on_allocate_writer_failure:
 static void s_aws_pipeline_logger_unowned_clean_up(struct aws_logger *logger) {
     struct aws_logger_pipeline *impl = (struct aws_logger_pipeline *)logger->p_impl;
 
+    aws_log_subject_levels_clean_up(&impl->levels);
     aws_mem_release(impl->allocator, impl);
 }
 
@@ -255,6 +325,7 @@ static struct aws_logger_vtable s_pipeline_logger_unowned_vtable = {
     .get_log_level = s_aws_logger_pipeline_get_log_level,
     .log = s_aws_logger_pipeline_log,
     .clean_up = s_aws_pipeline_logger_unowned_clean_up,
+    .get_subject_levels = s_aws_logger_pipeline_get_subject_levels,
 };
 
 int aws_logger_init_from_external(
@@ -271,11 +342,15 @@ int aws_logger_init_from_external(
         return AWS_OP_ERR;
     }
 
+    if (aws_log_subject_levels_init(&impl->levels, allocator, level)) {
+        aws_mem_release(allocator, impl);
+        return AWS_OP_ERR;
+    }
+
     impl->formatter = formatter;
     impl->channel = channel;
     impl->writer = writer;
     impl->allocator = allocator;
-    impl->level = level;
 
     logger->vtable = &s_pipeline_logger_unowned_vtable;
     logger->allocator = allocator;
@@ -292,6 +367,109 @@ static const uint32_t S_MAX_LOG_SUBJECT = AWS_LOG_SUBJECT_SPACE_SIZE * AWS_MAX_L
 
 static const struct aws_log_subject_info_list *volatile s_log_subject_slots[AWS_MAX_LOG_SUBJECT_SLOTS] = {0};
 
+/*
+ * Per-subject levels, packed 4 bits to a subject so that a table covering every subject slot stays small
+ */
+enum {
+    SUBJECT_LEVEL_BITS = 4,
+    SUBJECT_LEVEL_MASK = (1 << SUBJECT_LEVEL_BITS) - 1,
+    SUBJECT_LEVELS_PER_WORD = sizeof(size_t) * 8 / SUBJECT_LEVEL_BITS,
+};
+
+static const size_t S_SUBJECT_LEVEL_WORD_COUNT =
+    (AWS_LOG_SUBJECT_SPACE_SIZE * AWS_MAX_LOG_SUBJECT_SLOTS + SUBJECT_LEVELS_PER_WORD - 1) / SUBJECT_LEVELS_PER_WORD;
+
+int aws_log_subject_levels_init(
+    struct aws_log_subject_levels *levels,
+    struct aws_allocator *allocator,
+    enum aws_log_level default_level) {
+
+    if (default_level >= AWS_LL_COUNT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    levels->subject_words = aws_mem_acquire(allocator, S_SUBJECT_LEVEL_WORD_COUNT * sizeof(struct aws_atomic_var));
+    if (levels->subject_words == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < S_SUBJECT_LEVEL_WORD_COUNT; ++i) {
+        aws_atomic_init_int(&levels->subject_words[i], 0);
+    }
+
+    levels->allocator = allocator;
+    aws_atomic_init_int(&levels->default_level, (size_t)default_level);
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_log_subject_levels_clean_up(struct aws_log_subject_levels *levels) {
+    aws_mem_release(levels->allocator, levels->subject_words);
+    levels->subject_words = NULL;
+}
+
+enum aws_log_level aws_log_subject_levels_get(struct aws_log_subject_levels *levels, aws_log_subject_t subject) {
+    /*
+     * Relaxed loads are enough: a level change only has to show up eventually, and nothing else is published with it
+     */
+    if (subject <= S_MAX_LOG_SUBJECT) {
+        size_t word = aws_atomic_load_int_explicit(
+            &levels->subject_words[subject / SUBJECT_LEVELS_PER_WORD], aws_memory_order_relaxed);
+        size_t subject_level = (word >> (subject % SUBJECT_LEVELS_PER_WORD * SUBJECT_LEVEL_BITS)) & SUBJECT_LEVEL_MASK;
+
+        if (subject_level != 0) {
+            return (enum aws_log_level)(subject_level - 1);
+        }
+    }
+
+    return (enum aws_log_level)aws_atomic_load_int_explicit(&levels->default_level, aws_memory_order_relaxed);
+}
+
+int aws_log_subject_levels_set_default(struct aws_log_subject_levels *levels, enum aws_log_level level) {
+    if (level >= AWS_LL_COUNT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    aws_atomic_store_int(&levels->default_level, (size_t)level);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* subject_level is 0 to fall back to the default level, level + 1 otherwise */
+static int s_set_subject_level(struct aws_log_subject_levels *levels, aws_log_subject_t subject, size_t subject_level) {
+    if (subject > S_MAX_LOG_SUBJECT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct aws_atomic_var *word = &levels->subject_words[subject / SUBJECT_LEVELS_PER_WORD];
+    size_t shift = subject % SUBJECT_LEVELS_PER_WORD * SUBJECT_LEVEL_BITS;
+
+    /* other subjects share the word, so only this subject's bits can change */
+    size_t expected = aws_atomic_load_int(word);
+    size_t desired = 0;
+    do {
+        desired = (expected & ~((size_t)SUBJECT_LEVEL_MASK << shift)) | (subject_level << shift);
+    } while (!aws_atomic_compare_exchange_int(word, &expected, desired));
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_log_subject_levels_set(
+    struct aws_log_subject_levels *levels,
+    aws_log_subject_t subject,
+    enum aws_log_level level) {
+
+    if (level >= AWS_LL_COUNT) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    return s_set_subject_level(levels, subject, (size_t)level + 1);
+}
+
+int aws_log_subject_levels_clear(struct aws_log_subject_levels *levels, aws_log_subject_t subject) {
+    return s_set_subject_level(levels, subject, 0);
+}
+
 static const struct aws_log_subject_info *s_get_log_subject_info_by_id(aws_log_subject_t subject) {
     if (subject > S_MAX_LOG_SUBJECT) {
         return NULL;
@@ -17,30 +17,116 @@
 
 #include <aws/common/thread.h>
 
+/* slab segments are laid out back to back, so each one is padded to keep the next suitably aligned. */
+static size_t s_slab_stride(size_t segment_size) {
+    const size_t alignment = sizeof(void *) * 2;
+    return (segment_size + alignment - 1) & ~(alignment - 1);
+}
+
+static bool s_slab_owns(struct aws_memory_pool *mempool, void *memory) {
+    uint8_t *address = memory;
+    return mempool->slab && address >= mempool->slab &&
+           address < mempool->slab + mempool->slab_segment_count * s_slab_stride(mempool->segment_size);
+}
+
+/* an adaptive pool looks at its demand again after this many acquisitions */
+enum { ADAPT_WINDOW_ACQUIRE_COUNT = 256 };
+
+/* frees idle segments, never slab ones, until no more than ideal_segment_count are kept */
+static void s_trim_to_ideal(struct aws_memory_pool *mempool) {
+    void **entries = mempool->data_ptr;
+    size_t length = aws_array_list_length(&mempool->stack);
+
+    size_t i = 0;
+    while (length > mempool->ideal_segment_count && i < length) {
+        if (s_slab_owns(mempool, entries[i])) {
+            ++i;
+            continue;
+        }
+
+        aws_mem_release(mempool->alloc, entries[i]);
+        entries[i] = entries[length - 1];
+        aws_array_list_pop_back(&mempool->stack);
+        --length;
+    }
+}
+
+static void s_reset_window(struct aws_memory_pool *mempool) {
+    mempool->window_acquire_count = 0;
+    mempool->window_miss_count = 0;
+    mempool->window_low_water = aws_array_list_length(&mempool->stack);
+}
+
+/*
+ * grows the pool by however many acquisitions missed during the window, or if none did, shrinks it by half of what
+ * sat idle the whole time.
+ */
+static void s_adapt(struct aws_memory_pool *mempool) {
+    size_t ideal = mempool->ideal_segment_count;
+
+    if (mempool->window_miss_count) {
+        ideal += mempool->window_miss_count;
+    } else {
+        size_t unused = (mempool->window_low_water + 1) / 2;
+        ideal = unused < ideal ? ideal - unused : 0;
+    }
+
+    if (ideal < mempool->min_segment_count) {
+        ideal = mempool->min_segment_count;
+    }
+    if (ideal > mempool->max_segment_count) {
+        ideal = mempool->max_segment_count;
+    }
+
+    mempool->ideal_segment_count = (uint16_t)ideal;
+    s_trim_to_ideal(mempool);
+    s_reset_window(mempool);
+}
+
 int aws_memory_pool_init(
     struct aws_memory_pool *mempool,
     struct aws_allocator *alloc,
     uint16_t ideal_segment_count,
     size_t segment_size) {
 
+    return aws_memory_pool_init_with_slab(mempool, alloc, ideal_segment_count, ideal_segment_count, segment_size);
+}
+
+int aws_memory_pool_init_with_slab(
+    struct aws_memory_pool *mempool,
+    struct aws_allocator *alloc,
+    uint16_t slab_segment_count,
+    uint16_t ideal_segment_count,
+    size_t segment_size) {
+
+    AWS_ASSERT(slab_segment_count <= ideal_segment_count);
+
+    AWS_ZERO_STRUCT(*mempool);
     mempool->alloc = alloc;
     mempool->ideal_segment_count = ideal_segment_count;
     mempool->segment_size = segment_size;
-    mempool->data_ptr = aws_mem_acquire(alloc, ideal_segment_count * sizeof(void *));
 
+    /* a pool that retains nothing still gets a (never used) slot, so the stack always has backing storage */
+    size_t stack_slots = ideal_segment_count ? ideal_segment_count : 1;
+    mempool->data_ptr = aws_mem_acquire(alloc, stack_slots * sizeof(void *));
     if (!mempool->data_ptr) {
         return AWS_OP_ERR;
     }
 
-    aws_array_list_init_static(&mempool->stack, mempool->data_ptr, ideal_segment_count, sizeof(void *));
+    aws_array_list_init_static(&mempool->stack, mempool->data_ptr, stack_slots, sizeof(void *));
 
-    for (uint16_t i = 0; i < ideal_segment_count; ++i) {
-        void *memory = aws_mem_acquire(alloc, segment_size);
-        if (memory) {
-            aws_array_list_push_back(&mempool->stack, &memory);
-        } else {
+    if (slab_segment_count) {
+        size_t stride = s_slab_stride(segment_size);
+        mempool->slab = aws_mem_acquire(alloc, slab_segment_count * stride);
+        if (!mempool->slab) {
             goto clean_up;
         }
+        mempool->slab_segment_count = slab_segment_count;
+
+        for (uint16_t i = 0; i < slab_segment_count; ++i) {
+            void *memory = mempool->slab + i * stride;
+            aws_array_list_push_back(&mempool->stack, &memory);
+        }
     }
 
     return AWS_OP_SUCCESS;
@@ -57,22 +143,102 @@ void aws_memory_pool_clean_up(struct aws_memory_pool *mempool) {
         /* the only way this fails is not possible since I already checked the length. */
         aws_array_list_back(&mempool->stack, &cur);
         aws_array_list_pop_back(&mempool->stack);
-        aws_mem_release(mempool->alloc, cur);
+        if (!s_slab_owns(mempool, cur)) {
+            aws_mem_release(mempool->alloc, cur);
+        }
     }
 
     aws_array_list_clean_up(&mempool->stack);
-    aws_mem_release(mempool->alloc, mempool->data_ptr);
+    if (mempool->data_ptr) {
+        aws_mem_release(mempool->alloc, mempool->data_ptr);
+    }
+    if (mempool->slab) {
+        aws_mem_release(mempool->alloc, mempool->slab);
+    }
+    mempool->data_ptr = NULL;
+    mempool->slab = NULL;
+    mempool->slab_segment_count = 0;
+}
+
+int aws_memory_pool_set_bounds(
+    struct aws_memory_pool *mempool,
+    uint16_t min_segment_count,
+    uint16_t max_segment_count) {
+
+    if (min_segment_count > max_segment_count) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* the slab has to fit in the pool, see aws_memory_pool_release() */
+    uint16_t floor = min_segment_count > mempool->slab_segment_count ? min_segment_count : mempool->slab_segment_count;
+    uint16_t ceiling = max_segment_count > floor ? max_segment_count : floor;
+
+    if (mempool->ideal_segment_count < floor) {
+        mempool->ideal_segment_count = floor;
+    }
+    if (mempool->ideal_segment_count > ceiling) {
+        mempool->ideal_segment_count = ceiling;
+        s_trim_to_ideal(mempool);
+    }
+
+    /* the stack needs room for as many segments as the pool might grow to keep */
+    size_t stack_slots = ceiling ? ceiling : 1;
+    if (stack_slots != aws_array_list_capacity(&mempool->stack)) {
+        void *new_data = aws_mem_acquire(mempool->alloc, stack_slots * sizeof(void *));
+        if (!new_data) {
+            return AWS_OP_ERR;
+        }
+
+        struct aws_array_list new_stack;
+        aws_array_list_init_static(&new_stack, new_data, stack_slots, sizeof(void *));
+
+        void **entries = mempool->data_ptr;
+        for (size_t i = 0; i < aws_array_list_length(&mempool->stack); ++i) {
+            aws_array_list_push_back(&new_stack, &entries[i]);
+        }
+
+        aws_array_list_clean_up(&mempool->stack);
+        aws_mem_release(mempool->alloc, mempool->data_ptr);
+        mempool->data_ptr = new_data;
+        mempool->stack = new_stack;
+    }
+
+    mempool->adaptive = true;
+    mempool->min_segment_count = floor;
+    mempool->max_segment_count = ceiling;
+    s_reset_window(mempool);
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_memory_pool_adapt(struct aws_memory_pool *mempool) {
+    if (mempool->adaptive) {
+        s_adapt(mempool);
+    }
 }
 
 void *aws_memory_pool_acquire(struct aws_memory_pool *mempool) {
+    if (mempool->adaptive && mempool->window_acquire_count >= ADAPT_WINDOW_ACQUIRE_COUNT) {
+        s_adapt(mempool);
+    }
+    mempool->window_acquire_count++;
+
     void *back = NULL;
-    if (aws_array_list_length(&mempool->stack) > 0) {
+    size_t pool_size = aws_array_list_length(&mempool->stack);
+    if (pool_size > 0) {
         aws_array_list_back(&mempool->stack, &back);
         aws_array_list_pop_back(&mempool->stack);
 
+        if (pool_size - 1 < mempool->window_low_water) {
+            mempool->window_low_water = pool_size - 1;
+        }
+
         return back;
     }
 
+    mempool->window_miss_count++;
+    mempool->window_low_water = 0;
+
     void *mem = aws_mem_acquire(mempool->alloc, mempool->segment_size);
     return mem;
 }
@@ -81,7 +247,25 @@ void aws_memory_pool_release(struct aws_memory_pool *mempool, void *to_release)
     size_t pool_size = aws_array_list_length(&mempool->stack);
 
     if (pool_size >= mempool->ideal_segment_count) {
-        aws_mem_release(mempool->alloc, to_release);
+        if (!s_slab_owns(mempool, to_release)) {
+            aws_mem_release(mempool->alloc, to_release);
+            return;
+        }
+
+        /*
+         * slab segments can't be freed on their own. Since this one was out, the stack holds at most
+         * slab_segment_count - 1 others, so there's a separately allocated segment in it to make room.
+         */
+        void **entries = mempool->data_ptr;
+        for (size_t i = 0; i < pool_size; ++i) {
+            if (!s_slab_owns(mempool, entries[i])) {
+                aws_mem_release(mempool->alloc, entries[i]);
+                entries[i] = to_release;
+                return;
+            }
+        }
+
+        AWS_ASSERT(0);
         return;
     }
 
@@ -91,6 +275,7 @@ void aws_memory_pool_release(struct aws_memory_pool *mempool, void *to_release)
 struct message_pool_allocator {
     struct aws_allocator base_allocator;
     struct aws_message_pool *msg_pool;
+    size_t size_class;
 };
 
 void *s_message_pool_mem_acquire(struct aws_allocator *allocator, size_t size) {
@@ -110,36 +295,112 @@ void s_message_pool_mem_release(struct aws_allocator *allocator, void *ptr) {
 
 static size_t MSG_OVERHEAD = sizeof(struct aws_io_message) + sizeof(struct message_pool_allocator);
 
+/* each default size class is this many times bigger than the one before it */
+enum { DEFAULT_SIZE_CLASS_GROWTH = 4 };
+
+/* spreads classes from the small block size up to the application data size, for callers that only set those. */
+static size_t s_default_size_classes(
+    const struct aws_message_pool_creation_args *args,
+    struct aws_message_pool_size_class *classes) {
+
+    size_t count = 0;
+    size_t data_size = args->small_block_msg_data_size;
+
+    classes[count].msg_data_size = data_size;
+    classes[count].preallocated_msg_count = args->small_block_msg_count;
+    classes[count].max_retained_msg_count = args->small_block_msg_count;
+    ++count;
+
+    while (count < AWS_MESSAGE_POOL_MAX_SIZE_CLASSES - 1 &&
+           data_size * DEFAULT_SIZE_CLASS_GROWTH < args->application_data_msg_data_size) {
+        data_size *= DEFAULT_SIZE_CLASS_GROWTH;
+        classes[count].msg_data_size = data_size;
+        classes[count].preallocated_msg_count = 0;
+        classes[count].max_retained_msg_count = args->application_data_msg_count;
+        ++count;
+    }
+
+    if (args->application_data_msg_data_size > data_size) {
+        classes[count].msg_data_size = args->application_data_msg_data_size;
+        classes[count].preallocated_msg_count = args->application_data_msg_count;
+        classes[count].max_retained_msg_count = args->application_data_msg_count;
+        ++count;
+    }
+
+    return count;
+}
+
 int aws_message_pool_init(
     struct aws_message_pool *msg_pool,
     struct aws_allocator *alloc,
     struct aws_message_pool_creation_args *args) {
 
+    AWS_ZERO_STRUCT(*msg_pool);
     msg_pool->alloc = alloc;
 
-    size_t msg_data_size = args->application_data_msg_data_size + MSG_OVERHEAD;
+    struct aws_message_pool_size_class default_classes[AWS_MESSAGE_POOL_MAX_SIZE_CLASSES];
+    const struct aws_message_pool_size_class *classes = args->size_classes;
+    size_t class_count = args->size_class_count;
 
-    if (aws_memory_pool_init(
-            &msg_pool->application_data_pool, alloc, args->application_data_msg_count, msg_data_size)) {
-        return AWS_OP_ERR;
+    if (!classes || !class_count) {
+        class_count = s_default_size_classes(args, default_classes);
+        classes = default_classes;
     }
 
-    size_t small_blk_data_size = args->small_block_msg_data_size + MSG_OVERHEAD;
+    if (class_count > AWS_MESSAGE_POOL_MAX_SIZE_CLASSES) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
 
-    if (aws_memory_pool_init(&msg_pool->small_block_pool, alloc, args->small_block_msg_count, small_blk_data_size)) {
-        aws_memory_pool_clean_up(&msg_pool->application_data_pool);
-        return AWS_OP_ERR;
+    for (size_t i = 0; i < class_count; ++i) {
+        if (classes[i].preallocated_msg_count > classes[i].max_retained_msg_count ||
+            (i > 0 && classes[i].msg_data_size <= classes[i - 1].msg_data_size)) {
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            goto clean_up;
+        }
+
+        if (aws_memory_pool_init_with_slab(
+                &msg_pool->size_classes[i],
+                alloc,
+                classes[i].preallocated_msg_count,
+                classes[i].max_retained_msg_count,
+                classes[i].msg_data_size + MSG_OVERHEAD)) {
+            goto clean_up;
+        }
+
+        msg_pool->size_class_count = i + 1;
     }
 
     return AWS_OP_SUCCESS;
+
+clean_up:
+    aws_message_pool_clean_up(msg_pool);
+    return AWS_OP_ERR;
 }
 
 void aws_message_pool_clean_up(struct aws_message_pool *msg_pool) {
-    aws_memory_pool_clean_up(&msg_pool->application_data_pool);
-    aws_memory_pool_clean_up(&msg_pool->small_block_pool);
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        aws_memory_pool_clean_up(&msg_pool->size_classes[i]);
+    }
     AWS_ZERO_STRUCT(*msg_pool);
 }
 
+int aws_message_pool_set_bounds(struct aws_message_pool *msg_pool, const struct aws_message_pool_bounds *bounds) {
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        if (aws_memory_pool_set_bounds(
+                &msg_pool->size_classes[i], bounds->min_retained_msg_count, bounds->max_retained_msg_count)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_message_pool_adapt(struct aws_message_pool *msg_pool) {
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        aws_memory_pool_adapt(&msg_pool->size_classes[i]);
+    }
+}
+
 struct message_wrapper {
     struct aws_io_message message;
     struct message_pool_allocator msg_allocator;
@@ -153,15 +414,16 @@ struct aws_io_message *aws_message_pool_acquire(
 
     struct message_wrapper *message_wrapper = NULL;
     size_t max_size = 0;
+    size_t size_class = 0;
     switch (message_type) {
         case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (size_hint > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->application_data_pool);
-                max_size = msg_pool->application_data_pool.segment_size - MSG_OVERHEAD;
-            } else {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->small_block_pool);
-                max_size = msg_pool->small_block_pool.segment_size - MSG_OVERHEAD;
+            /* smallest class that fits, or the biggest one there is */
+            while (size_class < msg_pool->size_class_count - 1 &&
+                   size_hint > msg_pool->size_classes[size_class].segment_size - MSG_OVERHEAD) {
+                ++size_class;
             }
+            message_wrapper = aws_memory_pool_acquire(&msg_pool->size_classes[size_class]);
+            max_size = msg_pool->size_classes[size_class].segment_size - MSG_OVERHEAD;
             break;
         default:
             AWS_ASSERT(0);
@@ -178,6 +440,7 @@ struct aws_io_message *aws_message_pool_acquire(
     message_wrapper->message.user_data = NULL;
     message_wrapper->message.copy_mark = 0;
     message_wrapper->message.on_completion = NULL;
+    message_wrapper->message.next_in_chain = NULL;
     /* the buffer shares the allocation with the message. It's the bit at the end. */
     message_wrapper->message.message_data.buffer = message_wrapper->buffer_start;
     message_wrapper->message.message_data.len = 0;
@@ -189,6 +452,7 @@ struct aws_io_message *aws_message_pool_acquire(
     message_wrapper->msg_allocator.base_allocator.mem_realloc = NULL;
     message_wrapper->msg_allocator.base_allocator.mem_release = s_message_pool_mem_release;
     message_wrapper->msg_allocator.msg_pool = msg_pool;
+    message_wrapper->msg_allocator.size_class = size_class;
 
     message_wrapper->message.allocator = &message_wrapper->msg_allocator.base_allocator;
     return &message_wrapper->message;
@@ -203,11 +467,7 @@ void aws_message_pool_release(struct aws_message_pool *msg_pool, struct aws_io_m
 
     switch (message->message_type) {
         case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (message->message_data.capacity > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                aws_memory_pool_release(&msg_pool->application_data_pool, wrapper);
-            } else {
-                aws_memory_pool_release(&msg_pool->small_block_pool, wrapper);
-            }
+            aws_memory_pool_release(&msg_pool->size_classes[wrapper->msg_allocator.size_class], wrapper);
             break;
         default:
             AWS_ASSERT(0);
@@ -90,6 +90,7 @@ int aws_default_dns_resolve(
         host_address.allocator = allocator;
         host_address.use_count = 0;
         host_address.connection_failure_count = 0;
+        host_address.expiry = 0;
         host_address.host = host_cpy;
 
         if (aws_array_list_push_back(output_addresses, &host_address)) {
@@ -403,16 +403,14 @@ int aws_pipe_unsubscribe_from_readable_events(struct aws_pipe_read_end *read_end
         return aws_raise_error(AWS_ERROR_IO_NOT_SUBSCRIBED);
     }
 
+    /* the event loop lets go of the handle even when this fails, so the read-end is unsubscribed either way. */
     int err = aws_event_loop_unsubscribe_from_io_events(read_impl->event_loop, &read_impl->handle);
-    if (err) {
-        return AWS_OP_ERR;
-    }
 
     read_impl->is_subscribed = false;
     read_impl->on_readable_user_callback = NULL;
     read_impl->on_readable_user_data = NULL;
 
-    return AWS_OP_SUCCESS;
+    return err ? AWS_OP_ERR : AWS_OP_SUCCESS;
 }
 
 /* Pop front write request, invoke its callback, and delete it.
@@ -566,10 +564,9 @@ int aws_pipe_clean_up_write_end(struct aws_pipe_write_end *write_end) {
         return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
     }
 
-    int err = aws_event_loop_unsubscribe_from_io_events(write_impl->event_loop, &write_impl->handle);
-    if (err) {
-        return AWS_OP_ERR;
-    }
+    /* The result is ignored: the event loop has already logged any failure and let go of the handle regardless, so
+     * the write-end can't be unsubscribed again and has to be torn down now. */
+    aws_event_loop_unsubscribe_from_io_events(write_impl->event_loop, &write_impl->handle);
 
     close(write_impl->handle.data.fd);
 
@@ -13,6 +13,11 @@
  * permissions and limitations under the License.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* recvmmsg() and sendmmsg() */
+#    define _GNU_SOURCE
+#endif
+
 #include <aws/io/socket.h>
 
 #include <aws/common/clock.h>
@@ -25,10 +30,13 @@
 #include <arpa/inet.h>
 #include <aws/io/io.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netinet/tcp.h>
+#include <string.h>
 #include <sys/errno.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #if defined(__MACH__)
@@ -48,6 +56,53 @@
 #    define O_CLOEXEC 02000000
 #endif
 
+#if defined(__linux__)
+#    include <linux/errqueue.h>
+#    include <netinet/in.h>
+#    include <netinet/udp.h>
+#endif
+
+/* MSG_ZEROCOPY needs kernel 4.14+ headers, without them large writes are just copied like everything else. */
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#    define USE_ZEROCOPY 1
+#else
+#    define USE_ZEROCOPY 0
+#endif
+
+/* UDP segmentation offload needs kernel 4.18+ headers for sending and 5.0+ for receiving. */
+#if defined(UDP_SEGMENT)
+#    define USE_UDP_GSO 1
+#else
+#    define USE_UDP_GSO 0
+#endif
+
+#if defined(UDP_GRO)
+#    define USE_UDP_GRO 1
+#else
+#    define USE_UDP_GRO 0
+#endif
+
+/* TCP_NOPUSH is the BSD take on TCP_CORK. */
+#if defined(TCP_CORK)
+#    define AWS_TCP_CORK TCP_CORK
+#elif defined(TCP_NOPUSH)
+#    define AWS_TCP_CORK TCP_NOPUSH
+#endif
+
+/* Delayed ACKs can only be turned off on Linux, and then only until the kernel turns them back on. */
+#if defined(TCP_QUICKACK)
+#    define USE_TCP_QUICKACK 1
+#else
+#    define USE_TCP_QUICKACK 0
+#endif
+
+/* Elsewhere datagrams are read and written one system call at a time. */
+#if defined(__linux__)
+#    define USE_MMSG 1
+#else
+#    define USE_MMSG 0
+#endif
+
 /* other than CONNECTED_READ | CONNECTED_WRITE
  * a socket is only in one of these states at a time. */
 enum socket_state {
@@ -142,7 +197,13 @@ static int s_create_socket(struct aws_socket *sock, const struct aws_socket_opti
         (void)success;
         sock->io_handle.data.fd = fd;
         sock->io_handle.additional_data = NULL;
-        return aws_socket_set_options(sock, options);
+        if (aws_socket_set_options(sock, options)) {
+            close(fd);
+            sock->io_handle.data.fd = -1;
+            return AWS_OP_ERR;
+        }
+
+        return AWS_OP_SUCCESS;
     }
 
     int aws_error = s_determine_socket_error(errno);
@@ -164,6 +225,26 @@ struct posix_socket {
     bool currently_in_event;
     bool clean_yourself_up;
     bool *close_happened;
+    /* requests whose data went out with MSG_ZEROCOPY and that the kernel may still be reading from, plus anything
+     * that finished behind them, in the order their callbacks have to run. */
+    struct aws_linked_list zerocopy_pending;
+    /* the notification id the kernel will assign to the next successful MSG_ZEROCOPY send */
+    uint32_t zerocopy_next_id;
+    bool zerocopy_supported;
+    bool zerocopy_disabled;
+    /* whether UDP_SEGMENT and UDP_GRO are currently switched on for the socket. */
+    bool udp_gso_enabled;
+    bool udp_gro_enabled;
+    /* whether TCP_NODELAY and TCP_CORK are currently switched on, so that setting options again can switch them off. */
+    bool tcp_nodelay_enabled;
+    bool tcp_cork_enabled;
+    /* bytes in write_queue the kernel hasn't taken yet, and the limits set by aws_socket_set_write_watermarks(). */
+    size_t pending_write_bytes;
+    size_t write_low_watermark;
+    size_t write_high_watermark;
+    bool write_blocked;
+    aws_socket_on_writable_fn *on_writable;
+    void *on_writable_user_data;
 };
 
 static int s_socket_init(
@@ -184,9 +265,35 @@ static int s_socket_init(
     socket->state = INIT;
     socket->options = *options;
 
+    aws_linked_list_init(&posix_socket->write_queue);
+    posix_socket->write_in_progress = false;
+    posix_socket->currently_subscribed = false;
+    posix_socket->continue_accept = false;
+    posix_socket->currently_in_event = false;
+    posix_socket->clean_yourself_up = false;
+    posix_socket->connect_args = NULL;
+    posix_socket->close_happened = NULL;
+    aws_linked_list_init(&posix_socket->zerocopy_pending);
+    posix_socket->zerocopy_next_id = 0;
+    posix_socket->zerocopy_supported = false;
+    posix_socket->zerocopy_disabled = false;
+    posix_socket->udp_gso_enabled = false;
+    posix_socket->udp_gro_enabled = false;
+    posix_socket->tcp_nodelay_enabled = false;
+    posix_socket->tcp_cork_enabled = false;
+    posix_socket->pending_write_bytes = 0;
+    posix_socket->write_low_watermark = 0;
+    posix_socket->write_high_watermark = 0;
+    posix_socket->write_blocked = false;
+    posix_socket->on_writable = NULL;
+    posix_socket->on_writable_user_data = NULL;
+    /* set_options() records what the kernel agreed to in here, so it has to be in place first. */
+    socket->impl = posix_socket;
+
     if (existing_socket_fd < 0) {
         int err = s_create_socket(socket, options);
         if (err) {
+            socket->impl = NULL;
             aws_mem_release(alloc, posix_socket);
             return AWS_OP_ERR;
         }
@@ -198,15 +305,6 @@ static int s_socket_init(
         aws_socket_set_options(socket, options);
     }
 
-    aws_linked_list_init(&posix_socket->write_queue);
-    posix_socket->write_in_progress = false;
-    posix_socket->currently_subscribed = false;
-    posix_socket->continue_accept = false;
-    posix_socket->currently_in_event = false;
-    posix_socket->clean_yourself_up = false;
-    posix_socket->connect_args = NULL;
-    posix_socket->close_happened = NULL;
-    socket->impl = posix_socket;
     return AWS_OP_SUCCESS;
 }
 
@@ -1058,11 +1156,155 @@ int aws_socket_stop_accept(struct aws_socket *socket) {
     return ret_val;
 }
 
+static int s_set_udp_offload_options(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+
+#if USE_UDP_GSO
+    if (socket->options.udp_segment_size || socket_impl->udp_gso_enabled) {
+        int segment_size = socket->options.udp_segment_size;
+        if (setsockopt(socket->io_handle.data.fd, IPPROTO_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size))) {
+            int error = errno;
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for UDP_SEGMENT failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                error);
+            return aws_raise_error(
+                error == ENOPROTOOPT ? AWS_ERROR_UNSUPPORTED_OPERATION : AWS_IO_SOCKET_INVALID_OPTIONS);
+        }
+
+        socket_impl->udp_gso_enabled = segment_size != 0;
+    }
+#else
+    if (socket->options.udp_segment_size) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: UDP segmentation offload is not supported on this platform.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+#endif
+
+#if USE_UDP_GRO
+    if (socket->options.udp_gro != socket_impl->udp_gro_enabled) {
+        int gro = socket->options.udp_gro;
+        if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, IPPROTO_UDP, UDP_GRO, &gro, sizeof(gro)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for UDP_GRO failed with errno %d, datagrams will be read one at a time.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        } else {
+            socket_impl->udp_gro_enabled = socket->options.udp_gro;
+        }
+    }
+#else
+    (void)socket_impl;
+#endif
+
+    return AWS_OP_SUCCESS;
+}
+
+/* the tuning options are best effort, like keep-alive, a socket the kernel won't tune still works. */
+static void s_set_int_option(struct aws_socket *socket, int level, int option, int value, const char *option_name) {
+    if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, level, option, &value, sizeof(value)))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for setting %s to %d failed with errno %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            option_name,
+            value,
+            errno);
+    }
+}
+
+static void s_set_tcp_tuning_options(struct aws_socket *socket) {
+    const struct aws_socket_options *options = &socket->options;
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (options->tcp_nodelay != socket_impl->tcp_nodelay_enabled) {
+        s_set_int_option(socket, IPPROTO_TCP, TCP_NODELAY, options->tcp_nodelay, "TCP_NODELAY");
+        socket_impl->tcp_nodelay_enabled = options->tcp_nodelay;
+    }
+
+#if defined(AWS_TCP_CORK)
+    /* switching it back off sends whatever is being held back right away. */
+    if (options->tcp_cork != socket_impl->tcp_cork_enabled) {
+        s_set_int_option(socket, IPPROTO_TCP, AWS_TCP_CORK, options->tcp_cork, "TCP_CORK");
+        socket_impl->tcp_cork_enabled = options->tcp_cork;
+    }
+#endif
+
+#if USE_TCP_QUICKACK
+    if (options->tcp_quickack) {
+        s_set_int_option(socket, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK");
+    }
+#endif
+
+#if defined(TCP_NOTSENT_LOWAT)
+    if (options->tcp_not_sent_low_watermark) {
+        s_set_int_option(
+            socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (int)options->tcp_not_sent_low_watermark, "TCP_NOTSENT_LOWAT");
+    }
+#endif
+
+#if defined(TCP_USER_TIMEOUT)
+    if (options->tcp_user_timeout_ms) {
+        s_set_int_option(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, (int)options->tcp_user_timeout_ms, "TCP_USER_TIMEOUT");
+    }
+#endif
+
+#if defined(TCP_CONGESTION)
+    size_t name_len = strnlen(options->tcp_congestion_control, sizeof(options->tcp_congestion_control));
+    if (name_len) {
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd,
+                IPPROTO_TCP,
+                TCP_CONGESTION,
+                options->tcp_congestion_control,
+                (socklen_t)name_len))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for setting TCP_CONGESTION to %.*s failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (int)name_len,
+                options->tcp_congestion_control,
+                errno);
+        }
+    }
+#endif
+}
+
+#if USE_TCP_QUICKACK
+/* quick ack mode only lasts until the kernel decides the connection is interactive again, so ask again. */
+static void s_rearm_quickack(struct aws_socket *socket) {
+    if (socket->options.tcp_quickack && socket->options.type == AWS_SOCKET_STREAM &&
+        socket->options.domain != AWS_SOCKET_LOCAL) {
+        int quickack = 1;
+        setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_QUICKACK, &quickack, sizeof(quickack));
+    }
+}
+#else
+static void s_rearm_quickack(struct aws_socket *socket) {
+    (void)socket;
+}
+#endif
+
 int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_options *options) {
     if (socket->options.domain != options->domain || socket->options.type != options->type) {
         return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
     }
 
+    if ((options->udp_segment_size || options->udp_gro) &&
+        (options->type != AWS_SOCKET_DGRAM || options->domain == AWS_SOCKET_LOCAL)) {
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
+    }
+
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET,
         "id=%p fd=%d: setting socket options to: keep-alive %d, keep idle %d, keep-alive interval %d, keep-alive probe "
@@ -1099,7 +1341,17 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
             errno);
     }
 
+    if (options->send_buffer_size) {
+        s_set_int_option(socket, SOL_SOCKET, SO_SNDBUF, (int)options->send_buffer_size, "SO_SNDBUF");
+    }
+
+    if (options->receive_buffer_size) {
+        s_set_int_option(socket, SOL_SOCKET, SO_RCVBUF, (int)options->receive_buffer_size, "SO_RCVBUF");
+    }
+
     if (options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL) {
+        s_set_tcp_tuning_options(socket);
+
         if (socket->options.keepalive) {
             int keep_alive = 1;
             if (AWS_UNLIKELY(
@@ -1149,17 +1401,50 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
                     errno);
             }
         }
+
+#if USE_ZEROCOPY
+        struct posix_socket *socket_impl = socket->impl;
+        if (socket->options.zero_copy_threshold && !socket_impl->zerocopy_supported) {
+            int zerocopy = 1;
+            if (AWS_UNLIKELY(
+                    setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_ZEROCOPY, &zerocopy, sizeof(zerocopy)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for enabling SO_ZEROCOPY failed with errno %d, writes will be copied.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            } else {
+                socket_impl->zerocopy_supported = true;
+            }
+        }
+#endif
+    }
+
+    if (options->type == AWS_SOCKET_DGRAM && options->domain != AWS_SOCKET_LOCAL) {
+        return s_set_udp_offload_options(socket);
     }
 
     return AWS_OP_SUCCESS;
 }
 
+/* Most write requests queued behind one another are coalesced into a single sendmsg(), up to this many. */
+#if defined(IOV_MAX) && IOV_MAX < 1024
+#    define MAX_WRITE_IOVECS IOV_MAX
+#else
+#    define MAX_WRITE_IOVECS 1024
+#endif
+
 struct write_request {
     struct aws_byte_cursor cursor_cpy;
     aws_socket_on_write_completed_fn *written_fn;
     void *write_user_data;
     struct aws_linked_list_node node;
     size_t original_buffer_len;
+    /* MSG_ZEROCOPY sends are numbered by the kernel, this request's data went out in the ones from first_id on. */
+    uint32_t zerocopy_first_id;
+    uint32_t zerocopy_send_count;
+    uint32_t zerocopy_sends_completed;
 };
 
 struct posix_socket_close_args {
@@ -1192,6 +1477,13 @@ static void s_close_task(struct aws_task *task, void *arg, enum aws_task_status
     aws_mutex_unlock(&close_args->mutex);
 }
 
+static void s_update_write_watermark(struct aws_socket *socket, bool notify);
+
+#if USE_ZEROCOPY
+static void s_process_zerocopy_completions(struct aws_socket *socket);
+static bool s_has_zerocopy_sends_in_flight(struct posix_socket *socket_impl);
+#endif
+
 int aws_socket_close(struct aws_socket *socket) {
     struct posix_socket *socket_impl = socket->impl;
     AWS_LOGF_DEBUG(AWS_LS_IO_SOCKET, "id=%p fd=%d: closing", (void *)socket, socket->io_handle.data.fd);
@@ -1241,7 +1533,10 @@ int aws_socket_close(struct aws_socket *socket) {
             } else {
                 int err_code = aws_event_loop_unsubscribe_from_io_events(socket->event_loop, &socket->io_handle);
 
+                /* the loop has let go of the handle either way, so it mustn't be unsubscribed again. */
                 if (err_code) {
+                    socket_impl->currently_subscribed = false;
+                    socket->event_loop = NULL;
                     return AWS_OP_ERR;
                 }
             }
@@ -1259,13 +1554,56 @@ int aws_socket_close(struct aws_socket *socket) {
         socket_impl->connect_args = NULL;
     }
 
+#if USE_ZEROCOPY
+    /* anything the kernel is already done with completes normally. */
+    if (aws_socket_is_open(socket) && !aws_linked_list_empty(&socket_impl->zerocopy_pending)) {
+        s_process_zerocopy_completions(socket);
+    }
+
+    /* the rest is still being sent straight out of the callers' buffers, which they're free to reuse as soon as the
+     * writes complete below. A graceful close would keep sending from them, so reset the connection instead: the
+     * kernel drops what it hasn't sent, and anything already in flight goes to a peer that discards it. */
+    if (aws_socket_is_open(socket) && s_has_zerocopy_sends_in_flight(socket_impl)) {
+        struct linger linger = {.l_onoff = 1, .l_linger = 0};
+        if (setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_LINGER failed with errno %d, the kernel may keep sending from the "
+                "buffers of zero-copy writes that are being cancelled.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        } else {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: zero-copy writes still pending, resetting the connection",
+                (void *)socket,
+                socket->io_handle.data.fd);
+        }
+    }
+#endif
+
     if (aws_socket_is_open(socket)) {
         close(socket->io_handle.data.fd);
         socket->io_handle.data.fd = -1;
         socket->state = CLOSED;
 
         /* after close, just go ahead and clear out the pending writes queue
-         * and tell the user they were cancelled. */
+         * and tell the user they were cancelled. Requests waiting on a zero-copy completion were written
+         * before anything still in the queue, so they go first, and the reset above means the kernel no longer
+         * reads from their buffers. */
+        while (!aws_linked_list_empty(&socket_impl->zerocopy_pending)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->zerocopy_pending);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            write_request->written_fn(
+                socket, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len, write_request->write_user_data);
+            aws_mem_release(socket->allocator, write_request);
+        }
+
+        /* a closed socket doesn't become writable, so nobody is told. It just stops reporting itself blocked. */
+        socket_impl->pending_write_bytes = 0;
+        s_update_write_watermark(socket, false);
         while (!aws_linked_list_empty(&socket_impl->write_queue)) {
             struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_queue);
             struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
@@ -1297,6 +1635,48 @@ int aws_socket_shutdown_dir(struct aws_socket *socket, enum aws_channel_directio
     return AWS_OP_SUCCESS;
 }
 
+static bool s_wants_zerocopy(struct aws_socket *socket, const struct write_request *write_request) {
+#if USE_ZEROCOPY
+    struct posix_socket *socket_impl = socket->impl;
+    return socket_impl->zerocopy_supported && !socket_impl->zerocopy_disabled && socket->options.zero_copy_threshold &&
+           write_request->original_buffer_len >= socket->options.zero_copy_threshold;
+#else
+    (void)socket;
+    (void)write_request;
+    return false;
+#endif
+}
+
+/* Called after every change to pending_write_bytes. Blocks writes once the queue reaches the high watermark and
+ * unblocks them once it has drained to the low watermark, invoking on_writable for that if `notify` is set. */
+static void s_update_write_watermark(struct aws_socket *socket, bool notify) {
+    struct posix_socket *socket_impl = socket->impl;
+    if (!socket_impl->write_high_watermark) {
+        return;
+    }
+
+    if (!socket_impl->write_blocked && socket_impl->pending_write_bytes >= socket_impl->write_high_watermark) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: %llu bytes queued for writing, no longer writable",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (unsigned long long)socket_impl->pending_write_bytes);
+        socket_impl->write_blocked = true;
+    } else if (socket_impl->write_blocked && socket_impl->pending_write_bytes <= socket_impl->write_low_watermark) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: %llu bytes queued for writing, writable again",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (unsigned long long)socket_impl->pending_write_bytes);
+        socket_impl->write_blocked = false;
+        if (notify && socket_impl->on_writable) {
+            socket_impl->on_writable(socket, socket_impl->on_writable_user_data);
+        }
+    }
+}
+
 /* this gets called in two scenarios.
  * 1st scenario, someone called aws_socket_write() and we want to try writing now, so an error can be returned
  * immediately if something bad has happened to the socket. In this case, `parent_request` is set.
@@ -1332,21 +1712,78 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     int aws_error = AWS_OP_SUCCESS;
     bool parent_request_failed = false;
 
+    /* datagrams can't be coalesced, each write request has to go out as its own packet. */
+    size_t max_iovecs = socket->options.type == AWS_SOCKET_STREAM ? MAX_WRITE_IOVECS : 1;
+
     /* if a close call happens in the middle, this queue will have been cleaned out from under us. */
     while (!aws_linked_list_empty(&socket_impl->write_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
-        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+        struct iovec iovecs[MAX_WRITE_IOVECS];
+        size_t iovec_count = 0;
+        size_t bytes_queued = 0;
+        bool zerocopy = false;
+
+        /* gather as much of the queue as a single sendmsg() will take. A zero-copy request always goes out on its own,
+         * so that the kernel's completion notification for a send maps back to exactly one request. */
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_impl->write_queue);
+             node != aws_linked_list_end(&socket_impl->write_queue) && iovec_count < max_iovecs && !zerocopy;
+             node = aws_linked_list_next(node)) {
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+            if (s_wants_zerocopy(socket, write_request)) {
+                if (iovec_count) {
+                    break;
+                }
+                zerocopy = true;
+            }
+
+            iovecs[iovec_count].iov_base = write_request->cursor_cpy.ptr;
+            iovecs[iovec_count].iov_len = write_request->cursor_cpy.len;
+            bytes_queued += write_request->cursor_cpy.len;
+            iovec_count++;
+        }
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: dequeued write request of size %llu, remaining to write %llu",
+            "id=%p fd=%d: writing %llu bytes from %llu write requests",
             (void *)socket,
             socket->io_handle.data.fd,
-            (unsigned long long)write_request->original_buffer_len,
-            (unsigned long long)write_request->cursor_cpy.len);
+            (unsigned long long)bytes_queued,
+            (unsigned long long)iovec_count);
+
+        struct msghdr message;
+        AWS_ZERO_STRUCT(message);
+        message.msg_iov = iovecs;
+        message.msg_iovlen = iovec_count;
+
+        int send_flags = NO_SIGNAL;
+#if USE_ZEROCOPY
+        if (zerocopy) {
+            send_flags |= MSG_ZEROCOPY;
+        }
+#endif
+        ssize_t written = sendmsg(socket->io_handle.data.fd, &message, send_flags);
 
-        ssize_t written =
-            send(socket->io_handle.data.fd, write_request->cursor_cpy.ptr, write_request->cursor_cpy.len, NO_SIGNAL);
+#if USE_ZEROCOPY
+        if (zerocopy) {
+            if (written < 0 && errno == ENOBUFS) {
+                /* the pinned pages count against the socket's optmem limit, copy this one instead. */
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: out of zero-copy buffer space, copying write instead",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                written = sendmsg(socket->io_handle.data.fd, &message, NO_SIGNAL);
+            } else if (written > 0) {
+                /* every send that takes any data gets the next id, that's what comes back on the error queue. */
+                struct write_request *write_request = AWS_CONTAINER_OF(
+                    aws_linked_list_front(&socket_impl->write_queue), struct write_request, node);
+                if (!write_request->zerocopy_send_count) {
+                    write_request->zerocopy_first_id = socket_impl->zerocopy_next_id;
+                }
+                write_request->zerocopy_send_count++;
+                socket_impl->zerocopy_next_id++;
+            }
+        }
+#endif
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET,
@@ -1387,21 +1824,65 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
             break;
         }
 
-        size_t remaining_to_write = write_request->cursor_cpy.len;
+        /* pull every request the kernel took all of off the queue before telling anyone, since a completion
+         * callback is allowed to close the socket and purge the queue out from under us. */
+        struct aws_linked_list completed;
+        aws_linked_list_init(&completed);
 
-        aws_byte_cursor_advance(&write_request->cursor_cpy, (size_t)written);
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: remaining write request to write %llu",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (unsigned long long)write_request->cursor_cpy.len);
+        socket_impl->pending_write_bytes -= (size_t)written;
+        size_t remaining_written = (size_t)written;
+        while (!aws_linked_list_empty(&socket_impl->write_queue)) {
+            struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            if (write_request->cursor_cpy.len > remaining_written) {
+                aws_byte_cursor_advance(&write_request->cursor_cpy, remaining_written);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: remaining write request to write %llu",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    (unsigned long long)write_request->cursor_cpy.len);
+                break;
+            }
+
+            remaining_written -= write_request->cursor_cpy.len;
+            aws_byte_cursor_advance(&write_request->cursor_cpy, write_request->cursor_cpy.len);
+            aws_linked_list_remove(node);
+            aws_linked_list_push_back(&completed, node);
+        }
+
+        /* before any callback runs, so they all see the queue as it is now. Like them, on_writable can run from
+         * inside aws_socket_write(), and anything it writes is queued and goes out on this loop's next pass. */
+        s_update_write_watermark(socket, true);
+
+        while (!aws_linked_list_empty(&completed)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&completed);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            /* the kernel may still be reading out of this buffer, or out of one that was written before it. Either
+             * way the callback has to wait for the error queue to say so. */
+            if (write_request->zerocopy_send_count || !aws_linked_list_empty(&socket_impl->zerocopy_pending)) {
+                if (aws_socket_is_open(socket)) {
+                    AWS_LOGF_TRACE(
+                        AWS_LS_IO_SOCKET,
+                        "id=%p fd=%d: write request sent, waiting on zero-copy completion",
+                        (void *)socket,
+                        socket->io_handle.data.fd);
+                    aws_linked_list_push_back(&socket_impl->zerocopy_pending, node);
+                    continue;
+                }
+
+                /* an earlier callback closed the socket, which already cancelled everything that was pending. */
+                write_request->written_fn(
+                    socket, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len, write_request->write_user_data);
+                aws_mem_release(allocator, write_request);
+                continue;
+            }
 
-        if ((size_t)written == remaining_to_write) {
             AWS_LOGF_TRACE(
                 AWS_LS_IO_SOCKET, "id=%p fd=%d: write request completed", (void *)socket, socket->io_handle.data.fd);
 
-            aws_linked_list_remove(node);
             write_request->written_fn(
                 socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
             aws_mem_release(allocator, write_request);
@@ -1409,9 +1890,20 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     }
 
     if (purge) {
+        struct aws_linked_list purged;
+        aws_linked_list_init(&purged);
         while (!aws_linked_list_empty(&socket_impl->write_queue)) {
             struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->write_queue);
             struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+            socket_impl->pending_write_bytes -= write_request->cursor_cpy.len;
+            aws_linked_list_push_back(&purged, node);
+        }
+
+        s_update_write_watermark(socket, true);
+
+        while (!aws_linked_list_empty(&purged)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&purged);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
 
             /* If this fn was invoked directly from aws_socket_write(), don't invoke the error callback
              * as the user will be able to rely on the return value from aws_socket_write() */
@@ -1433,6 +1925,9 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
 
     if (socket_impl->clean_yourself_up) {
         aws_mem_release(allocator, socket_impl);
+    } else {
+        /* covers a write that blocked before anything went out, which the checks above never saw. */
+        s_update_write_watermark(socket, true);
     }
 
     /* Only report error if aws_socket_write() invoked this function and its write_request failed */
@@ -1444,43 +1939,164 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     return AWS_OP_ERR;
 }
 
-static void s_on_socket_io_event(
-    struct aws_event_loop *event_loop,
-    struct aws_io_handle *handle,
-    int events,
-    void *user_data) {
-    (void)event_loop;
-    (void)handle;
-    /* this is to handle a race condition when an error kicks off a cleanup, or the user decides
-     * to close the socket based on something they read (SSL validation failed for example).
-     * if clean_up happens when currently_in_event is true, socket_impl is kept dangling but currently
-     * subscribed is set to false. */
-    struct aws_socket *socket = user_data;
-    struct posix_socket *socket_impl = socket->impl;
-    struct aws_allocator *allocator = socket->allocator;
+#if USE_ZEROCOPY
+/* ids in [first_id, last_id] are done, that range can wrap around UINT32_MAX. */
+static void s_mark_zerocopy_sends_completed(struct posix_socket *socket_impl, uint32_t first_id, uint32_t last_id) {
+    uint32_t range_span = last_id - first_id;
 
-    socket_impl->currently_in_event = true;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_impl->zerocopy_pending);
+         node != aws_linked_list_end(&socket_impl->zerocopy_pending);
+         node = aws_linked_list_next(node)) {
+        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
 
-    if (events & AWS_IO_EVENT_TYPE_REMOTE_HANG_UP || events & AWS_IO_EVENT_TYPE_CLOSED) {
-        aws_raise_error(AWS_IO_SOCKET_CLOSED);
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: closed remotely", (void *)socket, socket->io_handle.data.fd);
-        if (socket->readable_fn) {
-            socket->readable_fn(socket, AWS_IO_SOCKET_CLOSED, socket->readable_user_data);
+        for (uint32_t i = 0; i < write_request->zerocopy_send_count; ++i) {
+            uint32_t id = write_request->zerocopy_first_id + i;
+            if ((uint32_t)(id - first_id) <= range_span) {
+                write_request->zerocopy_sends_completed++;
+            }
         }
-        goto end_check;
     }
+}
 
-    if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_ERROR) {
-        int aws_error = aws_socket_get_error(socket);
-        aws_raise_error(aws_error);
+/* whether the kernel may still be reading from a write request's buffer. Only the front of the write queue can have
+ * been partly sent. */
+static bool s_has_zerocopy_sends_in_flight(struct posix_socket *socket_impl) {
+    if (!aws_linked_list_empty(&socket_impl->zerocopy_pending)) {
+        return true;
+    }
+
+    if (aws_linked_list_empty(&socket_impl->write_queue)) {
+        return false;
+    }
+
+    struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
+    struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+    return write_request->zerocopy_sends_completed < write_request->zerocopy_send_count;
+}
+
+/* drains the zero-copy notifications off the socket's error queue, then completes, in order, every pending write
+ * request the kernel no longer needs. */
+static void s_process_zerocopy_completions(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+    struct aws_allocator *allocator = socket->allocator;
+
+    for (;;) {
+        uint8_t control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+        struct msghdr message;
+        AWS_ZERO_STRUCT(message);
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(socket->io_handle.data.fd, &message, MSG_ERRQUEUE) < 0) {
+            break;
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            bool is_ip_error = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                               (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!is_ip_error) {
+                continue;
+            }
+
+            struct sock_extended_err extended_error;
+            memcpy(&extended_error, CMSG_DATA(cmsg), sizeof(extended_error));
+            if (extended_error.ee_errno != 0 || extended_error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: zero-copy sends %u through %u completed",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (unsigned)extended_error.ee_info,
+                (unsigned)extended_error.ee_data);
+
+            /* the kernel had to copy the data anyway (loopback, or a device that can't do scatter/gather), so pinning
+             * pages only costs us. Stop asking for it on this socket. */
+            if (extended_error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED && !socket_impl->zerocopy_disabled) {
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: kernel copied a zero-copy send, disabling zero-copy writes",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                socket_impl->zerocopy_disabled = true;
+            }
+
+            s_mark_zerocopy_sends_completed(socket_impl, extended_error.ee_info, extended_error.ee_data);
+        }
+    }
+
+    /* if a callback closes the socket, the pending list gets cancelled out from under us. */
+    while (!aws_linked_list_empty(&socket_impl->zerocopy_pending)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->zerocopy_pending);
+        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+        if (write_request->zerocopy_sends_completed < write_request->zerocopy_send_count) {
+            break;
+        }
+
+        aws_linked_list_pop_front(&socket_impl->zerocopy_pending);
         AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET, "id=%p fd=%d: error event occurred", (void *)socket, socket->io_handle.data.fd);
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: write request completed", (void *)socket, socket->io_handle.data.fd);
+        write_request->written_fn(
+            socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
+        aws_mem_release(allocator, write_request);
+    }
+}
+#endif
+
+static void s_on_socket_io_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+    (void)event_loop;
+    (void)handle;
+    /* this is to handle a race condition when an error kicks off a cleanup, or the user decides
+     * to close the socket based on something they read (SSL validation failed for example).
+     * if clean_up happens when currently_in_event is true, socket_impl is kept dangling but currently
+     * subscribed is set to false. */
+    struct aws_socket *socket = user_data;
+    struct posix_socket *socket_impl = socket->impl;
+    struct aws_allocator *allocator = socket->allocator;
+
+    socket_impl->currently_in_event = true;
+
+    if (events & AWS_IO_EVENT_TYPE_REMOTE_HANG_UP || events & AWS_IO_EVENT_TYPE_CLOSED) {
+        aws_raise_error(AWS_IO_SOCKET_CLOSED);
+        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: closed remotely", (void *)socket, socket->io_handle.data.fd);
         if (socket->readable_fn) {
-            socket->readable_fn(socket, aws_error, socket->readable_user_data);
+            socket->readable_fn(socket, AWS_IO_SOCKET_CLOSED, socket->readable_user_data);
         }
         goto end_check;
     }
 
+    if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_ERROR) {
+        int aws_error = aws_socket_get_error(socket);
+        bool is_socket_error = true;
+#if USE_ZEROCOPY
+        /* zero-copy completions arrive on the error queue, which raises this event without anything being wrong. */
+        if (socket_impl->zerocopy_supported) {
+            s_process_zerocopy_completions(socket);
+            is_socket_error = aws_error != AWS_OP_SUCCESS;
+        }
+#endif
+        if (is_socket_error) {
+            if (!socket_impl->currently_subscribed) {
+                goto end_check;
+            }
+
+            aws_raise_error(aws_error);
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET, "id=%p fd=%d: error event occurred", (void *)socket, socket->io_handle.data.fd);
+            if (socket->readable_fn) {
+                socket->readable_fn(socket, aws_error, socket->readable_user_data);
+            }
+            goto end_check;
+        }
+    }
+
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_READABLE) {
         AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: is readable", (void *)socket, socket->io_handle.data.fd);
         if (socket->readable_fn) {
@@ -1602,6 +2218,7 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
     if (read_val > 0) {
         *amount_read = (size_t)read_val;
         buffer->len += *amount_read;
+        s_rearm_quickack(socket);
         return AWS_OP_SUCCESS;
     }
 
@@ -1638,6 +2255,124 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
     return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
 }
 
+/* aws_socket_read_vectored() fills at most this many buffers per call. */
+enum { MAX_READ_IOVECS = 64 };
+
+int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+
+    AWS_ASSERT(amount_read);
+    *amount_read = 0;
+
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot read from a different thread than event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!(socket->state & CONNECTED_READ)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot read because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (buffer_count > MAX_READ_IOVECS) {
+        buffer_count = MAX_READ_IOVECS;
+    }
+
+    struct iovec iovecs[MAX_READ_IOVECS];
+    size_t room = 0;
+    for (size_t i = 0; i < buffer_count; ++i) {
+        iovecs[i].iov_base = buffers[i]->buffer + buffers[i]->len;
+        iovecs[i].iov_len = buffers[i]->capacity - buffers[i]->len;
+        room += iovecs[i].iov_len;
+    }
+
+    ssize_t read_val = readv(socket->io_handle.data.fd, iovecs, (int)buffer_count);
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: read of %d into %d buffers",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (int)read_val,
+        (int)buffer_count);
+
+    if (read_val > 0) {
+        *amount_read = (size_t)read_val;
+        size_t remaining = *amount_read;
+        for (size_t i = 0; i < buffer_count && remaining; ++i) {
+            size_t filled = remaining < iovecs[i].iov_len ? remaining : iovecs[i].iov_len;
+            buffers[i]->len += filled;
+            remaining -= filled;
+        }
+        s_rearm_quickack(socket);
+        return AWS_OP_SUCCESS;
+    }
+
+    /* read_val of 0 means EOF which we'll treat as AWS_IO_SOCKET_CLOSED */
+    if (read_val == 0) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: zero read, socket is closed", (void *)socket, socket->io_handle.data.fd);
+
+        if (room > 0) {
+            return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+        }
+
+        return AWS_OP_SUCCESS;
+    }
+
+    int error = errno;
+
+    if (error == EAGAIN) {
+        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: read would block", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+    }
+
+    if (error == EPIPE) {
+        AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket is closed.", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    if (error == ETIMEDOUT) {
+        AWS_LOGF_ERROR(AWS_LS_IO_SOCKET, "id=%p fd=%d: socket timed out.", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_TIMEOUT);
+    }
+
+    return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+}
+
+static struct write_request *s_write_request_new(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursor,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    struct write_request *write_request = aws_mem_acquire(socket->allocator, sizeof(struct write_request));
+
+    if (!write_request) {
+        return NULL;
+    }
+
+    write_request->original_buffer_len = cursor->len;
+    write_request->written_fn = written_fn;
+    write_request->write_user_data = user_data;
+    write_request->cursor_cpy = *cursor;
+    write_request->zerocopy_first_id = 0;
+    write_request->zerocopy_send_count = 0;
+    write_request->zerocopy_sends_completed = 0;
+
+    return write_request;
+}
+
 int aws_socket_write(
     struct aws_socket *socket,
     const struct aws_byte_cursor *cursor,
@@ -1658,23 +2393,507 @@ int aws_socket_write(
 
     AWS_ASSERT(written_fn);
     struct posix_socket *socket_impl = socket->impl;
-    struct write_request *write_request = aws_mem_acquire(socket->allocator, sizeof(struct write_request));
+    struct write_request *write_request = s_write_request_new(socket, cursor, written_fn, user_data);
 
     if (!write_request) {
         return AWS_OP_ERR;
     }
 
-    write_request->original_buffer_len = cursor->len;
-    write_request->written_fn = written_fn;
-    write_request->write_user_data = user_data;
-    write_request->cursor_cpy = *cursor;
+    /* anything already queued is waiting on a writable event, since the last attempt would have blocked. Trying again
+     * now would just block again, so let the event flush this one along with the rest in a single write. */
+    bool is_backlogged = !aws_linked_list_empty(&socket_impl->write_queue);
     aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
+    socket_impl->pending_write_bytes += cursor->len;
 
-    /* avoid reentrancy when a user calls write after receiving their completion callback. */
-    if (!socket_impl->write_in_progress) {
+    /* avoid reentrancy when a user calls write after receiving their completion callback. The write may close the
+     * socket and clean it up, so it's not touched after this. */
+    if (!socket_impl->write_in_progress && !is_backlogged) {
         return s_process_write_requests(socket, write_request);
     }
 
+    s_update_write_watermark(socket, false);
+    return AWS_OP_SUCCESS;
+}
+
+/* only the last buffer of a vectored write reports back to the user */
+static void s_on_vectored_write_piece_completed(
+    struct aws_socket *socket,
+    int error_code,
+    size_t bytes_written,
+    void *user_data) {
+    (void)socket;
+    (void)error_code;
+    (void)bytes_written;
+    (void)user_data;
+}
+
+int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t cursor_count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot write to because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    AWS_ASSERT(written_fn);
+    if (cursor_count == 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* build every request before queueing any of them, so running out of memory can't leave half a write queued */
+    struct aws_linked_list requests;
+    aws_linked_list_init(&requests);
+    struct write_request *last_request = NULL;
+
+    for (size_t i = 0; i < cursor_count; ++i) {
+        bool is_last = i + 1 == cursor_count;
+        last_request = s_write_request_new(
+            socket,
+            &cursors[i],
+            is_last ? written_fn : s_on_vectored_write_piece_completed,
+            is_last ? user_data : NULL);
+
+        if (!last_request) {
+            while (!aws_linked_list_empty(&requests)) {
+                struct aws_linked_list_node *node = aws_linked_list_pop_front(&requests);
+                aws_mem_release(socket->allocator, AWS_CONTAINER_OF(node, struct write_request, node));
+            }
+            return AWS_OP_ERR;
+        }
+
+        aws_linked_list_push_back(&requests, &last_request->node);
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    bool is_backlogged = !aws_linked_list_empty(&socket_impl->write_queue);
+    while (!aws_linked_list_empty(&requests)) {
+        aws_linked_list_push_back(&socket_impl->write_queue, aws_linked_list_pop_front(&requests));
+    }
+
+    for (size_t i = 0; i < cursor_count; ++i) {
+        socket_impl->pending_write_bytes += cursors[i].len;
+    }
+
+    /* the last request stands in for the whole write: if it fails right away, the error is returned instead of
+     * reported through written_fn. */
+    if (!socket_impl->write_in_progress && !is_backlogged) {
+        return s_process_write_requests(socket, last_request);
+    }
+
+    s_update_write_watermark(socket, false);
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_set_write_watermarks(
+    struct aws_socket *socket,
+    size_t low_watermark,
+    size_t high_watermark,
+    aws_socket_on_writable_fn *on_writable,
+    void *user_data) {
+
+    if (high_watermark && low_watermark >= high_watermark) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: setting write watermarks to low %llu, high %llu",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (unsigned long long)low_watermark,
+        (unsigned long long)high_watermark);
+
+    struct posix_socket *socket_impl = socket->impl;
+    socket_impl->write_low_watermark = low_watermark;
+    socket_impl->write_high_watermark = high_watermark;
+    socket_impl->on_writable = on_writable;
+    socket_impl->on_writable_user_data = user_data;
+    socket_impl->write_blocked = false;
+    s_update_write_watermark(socket, false);
+
+    return AWS_OP_SUCCESS;
+}
+
+bool aws_socket_is_writable(const struct aws_socket *socket) {
+    const struct posix_socket *socket_impl = socket->impl;
+    return !socket_impl->write_blocked;
+}
+
+size_t aws_socket_get_pending_write_bytes(const struct aws_socket *socket) {
+    const struct posix_socket *socket_impl = socket->impl;
+    return socket_impl->pending_write_bytes;
+}
+
+/* recvmmsg() and sendmmsg() are handed at most this many datagrams at a time, bigger batches take several calls. */
+enum { MAX_DATAGRAM_BATCH = 64 };
+
+#if USE_MMSG
+typedef struct mmsghdr datagram_header;
+
+static int s_recv_datagrams(int fd, datagram_header *headers, size_t count) {
+    return recvmmsg(fd, headers, (unsigned int)count, 0, NULL);
+}
+
+static int s_send_datagrams(int fd, datagram_header *headers, size_t count) {
+    return sendmmsg(fd, headers, (unsigned int)count, NO_SIGNAL);
+}
+#else
+/* laid out like struct mmsghdr, so the code above these doesn't care which one it's using. */
+typedef struct {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+} datagram_header;
+
+/* Like recvmmsg(): returns how many datagrams were read, or -1 with errno set if not even one was. */
+static int s_recv_datagrams(int fd, datagram_header *headers, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ssize_t read_val = recvmsg(fd, &headers[i].msg_hdr, 0);
+        if (read_val < 0) {
+            return i ? (int)i : -1;
+        }
+        headers[i].msg_len = (unsigned int)read_val;
+    }
+
+    return (int)count;
+}
+
+static int s_send_datagrams(int fd, datagram_header *headers, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        ssize_t written = sendmsg(fd, &headers[i].msg_hdr, NO_SIGNAL);
+        if (written < 0) {
+            return i ? (int)i : -1;
+        }
+        headers[i].msg_len = (unsigned int)written;
+    }
+
+    return (int)count;
+}
+#endif /* USE_MMSG */
+
+/* room for the one control message (the segment size) that goes along with a datagram, aligned like a cmsghdr. */
+union datagram_control {
+    size_t align;
+    uint8_t buffer[CMSG_SPACE(sizeof(int))];
+};
+
+static int s_check_datagram_io(struct aws_socket *socket, const char *operation) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot %s datagrams from a different thread than event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            operation,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot %s datagrams on a stream socket",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            operation);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_address_to_endpoint(const struct sockaddr_storage *address, struct aws_socket_endpoint *endpoint) {
+    AWS_ZERO_STRUCT(*endpoint);
+
+    /* this came from the kernel, so inet_ntop() won't fail. */
+    if (address->ss_family == AF_INET) {
+        const struct sockaddr_in *addr_in = (const struct sockaddr_in *)address;
+        inet_ntop(AF_INET, &addr_in->sin_addr, endpoint->address, sizeof(endpoint->address));
+        endpoint->port = ntohs(addr_in->sin_port);
+    } else if (address->ss_family == AF_INET6) {
+        const struct sockaddr_in6 *addr_in6 = (const struct sockaddr_in6 *)address;
+        inet_ntop(AF_INET6, &addr_in6->sin6_addr, endpoint->address, sizeof(endpoint->address));
+        endpoint->port = ntohs(addr_in6->sin6_port);
+    }
+}
+
+static int s_endpoint_to_address(
+    struct aws_socket *socket,
+    const struct aws_socket_endpoint *endpoint,
+    struct socket_address *address,
+    socklen_t *address_len) {
+
+    AWS_ZERO_STRUCT(*address);
+    int pton_err = 1;
+    if (socket->options.domain == AWS_SOCKET_IPV4) {
+        pton_err = inet_pton(AF_INET, endpoint->address, &address->sock_addr_types.addr_in.sin_addr);
+        address->sock_addr_types.addr_in.sin_port = htons(endpoint->port);
+        address->sock_addr_types.addr_in.sin_family = AF_INET;
+        *address_len = sizeof(address->sock_addr_types.addr_in);
+    } else if (socket->options.domain == AWS_SOCKET_IPV6) {
+        pton_err = inet_pton(AF_INET6, endpoint->address, &address->sock_addr_types.addr_in6.sin6_addr);
+        address->sock_addr_types.addr_in6.sin6_port = htons(endpoint->port);
+        address->sock_addr_types.addr_in6.sin6_family = AF_INET6;
+        *address_len = sizeof(address->sock_addr_types.addr_in6);
+    } else {
+        return aws_raise_error(AWS_IO_SOCKET_UNSUPPORTED_ADDRESS_FAMILY);
+    }
+
+    if (pton_err != 1) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: failed to parse address %s:%d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            endpoint->address,
+            (int)endpoint->port);
+        return aws_raise_error(s_convert_pton_error(pton_err));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* The size the kernel cut a coalesced (UDP_GRO) read into, or the whole length for a single datagram. */
+static size_t s_read_segment_size(struct msghdr *header, size_t length) {
+#if USE_UDP_GRO
+    for (struct cmsghdr *control = CMSG_FIRSTHDR(header); control; control = CMSG_NXTHDR(header, control)) {
+        if (control->cmsg_level == IPPROTO_UDP && control->cmsg_type == UDP_GRO) {
+            int segment_size = 0;
+            memcpy(&segment_size, CMSG_DATA(control), sizeof(segment_size));
+            if (segment_size > 0 && (size_t)segment_size < length) {
+                return (size_t)segment_size;
+            }
+        }
+    }
+#else
+    (void)header;
+#endif
+
+    return length;
+}
+
+/* Attaches a UDP_SEGMENT control message to header, so the kernel splits the datagram into segment_size pieces. */
+static int s_write_segment_size(
+    struct aws_socket *socket,
+    struct msghdr *header,
+    union datagram_control *control_buffer,
+    size_t segment_size) {
+
+#if USE_UDP_GSO
+    (void)socket;
+    if (segment_size > UINT16_MAX) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    header->msg_control = control_buffer->buffer;
+    header->msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+
+    struct cmsghdr *control = CMSG_FIRSTHDR(header);
+    control->cmsg_level = IPPROTO_UDP;
+    control->cmsg_type = UDP_SEGMENT;
+    control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t size = (uint16_t)segment_size;
+    memcpy(CMSG_DATA(control), &size, sizeof(size));
+
+    return AWS_OP_SUCCESS;
+#else
+    (void)header;
+    (void)control_buffer;
+    (void)segment_size;
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: UDP segmentation offload is not supported on this platform.",
+        (void *)socket,
+        socket->io_handle.data.fd);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
+int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_read) {
+
+    AWS_ASSERT(datagrams_read);
+    *datagrams_read = 0;
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (s_check_datagram_io(socket, "read")) {
+        return AWS_OP_ERR;
+    }
+
+    if (!(socket->state & CONNECTED_READ)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot read because it is not bound or connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    while (*datagrams_read < datagram_count) {
+        struct aws_socket_datagram *batch = datagrams + *datagrams_read;
+        size_t batch_count = datagram_count - *datagrams_read;
+        if (batch_count > MAX_DATAGRAM_BATCH) {
+            batch_count = MAX_DATAGRAM_BATCH;
+        }
+
+        datagram_header headers[MAX_DATAGRAM_BATCH];
+        struct iovec iovecs[MAX_DATAGRAM_BATCH];
+        struct sockaddr_storage addresses[MAX_DATAGRAM_BATCH];
+        union datagram_control controls[MAX_DATAGRAM_BATCH];
+        AWS_ZERO_ARRAY(headers);
+
+        for (size_t i = 0; i < batch_count; ++i) {
+            struct aws_byte_buf *buffer = batch[i].buffer;
+            iovecs[i].iov_base = buffer->buffer + buffer->len;
+            iovecs[i].iov_len = buffer->capacity - buffer->len;
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+            headers[i].msg_hdr.msg_name = &addresses[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            if (socket_impl->udp_gro_enabled) {
+                headers[i].msg_hdr.msg_control = controls[i].buffer;
+                headers[i].msg_hdr.msg_controllen = sizeof(controls[i].buffer);
+            }
+        }
+
+        int read_count = s_recv_datagrams(socket->io_handle.data.fd, headers, batch_count);
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: read %d datagrams of %llu",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            read_count,
+            (unsigned long long)batch_count);
+
+        if (read_count < 0) {
+            int error = errno;
+            if (*datagrams_read) {
+                /* report what was read, the next read will hit the error again if it's still there. */
+                break;
+            }
+
+            if (error == EAGAIN) {
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_SOCKET, "id=%p fd=%d: read would block", (void *)socket, socket->io_handle.data.fd);
+                return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+            }
+
+            return aws_raise_error(s_determine_socket_error(error));
+        }
+
+        for (int i = 0; i < read_count; ++i) {
+            batch[i].buffer->len += headers[i].msg_len;
+            batch[i].truncated = (headers[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            batch[i].segment_size = s_read_segment_size(&headers[i].msg_hdr, headers[i].msg_len);
+            s_address_to_endpoint(&addresses[i], &batch[i].endpoint);
+        }
+
+        *datagrams_read += (size_t)read_count;
+        if ((size_t)read_count < batch_count) {
+            break;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_written) {
+
+    AWS_ASSERT(datagrams_written);
+    *datagrams_written = 0;
+
+    if (s_check_datagram_io(socket, "write")) {
+        return AWS_OP_ERR;
+    }
+
+    while (*datagrams_written < datagram_count) {
+        const struct aws_socket_datagram *batch = datagrams + *datagrams_written;
+        size_t batch_count = datagram_count - *datagrams_written;
+        if (batch_count > MAX_DATAGRAM_BATCH) {
+            batch_count = MAX_DATAGRAM_BATCH;
+        }
+
+        datagram_header headers[MAX_DATAGRAM_BATCH];
+        struct iovec iovecs[MAX_DATAGRAM_BATCH];
+        struct socket_address addresses[MAX_DATAGRAM_BATCH];
+        union datagram_control controls[MAX_DATAGRAM_BATCH];
+        AWS_ZERO_ARRAY(headers);
+        AWS_ZERO_ARRAY(controls);
+
+        for (size_t i = 0; i < batch_count; ++i) {
+            iovecs[i].iov_base = batch[i].buffer->buffer;
+            iovecs[i].iov_len = batch[i].buffer->len;
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+
+            if (batch[i].segment_size &&
+                s_write_segment_size(socket, &headers[i].msg_hdr, &controls[i], batch[i].segment_size)) {
+                return AWS_OP_ERR;
+            }
+
+            if (batch[i].endpoint.address[0]) {
+                socklen_t address_len = 0;
+                if (s_endpoint_to_address(socket, &batch[i].endpoint, &addresses[i], &address_len)) {
+                    return AWS_OP_ERR;
+                }
+                headers[i].msg_hdr.msg_name = &addresses[i].sock_addr_types;
+                headers[i].msg_hdr.msg_namelen = address_len;
+            } else if (!(socket->state & CONNECTED_WRITE)) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: cannot write a datagram without an endpoint because the socket is not connected",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+            }
+        }
+
+        int written_count = s_send_datagrams(socket->io_handle.data.fd, headers, batch_count);
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: wrote %d datagrams of %llu",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            written_count,
+            (unsigned long long)batch_count);
+
+        if (written_count < 0) {
+            int error = errno;
+            if (error == EAGAIN || *datagrams_written) {
+                /* the send buffer is full, or the error will come up again on the next write. */
+                break;
+            }
+
+            if (error == EPIPE) {
+                return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+            }
+
+            return aws_raise_error(s_determine_socket_error(error));
+        }
+
+        *datagrams_written += (size_t)written_count;
+        if ((size_t)written_count < batch_count) {
+            break;
+        }
+    }
+
     return AWS_OP_SUCCESS;
 }
 
@@ -25,6 +25,12 @@
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
+/* chains up to this long are gathered without allocating */
+enum { MAX_LOCAL_CHAIN_CURSORS = 16 };
+
+/* a datagram handler sends at most this many datagrams per aws_socket_write_datagrams() call */
+enum { MAX_DATAGRAMS_PER_WRITE = 64 };
+
 struct socket_handler {
     struct aws_socket *socket;
     struct aws_channel_slot *slot;
@@ -33,6 +39,25 @@ struct socket_handler {
     struct aws_channel_task shutdown_task_storage;
     int shutdown_err_code;
     bool shutdown_in_progress;
+    /* the messages a single read fills, max_messages_per_read (max_datagrams_per_read for datagram handlers) of them,
+     * allocated along with the handler */
+    struct aws_io_message **read_messages;
+
+    /* only used by stream handlers. */
+    size_t max_messages_per_read;
+    struct aws_byte_buf **read_buffers;
+
+    /* the rest is only used by datagram handlers, see aws_socket_handler_new_datagram(). */
+    bool is_datagram;
+    size_t max_datagram_size;
+    size_t max_datagrams_per_read;
+    struct aws_socket_datagram *read_datagrams;
+    /* messages written since the last flush, linked through queueing_handle */
+    struct aws_linked_list pending_datagrams;
+    struct aws_channel_task write_task_storage;
+    /* datagrams that didn't fit in the send buffer go through aws_socket_write(), which waits for it to drain. Until
+     * they're all out, everything else follows them, to keep datagrams in the order they were written. */
+    size_t queued_socket_writes;
 };
 
 static int s_socket_process_read_message(
@@ -73,11 +98,16 @@ static void s_on_socket_write_complete(
             (unsigned long long)amount_written,
             (void *)channel);
 
-        if (message->on_completion) {
-            message->on_completion(channel, message, error_code, message->user_data);
-        }
+        /* a chain went out as a single write, so all of it is done now */
+        while (message) {
+            struct aws_io_message *next = message->next_in_chain;
+            if (message->on_completion) {
+                message->on_completion(channel, message, error_code, message->user_data);
+            }
 
-        aws_mem_release(message->allocator, message);
+            aws_mem_release(message->allocator, message);
+            message = next;
+        }
 
         if (error_code) {
             aws_channel_shutdown(channel, error_code);
@@ -98,24 +128,224 @@ static int s_socket_process_write_message(
         (void *)handler,
         (unsigned long long)message->message_data.len);
 
+    if (!message->next_in_chain) {
+        struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&message->message_data);
+        if (aws_socket_write(socket_handler->socket, &cursor, s_on_socket_write_complete, message)) {
+            return AWS_OP_ERR;
+        }
+
+        return AWS_OP_SUCCESS;
+    }
+
+    /* headers and payloads chained by the handlers above go out in one gathered write, without being copied
+     * together first. */
+    size_t chain_length = 0;
+    for (struct aws_io_message *iter = message; iter; iter = iter->next_in_chain) {
+        ++chain_length;
+    }
+
+    struct aws_byte_cursor local_cursors[MAX_LOCAL_CHAIN_CURSORS];
+    struct aws_byte_cursor *cursors = local_cursors;
+    if (chain_length > MAX_LOCAL_CHAIN_CURSORS) {
+        cursors = aws_mem_acquire(handler->alloc, chain_length * sizeof(struct aws_byte_cursor));
+        if (!cursors) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    size_t cursor_index = 0;
+    for (struct aws_io_message *iter = message; iter; iter = iter->next_in_chain) {
+        cursors[cursor_index++] = aws_byte_cursor_from_buf(&iter->message_data);
+    }
+
+    int result = aws_socket_write_vectored(
+        socket_handler->socket, cursors, chain_length, s_on_socket_write_complete, message);
+
+    if (cursors != local_cursors) {
+        aws_mem_release(handler->alloc, cursors);
+    }
+
+    return result;
+}
+
+static void s_complete_datagram(struct aws_io_message *message, int error_code) {
+    if (message->on_completion) {
+        message->on_completion(message->owning_channel, message, error_code, message->user_data);
+    }
+
+    aws_mem_release(message->allocator, message);
+}
+
+static void s_fail_pending_datagrams(struct socket_handler *socket_handler, int error_code) {
+    while (!aws_linked_list_empty(&socket_handler->pending_datagrams)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_handler->pending_datagrams);
+        s_complete_datagram(AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle), error_code);
+    }
+}
+
+/* user data for a datagram that went through aws_socket_write() */
+struct queued_datagram_write {
+    struct socket_handler *socket_handler;
+    struct aws_io_message *message;
+};
+
+static void s_on_queued_datagram_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)socket;
+    (void)amount_written;
+
+    struct queued_datagram_write *write = user_data;
+    struct socket_handler *socket_handler = write->socket_handler;
+    struct aws_io_message *message = write->message;
+    aws_mem_release(socket_handler->slot->handler->alloc, write);
+
+    socket_handler->queued_socket_writes--;
+
+    struct aws_channel *channel = message->owning_channel;
+    s_complete_datagram(message, error_code);
+
+    if (error_code) {
+        aws_channel_shutdown(channel, error_code);
+    }
+}
+
+static int s_queue_datagram_on_socket(struct socket_handler *socket_handler, struct aws_io_message *message) {
+    struct aws_allocator *alloc = socket_handler->slot->handler->alloc;
+    struct queued_datagram_write *write = aws_mem_acquire(alloc, sizeof(struct queued_datagram_write));
+    if (!write) {
+        return AWS_OP_ERR;
+    }
+
+    write->socket_handler = socket_handler;
+    write->message = message;
+
+    /* counted first, the write may well complete before aws_socket_write() returns. */
+    socket_handler->queued_socket_writes++;
+
     struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&message->message_data);
-    if (aws_socket_write(socket_handler->socket, &cursor, s_on_socket_write_complete, message)) {
+    if (aws_socket_write(socket_handler->socket, &cursor, s_on_queued_datagram_written, write)) {
+        socket_handler->queued_socket_writes--;
+        aws_mem_release(alloc, write);
         return AWS_OP_ERR;
     }
 
     return AWS_OP_SUCCESS;
 }
 
+/* Sends everything written since the last flush, as few system calls as aws_socket_write_datagrams() can manage. */
+static void s_write_datagrams_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
+    task->task_fn = NULL;
+    task->arg = NULL;
+
+    struct socket_handler *socket_handler = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        s_fail_pending_datagrams(socket_handler, AWS_ERROR_IO_OPERATION_CANCELLED);
+        return;
+    }
+
+    while (!aws_linked_list_empty(&socket_handler->pending_datagrams)) {
+        struct aws_socket_datagram datagrams[MAX_DATAGRAMS_PER_WRITE];
+        struct aws_io_message *messages[MAX_DATAGRAMS_PER_WRITE];
+        size_t count = 0;
+
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_handler->pending_datagrams);
+             node != aws_linked_list_end(&socket_handler->pending_datagrams) && count < MAX_DATAGRAMS_PER_WRITE;
+             node = aws_linked_list_next(node)) {
+            messages[count] = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+            AWS_ZERO_STRUCT(datagrams[count]);
+            datagrams[count].buffer = &messages[count]->message_data;
+            ++count;
+        }
+
+        size_t written = 0;
+        if (aws_socket_write_datagrams(socket_handler->socket, datagrams, count, &written)) {
+            int error_code = aws_last_error();
+            s_fail_pending_datagrams(socket_handler, error_code);
+            aws_channel_shutdown(socket_handler->slot->channel, error_code);
+            return;
+        }
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET_HANDLER,
+            "id=%p: wrote %llu of %llu datagrams",
+            (void *)socket_handler->slot->handler,
+            (unsigned long long)written,
+            (unsigned long long)count);
+
+        /* off the list before any callbacks run, one of them may shut the channel down and fail what's pending. */
+        for (size_t i = 0; i < written; ++i) {
+            aws_linked_list_remove(&messages[i]->queueing_handle);
+        }
+
+        for (size_t i = 0; i < written; ++i) {
+            s_complete_datagram(messages[i], AWS_ERROR_SUCCESS);
+        }
+
+        if (written < count) {
+            /* the send buffer is full. The socket's write queue waits for it to drain, so let it take the rest. */
+            while (!aws_linked_list_empty(&socket_handler->pending_datagrams)) {
+                struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_handler->pending_datagrams);
+                struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+                if (s_queue_datagram_on_socket(socket_handler, message)) {
+                    int error_code = aws_last_error();
+                    s_complete_datagram(message, error_code);
+                    s_fail_pending_datagrams(socket_handler, error_code);
+                    aws_channel_shutdown(socket_handler->slot->channel, error_code);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static int s_datagram_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    struct socket_handler *socket_handler = handler->impl;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: writing datagram of size %llu",
+        (void *)handler,
+        (unsigned long long)message->message_data.len);
+
+    if (socket_handler->queued_socket_writes) {
+        return s_queue_datagram_on_socket(socket_handler, message);
+    }
+
+    /* everything written on this tick goes out together once the tick's other tasks are done. */
+    aws_linked_list_push_back(&socket_handler->pending_datagrams, &message->queueing_handle);
+    if (!socket_handler->write_task_storage.task_fn) {
+        aws_channel_task_init(&socket_handler->write_task_storage, s_write_datagrams_task, socket_handler);
+        aws_channel_schedule_task_now(slot->channel, &socket_handler->write_task_storage);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_status status);
 
 static void s_on_readable_notification(struct aws_socket *socket, int error_code, void *user_data);
 
+/* releases read_messages[first] up to (not including) read_messages[end], which weren't sent anywhere. */
+static void s_release_read_messages(struct socket_handler *socket_handler, size_t first, size_t end) {
+    for (size_t i = first; i < end; ++i) {
+        struct aws_io_message *message = socket_handler->read_messages[i];
+        aws_mem_release(message->allocator, message);
+    }
+}
+
 /* Ok this next function is VERY important for how back pressure works. Here's what it's supposed to be doing:
  *
  * See how much data downstream is willing to accept.
  * See how much we're actually willing to read per event loop tick (usually 16 kb).
  * Take the minimum of those two.
- * Try and read as much as possible up to the calculated max read.
+ * Try and read as much as possible up to the calculated max read, filling up to max_messages_per_read messages with
+ * each read system call.
  * If we didn't read up to the max_read, we go back to waiting on the event loop to tell us we can read more.
  * If we did read up to the max_read, we stop reading immediately and wait for either for a window update,
  * or schedule a task to enforce fairness for other sockets in the event loop if we read up to the max
@@ -143,27 +373,56 @@ static void s_do_read(struct socket_handler *socket_handler) {
     while (total_read < max_to_read && !socket_handler->shutdown_in_progress) {
         size_t iter_max_read = max_to_read - total_read;
 
-        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
-            socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, iter_max_read);
+        /* as many messages as it takes to cover the rest of max_to_read, up to max_messages_per_read, all filled by
+         * one read. */
+        size_t acquired = 0;
+        size_t capacity = 0;
+        while (acquired < socket_handler->max_messages_per_read && capacity < iter_max_read) {
+            struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+                socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, iter_max_read - capacity);
 
-        if (!message) {
+            if (!message) {
+                break;
+            }
+
+            socket_handler->read_messages[acquired] = message;
+            socket_handler->read_buffers[acquired] = &message->message_data;
+            capacity += message->message_data.capacity;
+            ++acquired;
+        }
+
+        if (!acquired) {
             break;
         }
 
-        if (aws_socket_read(socket_handler->socket, &message->message_data, &read)) {
-            aws_mem_release(message->allocator, message);
+        if (aws_socket_read_vectored(socket_handler->socket, socket_handler->read_buffers, acquired, &read)) {
+            s_release_read_messages(socket_handler, 0, acquired);
             break;
         }
 
         total_read += read;
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET_HANDLER,
-            "id=%p: read %llu from socket",
+            "id=%p: read %llu from socket into %llu messages",
             (void *)socket_handler->slot->handler,
-            (unsigned long long)read);
+            (unsigned long long)read,
+            (unsigned long long)acquired);
+
+        /* the read fills the messages in order, so the ones with data come first. */
+        size_t next = 0;
+        bool send_failed = false;
+        while (next < acquired && socket_handler->read_messages[next]->message_data.len &&
+               !socket_handler->shutdown_in_progress) {
+            struct aws_io_message *message = socket_handler->read_messages[next++];
+            if (aws_channel_slot_send_message(socket_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
+                aws_mem_release(message->allocator, message);
+                send_failed = true;
+                break;
+            }
+        }
 
-        if (aws_channel_slot_send_message(socket_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
-            aws_mem_release(message->allocator, message);
+        s_release_read_messages(socket_handler, next, acquired);
+        if (send_failed) {
             break;
         }
     }
@@ -204,6 +463,112 @@ static void s_do_read(struct socket_handler *socket_handler) {
     }
 }
 
+/* Datagram handlers' s_do_read(). A datagram can't be split across messages, so it only reads as many as are sure to
+ * fit the downstream window, each into its own message, and all of them with one aws_socket_read_datagrams(). */
+static void s_do_read_datagrams(struct socket_handler *socket_handler) {
+    size_t downstream_window = aws_channel_slot_downstream_read_window(socket_handler->slot);
+    size_t max_datagrams = downstream_window / socket_handler->max_datagram_size;
+    if (max_datagrams > socket_handler->max_datagrams_per_read) {
+        max_datagrams = socket_handler->max_datagrams_per_read;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: invoking datagram read. Downstream window %llu, max datagrams %llu",
+        (void *)socket_handler->slot->handler,
+        (unsigned long long)downstream_window,
+        (unsigned long long)max_datagrams);
+
+    if (max_datagrams == 0 || socket_handler->shutdown_in_progress) {
+        return;
+    }
+
+    size_t acquired = 0;
+    for (; acquired < max_datagrams; ++acquired) {
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, socket_handler->max_datagram_size);
+        if (!message) {
+            break;
+        }
+
+        socket_handler->read_messages[acquired] = message;
+        AWS_ZERO_STRUCT(socket_handler->read_datagrams[acquired]);
+        socket_handler->read_datagrams[acquired].buffer = &message->message_data;
+    }
+
+    size_t read = 0;
+    int read_error = AWS_ERROR_SUCCESS;
+    if (acquired == 0) {
+        read_error = aws_last_error();
+    } else if (aws_socket_read_datagrams(socket_handler->socket, socket_handler->read_datagrams, acquired, &read)) {
+        read_error = aws_last_error();
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: read %llu datagrams from socket",
+        (void *)socket_handler->slot->handler,
+        (unsigned long long)read);
+
+    size_t next = 0;
+    for (; next < read && !socket_handler->shutdown_in_progress; ++next) {
+        struct aws_io_message *message = socket_handler->read_messages[next];
+
+        if (socket_handler->read_datagrams[next].truncated) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET_HANDLER,
+                "id=%p: dropping a datagram larger than the %llu bytes there was room for",
+                (void *)socket_handler->slot->handler,
+                (unsigned long long)message->message_data.capacity);
+            aws_mem_release(message->allocator, message);
+            continue;
+        }
+
+        if (aws_channel_slot_send_message(socket_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
+            aws_mem_release(message->allocator, message);
+            ++next;
+            break;
+        }
+    }
+
+    /* whatever wasn't read into, or was read after the channel started shutting down. */
+    s_release_read_messages(socket_handler, next, acquired);
+
+    if (read_error) {
+        if (read_error != AWS_IO_READ_WOULD_BLOCK && !socket_handler->shutdown_in_progress) {
+            aws_channel_shutdown(socket_handler->slot->channel, read_error);
+        }
+        return;
+    }
+
+    /* a short read means the socket is drained, and the next datagram comes with a readable notification. Otherwise
+     * there may be more waiting, so come back for it on the next tick to be fair to the loop's other sockets. */
+    if (read == acquired && !socket_handler->shutdown_in_progress && !socket_handler->read_task_storage.task_fn) {
+        aws_channel_task_init(&socket_handler->read_task_storage, s_read_task, socket_handler);
+        aws_channel_schedule_task_now(socket_handler->slot->channel, &socket_handler->read_task_storage);
+    }
+}
+
+static void s_read(struct socket_handler *socket_handler) {
+    /* whatever is read goes straight into the next handler, so that's who a stall report should name. */
+    struct aws_channel_slot *next_slot = socket_handler->slot->adj_right;
+    aws_event_loop_inner_fn *read_fn = NULL;
+    if (next_slot && next_slot->handler) {
+        read_fn = (aws_event_loop_inner_fn *)next_slot->handler->vtable->process_read_message;
+    }
+
+    struct aws_event_loop *loop = socket_handler->socket->event_loop;
+    aws_event_loop_inner_fn *previous_fn = aws_event_loop_set_current_inner_fn(loop, read_fn);
+
+    if (socket_handler->is_datagram) {
+        s_do_read_datagrams(socket_handler);
+    } else {
+        s_do_read(socket_handler);
+    }
+
+    aws_event_loop_set_current_inner_fn(loop, previous_fn);
+}
+
 /* the socket is either readable or errored out. If it's readable, kick off s_do_read() to do its thing.
  * If an error, start the channel shutdown process. */
 static void s_on_readable_notification(struct aws_socket *socket, int error_code, void *user_data) {
@@ -216,7 +581,7 @@ static void s_on_readable_notification(struct aws_socket *socket, int error_code
      * then immediately closes the socket. On some platforms, we'll never see the readable flag. So we want to make
      * sure we read the ALERT, otherwise, we'll end up telling the user that the channel shutdown because of a socket
      * closure, when in reality it was a TLS error */
-    s_do_read(socket_handler);
+    s_read(socket_handler);
 
     if (error_code && !socket_handler->shutdown_in_progress) {
         aws_channel_shutdown(socket_handler->slot->channel, error_code);
@@ -230,7 +595,7 @@ static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_statu
 
     if (status == AWS_TASK_STATUS_RUN_READY) {
         struct socket_handler *socket_handler = arg;
-        s_do_read(socket_handler);
+        s_read(socket_handler);
     }
 }
 
@@ -300,6 +665,10 @@ static int s_socket_shutdown(
         "id=%p: shutting down write direction with error_code %d",
         (void *)handler,
         error_code);
+    if (socket_handler->is_datagram) {
+        s_fail_pending_datagrams(socket_handler, AWS_IO_SOCKET_CLOSED);
+    }
+
     if (aws_socket_is_open(socket_handler->socket)) {
         aws_socket_close(socket_handler->socket);
     }
@@ -324,6 +693,23 @@ static size_t s_socket_initial_window_size(struct aws_channel_handler *handler)
     return SIZE_MAX;
 }
 
+/* the socket's write queue drained down to its low watermark, let the handlers that were holding off know. */
+static void s_on_socket_writable(struct aws_socket *socket, void *user_data) {
+    (void)socket;
+
+    struct socket_handler *socket_handler = user_data;
+    AWS_LOGF_TRACE(AWS_LS_IO_SOCKET_HANDLER, "id=%p: socket is writable again", (void *)socket_handler->slot->handler);
+
+    if (!socket_handler->shutdown_in_progress) {
+        aws_channel_slot_on_writable(socket_handler->slot);
+    }
+}
+
+static bool s_socket_is_writable(struct aws_channel_handler *handler) {
+    struct socket_handler *socket_handler = handler->impl;
+    return aws_socket_is_writable(socket_handler->socket);
+}
+
 static void s_socket_destroy(struct aws_channel_handler *handler) {
     aws_mem_release(handler->alloc, handler);
 }
@@ -336,6 +722,19 @@ static struct aws_channel_handler_vtable s_vtable = {
     .increment_read_window = s_socket_increment_read_window,
     .shutdown = s_socket_shutdown,
     .message_overhead = s_message_overhead,
+    .accepts_message_chains = true,
+    .is_writable = s_socket_is_writable,
+};
+
+static struct aws_channel_handler_vtable s_datagram_vtable = {
+    .process_read_message = s_socket_process_read_message,
+    .destroy = s_socket_destroy,
+    .process_write_message = s_datagram_process_write_message,
+    .initial_window_size = s_socket_initial_window_size,
+    .increment_read_window = s_socket_increment_read_window,
+    .shutdown = s_socket_shutdown,
+    .message_overhead = s_message_overhead,
+    .is_writable = s_socket_is_writable,
 };
 
 struct aws_channel_handler *aws_socket_handler_new(
@@ -344,43 +743,159 @@ struct aws_channel_handler *aws_socket_handler_new(
     struct aws_channel_slot *slot,
     size_t max_read_size) {
 
+    struct aws_socket_handler_options options = {
+        .max_read_size = max_read_size,
+        .max_messages_per_read = 1,
+    };
+
+    return aws_socket_handler_new_with_options(allocator, socket, slot, &options);
+}
+
+struct aws_channel_handler *aws_socket_handler_new_with_options(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    const struct aws_socket_handler_options *options) {
+
     /* make sure something has assigned this socket to an event loop, in client mode this will already have occurred.
        In server mode, someone should have assigned it before calling us.*/
     AWS_ASSERT(aws_socket_get_event_loop(socket));
 
-    struct aws_channel_handler *handler = NULL;
+    size_t max_messages_per_read = options->max_messages_per_read ? options->max_messages_per_read : 1;
 
+    struct aws_channel_handler *handler = NULL;
     struct socket_handler *impl = NULL;
+    struct aws_io_message **read_messages = NULL;
+    struct aws_byte_buf **read_buffers = NULL;
 
     if (!aws_mem_acquire_many(
-            allocator, 2, &handler, sizeof(struct aws_channel_handler), &impl, sizeof(struct socket_handler))) {
+            allocator,
+            4,
+            &handler,
+            sizeof(struct aws_channel_handler),
+            &impl,
+            sizeof(struct socket_handler),
+            &read_messages,
+            sizeof(struct aws_io_message *) * max_messages_per_read,
+            &read_buffers,
+            sizeof(struct aws_byte_buf *) * max_messages_per_read)) {
         return NULL;
     }
 
+    AWS_ZERO_STRUCT(*impl);
     impl->socket = socket;
     impl->slot = slot;
-    impl->max_rw_size = max_read_size;
-    AWS_ZERO_STRUCT(impl->read_task_storage);
-    AWS_ZERO_STRUCT(impl->shutdown_task_storage);
-    impl->shutdown_in_progress = false;
+    impl->max_rw_size = options->max_read_size;
+    impl->max_messages_per_read = max_messages_per_read;
+    impl->read_messages = read_messages;
+    impl->read_buffers = read_buffers;
 
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET_HANDLER,
-        "id=%p: Socket handler created with max_read_size of %llu",
+        "id=%p: Socket handler created with max_read_size of %llu, filling up to %llu messages per read",
         (void *)handler,
-        (unsigned long long)max_read_size);
+        (unsigned long long)options->max_read_size,
+        (unsigned long long)max_messages_per_read);
 
     handler->alloc = allocator;
     handler->impl = impl;
     handler->vtable = &s_vtable;
-    if (aws_socket_subscribe_to_readable_events(socket, s_on_readable_notification, impl)) {
+
+    if (options->write_high_watermark &&
+        aws_socket_set_write_watermarks(
+            socket, options->write_low_watermark, options->write_high_watermark, s_on_socket_writable, impl)) {
         goto cleanup_handler;
     }
 
+    if (aws_socket_subscribe_to_readable_events(socket, s_on_readable_notification, impl)) {
+        goto cleanup_watermarks;
+    }
+
     return handler;
 
+cleanup_watermarks:
+    /* the socket mustn't be left calling back into the handler freed below. */
+    if (options->write_high_watermark) {
+        aws_socket_set_write_watermarks(socket, 0, 0, NULL, NULL);
+    }
+
 cleanup_handler:
     aws_mem_release(allocator, handler);
 
     return NULL;
 }
+
+struct aws_channel_handler *aws_socket_handler_new_datagram(
+    struct aws_allocator *allocator,
+    struct aws_socket *socket,
+    struct aws_channel_slot *slot,
+    size_t max_datagram_size,
+    size_t max_datagrams_per_read) {
+
+    AWS_ASSERT(aws_socket_get_event_loop(socket));
+
+#ifdef _WIN32
+    /* winsock has no batched datagram io, aws_socket_read_datagrams() and aws_socket_write_datagrams() always fail. */
+    (void)allocator;
+    (void)slot;
+    (void)max_datagram_size;
+    (void)max_datagrams_per_read;
+    AWS_LOGF_ERROR(AWS_LS_IO_SOCKET_HANDLER, "static: datagram socket handlers aren't supported on this platform");
+    aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    return NULL;
+#else
+    /* a coalesced read would reach the next handler as one message, with nothing saying where its datagrams begin. */
+    if (socket->options.type != AWS_SOCKET_DGRAM || socket->options.udp_gro || max_datagram_size == 0 ||
+        max_datagrams_per_read == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_channel_handler *handler = NULL;
+    struct socket_handler *impl = NULL;
+    struct aws_io_message **read_messages = NULL;
+    struct aws_socket_datagram *read_datagrams = NULL;
+
+    if (!aws_mem_acquire_many(
+            allocator,
+            4,
+            &handler,
+            sizeof(struct aws_channel_handler),
+            &impl,
+            sizeof(struct socket_handler),
+            &read_messages,
+            sizeof(struct aws_io_message *) * max_datagrams_per_read,
+            &read_datagrams,
+            sizeof(struct aws_socket_datagram) * max_datagrams_per_read)) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    impl->socket = socket;
+    impl->slot = slot;
+    impl->max_rw_size = max_datagram_size * max_datagrams_per_read;
+    impl->is_datagram = true;
+    impl->max_datagram_size = max_datagram_size;
+    impl->max_datagrams_per_read = max_datagrams_per_read;
+    impl->read_messages = read_messages;
+    impl->read_datagrams = read_datagrams;
+    aws_linked_list_init(&impl->pending_datagrams);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: Datagram socket handler created, reading up to %llu datagrams of up to %llu bytes at a time",
+        (void *)handler,
+        (unsigned long long)max_datagrams_per_read,
+        (unsigned long long)max_datagram_size);
+
+    handler->alloc = allocator;
+    handler->impl = impl;
+    handler->vtable = &s_datagram_vtable;
+    if (aws_socket_subscribe_to_readable_events(socket, s_on_readable_notification, impl)) {
+        aws_mem_release(allocator, handler);
+        return NULL;
+    }
+
+    return handler;
+#endif /* _WIN32 */
+}
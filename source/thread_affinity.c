@@ -0,0 +1,225 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* cpu_set_t and pthread_{get,set}affinity_np */
+#    define _GNU_SOURCE
+#endif
+
+#include <aws/io/private/thread_affinity.h>
+
+#include <aws/common/system_info.h>
+
+#ifdef __linux__
+#    include <ctype.h>
+#    include <errno.h>
+#    include <pthread.h>
+#    include <sched.h>
+#    include <stdio.h>
+#    include <stdlib.h>
+#endif
+
+void aws_cpu_set_clear(struct aws_cpu_set *set) {
+    AWS_ZERO_STRUCT(*set);
+}
+
+int aws_cpu_set_add(struct aws_cpu_set *set, size_t cpu_id) {
+    if (cpu_id >= AWS_CPU_SET_MAX_CPUS) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    set->bits[cpu_id / 64] |= (uint64_t)1 << (cpu_id % 64);
+    return AWS_OP_SUCCESS;
+}
+
+bool aws_cpu_set_contains(const struct aws_cpu_set *set, size_t cpu_id) {
+    if (cpu_id >= AWS_CPU_SET_MAX_CPUS) {
+        return false;
+    }
+
+    return (set->bits[cpu_id / 64] >> (cpu_id % 64)) & 1;
+}
+
+size_t aws_cpu_set_count(const struct aws_cpu_set *set) {
+    size_t count = 0;
+    for (size_t i = 0; i < AWS_CPU_SET_MAX_CPUS; ++i) {
+        count += aws_cpu_set_contains(set, i);
+    }
+
+    return count;
+}
+
+bool aws_cpu_set_eq(const struct aws_cpu_set *a, const struct aws_cpu_set *b) {
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(a->bits); ++i) {
+        if (a->bits[i] != b->bits[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifdef __linux__
+
+int aws_thread_affinity_get_current(struct aws_cpu_set *set) {
+    cpu_set_t native;
+    CPU_ZERO(&native);
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(native), &native)) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    aws_cpu_set_clear(set);
+    for (size_t i = 0; i < CPU_SETSIZE && i < AWS_CPU_SET_MAX_CPUS; ++i) {
+        if (CPU_ISSET(i, &native)) {
+            aws_cpu_set_add(set, i);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_thread_affinity_set_current(const struct aws_cpu_set *set) {
+    cpu_set_t native;
+    CPU_ZERO(&native);
+
+    for (size_t i = 0; i < CPU_SETSIZE && i < AWS_CPU_SET_MAX_CPUS; ++i) {
+        if (aws_cpu_set_contains(set, i)) {
+            CPU_SET(i, &native);
+        }
+    }
+
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(native), &native);
+    if (err) {
+        /* EINVAL means none of the CPUs in the set exist or are allowed for this process. */
+        return aws_raise_error(err == EINVAL ? AWS_ERROR_INVALID_ARGUMENT : AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Parses the kernel's list format ("0-3,8,10-11\n") from path into set. Used for both node and CPU lists.
+ */
+static int s_read_id_list(const char *path, struct aws_cpu_set *set) {
+    aws_cpu_set_clear(set);
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    char line[4096];
+    bool read_line = fgets(line, sizeof(line), file) != NULL;
+    fclose(file);
+
+    if (!read_line) {
+        return aws_raise_error(AWS_IO_SYS_CALL_FAILURE);
+    }
+
+    char *cursor = line;
+    while (isdigit((unsigned char)*cursor)) {
+        unsigned long first = strtoul(cursor, &cursor, 10);
+        unsigned long last = first;
+
+        if (*cursor == '-') {
+            ++cursor;
+            last = strtoul(cursor, &cursor, 10);
+        }
+
+        for (unsigned long id = first; id <= last && id < AWS_CPU_SET_MAX_CPUS; ++id) {
+            aws_cpu_set_add(set, id);
+        }
+
+        if (*cursor == ',') {
+            ++cursor;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Node ids can have gaps, so the index'th online node isn't necessarily node<index>. */
+static bool s_find_online_node(size_t node_index, size_t *node_id) {
+    struct aws_cpu_set nodes;
+    if (s_read_id_list("/sys/devices/system/node/online", &nodes)) {
+        return false;
+    }
+
+    size_t seen = 0;
+    for (size_t id = 0; id < AWS_CPU_SET_MAX_CPUS; ++id) {
+        if (aws_cpu_set_contains(&nodes, id) && seen++ == node_index) {
+            *node_id = id;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t aws_numa_node_count(void) {
+    struct aws_cpu_set nodes;
+    if (s_read_id_list("/sys/devices/system/node/online", &nodes)) {
+        /* no NUMA support in the kernel, everything is one node. */
+        aws_reset_error();
+        return 1;
+    }
+
+    size_t count = aws_cpu_set_count(&nodes);
+    return count ? count : 1;
+}
+
+int aws_numa_node_get_cpus(size_t node_index, struct aws_cpu_set *set) {
+    size_t node_id = 0;
+    if (!s_find_online_node(node_index, &node_id)) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node_id);
+    return s_read_id_list(path, set);
+}
+
+#else
+
+int aws_thread_affinity_get_current(struct aws_cpu_set *set) {
+    (void)set;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_thread_affinity_set_current(const struct aws_cpu_set *set) {
+    (void)set;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+size_t aws_numa_node_count(void) {
+    return 1;
+}
+
+int aws_numa_node_get_cpus(size_t node_index, struct aws_cpu_set *set) {
+    if (node_index != 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    aws_cpu_set_clear(set);
+    size_t processor_count = aws_system_info_processor_count();
+    for (size_t i = 0; i < processor_count && i < AWS_CPU_SET_MAX_CPUS; ++i) {
+        aws_cpu_set_add(set, i);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/timing_wheel.h>
+
+#include <aws/common/task_scheduler.h>
+
+#include <string.h>
+
+/* a task on the wheel carries the wheel's address in task->reserved, which aws_task_init() zeroes and the task
+ * scheduler doesn't look at while the task is out here. An address can't be mistaken for anything the scheduler
+ * might leave there, and it tells this wheel's tasks apart from another loop's. */
+static bool s_is_on_wheel(const struct aws_timing_wheel *wheel, const struct aws_task *task) {
+    return task->reserved == (size_t)(uintptr_t)wheel;
+}
+
+static size_t s_lowest_set_bit(uint64_t bits) {
+    AWS_ASSERT(bits);
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(bits);
+#else
+    size_t index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+static void s_mark_slot(struct aws_timing_wheel *wheel, size_t slot) {
+    wheel->occupied_slots[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+static void s_clear_slot_if_empty(struct aws_timing_wheel *wheel, size_t slot) {
+    if (aws_linked_list_empty(&wheel->slots[slot])) {
+        wheel->occupied_slots[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+}
+
+int aws_timing_wheel_init(
+    struct aws_timing_wheel *wheel,
+    struct aws_allocator *alloc,
+    uint64_t tick_ns,
+    size_t slot_count,
+    uint64_t min_delay_ns,
+    uint64_t now_ns) {
+
+    AWS_ASSERT(wheel);
+    AWS_ASSERT(alloc);
+
+    /* power of two so that the slot for a tick is just a mask */
+    if (tick_ns == 0 || slot_count == 0 || (slot_count & (slot_count - 1)) != 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    AWS_ZERO_STRUCT(*wheel);
+    size_t bitmap_words = (slot_count + 63) / 64;
+    if (!aws_mem_acquire_many(
+            alloc,
+            2,
+            &wheel->slots,
+            sizeof(struct aws_linked_list) * slot_count,
+            &wheel->occupied_slots,
+            sizeof(uint64_t) * bitmap_words)) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < slot_count; ++i) {
+        aws_linked_list_init(&wheel->slots[i]);
+    }
+    memset(wheel->occupied_slots, 0, sizeof(uint64_t) * bitmap_words);
+
+    wheel->alloc = alloc;
+    wheel->slot_mask = slot_count - 1;
+    wheel->tick_ns = tick_ns;
+    wheel->min_delay_ns = min_delay_ns;
+    wheel->current_tick = now_ns / tick_ns;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_timing_wheel_clean_up(struct aws_timing_wheel *wheel) {
+    AWS_ASSERT(wheel->task_count == 0);
+
+    aws_mem_release(wheel->alloc, wheel->slots);
+    AWS_ZERO_STRUCT(*wheel);
+}
+
+bool aws_timing_wheel_try_schedule(struct aws_timing_wheel *wheel, struct aws_task *task, uint64_t run_at_nanos) {
+    AWS_ASSERT(!s_is_on_wheel(wheel, task));
+
+    /* written this way around so that nothing overflows for timestamps near UINT64_MAX */
+    if (run_at_nanos < wheel->min_delay_ns ||
+        (run_at_nanos - wheel->min_delay_ns) / wheel->tick_ns < wheel->current_tick) {
+        return false;
+    }
+
+    size_t slot = (size_t)((run_at_nanos / wheel->tick_ns) & wheel->slot_mask);
+
+    task->timestamp = run_at_nanos;
+    task->reserved = (size_t)(uintptr_t)wheel;
+    aws_linked_list_push_back(&wheel->slots[slot], &task->node);
+    s_mark_slot(wheel, slot);
+    wheel->task_count++;
+
+    return true;
+}
+
+static void s_unlink(struct aws_timing_wheel *wheel, struct aws_task *task) {
+    aws_linked_list_remove(&task->node);
+    task->reserved = 0;
+    s_clear_slot_if_empty(wheel, (size_t)((task->timestamp / wheel->tick_ns) & wheel->slot_mask));
+    wheel->task_count--;
+}
+
+bool aws_timing_wheel_remove(struct aws_timing_wheel *wheel, struct aws_task *task) {
+    if (!s_is_on_wheel(wheel, task)) {
+        return false;
+    }
+
+    s_unlink(wheel, task);
+    return true;
+}
+
+void aws_timing_wheel_expire(struct aws_timing_wheel *wheel, uint64_t now_ns, struct aws_linked_list *expired) {
+    uint64_t now_tick = now_ns / wheel->tick_ns;
+    size_t slots_visited = 0;
+
+    /* a slot can hold tasks from later rotations too, only the ones whose tick has come go out. Once every slot has
+     * been visited there's nothing left to find, so a long sleep costs at most one rotation. */
+    while (wheel->task_count > 0 && wheel->current_tick <= now_tick && slots_visited <= wheel->slot_mask) {
+        struct aws_linked_list *slot = &wheel->slots[wheel->current_tick & wheel->slot_mask];
+
+        struct aws_linked_list_node *node = aws_linked_list_begin(slot);
+        while (node != aws_linked_list_end(slot)) {
+            struct aws_linked_list_node *next = aws_linked_list_next(node);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+
+            if (task->timestamp / wheel->tick_ns <= now_tick) {
+                s_unlink(wheel, task);
+                aws_linked_list_push_back(expired, &task->node);
+            }
+
+            node = next;
+        }
+
+        wheel->current_tick++;
+        slots_visited++;
+    }
+
+    if (wheel->current_tick <= now_tick) {
+        wheel->current_tick = now_tick + 1;
+    }
+}
+
+void aws_timing_wheel_take_all(struct aws_timing_wheel *wheel, struct aws_linked_list *out) {
+    for (size_t i = 0; i <= wheel->slot_mask && wheel->task_count > 0; ++i) {
+        while (!aws_linked_list_empty(&wheel->slots[i])) {
+            struct aws_linked_list_node *node = aws_linked_list_front(&wheel->slots[i]);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+            s_unlink(wheel, task);
+            aws_linked_list_push_back(out, &task->node);
+        }
+    }
+}
+
+bool aws_timing_wheel_next_tick_time(const struct aws_timing_wheel *wheel, uint64_t limit_ns, uint64_t *next_tick_ns) {
+    if (wheel->task_count == 0) {
+        return false;
+    }
+
+    uint64_t limit_tick = limit_ns / wheel->tick_ns;
+    size_t slot_count = wheel->slot_mask + 1;
+
+    /* the first occupied slot may only hold tasks for a later rotation, in which case we wake up once for nothing.
+     * That's cheaper than tracking the earliest tick per slot. Empty slots are skipped a bitmap word at a time, and a
+     * step never runs past the last slot, so the scan wraps around to slot 0 like the ticks do. */
+    uint64_t offset = 0;
+    while (offset <= wheel->slot_mask && wheel->current_tick + offset <= limit_tick) {
+        size_t slot = (size_t)((wheel->current_tick + offset) & wheel->slot_mask);
+        size_t step = 64 - slot % 64;
+        if (step > slot_count - slot) {
+            step = slot_count - slot;
+        }
+
+        uint64_t bits = wheel->occupied_slots[slot / 64] >> (slot % 64);
+        if (bits) {
+            uint64_t tick = wheel->current_tick + offset + s_lowest_set_bit(bits);
+            if (tick > limit_tick) {
+                return false;
+            }
+
+            *next_tick_ns = tick * wheel->tick_ns;
+            return true;
+        }
+
+        offset += step;
+    }
+
+    return false;
+}
+
+bool aws_timing_wheel_is_empty(const struct aws_timing_wheel *wheel) {
+    return wheel->task_count == 0;
+}
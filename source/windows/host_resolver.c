@@ -88,6 +88,7 @@ int aws_default_dns_resolve(
 
         host_address.use_count = 0;
         host_address.connection_failure_count = 0;
+        host_address.expiry = 0;
 
         if (aws_array_list_push_back(output_addresses, &host_address)) {
             aws_host_address_clean_up(&host_address);
@@ -510,6 +510,37 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
     return socket_impl->vtable->read(socket, buffer, amount_read);
 }
 
+/* The reads here are plain non-blocking ones, so the buffers are filled one read at a time. */
+int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+
+    AWS_ASSERT(amount_read);
+    *amount_read = 0;
+
+    for (size_t i = 0; i < buffer_count; ++i) {
+        size_t room = buffers[i]->capacity - buffers[i]->len;
+        size_t read = 0;
+        if (aws_socket_read(socket, buffers[i], &read)) {
+            if (*amount_read) {
+                /* report what was read, the next read will hit the error again if it's still there. */
+                aws_reset_error();
+                break;
+            }
+            return AWS_OP_ERR;
+        }
+
+        *amount_read += read;
+        if (read < room) {
+            break;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_socket_subscribe_to_readable_events(
     struct aws_socket *socket,
     aws_socket_on_readable_fn *on_readable,
@@ -2157,11 +2188,33 @@ static int s_dgram_stop_accept(struct aws_socket *socket) {
     return aws_raise_error(AWS_IO_SOCKET_ILLEGAL_OPERATION_FOR_STATE);
 }
 
+static void s_set_int_option(struct aws_socket *socket, int level, int option, int value, const char *option_name) {
+    if (setsockopt((SOCKET)socket->io_handle.data.handle, level, option, (char *)&value, sizeof(value))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: setsockopt() call for setting %s to %d failed with WSAError %d",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            option_name,
+            value,
+            WSAGetLastError());
+    }
+}
+
 int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_options *options) {
     if (socket->options.domain != options->domain || socket->options.type != options->type) {
         return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
     }
 
+    if (options->udp_segment_size) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: UDP segmentation offload is not supported on this platform.",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: setting socket options to: keep-alive %d, keep idle %d, keep-alive interval %d, max failed "
@@ -2185,7 +2238,18 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
             WSAGetLastError());
     }
 
+    /* of the tuning options, only these have a winsock equivalent, the rest are ignored. */
+    if (socket->options.send_buffer_size) {
+        s_set_int_option(socket, SOL_SOCKET, SO_SNDBUF, (int)socket->options.send_buffer_size, "SO_SNDBUF");
+    }
+
+    if (socket->options.receive_buffer_size) {
+        s_set_int_option(socket, SOL_SOCKET, SO_RCVBUF, (int)socket->options.receive_buffer_size, "SO_RCVBUF");
+    }
+
     if (socket->options.domain != AWS_SOCKET_LOCAL && socket->options.type == AWS_SOCKET_STREAM) {
+        s_set_int_option(socket, IPPROTO_TCP, TCP_NODELAY, socket->options.tcp_nodelay, "TCP_NODELAY");
+
         if (socket->options.keepalive &&
             !(socket->options.keep_alive_interval_sec && socket->options.keep_alive_timeout_sec)) {
             int keep_alive = 1;
@@ -3128,6 +3192,147 @@ int aws_socket_write(
     return AWS_OP_SUCCESS;
 }
 
+/* what the pieces of a vectored write share, the user hears back once the last one in flight completes. */
+struct vectored_write_args {
+    struct aws_allocator *allocator;
+    aws_socket_on_write_completed_fn *written_fn;
+    void *user_data;
+    size_t pieces_in_flight;
+    int error_code;
+};
+
+static void s_on_vectored_write_piece_completed(
+    struct aws_socket *socket,
+    int error_code,
+    size_t bytes_written,
+    void *user_data) {
+    struct vectored_write_args *args = user_data;
+
+    if (error_code && !args->error_code) {
+        args->error_code = error_code;
+    }
+
+    if (--args->pieces_in_flight) {
+        return;
+    }
+
+    /* pieces complete in order, so on success this is the last buffer's count, as on the other platforms. */
+    args->written_fn(socket, args->error_code, args->error_code ? 0 : bytes_written, args->user_data);
+    aws_mem_release(args->allocator, args);
+}
+
+/* overlapped WriteFile() can't gather, so each buffer is its own write. They still complete in order. */
+int aws_socket_write_vectored(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *cursors,
+    size_t cursor_count,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (cursor_count == 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (cursor_count == 1) {
+        return aws_socket_write(socket, &cursors[0], written_fn, user_data);
+    }
+
+    struct vectored_write_args *args = aws_mem_acquire(socket->allocator, sizeof(struct vectored_write_args));
+    if (!args) {
+        return AWS_OP_ERR;
+    }
+
+    args->allocator = socket->allocator;
+    args->written_fn = written_fn;
+    args->user_data = user_data;
+    args->pieces_in_flight = 0;
+    args->error_code = AWS_OP_SUCCESS;
+
+    /* completions are always queued to the event loop, so none of them can run before this loop is done counting. */
+    for (size_t i = 0; i < cursor_count; ++i) {
+        if (aws_socket_write(socket, &cursors[i], s_on_vectored_write_piece_completed, args)) {
+            if (args->pieces_in_flight == 0) {
+                aws_mem_release(socket->allocator, args);
+                return AWS_OP_ERR;
+            }
+
+            /* the pieces already handed to WriteFile() still point into the caller's memory, so the caller mustn't
+             * let go of it until written_fn reports the failure, once they are done. */
+            args->error_code = aws_last_error();
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: vectored write failed after %llu of %llu buffers with error %d",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle,
+                (unsigned long long)i,
+                (unsigned long long)cursor_count,
+                args->error_code);
+            break;
+        }
+
+        args->pieces_in_flight++;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* write queue accounting isn't implemented for overlapped writes yet, so the socket always reports writable. */
+int aws_socket_set_write_watermarks(
+    struct aws_socket *socket,
+    size_t low_watermark,
+    size_t high_watermark,
+    aws_socket_on_writable_fn *on_writable,
+    void *user_data) {
+    (void)socket;
+    (void)low_watermark;
+    (void)high_watermark;
+    (void)on_writable;
+    (void)user_data;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+bool aws_socket_is_writable(const struct aws_socket *socket) {
+    (void)socket;
+    return true;
+}
+
+size_t aws_socket_get_pending_write_bytes(const struct aws_socket *socket) {
+    (void)socket;
+    return 0;
+}
+
+/* there's no batched datagram io on winsock, and UDP sockets here go through overlapped reads and writes instead. */
+int aws_socket_read_datagrams(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_read) {
+    (void)socket;
+    (void)datagrams;
+    (void)datagram_count;
+    *datagrams_read = 0;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_write_datagrams(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t datagram_count,
+    size_t *datagrams_written) {
+    (void)socket;
+    (void)datagrams;
+    (void)datagram_count;
+    *datagrams_written = 0;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 int aws_socket_get_error(struct aws_socket *socket) {
     if (socket->options.domain != AWS_SOCKET_LOCAL) {
         int connect_result;
@@ -765,6 +765,369 @@ static int s_test_channel_duplicate_shutdown(struct aws_allocator *allocator, vo
 
 AWS_TEST_CASE(channel_duplicate_shutdown, s_test_channel_duplicate_shutdown)
 
+struct channel_stall_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    aws_event_loop_inner_fn *stalled_inner_fn;
+    bool task_done;
+};
+
+static void s_channel_stall_on_stall(
+    struct aws_event_loop *event_loop,
+    uint64_t stalled_for_ns,
+    const struct aws_event_loop_stats *stats,
+    void *user_data) {
+
+    (void)event_loop;
+    (void)stalled_for_ns;
+    struct channel_stall_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->stalled_inner_fn = stats->current_inner_fn;
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_channel_blocking_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct channel_stall_test_args *args = arg;
+
+    aws_thread_current_sleep(200000000);
+
+    aws_mutex_lock(&args->mutex);
+    args->task_done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_channel_stall_task_done_predicate(void *arg) {
+    struct channel_stall_test_args *args = arg;
+    return args->task_done;
+}
+
+static int s_test_channel_stall_names_task(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct channel_stall_test_args stall_args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_event_loop_group_options options = {
+        .loop_count = 1,
+        .stall_budget_ns = 20000000,
+        .on_stall = s_channel_stall_on_stall,
+        .on_stall_user_data = &stall_args,
+    };
+
+    struct aws_event_loop_group event_loop_group;
+    if (aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options)) {
+        /* loops without stats can't be watched. */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    struct aws_channel *channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    struct aws_channel_task task;
+    aws_channel_task_init(&task, s_channel_blocking_task, &stall_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&stall_args.mutex));
+    aws_channel_schedule_task_now(channel, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &stall_args.condition_variable, &stall_args.mutex, s_channel_stall_task_done_predicate, &stall_args));
+
+    /* the report names the channel task, not the channel's wrapper around it. */
+    ASSERT_PTR_EQUALS((aws_event_loop_inner_fn *)s_channel_blocking_task, stall_args.stalled_inner_fn);
+    ASSERT_SUCCESS(aws_mutex_unlock(&stall_args.mutex));
+
+    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_args.condition_variable, &test_args.mutex, s_channel_test_shutdown_predicate, &test_args));
+    aws_channel_destroy(channel);
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_args.mutex));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_stall_names_task, s_test_channel_stall_names_task)
+
+/* sits at the left end of the channel and records everything written to it, completing each message as it goes. */
+struct chain_capture_handler_impl {
+    struct aws_byte_buf written;
+    size_t messages_written;
+};
+
+static int s_chain_capture_process_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_chain_capture_process_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+
+    struct chain_capture_handler_impl *impl = handler->impl;
+
+    /* a handler that doesn't accept chains must never see one */
+    if (message->next_in_chain) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(&message->message_data);
+    if (aws_byte_buf_append_dynamic(&impl->written, &data)) {
+        return AWS_OP_ERR;
+    }
+    impl->messages_written++;
+
+    if (message->on_completion) {
+        message->on_completion(message->owning_channel, message, AWS_OP_SUCCESS, message->user_data);
+    }
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_chain_capture_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    (void)slot;
+    (void)size;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_chain_capture_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_chain_capture_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_chain_capture_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_chain_capture_destroy(struct aws_channel_handler *handler) {
+    struct chain_capture_handler_impl *impl = handler->impl;
+    aws_byte_buf_clean_up(&impl->written);
+    aws_mem_release(handler->alloc, handler);
+}
+
+/* accepts_message_chains is deliberately left unset */
+static struct aws_channel_handler_vtable s_chain_capture_vtable = {
+    .process_read_message = s_chain_capture_process_read,
+    .process_write_message = s_chain_capture_process_write,
+    .increment_read_window = s_chain_capture_increment_read_window,
+    .shutdown = s_chain_capture_shutdown,
+    .initial_window_size = s_chain_capture_initial_window_size,
+    .message_overhead = s_chain_capture_message_overhead,
+    .destroy = s_chain_capture_destroy,
+};
+
+static struct aws_channel_handler *s_chain_capture_handler_new(
+    struct aws_allocator *allocator,
+    struct chain_capture_handler_impl *impl) {
+
+    struct aws_channel_handler *handler = aws_mem_acquire(allocator, sizeof(struct aws_channel_handler));
+    if (!handler) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*impl);
+    if (aws_byte_buf_init(&impl->written, allocator, 0)) {
+        aws_mem_release(allocator, handler);
+        return NULL;
+    }
+
+    handler->alloc = allocator;
+    handler->vtable = &s_chain_capture_vtable;
+    handler->impl = impl;
+    return handler;
+}
+
+static void s_chain_message_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+
+    int *completion_count = user_data;
+    if (!err_code) {
+        (*completion_count)++;
+    }
+}
+
+enum { CHAIN_TEST_MESSAGE_COUNT = 3, CHAIN_TEST_MESSAGE_SIZE = 8 * 1024 };
+
+/* builds a chain whose total size is larger than a single pool message, so it has to be split when flattened */
+static struct aws_io_message *s_build_test_chain(
+    struct aws_channel *channel,
+    struct aws_byte_buf *expected,
+    int *completion_counts) {
+
+    struct aws_io_message *head = NULL;
+    for (int i = 0; i < CHAIN_TEST_MESSAGE_COUNT; ++i) {
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, CHAIN_TEST_MESSAGE_SIZE);
+        if (!message) {
+            aws_io_message_chain_release(head);
+            return NULL;
+        }
+
+        size_t fill_len = message->message_data.capacity;
+        if (fill_len > CHAIN_TEST_MESSAGE_SIZE) {
+            fill_len = CHAIN_TEST_MESSAGE_SIZE;
+        }
+        for (size_t j = 0; j < fill_len; ++j) {
+            message->message_data.buffer[j] = (uint8_t)('a' + (i * 7 + j) % 26);
+        }
+        message->message_data.len = fill_len;
+        message->on_completion = s_chain_message_completed;
+        message->user_data = &completion_counts[i];
+
+        struct aws_byte_cursor data = aws_byte_cursor_from_buf(&message->message_data);
+        aws_byte_buf_append_dynamic(expected, &data);
+
+        if (head) {
+            aws_io_message_chain_append(head, message);
+        } else {
+            head = message;
+        }
+    }
+
+    return head;
+}
+
+static int s_test_channel_flattens_message_chains(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_channel *channel = NULL;
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .shutdown_completed = false,
+    };
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_channel_test_shutdown,
+        .shutdown_user_data = &test_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    channel = aws_channel_new(allocator, event_loop, &callbacks);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait(&test_args.condition_variable, &test_args.mutex));
+    ASSERT_INT_EQUALS(0, test_args.error_code);
+
+    struct aws_channel_slot *slot_1 = aws_channel_slot_new(channel);
+    struct aws_channel_slot *slot_2 = aws_channel_slot_new(channel);
+    ASSERT_NOT_NULL(slot_1);
+    ASSERT_NOT_NULL(slot_2);
+    ASSERT_SUCCESS(aws_channel_slot_insert_right(slot_1, slot_2));
+
+    struct chain_capture_handler_impl handler_1_impl;
+    struct chain_capture_handler_impl handler_2_impl;
+    struct aws_channel_handler *handler_1 = s_chain_capture_handler_new(allocator, &handler_1_impl);
+    struct aws_channel_handler *handler_2 = s_chain_capture_handler_new(allocator, &handler_2_impl);
+    ASSERT_NOT_NULL(handler_1);
+    ASSERT_NOT_NULL(handler_2);
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_1, handler_1));
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(slot_2, handler_2));
+
+    struct aws_byte_buf expected;
+    ASSERT_SUCCESS(aws_byte_buf_init(&expected, allocator, CHAIN_TEST_MESSAGE_COUNT * CHAIN_TEST_MESSAGE_SIZE));
+
+    /* write direction: the chain arrives at handler_1 as plain copies, in order, and every message completes once */
+    int completion_counts[CHAIN_TEST_MESSAGE_COUNT] = {0};
+    struct aws_io_message *chain = s_build_test_chain(channel, &expected, completion_counts);
+    ASSERT_NOT_NULL(chain);
+    ASSERT_UINT_EQUALS(expected.len, aws_io_message_chain_data_size(chain));
+
+    ASSERT_SUCCESS(aws_channel_slot_send_message(slot_2, chain, AWS_CHANNEL_DIR_WRITE));
+    ASSERT_BIN_ARRAYS_EQUALS(expected.buffer, expected.len, handler_1_impl.written.buffer, handler_1_impl.written.len);
+    ASSERT_TRUE(handler_1_impl.messages_written > 1);
+    for (int i = 0; i < CHAIN_TEST_MESSAGE_COUNT; ++i) {
+        ASSERT_INT_EQUALS(1, completion_counts[i]);
+    }
+
+    /* read direction: chains are rejected outright, nothing is delivered or completed */
+    int rejected_completion_counts[CHAIN_TEST_MESSAGE_COUNT] = {0};
+    expected.len = 0;
+    struct aws_io_message *rejected_chain = s_build_test_chain(channel, &expected, rejected_completion_counts);
+    ASSERT_NOT_NULL(rejected_chain);
+
+    ASSERT_FAILS(aws_channel_slot_send_message(slot_1, rejected_chain, AWS_CHANNEL_DIR_READ));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+    ASSERT_UINT_EQUALS(0, handler_2_impl.written.len);
+    aws_io_message_chain_release(rejected_chain);
+    for (int i = 0; i < CHAIN_TEST_MESSAGE_COUNT; ++i) {
+        ASSERT_INT_EQUALS(0, rejected_completion_counts[i]);
+    }
+
+    aws_byte_buf_clean_up(&expected);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(channel, AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_args.condition_variable, &test_args.mutex, s_channel_test_shutdown_predicate, &test_args));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_flattens_message_chains, s_test_channel_flattens_message_chains)
+
 struct channel_connect_test_args {
     struct aws_mutex *mutex;
     struct aws_condition_variable cv;
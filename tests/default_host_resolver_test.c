@@ -928,3 +928,143 @@ static int s_test_resolver_ipv6_address_lookup_fn(struct aws_allocator *allocato
     return 0;
 }
 AWS_TEST_CASE(test_resolver_ipv6_address_lookup, s_test_resolver_ipv6_address_lookup_fn)
+
+enum {
+    SHARED_WORKERS_HOST_COUNT = 64,
+};
+
+struct shared_workers_test_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    uint64_t resolving_threads[SHARED_WORKERS_HOST_COUNT];
+    size_t resolving_thread_count;
+    size_t resolved_count;
+    size_t failed_count;
+};
+
+/* hands back one A record for any host, slowly, and remembers which threads it was called from */
+static int s_shared_workers_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct shared_workers_test_data *test_data = user_data;
+
+    aws_mutex_lock(&test_data->mutex);
+    uint64_t thread_id = aws_thread_current_thread_id();
+    bool seen = false;
+    for (size_t i = 0; i < test_data->resolving_thread_count; ++i) {
+        seen |= test_data->resolving_threads[i] == thread_id;
+    }
+    if (!seen && test_data->resolving_thread_count < SHARED_WORKERS_HOST_COUNT) {
+        test_data->resolving_threads[test_data->resolving_thread_count++] = thread_id;
+    }
+    aws_mutex_unlock(&test_data->mutex);
+
+    aws_thread_current_sleep(10000000);
+
+    struct aws_host_address address = {
+        .allocator = allocator,
+        .address = aws_string_new_from_c_str(allocator, "10.0.0.1"),
+        .host = aws_string_new_from_array(allocator, aws_string_bytes(host_name), host_name->len),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    return aws_array_list_push_back(output_addresses, &address);
+}
+
+static void s_shared_workers_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    struct shared_workers_test_data *test_data = user_data;
+
+    struct aws_host_address *host_address = NULL;
+    bool matches = !err_code && aws_array_list_length(host_addresses) == 1 &&
+                   !aws_array_list_get_at_ptr(host_addresses, (void **)&host_address, 0) &&
+                   aws_string_eq(host_name, host_address->host);
+
+    aws_mutex_lock(&test_data->mutex);
+    if (matches) {
+        test_data->resolved_count++;
+    } else {
+        test_data->failed_count++;
+    }
+    aws_condition_variable_notify_one(&test_data->condition_variable);
+    aws_mutex_unlock(&test_data->mutex);
+}
+
+static bool s_shared_workers_all_resolved_predicate(void *arg) {
+    struct shared_workers_test_data *test_data = arg;
+    return test_data->resolved_count + test_data->failed_count == SHARED_WORKERS_HOST_COUNT;
+}
+
+/* lots of distinct hosts all get resolved, on no more than max_worker_count threads */
+static int s_run_shared_workers_test(struct aws_allocator *allocator, size_t max_worker_count) {
+    struct aws_host_resolver resolver;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 1));
+
+    struct aws_host_resolver_default_options resolver_options = {
+        .max_entries = SHARED_WORKERS_HOST_COUNT,
+        .el_group = &el_group,
+        .max_worker_count = max_worker_count,
+    };
+    ASSERT_SUCCESS(aws_host_resolver_init_default_with_options(&resolver, allocator, &resolver_options));
+
+    struct shared_workers_test_data test_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_shared_workers_resolve,
+        .impl_data = &test_data,
+    };
+
+    for (size_t i = 0; i < SHARED_WORKERS_HOST_COUNT; ++i) {
+        char host_name_str[64];
+        snprintf(host_name_str, sizeof(host_name_str), "bucket-%d.s3.us-east-1.amazonaws.com", (int)i);
+        const struct aws_string *host_name = aws_string_new_from_c_str(allocator, host_name_str);
+        ASSERT_NOT_NULL(host_name);
+
+        ASSERT_SUCCESS(
+            aws_host_resolver_resolve_host(&resolver, host_name, s_shared_workers_resolved, &config, &test_data));
+        aws_string_destroy((void *)host_name);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_data.condition_variable, &test_data.mutex, s_shared_workers_all_resolved_predicate, &test_data));
+    ASSERT_UINT_EQUALS(SHARED_WORKERS_HOST_COUNT, test_data.resolved_count);
+    ASSERT_TRUE(test_data.resolving_thread_count > 0);
+    ASSERT_TRUE(
+        test_data.resolving_thread_count <=
+        (max_worker_count ? max_worker_count : AWS_HOST_RESOLVER_DEFAULT_MAX_WORKER_COUNT));
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_data.mutex));
+
+    aws_host_resolver_clean_up(&resolver);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return 0;
+}
+
+static int s_test_resolver_many_hosts_share_workers_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_run_shared_workers_test(allocator, 0);
+}
+AWS_TEST_CASE(test_resolver_many_hosts_share_workers, s_test_resolver_many_hosts_share_workers_fn)
+
+/* a single worker still gets through all of them, one after another */
+static int s_test_resolver_max_worker_count_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_run_shared_workers_test(allocator, 1);
+}
+AWS_TEST_CASE(test_resolver_max_worker_count, s_test_resolver_max_worker_count_fn)
@@ -0,0 +1,760 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/* the stub name server below is plain BSD sockets, aws_socket can't answer UDP clients. */
+#ifndef _WIN32
+
+#    include <aws/io/dns_client.h>
+
+#    include <aws/common/byte_buf.h>
+#    include <aws/common/clock.h>
+#    include <aws/common/condition_variable.h>
+#    include <aws/common/string.h>
+#    include <aws/common/thread.h>
+
+#    include <aws/io/event_loop.h>
+#    include <aws/io/host_resolver.h>
+
+#    include <aws/testing/aws_test_harness.h>
+
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <stdio.h>
+#    include <stdlib.h>
+#    include <string.h>
+#    include <strings.h>
+#    include <sys/socket.h>
+#    include <sys/time.h>
+#    include <unistd.h>
+
+enum {
+    STUB_TYPE_A = 1,
+    STUB_TYPE_CNAME = 5,
+    STUB_TYPE_AAAA = 28,
+    STUB_MAX_PACKET = 512,
+};
+
+/* answers a fixed set of made-up names on 127.0.0.1, see s_stub_server_answer() for what each of them does */
+struct stub_dns_server {
+    int fd;
+    uint16_t port;
+    struct aws_thread thread;
+    struct aws_mutex lock;
+    bool stop;
+    size_t queries_received;
+    /* where the first few queries came from */
+    uint16_t source_ports[8];
+    bool dropped_flaky_a;
+    bool dropped_flaky_aaaa;
+};
+
+static bool s_stub_server_should_stop(struct stub_dns_server *server) {
+    aws_mutex_lock(&server->lock);
+    bool stop = server->stop;
+    aws_mutex_unlock(&server->lock);
+    return stop;
+}
+
+static void s_write_header(struct aws_byte_buf *response, uint16_t id, uint16_t rcode, uint16_t answer_count) {
+    aws_byte_buf_write_be16(response, id);
+    /* a response, recursion desired and available */
+    aws_byte_buf_write_be16(response, (uint16_t)(0x8180 | rcode));
+    aws_byte_buf_write_be16(response, 1);
+    aws_byte_buf_write_be16(response, answer_count);
+    aws_byte_buf_write_be16(response, 0);
+    aws_byte_buf_write_be16(response, 0);
+}
+
+/* owner is a compression pointer to wherever the name is in the packet */
+static void s_write_record(
+    struct aws_byte_buf *response,
+    uint16_t owner,
+    uint16_t type,
+    uint32_t ttl,
+    const uint8_t *data,
+    uint16_t data_len) {
+    aws_byte_buf_write_be16(response, (uint16_t)(0xC000 | owner));
+    aws_byte_buf_write_be16(response, type);
+    aws_byte_buf_write_be16(response, 1);
+    aws_byte_buf_write_be32(response, ttl);
+    aws_byte_buf_write_be16(response, data_len);
+    aws_byte_buf_write(response, data, data_len);
+}
+
+static void s_write_a_record(struct aws_byte_buf *response, uint16_t owner, uint32_t ttl, const char *address) {
+    uint8_t data[4];
+    inet_pton(AF_INET, address, data);
+    s_write_record(response, owner, STUB_TYPE_A, ttl, data, sizeof(data));
+}
+
+static void s_write_aaaa_record(struct aws_byte_buf *response, uint16_t owner, uint32_t ttl, const char *address) {
+    uint8_t data[16];
+    inet_pton(AF_INET6, address, data);
+    s_write_record(response, owner, STUB_TYPE_AAAA, ttl, data, sizeof(data));
+}
+
+static void s_stub_server_answer(
+    struct stub_dns_server *server,
+    const uint8_t *request,
+    size_t request_len,
+    const struct sockaddr *from,
+    socklen_t from_len) {
+
+    /* questions from the client are never compressed, so the name is just labels up to a zero */
+    if (request_len < 12) {
+        return;
+    }
+    uint16_t id = (uint16_t)((request[0] << 8) | request[1]);
+
+    char name[256];
+    size_t name_len = 0;
+    size_t offset = 12;
+    while (offset < request_len && request[offset] != 0) {
+        size_t label_len = request[offset++];
+        if (offset + label_len > request_len || name_len + label_len + 1 >= sizeof(name)) {
+            return;
+        }
+        if (name_len) {
+            name[name_len++] = '.';
+        }
+        memcpy(name + name_len, request + offset, label_len);
+        name_len += label_len;
+        offset += label_len;
+    }
+    name[name_len] = 0;
+
+    size_t question_end = offset + 1 + 4;
+    if (question_end > request_len) {
+        return;
+    }
+    uint16_t type = (uint16_t)((request[offset + 1] << 8) | request[offset + 2]);
+
+    aws_mutex_lock(&server->lock);
+    if (server->queries_received < AWS_ARRAY_SIZE(server->source_ports)) {
+        server->source_ports[server->queries_received] = ntohs(((const struct sockaddr_in *)from)->sin_port);
+    }
+    server->queries_received++;
+    bool drop = false;
+    if (!strcasecmp(name, "flaky.test")) {
+        bool *dropped = type == STUB_TYPE_A ? &server->dropped_flaky_a : &server->dropped_flaky_aaaa;
+        drop = !*dropped;
+        *dropped = true;
+    }
+    aws_mutex_unlock(&server->lock);
+
+    if (drop || !strcasecmp(name, "silent.test")) {
+        return;
+    }
+
+    uint8_t response_storage[STUB_MAX_PACKET];
+    struct aws_byte_buf response = aws_byte_buf_from_empty_array(response_storage, sizeof(response_storage));
+    struct aws_byte_cursor question = aws_byte_cursor_from_array(request + 12, question_end - 12);
+
+    if (!strcasecmp(name, "spoof.test")) {
+        /* right id, wrong question. The client has to ignore this one. */
+        uint8_t other_question[] = {5, 'o', 't', 'h', 'e', 'r', 4, 't', 'e', 's', 't', 0, 0, STUB_TYPE_A, 0, 1};
+        s_write_header(&response, id, 0, 1);
+        aws_byte_buf_write(&response, other_question, sizeof(other_question));
+        s_write_a_record(&response, 12, 30, "10.6.6.6");
+        sendto(server->fd, response.buffer, response.len, 0, from, from_len);
+        response.len = 0;
+    }
+
+    if (!strcasecmp(name, "missing.test")) {
+        s_write_header(&response, id, 3, 0);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+    } else if (!strcasecmp(name, "alias.test")) {
+        /* a CNAME to example.test, whose records point into the CNAME's data for their name */
+        uint8_t target[] = {7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 4, 't', 'e', 's', 't', 0};
+        s_write_header(&response, id, 0, type == STUB_TYPE_A ? 2 : 1);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+        s_write_record(&response, 12, STUB_TYPE_CNAME, 300, target, sizeof(target));
+        uint16_t target_offset = (uint16_t)(response.len - sizeof(target));
+        if (type == STUB_TYPE_A) {
+            s_write_a_record(&response, target_offset, 20, "10.0.0.5");
+        }
+    } else if (!strcasecmp(name, "v6.test")) {
+        s_write_header(&response, id, 0, type == STUB_TYPE_AAAA ? 3 : 0);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+        if (type == STUB_TYPE_AAAA) {
+            s_write_aaaa_record(&response, 12, 30, "2001:db8:0:0:1:0:0:1");
+            s_write_aaaa_record(&response, 12, 30, "::1");
+            s_write_aaaa_record(&response, 12, 30, "fe80::");
+        }
+    } else if (!strncasecmp(name, "host", 4)) {
+        /* hostN.test is 10.0.1.N */
+        char address[16];
+        snprintf(address, sizeof(address), "10.0.1.%d", atoi(name + 4));
+        s_write_header(&response, id, 0, type == STUB_TYPE_A ? 1 : 0);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+        if (type == STUB_TYPE_A) {
+            s_write_a_record(&response, 12, 30, address);
+        }
+    } else if (
+        !strcasecmp(name, "example.test") || !strcasecmp(name, "flaky.test") || !strcasecmp(name, "spoof.test")) {
+        s_write_header(&response, id, 0, type == STUB_TYPE_A ? 2 : 1);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+        if (type == STUB_TYPE_A) {
+            s_write_a_record(&response, 12, 30, "10.0.0.1");
+            s_write_a_record(&response, 12, 60, "10.0.0.2");
+        } else {
+            s_write_aaaa_record(&response, 12, 30, "2001:db8::1");
+        }
+    } else {
+        s_write_header(&response, id, 3, 0);
+        aws_byte_buf_write_from_whole_cursor(&response, question);
+    }
+
+    sendto(server->fd, response.buffer, response.len, 0, from, from_len);
+}
+
+static void s_stub_server_thread_fn(void *arg) {
+    struct stub_dns_server *server = arg;
+
+    while (!s_stub_server_should_stop(server)) {
+        uint8_t request[STUB_MAX_PACKET];
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t request_len =
+            recvfrom(server->fd, request, sizeof(request), 0, (struct sockaddr *)&from, &from_len);
+
+        /* nothing within the receive timeout, go check whether it's time to stop */
+        if (request_len <= 0) {
+            continue;
+        }
+
+        s_stub_server_answer(server, request, (size_t)request_len, (struct sockaddr *)&from, from_len);
+    }
+}
+
+static int s_stub_server_start(struct stub_dns_server *server, struct aws_allocator *allocator) {
+    AWS_ZERO_STRUCT(*server);
+    ASSERT_SUCCESS(aws_mutex_init(&server->lock));
+
+    server->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_TRUE(server->fd >= 0);
+
+    struct timeval receive_timeout = {.tv_sec = 0, .tv_usec = 20000};
+    ASSERT_SUCCESS(setsockopt(server->fd, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout, sizeof(receive_timeout)));
+
+    /* let the kernel pick a port, so tests don't step on each other */
+    struct sockaddr_in address;
+    AWS_ZERO_STRUCT(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_SUCCESS(bind(server->fd, (struct sockaddr *)&address, sizeof(address)));
+
+    socklen_t address_len = sizeof(address);
+    ASSERT_SUCCESS(getsockname(server->fd, (struct sockaddr *)&address, &address_len));
+    server->port = ntohs(address.sin_port);
+
+    ASSERT_SUCCESS(aws_thread_init(&server->thread, allocator));
+    ASSERT_SUCCESS(aws_thread_launch(&server->thread, s_stub_server_thread_fn, server, NULL));
+
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_stub_server_queries_received(struct stub_dns_server *server) {
+    aws_mutex_lock(&server->lock);
+    size_t queries_received = server->queries_received;
+    aws_mutex_unlock(&server->lock);
+    return queries_received;
+}
+
+static void s_stub_server_stop(struct stub_dns_server *server) {
+    aws_mutex_lock(&server->lock);
+    server->stop = true;
+    aws_mutex_unlock(&server->lock);
+
+    aws_thread_join(&server->thread);
+    aws_thread_clean_up(&server->thread);
+    close(server->fd);
+    aws_mutex_clean_up(&server->lock);
+}
+
+struct dns_test_tester {
+    struct aws_allocator *allocator;
+    struct stub_dns_server server;
+    struct aws_event_loop *event_loop;
+    struct aws_dns_client *client;
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+};
+
+struct dns_test_lookup {
+    struct dns_test_tester *tester;
+    bool completed;
+    int error_code;
+    /* copies of what the client handed us */
+    struct aws_array_list addresses;
+};
+
+static int s_tester_init(
+    struct dns_test_tester *tester,
+    struct aws_allocator *allocator,
+    uint32_t query_timeout_ms,
+    uint32_t max_attempts) {
+
+    AWS_ZERO_STRUCT(*tester);
+    tester->allocator = allocator;
+    ASSERT_SUCCESS(aws_mutex_init(&tester->lock));
+    ASSERT_SUCCESS(aws_condition_variable_init(&tester->signal));
+    ASSERT_SUCCESS(s_stub_server_start(&tester->server, allocator));
+
+    tester->event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(tester->event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(tester->event_loop));
+
+    struct aws_dns_client_options options = {
+        .event_loop = tester->event_loop,
+        .name_server_domain = AWS_SOCKET_IPV4,
+        .query_timeout_ms = query_timeout_ms,
+        .max_attempts = max_attempts,
+    };
+    snprintf(options.name_server.address, sizeof(options.name_server.address), "127.0.0.1");
+    options.name_server.port = tester->server.port;
+
+    tester->client = aws_dns_client_new(allocator, &options);
+    ASSERT_NOT_NULL(tester->client);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_tester_clean_up(struct dns_test_tester *tester) {
+    if (tester->client) {
+        aws_dns_client_destroy(tester->client);
+    }
+    aws_event_loop_destroy(tester->event_loop);
+    s_stub_server_stop(&tester->server);
+    aws_condition_variable_clean_up(&tester->signal);
+    aws_mutex_clean_up(&tester->lock);
+}
+
+static int s_lookup_init(struct dns_test_lookup *lookup, struct dns_test_tester *tester) {
+    AWS_ZERO_STRUCT(*lookup);
+    lookup->tester = tester;
+    return aws_array_list_init_dynamic(&lookup->addresses, tester->allocator, 4, sizeof(struct aws_host_address));
+}
+
+static void s_lookup_clean_up(struct dns_test_lookup *lookup) {
+    for (size_t i = 0; i < aws_array_list_length(&lookup->addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(&lookup->addresses, (void **)&address, i);
+        aws_host_address_clean_up(address);
+    }
+    aws_array_list_clean_up(&lookup->addresses);
+}
+
+static void s_on_resolved(
+    struct aws_dns_client *client,
+    const struct aws_string *host_name,
+    int error_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)client;
+    (void)host_name;
+    struct dns_test_lookup *lookup = user_data;
+
+    aws_mutex_lock(&lookup->tester->lock);
+    for (size_t i = 0; i < aws_array_list_length(host_addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(host_addresses, (void **)&address, i);
+
+        struct aws_host_address address_copy;
+        aws_host_address_copy(address, &address_copy);
+        aws_array_list_push_back(&lookup->addresses, &address_copy);
+    }
+    lookup->error_code = error_code;
+    lookup->completed = true;
+    aws_condition_variable_notify_all(&lookup->tester->signal);
+    aws_mutex_unlock(&lookup->tester->lock);
+}
+
+static bool s_lookup_completed_pred(void *arg) {
+    struct dns_test_lookup *lookup = arg;
+    return lookup->completed;
+}
+
+static int s_resolve(struct dns_test_tester *tester, const char *host_name, struct dns_test_lookup *lookup) {
+    ASSERT_SUCCESS(s_lookup_init(lookup, tester));
+
+    struct aws_string *name = aws_string_new_from_c_str(tester->allocator, host_name);
+    ASSERT_NOT_NULL(name);
+    ASSERT_SUCCESS(aws_dns_client_resolve_async(tester->client, name, s_on_resolved, lookup));
+    aws_string_destroy(name);
+
+    aws_mutex_lock(&tester->lock);
+    aws_condition_variable_wait_pred(&tester->signal, &tester->lock, s_lookup_completed_pred, lookup);
+    aws_mutex_unlock(&tester->lock);
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_host_address *s_find_address(struct dns_test_lookup *lookup, const char *address) {
+    for (size_t i = 0; i < aws_array_list_length(&lookup->addresses); ++i) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(&lookup->addresses, (void **)&host_address, i);
+        if (!strcmp((const char *)aws_string_bytes(host_address->address), address)) {
+            return host_address;
+        }
+    }
+    return NULL;
+}
+
+static int s_test_dns_client_resolves_a_and_aaaa(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    uint64_t before = 0;
+    aws_sys_clock_get_ticks(&before);
+
+    /* the trailing dot and the case shouldn't matter */
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "Example.TEST.", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    ASSERT_UINT_EQUALS(3, aws_array_list_length(&lookup.addresses));
+
+    struct aws_host_address *address = s_find_address(&lookup, "10.0.0.1");
+    ASSERT_NOT_NULL(address);
+    ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_A, address->record_type);
+    ASSERT_STR_EQUALS("Example.TEST.", (const char *)aws_string_bytes(address->host));
+
+    /* expiry follows the record's own TTL */
+    uint64_t ttl_30s = aws_timestamp_convert(30, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t ttl_60s = aws_timestamp_convert(60, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    ASSERT_TRUE(address->expiry >= before + ttl_30s && address->expiry < before + ttl_60s);
+
+    address = s_find_address(&lookup, "10.0.0.2");
+    ASSERT_NOT_NULL(address);
+    ASSERT_TRUE(address->expiry >= before + ttl_60s);
+
+    address = s_find_address(&lookup, "2001:db8::1");
+    ASSERT_NOT_NULL(address);
+    ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_AAAA, address->record_type);
+
+    s_lookup_clean_up(&lookup);
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_resolves_a_and_aaaa, s_test_dns_client_resolves_a_and_aaaa)
+
+static int s_test_dns_client_follows_cname_and_formats_ipv6(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    /* the CNAME itself isn't an address, only the A record behind it is */
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "alias.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&lookup.addresses));
+    ASSERT_NOT_NULL(s_find_address(&lookup, "10.0.0.5"));
+    s_lookup_clean_up(&lookup);
+
+    ASSERT_SUCCESS(s_resolve(&tester, "v6.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    ASSERT_UINT_EQUALS(3, aws_array_list_length(&lookup.addresses));
+    /* of two equally long runs of zeros, only the first gets shortened */
+    ASSERT_NOT_NULL(s_find_address(&lookup, "2001:db8::1:0:0:1"));
+    ASSERT_NOT_NULL(s_find_address(&lookup, "::1"));
+    ASSERT_NOT_NULL(s_find_address(&lookup, "fe80::"));
+    s_lookup_clean_up(&lookup);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_follows_cname_and_formats_ipv6, s_test_dns_client_follows_cname_and_formats_ipv6)
+
+static int s_test_dns_client_nxdomain(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "missing.test", &lookup));
+    ASSERT_INT_EQUALS(AWS_IO_DNS_INVALID_NAME, lookup.error_code);
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&lookup.addresses));
+    s_lookup_clean_up(&lookup);
+
+    /* names that can't be put in a query don't get that far */
+    struct aws_string *bad_name = aws_string_new_from_c_str(allocator, "two..dots.test");
+    ASSERT_ERROR(AWS_IO_DNS_INVALID_NAME, aws_dns_client_resolve_async(tester.client, bad_name, s_on_resolved, NULL));
+    aws_string_destroy(bad_name);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_nxdomain, s_test_dns_client_nxdomain)
+
+static int s_test_dns_client_retries_lost_queries(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 100, 3));
+
+    /* the server ignores the first A and the first AAAA query */
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "flaky.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    ASSERT_UINT_EQUALS(3, aws_array_list_length(&lookup.addresses));
+    ASSERT_UINT_EQUALS(4, s_stub_server_queries_received(&tester.server));
+    s_lookup_clean_up(&lookup);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_retries_lost_queries, s_test_dns_client_retries_lost_queries)
+
+static int s_test_dns_client_gives_up_after_max_attempts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 50, 2));
+
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "silent.test", &lookup));
+    ASSERT_INT_EQUALS(AWS_IO_DNS_QUERY_FAILED, lookup.error_code);
+    /* two attempts each for A and AAAA */
+    ASSERT_UINT_EQUALS(4, s_stub_server_queries_received(&tester.server));
+    s_lookup_clean_up(&lookup);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_gives_up_after_max_attempts, s_test_dns_client_gives_up_after_max_attempts)
+
+static int s_test_dns_client_ignores_mismatched_answers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    /* every query first gets an answer to a different question, with the right id */
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "spoof.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    ASSERT_UINT_EQUALS(3, aws_array_list_length(&lookup.addresses));
+    ASSERT_NULL(s_find_address(&lookup, "10.6.6.6"));
+    s_lookup_clean_up(&lookup);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_ignores_mismatched_answers, s_test_dns_client_ignores_mismatched_answers)
+
+static int s_test_dns_client_queries_use_own_ports(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_resolve(&tester, "example.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    s_lookup_clean_up(&lookup);
+
+    ASSERT_SUCCESS(s_resolve(&tester, "host1.test", &lookup));
+    ASSERT_SUCCESS(lookup.error_code);
+    s_lookup_clean_up(&lookup);
+
+    /* a lookup's A and AAAA queries are in flight together, each from a socket of its own */
+    ASSERT_UINT_EQUALS(4, s_stub_server_queries_received(&tester.server));
+    aws_mutex_lock(&tester.server.lock);
+    uint16_t source_ports[4];
+    memcpy(source_ports, tester.server.source_ports, sizeof(source_ports));
+    aws_mutex_unlock(&tester.server.lock);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(source_ports); ++i) {
+        ASSERT_TRUE(source_ports[i] != 0);
+    }
+    ASSERT_TRUE(source_ports[0] != source_ports[1]);
+    ASSERT_TRUE(source_ports[2] != source_ports[3]);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_queries_use_own_ports, s_test_dns_client_queries_use_own_ports)
+
+static bool s_all_lookups_completed_pred(void *arg) {
+    struct dns_test_lookup *lookups = arg;
+    for (size_t i = 0; i < 16; ++i) {
+        if (!lookups[i].completed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int s_test_dns_client_pipelines_lookups(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    /* all of them go out before any answer comes back */
+    struct dns_test_lookup lookups[16];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lookups); ++i) {
+        ASSERT_SUCCESS(s_lookup_init(&lookups[i], &tester));
+
+        char host_name[32];
+        snprintf(host_name, sizeof(host_name), "host%d.test", (int)i);
+        struct aws_string *name = aws_string_new_from_c_str(allocator, host_name);
+        ASSERT_SUCCESS(aws_dns_client_resolve_async(tester.client, name, s_on_resolved, &lookups[i]));
+        aws_string_destroy(name);
+    }
+
+    aws_mutex_lock(&tester.lock);
+    aws_condition_variable_wait_pred(&tester.signal, &tester.lock, s_all_lookups_completed_pred, lookups);
+    aws_mutex_unlock(&tester.lock);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(lookups); ++i) {
+        ASSERT_SUCCESS(lookups[i].error_code);
+        ASSERT_UINT_EQUALS(1, aws_array_list_length(&lookups[i].addresses));
+
+        char expected_address[16];
+        snprintf(expected_address, sizeof(expected_address), "10.0.1.%d", (int)i);
+        ASSERT_NOT_NULL(s_find_address(&lookups[i], expected_address));
+        s_lookup_clean_up(&lookups[i]);
+    }
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_pipelines_lookups, s_test_dns_client_pipelines_lookups)
+
+static int s_test_dns_client_destroy_cancels_lookups(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 10000, 0));
+
+    struct dns_test_lookup lookup;
+    ASSERT_SUCCESS(s_lookup_init(&lookup, &tester));
+    struct aws_string *name = aws_string_new_from_c_str(allocator, "silent.test");
+    ASSERT_SUCCESS(aws_dns_client_resolve_async(tester.client, name, s_on_resolved, &lookup));
+    aws_string_destroy(name);
+
+    aws_dns_client_destroy(tester.client);
+    tester.client = NULL;
+
+    /* destroy doesn't return until the loop has let go of everything */
+    ASSERT_TRUE(lookup.completed);
+    ASSERT_INT_EQUALS(AWS_ERROR_IO_OPERATION_CANCELLED, lookup.error_code);
+    s_lookup_clean_up(&lookup);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_destroy_cancels_lookups, s_test_dns_client_destroy_cancels_lookups)
+
+struct resolver_callback_data {
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+    bool invoked;
+    int error_code;
+    uint64_t a_expiry;
+};
+
+static void s_on_host_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)resolver;
+    (void)host_name;
+    struct resolver_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->lock);
+    for (size_t i = 0; i < aws_array_list_length(host_addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(host_addresses, (void **)&address, i);
+        if (address->record_type == AWS_ADDRESS_RECORD_TYPE_A) {
+            callback_data->a_expiry = address->expiry;
+        }
+    }
+    callback_data->error_code = err_code;
+    callback_data->invoked = true;
+    aws_condition_variable_notify_one(&callback_data->signal);
+    aws_mutex_unlock(&callback_data->lock);
+}
+
+static bool s_host_resolved_pred(void *arg) {
+    struct resolver_callback_data *callback_data = arg;
+    return callback_data->invoked;
+}
+
+static int s_test_dns_client_backs_host_resolver(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct dns_test_tester tester;
+    ASSERT_SUCCESS(s_tester_init(&tester, allocator, 0, 0));
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 1));
+    struct aws_host_resolver resolver;
+    ASSERT_SUCCESS(aws_host_resolver_init_default(&resolver, allocator, 10, &el_group));
+
+    /* max_ttl is way beyond the records' TTLs, so those are what the cache goes by */
+    struct aws_host_resolution_config config = {
+        .max_ttl = 600,
+        .impl = aws_dns_client_resolve,
+        .impl_data = tester.client,
+    };
+
+    struct resolver_callback_data callback_data = {
+        .lock = AWS_MUTEX_INIT,
+        .signal = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    uint64_t before = 0;
+    aws_sys_clock_get_ticks(&before);
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "example.test");
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(&resolver, host_name, s_on_host_resolved, &config, &callback_data));
+
+    aws_mutex_lock(&callback_data.lock);
+    aws_condition_variable_wait_pred(&callback_data.signal, &callback_data.lock, s_host_resolved_pred, &callback_data);
+    aws_mutex_unlock(&callback_data.lock);
+
+    ASSERT_SUCCESS(callback_data.error_code);
+    ASSERT_TRUE(callback_data.a_expiry > before);
+    ASSERT_TRUE(
+        callback_data.a_expiry <= before + aws_timestamp_convert(65, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL));
+
+    aws_string_destroy(host_name);
+    aws_host_resolver_clean_up(&resolver);
+    aws_event_loop_group_clean_up(&el_group);
+
+    s_tester_clean_up(&tester);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(dns_client_backs_host_resolver, s_test_dns_client_backs_host_resolver)
+
+#endif /* _WIN32 */
@@ -19,6 +19,8 @@
 #include <aws/common/task_scheduler.h>
 #include <aws/io/event_loop.h>
 
+#include <aws/io/private/thread_affinity.h>
+
 #include <aws/common/thread.h>
 #include <aws/testing/aws_test_harness.h>
 
@@ -172,6 +174,249 @@ static int s_test_event_loop_canceled_tasks_run_in_el_thread(struct aws_allocato
 
 AWS_TEST_CASE(event_loop_canceled_tasks_run_in_el_thread, s_test_event_loop_canceled_tasks_run_in_el_thread)
 
+enum {
+    MULTI_PRODUCER_THREAD_COUNT = 8,
+    MULTI_PRODUCER_TASKS_PER_THREAD = 1000,
+};
+
+struct multi_producer_args {
+    struct aws_event_loop *loop;
+    struct aws_task tasks[MULTI_PRODUCER_THREAD_COUNT][MULTI_PRODUCER_TASKS_PER_THREAD];
+    /* only touched on the event-loop thread */
+    size_t next_expected[MULTI_PRODUCER_THREAD_COUNT];
+    size_t run_count;
+    bool out_of_order;
+    bool ran_off_thread;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+struct multi_producer_thread_args {
+    struct multi_producer_args *args;
+    size_t thread_index;
+};
+
+static void s_multi_producer_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)status;
+    struct multi_producer_args *args = user_data;
+
+    size_t index = (size_t)(task - &args->tasks[0][0]);
+    size_t thread_index = index / MULTI_PRODUCER_TASKS_PER_THREAD;
+    size_t task_index = index % MULTI_PRODUCER_TASKS_PER_THREAD;
+
+    if (!aws_event_loop_thread_is_callers_thread(args->loop)) {
+        args->ran_off_thread = true;
+    }
+
+    /* tasks scheduled by a single thread must run in the order that thread scheduled them */
+    if (args->next_expected[thread_index] != task_index) {
+        args->out_of_order = true;
+    }
+    args->next_expected[thread_index] = task_index + 1;
+
+    aws_mutex_lock(&args->mutex);
+    args->run_count++;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_multi_producer_thread_fn(void *user_data) {
+    struct multi_producer_thread_args *thread_args = user_data;
+    struct multi_producer_args *args = thread_args->args;
+
+    for (size_t i = 0; i < MULTI_PRODUCER_TASKS_PER_THREAD; ++i) {
+        struct aws_task *task = &args->tasks[thread_args->thread_index][i];
+        aws_task_init(task, s_multi_producer_task, args);
+        aws_event_loop_schedule_task_now(args->loop, task);
+    }
+}
+
+static bool s_multi_producer_all_ran_pred(void *user_data) {
+    struct multi_producer_args *args = user_data;
+    return args->run_count == MULTI_PRODUCER_THREAD_COUNT * MULTI_PRODUCER_TASKS_PER_THREAD;
+}
+
+/* Runs the multi-producer test against event_loop, and destroys it. */
+static int s_run_multi_producer_xthread_tasks(struct aws_allocator *allocator, struct aws_event_loop *event_loop) {
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct multi_producer_args *args = aws_mem_acquire(allocator, sizeof(struct multi_producer_args));
+    ASSERT_NOT_NULL(args);
+    AWS_ZERO_STRUCT(*args);
+    args->loop = event_loop;
+    args->mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    args->condition_variable = (struct aws_condition_variable)AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_thread threads[MULTI_PRODUCER_THREAD_COUNT];
+    struct multi_producer_thread_args thread_args[MULTI_PRODUCER_THREAD_COUNT];
+
+    for (size_t i = 0; i < MULTI_PRODUCER_THREAD_COUNT; ++i) {
+        thread_args[i].args = args;
+        thread_args[i].thread_index = i;
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_multi_producer_thread_fn, &thread_args[i], NULL));
+    }
+
+    for (size_t i = 0; i < MULTI_PRODUCER_THREAD_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args->mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args->condition_variable, &args->mutex, s_multi_producer_all_ran_pred, args));
+    aws_mutex_unlock(&args->mutex);
+
+    aws_event_loop_destroy(event_loop);
+
+    ASSERT_FALSE(args->out_of_order);
+    ASSERT_FALSE(args->ran_off_thread);
+    ASSERT_UINT_EQUALS(MULTI_PRODUCER_THREAD_COUNT * MULTI_PRODUCER_TASKS_PER_THREAD, args->run_count);
+
+    aws_mem_release(allocator, args);
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Test that tasks scheduled concurrently from many threads all run exactly once, on the event loop thread, and in
+ * per-thread submission order.
+ */
+static int s_test_event_loop_multi_producer_xthread_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+
+    return s_run_multi_producer_xthread_tasks(allocator, event_loop);
+}
+
+AWS_TEST_CASE(event_loop_multi_producer_xthread_tasks, s_test_event_loop_multi_producer_xthread_tasks)
+
+/*
+ * Same as above on a busy-polling loop, where producers skip the eventfd write while the loop spins, so a task pushed
+ * as the loop stops spinning must still be picked up.
+ */
+static int s_test_event_loop_busy_poll_multi_producer_xthread_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .busy_poll_ns = 1000000,
+        .socket_busy_poll_us = 50,
+    };
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_system_with_options(allocator, &options);
+    if (!event_loop) {
+        /* only the epoll loop busy polls. */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_run_multi_producer_xthread_tasks(allocator, event_loop);
+}
+
+AWS_TEST_CASE(
+    event_loop_busy_poll_multi_producer_xthread_tasks,
+    s_test_event_loop_busy_poll_multi_producer_xthread_tasks)
+
+struct coarse_task_args {
+    struct aws_event_loop *loop;
+    struct aws_task task;
+    uint64_t run_at;
+    uint64_t ran_at;
+    enum aws_task_status status;
+    bool invoked;
+    bool was_in_thread;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+};
+
+static void s_coarse_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    struct coarse_task_args *args = user_data;
+
+    aws_mutex_lock(args->mutex);
+    aws_event_loop_current_clock_time(args->loop, &args->ran_at);
+    args->status = status;
+    args->invoked = true;
+    args->was_in_thread = aws_event_loop_thread_is_callers_thread(args->loop);
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static void s_cancel_coarse_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct coarse_task_args *args = user_data;
+    aws_event_loop_cancel_task(args->loop, &args->task);
+}
+
+static bool s_coarse_task_invoked_pred(void *user_data) {
+    struct coarse_task_args *args = user_data;
+    return args->invoked;
+}
+
+/*
+ * Test that tasks far enough in the future to be held on the loop's timing wheel run no earlier than their timestamp,
+ * and can be canceled both explicitly and by destroying the loop.
+ */
+static int s_test_event_loop_coarse_future_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct coarse_task_args due_args = {
+        .loop = event_loop, .status = -1, .mutex = &mutex, .condition_variable = &condition_variable};
+    struct coarse_task_args canceled_args = due_args;
+    struct coarse_task_args destroyed_args = due_args;
+    aws_task_init(&due_args.task, s_coarse_task, &due_args);
+    aws_task_init(&canceled_args.task, s_coarse_task, &canceled_args);
+    aws_task_init(&destroyed_args.task, s_coarse_task, &destroyed_args);
+
+    struct aws_task cancel_task;
+    aws_task_init(&cancel_task, s_cancel_coarse_task, &canceled_args);
+
+    uint64_t now = 0;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    due_args.run_at = now + aws_timestamp_convert(1200, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t far_future = now + aws_timestamp_convert(60, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    aws_event_loop_schedule_task_future(event_loop, &due_args.task, due_args.run_at);
+    aws_event_loop_schedule_task_future(event_loop, &canceled_args.task, far_future);
+    aws_event_loop_schedule_task_future(event_loop, &destroyed_args.task, far_future);
+    /* cross-thread tasks are picked up in order, so the task to cancel is already scheduled when this runs */
+    aws_event_loop_schedule_task_now(event_loop, &cancel_task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_coarse_task_invoked_pred, &canceled_args));
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, canceled_args.status);
+    ASSERT_TRUE(canceled_args.was_in_thread);
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_coarse_task_invoked_pred, &due_args));
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, due_args.status);
+    ASSERT_TRUE(due_args.was_in_thread);
+    ASSERT_TRUE(due_args.ran_at >= due_args.run_at);
+    ASSERT_FALSE(destroyed_args.invoked);
+    aws_mutex_unlock(&mutex);
+
+    aws_event_loop_destroy(event_loop);
+
+    ASSERT_TRUE(destroyed_args.invoked);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, destroyed_args.status);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_coarse_future_tasks, s_test_event_loop_coarse_future_tasks)
+
 #if AWS_USE_IO_COMPLETION_PORTS
 
 int aws_pipe_get_unique_name(char *dst, size_t dst_size);
@@ -688,12 +933,17 @@ static void s_timer_done_task(struct aws_task *task, void *arg, enum aws_task_st
     s_thread_tester_update(tester);
 }
 
-static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_fn *state_functions[]) {
+typedef struct aws_event_loop *(thread_tester_new_loop_fn)(struct aws_allocator *alloc, aws_io_clock_fn *clock);
+
+static int s_thread_tester_run_on(
+    struct aws_allocator *alloc,
+    thread_tester_new_loop_fn *new_loop_fn,
+    thread_tester_state_fn *state_functions[]) {
 
     /* Set up tester */
     struct thread_tester tester = {
         .alloc = alloc,
-        .event_loop = aws_event_loop_new_default(alloc, aws_high_res_clock_get_ticks),
+        .event_loop = new_loop_fn(alloc, aws_high_res_clock_get_ticks),
         .mutex = AWS_MUTEX_INIT,
         .condition_variable = AWS_CONDITION_VARIABLE_INIT,
         .state_functions = state_functions,
@@ -725,6 +975,10 @@ static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_
     return tester.error_code;
 }
 
+static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_fn *state_functions[]) {
+    return s_thread_tester_run_on(alloc, aws_event_loop_new_default, state_functions);
+}
+
 /* Count how many times each type of event fires on the readable and writable handles */
 static void s_io_event_counter(
     struct aws_event_loop *event_loop,
@@ -970,6 +1224,289 @@ static int s_test_event_loop_readable_event_on_2nd_time_readable(struct aws_allo
 }
 AWS_TEST_CASE(event_loop_readable_event_on_2nd_time_readable, s_test_event_loop_readable_event_on_2nd_time_readable);
 
+#    ifdef AWS_USE_IO_URING
+/* aws_event_loop_new_io_uring() quietly falls back to epoll, the io_uring tests check for that up front. */
+static bool s_io_uring_available(struct aws_allocator *allocator) {
+    struct aws_event_loop *event_loop = aws_event_loop_new_io_uring(allocator, aws_high_res_clock_get_ticks);
+    if (!event_loop) {
+        return false;
+    }
+
+    bool available = aws_event_loop_is_io_uring(event_loop);
+    aws_event_loop_destroy(event_loop);
+
+    if (!available) {
+        printf("io_uring is not available on this kernel, skipping.\n");
+    }
+
+    return available;
+}
+
+/* Same as aws_event_loop_new_io_uring(), but fails instead of falling back to epoll. */
+static struct aws_event_loop *s_io_uring_loop_new_no_fallback(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop *event_loop = aws_event_loop_new_io_uring(alloc, clock);
+    if (event_loop && !aws_event_loop_is_io_uring(event_loop)) {
+        aws_event_loop_destroy(event_loop);
+        return NULL;
+    }
+
+    return event_loop;
+}
+
+/* Run the edge-triggered expectations above against the io_uring loop */
+static int s_test_event_loop_io_uring_readable_event_after_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    if (!s_io_uring_available(allocator)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    thread_tester_state_fn *state_functions[] = {
+        s_state_subscribe,
+        s_state_on_writable,
+        s_state_write_data,
+        s_state_on_readable,
+        s_state_wait_1sec,
+        s_state_fail_if_more_readable_events,
+        s_state_read_until_blocked,
+        s_state_write_data,
+        s_state_on_readable,
+        s_state_unsubscribe,
+        NULL,
+    };
+
+    ASSERT_SUCCESS(s_thread_tester_run_on(allocator, s_io_uring_loop_new_no_fallback, state_functions));
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(event_loop_io_uring_readable_event_after_write, s_test_event_loop_io_uring_readable_event_after_write);
+
+static int s_test_event_loop_io_uring_group_xthread_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    if (!s_io_uring_available(allocator)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_io_uring_init(&event_loop_group, allocator, 2));
+    for (size_t i = 0; i < aws_event_loop_group_get_loop_count(&event_loop_group); ++i) {
+        ASSERT_TRUE(aws_event_loop_is_io_uring(aws_event_loop_group_get_loop_at(&event_loop_group, i)));
+    }
+
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_next_loop(&event_loop_group);
+    ASSERT_NOT_NULL(event_loop);
+
+    struct task_args task_args = {.condition_variable = AWS_CONDITION_VARIABLE_INIT,
+                                  .mutex = AWS_MUTEX_INIT,
+                                  .invoked = false,
+                                  .was_in_thread = false,
+                                  .status = -1,
+                                  .loop = event_loop,
+                                  .thread_id = 0};
+
+    struct aws_task task;
+    aws_task_init(&task, s_test_task, &task_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+
+    uint64_t now;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    aws_event_loop_schedule_task_future(event_loop, &task, now + 1000000);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+    ASSERT_TRUE(task_args.invoked);
+    ASSERT_TRUE(task_args.was_in_thread);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, task_args.status);
+    aws_mutex_unlock(&task_args.mutex);
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(event_loop_io_uring_group_xthread_tasks, s_test_event_loop_io_uring_group_xthread_tasks);
+
+static void s_io_uring_noop_on_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+    (void)event_loop;
+    (void)handle;
+    (void)events;
+    (void)user_data;
+}
+
+/* A subscription whose poll was never submitted must be cleaned up when the loop is destroyed. */
+static int s_test_event_loop_io_uring_destroy_with_pending_subscription(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    if (!s_io_uring_available(allocator)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_event_loop *event_loop = s_io_uring_loop_new_no_fallback(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+    ASSERT_SUCCESS(aws_event_loop_stop(event_loop));
+    ASSERT_SUCCESS(aws_event_loop_wait_for_stop_completion(event_loop));
+
+    struct aws_io_handle read_handle;
+    struct aws_io_handle write_handle;
+    ASSERT_SUCCESS(simple_pipe_open(&read_handle, &write_handle));
+
+    /* the loop isn't running, so the poll is left waiting in a cross-thread task that destroy cancels. */
+    ASSERT_SUCCESS(aws_event_loop_subscribe_to_io_events(
+        event_loop, &read_handle, AWS_IO_EVENT_TYPE_READABLE, s_io_uring_noop_on_event, NULL));
+    ASSERT_NOT_NULL(read_handle.additional_data);
+
+    aws_event_loop_destroy(event_loop);
+    ASSERT_NULL(read_handle.additional_data);
+
+    simple_pipe_close(&read_handle, &write_handle);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(
+    event_loop_io_uring_destroy_with_pending_subscription,
+    s_test_event_loop_io_uring_destroy_with_pending_subscription);
+#    endif /* AWS_USE_IO_URING */
+
+struct subscription_task_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *event_loop;
+    struct aws_io_handle *handle;
+    bool subscribe;
+    bool invoked;
+    int result;
+};
+
+static void s_noop_on_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+    (void)event_loop;
+    (void)handle;
+    (void)events;
+    (void)user_data;
+}
+
+static void s_subscription_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct subscription_task_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    if (args->subscribe) {
+        args->result = aws_event_loop_subscribe_to_io_events(
+            args->event_loop, args->handle, AWS_IO_EVENT_TYPE_READABLE, s_noop_on_event, NULL);
+    } else {
+        args->result = aws_event_loop_unsubscribe_from_io_events(args->event_loop, args->handle);
+    }
+    args->invoked = true;
+    /* notify before unlocking, the waiter's args are on its stack and gone as soon as it wakes up. */
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_subscription_task_ran_predicate(void *args) {
+    struct subscription_task_args *task_args = args;
+    return task_args->invoked;
+}
+
+/* (un)subscribes from the loop's own thread, waits for it to be done and returns its result. */
+static int s_change_subscription(struct aws_event_loop *event_loop, struct aws_io_handle *handle, bool subscribe) {
+    struct subscription_task_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+        .handle = handle,
+        .subscribe = subscribe,
+    };
+
+    struct aws_task task;
+    aws_task_init(&task, s_subscription_task, &args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_subscription_task_ran_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    return args.result;
+}
+
+static int s_test_event_loop_group_next_loop_avoids_busy_loops(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&event_loop_group, allocator, 2));
+
+    struct aws_event_loop *busy_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+    struct aws_event_loop *idle_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 1);
+
+    struct aws_io_handle read_handle;
+    struct aws_io_handle write_handle;
+    ASSERT_SUCCESS(simple_pipe_open(&read_handle, &write_handle));
+
+    ASSERT_UINT_EQUALS(0, aws_event_loop_get_load_factor(busy_loop));
+    ASSERT_SUCCESS(s_change_subscription(busy_loop, &read_handle, true));
+    ASSERT_UINT_EQUALS(1, aws_event_loop_get_load_factor(busy_loop));
+
+    /* with two loops the random pick is always the other one, so the idle loop wins every time. */
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_PTR_EQUALS(idle_loop, aws_event_loop_group_get_next_loop(&event_loop_group));
+    }
+
+    ASSERT_SUCCESS(s_change_subscription(busy_loop, &read_handle, false));
+    ASSERT_UINT_EQUALS(0, aws_event_loop_get_load_factor(busy_loop));
+
+    /* evenly loaded again, so it's back to round-robin. */
+    struct aws_event_loop *first_loop = aws_event_loop_group_get_next_loop(&event_loop_group);
+    for (size_t i = 0; i < 10; ++i) {
+        struct aws_event_loop *expected_loop = first_loop == busy_loop ? idle_loop : busy_loop;
+        first_loop = aws_event_loop_group_get_next_loop(&event_loop_group);
+        ASSERT_PTR_EQUALS(expected_loop, first_loop);
+    }
+
+    simple_pipe_close(&read_handle, &write_handle);
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(event_loop_group_next_loop_avoids_busy_loops, s_test_event_loop_group_next_loop_avoids_busy_loops)
+
+/* a handle whose fd is closed before it's unsubscribed can't be taken out of the kernel's set any more, which some
+ * loops report as an error, but the loop lets go of it all the same and must stop counting it. */
+static int s_test_event_loop_load_factor_after_failed_unsubscribe(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_io_handle read_handle;
+    struct aws_io_handle write_handle;
+    ASSERT_SUCCESS(simple_pipe_open(&read_handle, &write_handle));
+
+    ASSERT_SUCCESS(s_change_subscription(event_loop, &read_handle, true));
+    ASSERT_UINT_EQUALS(1, aws_event_loop_get_load_factor(event_loop));
+
+    close(read_handle.data.fd);
+    /* the result depends on the loop, what matters is that the handle no longer counts. */
+    s_change_subscription(event_loop, &read_handle, false);
+    ASSERT_UINT_EQUALS(0, aws_event_loop_get_load_factor(event_loop));
+    ASSERT_NULL(read_handle.additional_data);
+
+    close(write_handle.data.fd);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(event_loop_load_factor_after_failed_unsubscribe, s_test_event_loop_load_factor_after_failed_unsubscribe)
+
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 static int s_event_loop_test_stop_then_restart(struct aws_allocator *allocator, void *ctx) {
@@ -1048,3 +1585,465 @@ static int test_event_loop_group_setup_and_shutdown(struct aws_allocator *alloca
 }
 
 AWS_TEST_CASE(event_loop_group_setup_and_shutdown, test_event_loop_group_setup_and_shutdown)
+
+struct affinity_task_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_cpu_set loop_cpus;
+    bool invoked;
+    int error_code;
+};
+
+static void s_affinity_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct affinity_task_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->error_code = aws_thread_affinity_get_current(&args->loop_cpus) ? aws_last_error() : 0;
+    args->invoked = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_affinity_task_ran_predicate(void *args) {
+    struct affinity_task_args *task_args = args;
+    return task_args->invoked;
+}
+
+/* Reads the affinity of the loop's thread from a task running on it. */
+static int s_get_loop_cpus(struct aws_event_loop *event_loop, struct aws_cpu_set *loop_cpus) {
+    struct affinity_task_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task task;
+    aws_task_init(&task, s_affinity_task, &args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_affinity_task_ran_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_INT_EQUALS(0, args.error_code);
+    *loop_cpus = args.loop_cpus;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_event_loop_group_pinned_to_cpus(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_cpu_set callers_cpus;
+    if (aws_thread_affinity_get_current(&callers_cpus)) {
+        /* pinning isn't supported here, make sure asking for it fails cleanly. */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+
+        uint16_t cpu_id = 0;
+        struct aws_event_loop_group_options options = {.cpu_ids = &cpu_id, .cpu_id_count = 1};
+        struct aws_event_loop_group event_loop_group;
+        ASSERT_FAILS(aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options));
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+
+    /* pin to the first and last CPUs this process may use, which are the same one on a single CPU machine. */
+    uint16_t cpu_ids[2] = {0, 0};
+    bool found_first = false;
+    for (uint16_t i = 0; i < AWS_CPU_SET_MAX_CPUS; ++i) {
+        if (aws_cpu_set_contains(&callers_cpus, i)) {
+            cpu_ids[1] = i;
+            if (!found_first) {
+                cpu_ids[0] = i;
+                found_first = true;
+            }
+        }
+    }
+    ASSERT_TRUE(found_first);
+
+    struct aws_event_loop_group_options options = {
+        .loop_count = 4,
+        .cpu_ids = cpu_ids,
+        .cpu_id_count = AWS_ARRAY_SIZE(cpu_ids),
+    };
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options));
+    ASSERT_UINT_EQUALS(4, aws_event_loop_group_get_loop_count(&event_loop_group));
+
+    for (size_t i = 0; i < 4; ++i) {
+        struct aws_cpu_set loop_cpus;
+        ASSERT_SUCCESS(s_get_loop_cpus(aws_event_loop_group_get_loop_at(&event_loop_group, i), &loop_cpus));
+        ASSERT_UINT_EQUALS(1, aws_cpu_set_count(&loop_cpus));
+        ASSERT_TRUE(aws_cpu_set_contains(&loop_cpus, cpu_ids[i % 2]));
+    }
+
+    /* the calling thread gets its own affinity back. */
+    struct aws_cpu_set cpus_after;
+    ASSERT_SUCCESS(aws_thread_affinity_get_current(&cpus_after));
+    ASSERT_TRUE(aws_cpu_set_eq(&callers_cpus, &cpus_after));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_pinned_to_cpus, s_test_event_loop_group_pinned_to_cpus)
+
+static int s_test_event_loop_group_spread_across_numa_nodes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_cpu_set callers_cpus;
+    bool can_read_affinity = aws_thread_affinity_get_current(&callers_cpus) == AWS_OP_SUCCESS;
+
+    size_t node_count = aws_numa_node_count();
+    ASSERT_TRUE(node_count >= 1);
+
+    uint16_t loop_count = (uint16_t)(node_count * 2);
+    struct aws_event_loop_group_options options = {
+        .loop_count = loop_count,
+        .spread_across_numa_nodes = true,
+    };
+
+    struct aws_event_loop_group event_loop_group;
+    ASSERT_SUCCESS(aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options));
+    ASSERT_UINT_EQUALS(loop_count, aws_event_loop_group_get_loop_count(&event_loop_group));
+
+    if (can_read_affinity) {
+        for (size_t i = 0; i < loop_count; ++i) {
+            struct aws_cpu_set loop_cpus;
+            ASSERT_SUCCESS(s_get_loop_cpus(aws_event_loop_group_get_loop_at(&event_loop_group, i), &loop_cpus));
+
+            if (node_count == 1) {
+                /* nothing to spread across, loops are left alone. */
+                ASSERT_TRUE(aws_cpu_set_eq(&callers_cpus, &loop_cpus));
+                continue;
+            }
+
+            /* the loop runs only on CPUs of node i % node_count (less any the process isn't allowed to use). */
+            struct aws_cpu_set node_cpus;
+            ASSERT_SUCCESS(aws_numa_node_get_cpus(i % node_count, &node_cpus));
+            for (size_t cpu = 0; cpu < AWS_CPU_SET_MAX_CPUS; ++cpu) {
+                ASSERT_TRUE(!aws_cpu_set_contains(&loop_cpus, cpu) || aws_cpu_set_contains(&node_cpus, cpu));
+            }
+        }
+
+        struct aws_cpu_set cpus_after;
+        ASSERT_SUCCESS(aws_thread_affinity_get_current(&cpus_after));
+        ASSERT_TRUE(aws_cpu_set_eq(&callers_cpus, &cpus_after));
+    }
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_spread_across_numa_nodes, s_test_event_loop_group_spread_across_numa_nodes)
+
+struct stats_task_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t run_count;
+    aws_task_fn *fn_while_running;
+};
+
+static void s_stats_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)status;
+    struct stats_task_args *args = user_data;
+
+    /* long enough to show up as the longest task. */
+    aws_thread_current_sleep(5000000);
+
+    aws_mutex_lock(&args->mutex);
+    args->fn_while_running = task->fn;
+    args->run_count++;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_stats_tasks_ran_predicate(void *args) {
+    struct stats_task_args *task_args = args;
+    return task_args->run_count == 3;
+}
+
+static int s_test_event_loop_stats(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+
+    struct aws_event_loop_stats stats;
+    if (aws_event_loop_get_stats(event_loop, &stats)) {
+        /* not every loop implementation keeps statistics. */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        aws_event_loop_destroy(event_loop);
+        return AWS_OP_SUCCESS;
+    }
+
+    ASSERT_UINT_EQUALS(0, stats.task_count);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct stats_task_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task tasks[3];
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); ++i) {
+        aws_task_init(&tasks[i], s_stats_task, &args);
+        aws_event_loop_schedule_task_now(event_loop, &tasks[i]);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_stats_tasks_ran_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    /* tasks see themselves as they were scheduled. */
+    ASSERT_PTR_EQUALS(s_stats_task, args.fn_while_running);
+    ASSERT_PTR_EQUALS(&args, tasks[0].arg);
+
+    /* the stop task has to run too, after which the counters no longer move. */
+    ASSERT_SUCCESS(aws_event_loop_stop(event_loop));
+    ASSERT_SUCCESS(aws_event_loop_wait_for_stop_completion(event_loop));
+    ASSERT_SUCCESS(aws_event_loop_get_stats(event_loop, &stats));
+
+    ASSERT_UINT_EQUALS(4, stats.task_count);
+    ASSERT_UINT_EQUALS(4, stats.cross_thread_task_count);
+    ASSERT_TRUE(stats.max_task_duration_ns >= 5000000);
+    ASSERT_TRUE(stats.task_time_ns >= 3 * 5000000);
+    ASSERT_TRUE(stats.iteration_count > 0);
+    /* the cross-thread wakeups are io events on the loop's own eventfd/pipe. */
+    ASSERT_TRUE(stats.io_event_count > 0);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_stats, s_test_event_loop_stats)
+
+struct stats_cancel_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *loop;
+    struct aws_task schedule_task;
+    /* one task for the scheduler and one far enough out for the timing wheel */
+    struct aws_task tasks[2];
+    bool fields_kept;
+    size_t canceled_count;
+    bool done;
+};
+
+static void s_stats_cancel_target_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    struct stats_cancel_args *args = user_data;
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        args->canceled_count++;
+    }
+}
+
+static void s_stats_cancel_schedule_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct stats_cancel_args *args = user_data;
+
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(args->loop, &now);
+    aws_event_loop_schedule_task_future(args->loop, &args->tasks[0], now + 100000000);
+    aws_event_loop_schedule_task_future(args->loop, &args->tasks[1], now + 60000000000ULL);
+
+    bool fields_kept = true;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(args->tasks); ++i) {
+        fields_kept &= args->tasks[i].fn == s_stats_cancel_target_task && args->tasks[i].arg == args;
+        aws_event_loop_cancel_task(args->loop, &args->tasks[i]);
+    }
+
+    aws_mutex_lock(&args->mutex);
+    args->fields_kept = fields_kept;
+    args->done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_stats_cancel_done_predicate(void *args) {
+    return ((struct stats_cancel_args *)args)->done;
+}
+
+/* the stats time tasks without touching the caller's fn and arg, and canceling still finds them. */
+static int s_test_event_loop_stats_leave_tasks_alone(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct stats_cancel_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .loop = event_loop,
+    };
+
+    aws_task_init(&args.schedule_task, s_stats_cancel_schedule_task, &args);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(args.tasks); ++i) {
+        aws_task_init(&args.tasks[i], s_stats_cancel_target_task, &args);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &args.schedule_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_stats_cancel_done_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    ASSERT_TRUE(args.fields_kept);
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(args.tasks), args.canceled_count);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_stats_leave_tasks_alone, s_test_event_loop_stats_leave_tasks_alone)
+
+struct stall_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *stalled_loop;
+    uint64_t stalled_for_ns;
+    aws_task_fn *stalled_task_fn;
+    size_t stall_count;
+    bool task_done;
+};
+
+static void s_on_stall(
+    struct aws_event_loop *event_loop,
+    uint64_t stalled_for_ns,
+    const struct aws_event_loop_stats *stats,
+    void *user_data) {
+
+    struct stall_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->stalled_loop = event_loop;
+    args->stalled_for_ns = stalled_for_ns;
+    args->stalled_task_fn = stats->current_task_fn;
+    args->stall_count++;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_blocking_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct stall_test_args *args = user_data;
+
+    /* the kind of blocking call that shouldn't be made on an event loop. */
+    aws_thread_current_sleep(200000000);
+
+    aws_mutex_lock(&args->mutex);
+    args->task_done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_stall_task_done_predicate(void *arg) {
+    struct stall_test_args *args = arg;
+    return args->task_done;
+}
+
+static int s_test_event_loop_group_stall_watchdog(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct stall_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_event_loop_group_options options = {
+        .loop_count = 1,
+        .stall_budget_ns = 20000000,
+        .on_stall = s_on_stall,
+        .on_stall_user_data = &args,
+    };
+
+    struct aws_event_loop_group event_loop_group;
+    if (aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options)) {
+        /* loops without stats can't be watched. */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_loop_at(&event_loop_group, 0);
+
+    struct aws_task task;
+    aws_task_init(&task, s_blocking_task, &args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &args.mutex, s_stall_task_done_predicate, &args));
+
+    /* reported once, while the task was still running. */
+    ASSERT_UINT_EQUALS(1, args.stall_count);
+    ASSERT_PTR_EQUALS(event_loop, args.stalled_loop);
+    ASSERT_PTR_EQUALS(s_blocking_task, args.stalled_task_fn);
+    ASSERT_TRUE(args.stalled_for_ns > options.stall_budget_ns);
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    /* an idle loop isn't stalled. */
+    aws_thread_current_sleep(100000000);
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    ASSERT_UINT_EQUALS(1, args.stall_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_stall_watchdog, s_test_event_loop_group_stall_watchdog)
+
+static int s_test_event_loop_group_busy_poll(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group_options options = {
+        .loop_count = 2,
+        .busy_poll_ns = 1000000,
+    };
+
+    struct aws_event_loop_group event_loop_group;
+    if (aws_event_loop_group_init_with_options(&event_loop_group, allocator, &options)) {
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_next_loop(&event_loop_group);
+
+    struct task_args task_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = AWS_MUTEX_INIT,
+        .status = -1,
+        .loop = event_loop,
+    };
+
+    struct aws_task task;
+    aws_task_init(&task, s_test_task, &task_args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+
+    /* due well after the spin is over, so the loop has to go from spinning to blocking and wake up on time. */
+    uint64_t now;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    aws_event_loop_schedule_task_future(event_loop, &task, now + 50000000);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+    ASSERT_TRUE(task_args.was_in_thread);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, task_args.status);
+    ASSERT_SUCCESS(aws_mutex_unlock(&task_args.mutex));
+
+    aws_event_loop_group_clean_up(&event_loop_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_busy_poll, s_test_event_loop_group_busy_poll)
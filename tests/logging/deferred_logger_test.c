@@ -0,0 +1,209 @@
+/*
+ * Copyright 2010-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/deferred_logger.h>
+
+#include <aws/common/byte_buf.h>
+#include <aws/testing/aws_test_harness.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <wchar.h>
+
+#ifdef _MSC_VER
+#    pragma warning(disable : 4996) /* Disable warnings about fopen() being insecure */
+#endif                              /* _MSC_VER */
+
+#define TEST_DEFERRED_MAX_BUFFER_SIZE (64 * 1024)
+
+static const char *s_test_file_name =
+#ifdef WIN32
+    "aws_deferred_logger_test.log";
+#else
+    "./aws_deferred_logger_test.log";
+#endif
+
+static char s_log_file_content[TEST_DEFERRED_MAX_BUFFER_SIZE];
+
+typedef void(log_test_fn)(void);
+
+/*
+ * Logs through a deferred logger, then checks the expected content shows up in the log file, in order
+ */
+static int s_do_deferred_logger_test(
+    struct aws_allocator *allocator,
+    log_test_fn *log_fn,
+    const char **expected_content,
+    size_t expected_content_count) {
+
+    remove(s_test_file_name);
+
+    struct aws_logger_deferred_options options = {
+        .level = AWS_LL_TRACE,
+        .filename = s_test_file_name,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+    };
+
+    struct aws_logger logger;
+    ASSERT_SUCCESS(aws_logger_init_deferred(&logger, allocator, &options));
+
+    aws_logger_set(&logger);
+
+    (*log_fn)();
+
+    aws_logger_set(NULL);
+
+    aws_logger_clean_up(&logger);
+
+    FILE *file = fopen(s_test_file_name, "r");
+    int open_error = errno;
+    size_t bytes_read = 0;
+
+    if (file != NULL) {
+        bytes_read = fread(s_log_file_content, 1, TEST_DEFERRED_MAX_BUFFER_SIZE - 1, file);
+        fclose(file);
+    }
+
+    remove(s_test_file_name);
+
+    ASSERT_TRUE(
+        file != NULL, "Unable to open log file \"%s\" to verify contents. Error: %d", s_test_file_name, open_error);
+
+    s_log_file_content[bytes_read] = 0;
+
+    const char *content_ptr = s_log_file_content;
+    for (size_t i = 0; i < expected_content_count; ++i) {
+        content_ptr = strstr(content_ptr, expected_content[i]);
+        ASSERT_TRUE(
+            content_ptr != NULL,
+            "Expected to find \"%s\" in log file but could not.  Content is either missing or out-of-order.",
+            expected_content[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Every kind of argument a record holds comes out the way printf would have formatted it
+ */
+static void s_argument_types_callback(void) {
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "plain text");
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "int %d unsigned %u hex %#x char %c", -42, 42u, 42, 'c');
+    AWS_LOGF_INFO(
+        AWS_LS_IO_GENERAL, "long %ld long long %lld size %zu uint64 %" PRIu64, -7L, -8LL, (size_t)9, (uint64_t)10);
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "double %.2f long double %.1Lf exp %e", 2.5, (long double)1.25, 1000.0);
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "width [%5d] left [%-5d] star [%*d] star left [%*d]", 7, 7, 5, 7, -5, 7);
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "precision [%.*f] negative precision [%.*d] percent 100%%", 3, 3.14159, -1, 5);
+    AWS_LOGF_INFO(AWS_LS_IO_GENERAL, "string [%s] padded [%8s] null [%s]", "hello", "pad", (const char *)NULL);
+}
+
+static const char *s_argument_types_expected[] = {
+    "[INFO ] [",
+    "] - plain text\n",
+    "int -42 unsigned 42 hex 0x2a char c\n",
+    "long -7 long long -8 size 9 uint64 10\n",
+    "double 2.50 long double 1.2 exp 1.000000e+03\n",
+    "width [    7] left [7    ] star [    7] star left [7    ]\n",
+    "precision [3.142] negative precision [5] percent 100%\n",
+    "string [hello] padded [     pad] null [(null)]\n",
+};
+
+static int s_deferred_logger_argument_types(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    return s_do_deferred_logger_test(
+        allocator, s_argument_types_callback, s_argument_types_expected, AWS_ARRAY_SIZE(s_argument_types_expected));
+}
+
+AWS_TEST_CASE(test_deferred_logger_argument_types, s_deferred_logger_argument_types);
+
+/*
+ * Strings are copied when logged, since the caller's memory is long gone by the time the record is formatted
+ */
+static void s_copies_strings_callback(void) {
+    char scratch[32];
+
+    snprintf(scratch, sizeof(scratch), "first value");
+    AWS_LOGF_DEBUG(AWS_LS_IO_GENERAL, "scratch holds %s", scratch);
+
+    snprintf(scratch, sizeof(scratch), "second value");
+    AWS_LOGF_DEBUG(AWS_LS_IO_GENERAL, "scratch holds %s", scratch);
+
+    /* byte cursors aren't terminated, only the bytes the precision allows are recorded */
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_c_str("cursor contents and more");
+    cursor.len = 15;
+    AWS_LOGF_DEBUG(AWS_LS_IO_GENERAL, "cursor [%.*s]", (int)cursor.len, (const char *)cursor.ptr);
+
+    memset(scratch, 'x', sizeof(scratch));
+}
+
+static const char *s_copies_strings_expected[] = {
+    "scratch holds first value\n",
+    "scratch holds second value\n",
+    "cursor [cursor contents]\n",
+};
+
+static int s_deferred_logger_copies_strings(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    return s_do_deferred_logger_test(
+        allocator, s_copies_strings_callback, s_copies_strings_expected, AWS_ARRAY_SIZE(s_copies_strings_expected));
+}
+
+AWS_TEST_CASE(test_deferred_logger_copies_strings, s_deferred_logger_copies_strings);
+
+/*
+ * Records too big for the stack, lines too big for the decoder's text buffer, and formats a record can't hold
+ */
+#define LONG_STRING_LENGTH (20 * 1024)
+
+static char s_long_string[LONG_STRING_LENGTH + 1];
+
+static void s_large_and_unsupported_callback(void) {
+    memset(s_long_string, 'a', LONG_STRING_LENGTH);
+    s_long_string[LONG_STRING_LENGTH] = 0;
+
+    AWS_LOGF_WARN(AWS_LS_IO_GENERAL, "before the long line");
+    AWS_LOGF_WARN(AWS_LS_IO_GENERAL, "long [%s]", s_long_string);
+    AWS_LOGF_WARN(AWS_LS_IO_GENERAL, "wide [%ls] formatted right away", L"wide");
+    AWS_LOGF_WARN(AWS_LS_IO_GENERAL, "after the long line");
+}
+
+static const char *s_large_and_unsupported_expected[] = {
+    "before the long line\n",
+    "long [aaaaaaaaaaaaaaaa",
+    "aaaaaaaaaaaaaaaa]\n",
+    "wide [wide] formatted right away\n",
+    "after the long line\n",
+};
+
+static int s_deferred_logger_large_and_unsupported(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    ASSERT_SUCCESS(s_do_deferred_logger_test(
+        allocator,
+        s_large_and_unsupported_callback,
+        s_large_and_unsupported_expected,
+        AWS_ARRAY_SIZE(s_large_and_unsupported_expected)));
+
+    const char *long_start = strstr(s_log_file_content, "long [");
+    ASSERT_NOT_NULL(long_start);
+    ASSERT_UINT_EQUALS(LONG_STRING_LENGTH, strchr(long_start, ']') - long_start - strlen("long ["));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_deferred_logger_large_and_unsupported, s_deferred_logger_large_and_unsupported);
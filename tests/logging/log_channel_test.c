@@ -253,4 +253,347 @@ DEFINE_BACKGROUND_LOG_CHANNEL_TEST(numbers, s_channel_test_numbers, s_background
 
 DEFINE_BACKGROUND_LOG_CHANNEL_TEST(words, s_channel_test_words, s_background_sleep_times_ns)
 
-DEFINE_BACKGROUND_LOG_CHANNEL_TEST(all, s_channel_test_all, s_background_sleep_times_ns)
\ No newline at end of file
+DEFINE_BACKGROUND_LOG_CHANNEL_TEST(all, s_channel_test_all, s_background_sleep_times_ns)
+/*
+ * Several threads sending through a tiny queue that blocks when full: every line has to come out, and each thread's
+ * lines in the order it sent them.  Some lines are too long for the queue's slots and are passed through as they are.
+ */
+enum {
+    CONCURRENT_SENDER_COUNT = 4,
+    CONCURRENT_LINES_PER_SENDER = 500,
+};
+
+struct concurrent_sender {
+    struct aws_log_channel *channel;
+    size_t sender_index;
+};
+
+static void s_concurrent_sender_fn(void *arg) {
+    struct concurrent_sender *sender = arg;
+
+    for (size_t i = 0; i < CONCURRENT_LINES_PER_SENDER; ++i) {
+        char line[64];
+        snprintf(
+            line,
+            sizeof(line),
+            "%zu %zu%s\n",
+            sender->sender_index,
+            i,
+            (i % 3 == 0) ? " with some padding to overflow the slot" : "");
+        struct aws_string *log_line = aws_string_new_from_c_str(sender->channel->allocator, line);
+        (sender->channel->vtable->send)(sender->channel, log_line);
+    }
+}
+
+static int s_background_log_channel_concurrent_senders(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_writer mock_writer;
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&mock_writer, allocator));
+
+    struct aws_log_channel_background_options options = {
+        .queue_size = 4,
+        .line_slot_size = 16,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+    };
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_with_options(&log_channel, allocator, &mock_writer, &options));
+
+    struct aws_thread threads[CONCURRENT_SENDER_COUNT];
+    struct concurrent_sender senders[CONCURRENT_SENDER_COUNT];
+    struct aws_thread_options thread_options = {.stack_size = 0};
+
+    for (size_t i = 0; i < CONCURRENT_SENDER_COUNT; ++i) {
+        senders[i].channel = &log_channel;
+        senders[i].sender_index = i;
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_concurrent_sender_fn, &senders[i], &thread_options));
+    }
+
+    for (size_t i = 0; i < CONCURRENT_SENDER_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    aws_log_channel_clean_up(&log_channel);
+
+    struct mock_log_writer_impl *impl = (struct mock_log_writer_impl *)mock_writer.impl;
+    ASSERT_UINT_EQUALS(CONCURRENT_SENDER_COUNT * CONCURRENT_LINES_PER_SENDER, aws_array_list_length(&impl->log_lines));
+
+    size_t next_line[CONCURRENT_SENDER_COUNT] = {0};
+    for (size_t i = 0; i < aws_array_list_length(&impl->log_lines); ++i) {
+        struct aws_string *line = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at(&impl->log_lines, &line, i));
+
+        unsigned long long sender_index = 0;
+        unsigned long long line_index = 0;
+        ASSERT_INT_EQUALS(2, sscanf((const char *)line->bytes, "%llu %llu", &sender_index, &line_index));
+        ASSERT_TRUE(sender_index < CONCURRENT_SENDER_COUNT);
+        ASSERT_UINT_EQUALS(next_line[sender_index], line_index);
+        next_line[sender_index]++;
+    }
+
+    aws_log_writer_clean_up(&mock_writer);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_background_log_channel_concurrent_senders, s_background_log_channel_concurrent_senders);
+
+/*
+ * Writer that holds up the background thread on the first line until told to go on
+ */
+struct gated_log_writer_impl {
+    struct aws_log_writer mock_writer;
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+    bool entered;
+    bool released;
+};
+
+static bool s_gate_entered(void *context) {
+    return ((struct gated_log_writer_impl *)context)->entered;
+}
+
+static bool s_gate_released(void *context) {
+    return ((struct gated_log_writer_impl *)context)->released;
+}
+
+static int s_gated_log_writer_write(struct aws_log_writer *writer, const struct aws_string *output) {
+    struct gated_log_writer_impl *gate = writer->impl;
+
+    aws_mutex_lock(&gate->lock);
+    gate->entered = true;
+    aws_condition_variable_notify_one(&gate->signal);
+    aws_condition_variable_wait_pred(&gate->signal, &gate->lock, s_gate_released, gate);
+    aws_mutex_unlock(&gate->lock);
+
+    return (gate->mock_writer.vtable->write)(&gate->mock_writer, output);
+}
+
+static void s_gated_log_writer_clean_up(struct aws_log_writer *writer) {
+    (void)writer;
+}
+
+enum { MAX_GATED_BATCH_COUNT = 8 };
+
+/*
+ * Same as the gated writer, but takes lines in batches and records how many came in each
+ */
+struct gated_batch_log_writer_impl {
+    struct gated_log_writer_impl gate;
+    size_t batch_sizes[MAX_GATED_BATCH_COUNT];
+    size_t batch_count;
+};
+
+static int s_gated_log_writer_write_batch(
+    struct aws_log_writer *writer,
+    const struct aws_string *const *lines,
+    size_t line_count) {
+    struct gated_batch_log_writer_impl *impl = writer->impl;
+
+    aws_mutex_lock(&impl->gate.lock);
+    impl->gate.entered = true;
+    aws_condition_variable_notify_one(&impl->gate.signal);
+    aws_condition_variable_wait_pred(&impl->gate.signal, &impl->gate.lock, s_gate_released, &impl->gate);
+    aws_mutex_unlock(&impl->gate.lock);
+
+    if (impl->batch_count < MAX_GATED_BATCH_COUNT) {
+        impl->batch_sizes[impl->batch_count] = line_count;
+    }
+    ++impl->batch_count;
+
+    for (size_t i = 0; i < line_count; ++i) {
+        if ((impl->gate.mock_writer.vtable->write)(&impl->gate.mock_writer, lines[i])) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_log_writer_vtable s_gated_batch_writer_vtable = {
+    .write = s_gated_log_writer_write,
+    .clean_up = s_gated_log_writer_clean_up,
+    .write_batch = s_gated_log_writer_write_batch,
+};
+
+static struct aws_log_writer_vtable s_gated_writer_vtable = {.write = s_gated_log_writer_write,
+                                                             .clean_up = s_gated_log_writer_clean_up};
+
+AWS_STATIC_STRING_FROM_LITERAL(s_dropped_notice, "[8 log lines dropped]\n");
+
+const struct aws_string **s_channel_test_drop_expected[] = {
+    &s_log_line_1,
+    &s_log_line_2,
+    &s_dropped_notice,
+};
+
+static int s_background_log_channel_drops_on_overflow(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct gated_log_writer_impl gate = {
+        .lock = AWS_MUTEX_INIT,
+        .signal = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&gate.mock_writer, allocator));
+
+    struct aws_log_writer gated_writer = {
+        .vtable = &s_gated_writer_vtable,
+        .allocator = allocator,
+        .impl = &gate,
+    };
+
+    struct aws_log_channel_background_options options = {
+        .queue_size = 2,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_DROP,
+    };
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_with_options(&log_channel, allocator, &gated_writer, &options));
+
+    /* the first line gets the background thread stuck in the writer */
+    ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, aws_string_new_from_string(allocator, s_log_line_1)));
+    aws_mutex_lock(&gate.lock);
+    aws_condition_variable_wait_pred(&gate.signal, &gate.lock, s_gate_entered, &gate);
+    aws_mutex_unlock(&gate.lock);
+
+    /* line 1 keeps its slot until it has been written, so line 2 fills the queue and the other eight are dropped */
+    ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, aws_string_new_from_string(allocator, s_log_line_2)));
+    ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, aws_string_new_from_string(allocator, s_log_line_3)));
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, aws_string_new_from_string(allocator, s_log_line_4)));
+    }
+
+    aws_mutex_lock(&gate.lock);
+    gate.released = true;
+    aws_condition_variable_notify_one(&gate.signal);
+    aws_mutex_unlock(&gate.lock);
+
+    aws_log_channel_clean_up(&log_channel);
+
+    ASSERT_TRUE(s_verify_mock_equal(
+        &gate.mock_writer, s_channel_test_drop_expected, AWS_ARRAY_SIZE(s_channel_test_drop_expected)));
+
+    aws_log_writer_clean_up(&gate.mock_writer);
+    aws_condition_variable_clean_up(&gate.signal);
+    aws_mutex_clean_up(&gate.lock);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_background_log_channel_drops_on_overflow, s_background_log_channel_drops_on_overflow);
+
+/*
+ * Lines sent as bytes are copied, into the queue's own storage if they fit and into a new string if they don't
+ */
+AWS_STATIC_STRING_FROM_LITERAL(s_log_line_long, "This line is longer than a slot.\n");
+
+const struct aws_string **s_channel_test_send_line[] = {&s_log_line_1, &s_log_line_long, &s_log_line_simple};
+
+static int s_background_log_channel_send_line(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_writer mock_writer;
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&mock_writer, allocator));
+
+    struct aws_log_channel_background_options options = {
+        .queue_size = 2,
+        .line_slot_size = 16,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+    };
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_with_options(&log_channel, allocator, &mock_writer, &options));
+    ASSERT_NOT_NULL(log_channel.vtable->send_line);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_channel_test_send_line); ++i) {
+        char line[64];
+        snprintf(line, sizeof(line), "%s", (const char *)(*s_channel_test_send_line[i])->bytes);
+        ASSERT_SUCCESS((log_channel.vtable->send_line)(&log_channel, aws_byte_cursor_from_c_str(line)));
+        /* the channel has its own copy by now */
+        memset(line, 'x', sizeof(line));
+    }
+
+    aws_log_channel_clean_up(&log_channel);
+
+    ASSERT_TRUE(
+        s_verify_mock_equal(&mock_writer, s_channel_test_send_line, AWS_ARRAY_SIZE(s_channel_test_send_line)),
+        "%s",
+        s_test_error_message);
+
+    aws_log_writer_clean_up(&mock_writer);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_background_log_channel_send_line, s_background_log_channel_send_line);
+
+/*
+ * Lines that pile up while the writer is busy are handed to it as one batch
+ */
+const struct aws_string **s_channel_test_batch_lines[] = {&s_log_line_1, &s_log_line_2, &s_log_line_3, &s_log_line_4};
+
+static int s_background_log_channel_batches_pending_lines(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct gated_batch_log_writer_impl batch_writer = {
+        .gate =
+            {
+                .lock = AWS_MUTEX_INIT,
+                .signal = AWS_CONDITION_VARIABLE_INIT,
+            },
+    };
+    ASSERT_SUCCESS(s_aws_mock_log_writer_init(&batch_writer.gate.mock_writer, allocator));
+
+    struct aws_log_writer gated_writer = {
+        .vtable = &s_gated_batch_writer_vtable,
+        .allocator = allocator,
+        .impl = &batch_writer,
+    };
+
+    struct aws_log_channel_background_options options = {
+        .queue_size = 4,
+        .overflow_policy = AWS_LOG_CHANNEL_OVERFLOW_BLOCK,
+    };
+
+    struct aws_log_channel log_channel;
+    ASSERT_SUCCESS(aws_log_channel_init_background_with_options(&log_channel, allocator, &gated_writer, &options));
+
+    /* the first line gets the background thread stuck in the writer, the rest fill the queue behind it */
+    ASSERT_SUCCESS((log_channel.vtable->send)(&log_channel, aws_string_new_from_string(allocator, s_log_line_1)));
+    aws_mutex_lock(&batch_writer.gate.lock);
+    aws_condition_variable_wait_pred(
+        &batch_writer.gate.signal, &batch_writer.gate.lock, s_gate_entered, &batch_writer.gate);
+    aws_mutex_unlock(&batch_writer.gate.lock);
+
+    for (size_t i = 1; i < AWS_ARRAY_SIZE(s_channel_test_batch_lines); ++i) {
+        ASSERT_SUCCESS((log_channel.vtable->send)(
+            &log_channel, aws_string_new_from_string(allocator, *s_channel_test_batch_lines[i])));
+    }
+
+    aws_mutex_lock(&batch_writer.gate.lock);
+    batch_writer.gate.released = true;
+    aws_condition_variable_notify_one(&batch_writer.gate.signal);
+    aws_mutex_unlock(&batch_writer.gate.lock);
+
+    aws_log_channel_clean_up(&log_channel);
+
+    ASSERT_TRUE(
+        s_verify_mock_equal(
+            &batch_writer.gate.mock_writer, s_channel_test_batch_lines, AWS_ARRAY_SIZE(s_channel_test_batch_lines)),
+        "%s",
+        s_test_error_message);
+    ASSERT_UINT_EQUALS(2, batch_writer.batch_count);
+    ASSERT_UINT_EQUALS(1, batch_writer.batch_sizes[0]);
+    ASSERT_UINT_EQUALS(3, batch_writer.batch_sizes[1]);
+
+    aws_log_writer_clean_up(&batch_writer.gate.mock_writer);
+    aws_condition_variable_clean_up(&batch_writer.gate.signal);
+    aws_mutex_clean_up(&batch_writer.gate.lock);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_background_log_channel_batches_pending_lines, s_background_log_channel_batches_pending_lines);
@@ -238,4 +238,76 @@ DEFINE_LOG_FORMATTER_TEST(
     s_formatter_newline_case,
     AWS_LL_TRACE,
     AWS_DATE_FORMAT_RFC822,
-    "\nMaking sure \nnewlines don't mess things\nup")
\ No newline at end of file
+    "\nMaking sure \nnewlines don't mess things\nup")
+/*
+ * Same checks, with the line formatted into a caller's buffer instead of a new string
+ */
+static int invoke_formatter_to_buffer(
+    struct aws_log_formatter *formatter,
+    struct aws_byte_buf *output,
+    enum aws_log_level log_level,
+    const char *format,
+    ...) {
+    va_list args;
+    va_start(args, format);
+
+    int result = formatter->vtable->format_to_buffer(formatter, output, log_level, AWS_LS_IO_GENERAL, format, args);
+
+    va_end(args);
+
+    return result;
+}
+
+static int s_formatter_buffer_number_case(struct aws_log_formatter *formatter, struct aws_string **output) {
+    uint8_t storage[TEST_FORMATTER_MAX_BUFFER_SIZE];
+    struct aws_byte_buf line = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+
+    if (invoke_formatter_to_buffer(
+            formatter, &line, AWS_LL_DEBUG, "%d bottles of milk on the wall. Take %.4f bottles down.", 99, .9999f)) {
+        return AWS_OP_ERR;
+    }
+
+    *output = aws_string_new_from_array(formatter->allocator, line.buffer, line.len);
+    return AWS_OP_SUCCESS;
+}
+
+DEFINE_LOG_FORMATTER_TEST(
+    s_formatter_buffer_number_case,
+    AWS_LL_DEBUG,
+    AWS_DATE_FORMAT_ISO_8601,
+    "99 bottles of milk on the wall. Take 0.9999 bottles down.")
+
+/*
+ * Lines that don't fit are refused rather than cut short
+ */
+static int s_log_formatter_buffer_too_small(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_formatter_standard_options options = {.date_format = AWS_DATE_FORMAT_ISO_8601};
+
+    struct aws_log_formatter formatter;
+    ASSERT_SUCCESS(aws_log_formatter_init_default(&formatter, allocator, &options));
+
+    uint8_t storage[160];
+    struct aws_byte_buf line = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+
+    ASSERT_ERROR(
+        AWS_ERROR_SHORT_BUFFER,
+        invoke_formatter_to_buffer(
+            &formatter,
+            &line,
+            AWS_LL_INFO,
+            "%s",
+            "This is quite a bit longer than what's left in a buffer of a hundred and sixty bytes once the prefix of "
+            "the line has been written into it."));
+    ASSERT_UINT_EQUALS(0, line.len);
+
+    ASSERT_SUCCESS(invoke_formatter_to_buffer(&formatter, &line, AWS_LL_INFO, "%s", "Short"));
+    ASSERT_TRUE(line.len > 0 && line.buffer[line.len - 1] == '\n');
+
+    aws_log_formatter_clean_up(&formatter);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_log_formatter_buffer_too_small, s_log_formatter_buffer_too_small);
@@ -169,3 +169,39 @@ static int s_log_writer_bad_file_test(struct aws_allocator *allocator, void *ctx
     return AWS_OP_SUCCESS;
 }
 AWS_TEST_CASE(test_log_writer_bad_file_test, s_log_writer_bad_file_test);
+
+/*
+ * Batch test (verifies lines written one at a time and in batches stay in order)
+ */
+#define BATCH_FILE_CONTENT "Written alone\nWritten\nin a batch\nWritten alone again\n"
+
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_alone, "Written alone\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_first, "Written\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_second, "in a batch\n");
+AWS_STATIC_STRING_FROM_LITERAL(s_batch_alone_again, "Written alone again\n");
+
+static int s_log_writer_batch_file_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_log_writer_file_options options = {.filename = s_test_file_name};
+
+    struct aws_log_writer writer;
+    ASSERT_SUCCESS(aws_log_writer_init_file(&writer, allocator, &options));
+
+    if (writer.vtable->write_batch == NULL) {
+        /* not supported on this platform */
+        aws_log_writer_clean_up(&writer);
+        remove(s_test_file_name);
+        return AWS_OP_SUCCESS;
+    }
+
+    ASSERT_SUCCESS(writer.vtable->write(&writer, s_batch_alone));
+
+    const struct aws_string *batch[] = {s_batch_first, s_batch_second};
+    ASSERT_SUCCESS(writer.vtable->write_batch(&writer, batch, AWS_ARRAY_SIZE(batch)));
+
+    return do_default_log_writer_test(&writer, BATCH_FILE_CONTENT, s_batch_alone_again, NULL);
+}
+AWS_TEST_CASE(test_log_writer_batch_file_test, s_log_writer_batch_file_test);
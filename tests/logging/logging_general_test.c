@@ -14,6 +14,7 @@
  */
 
 #include "logging_test_utilities.h"
+#include "test_logger.h"
 
 DECLARE_LOGF_ALL_LEVELS_FUNCTION(s_logf_all_levels)
 
@@ -37,3 +38,67 @@ TEST_LEVEL_FILTER(AWS_LL_WARN, "123", s_logf_all_levels)
 TEST_LEVEL_FILTER(AWS_LL_ERROR, "12", s_logf_all_levels)
 TEST_LEVEL_FILTER(AWS_LL_FATAL, "1", s_logf_all_levels)
 TEST_LEVEL_FILTER(AWS_LL_NONE, "", s_logf_all_levels)
+
+/**
+ * Per-subject levels override the default level for their subject alone, including subjects that share storage
+ */
+static int s_log_subject_levels(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_log_subject_levels levels;
+    ASSERT_SUCCESS(aws_log_subject_levels_init(&levels, allocator, AWS_LL_WARN));
+
+    const aws_log_subject_t other_slot_subject = (3 << AWS_LOG_SUBJECT_BIT_SPACE) + AWS_LS_IO_DNS;
+
+    ASSERT_INT_EQUALS(AWS_LL_WARN, aws_log_subject_levels_get(&levels, AWS_LS_IO_DNS));
+
+    ASSERT_SUCCESS(aws_log_subject_levels_set(&levels, AWS_LS_IO_DNS, AWS_LL_TRACE));
+    ASSERT_SUCCESS(aws_log_subject_levels_set(&levels, AWS_LS_IO_PKI, AWS_LL_NONE));
+    ASSERT_SUCCESS(aws_log_subject_levels_set(&levels, other_slot_subject, AWS_LL_ERROR));
+
+    ASSERT_INT_EQUALS(AWS_LL_TRACE, aws_log_subject_levels_get(&levels, AWS_LS_IO_DNS));
+    ASSERT_INT_EQUALS(AWS_LL_NONE, aws_log_subject_levels_get(&levels, AWS_LS_IO_PKI));
+    ASSERT_INT_EQUALS(AWS_LL_WARN, aws_log_subject_levels_get(&levels, AWS_LS_IO_ALPN));
+    ASSERT_INT_EQUALS(AWS_LL_ERROR, aws_log_subject_levels_get(&levels, other_slot_subject));
+
+    ASSERT_SUCCESS(aws_log_subject_levels_set_default(&levels, AWS_LL_INFO));
+    ASSERT_INT_EQUALS(AWS_LL_TRACE, aws_log_subject_levels_get(&levels, AWS_LS_IO_DNS));
+    ASSERT_INT_EQUALS(AWS_LL_INFO, aws_log_subject_levels_get(&levels, AWS_LS_IO_ALPN));
+
+    ASSERT_SUCCESS(aws_log_subject_levels_clear(&levels, AWS_LS_IO_DNS));
+    ASSERT_INT_EQUALS(AWS_LL_INFO, aws_log_subject_levels_get(&levels, AWS_LS_IO_DNS));
+    ASSERT_INT_EQUALS(AWS_LL_NONE, aws_log_subject_levels_get(&levels, AWS_LS_IO_PKI));
+
+    /* subjects past the last slot can't have levels of their own, but still get the default */
+    const aws_log_subject_t out_of_range_subject = UINT32_MAX;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT, aws_log_subject_levels_set(&levels, out_of_range_subject, AWS_LL_TRACE));
+    ASSERT_INT_EQUALS(AWS_LL_INFO, aws_log_subject_levels_get(&levels, out_of_range_subject));
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_log_subject_levels_set(&levels, AWS_LS_IO_DNS, AWS_LL_COUNT));
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_log_subject_levels_set_default(&levels, AWS_LL_COUNT));
+
+    aws_log_subject_levels_clean_up(&levels);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_log_subject_levels, s_log_subject_levels);
+
+/**
+ * Loggers without a level table say so rather than silently ignoring the change
+ */
+static int s_logger_levels_unsupported(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_logger test_logger;
+    ASSERT_SUCCESS(test_logger_init(&test_logger, allocator, AWS_LL_WARN));
+
+    ASSERT_ERROR(AWS_ERROR_UNSUPPORTED_OPERATION, aws_logger_set_log_level(&test_logger, AWS_LL_TRACE));
+    ASSERT_ERROR(
+        AWS_ERROR_UNSUPPORTED_OPERATION,
+        aws_logger_set_subject_log_level(&test_logger, AWS_LS_IO_DNS, AWS_LL_TRACE));
+
+    aws_logger_clean_up(&test_logger);
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_logger_levels_unsupported, s_logger_levels_unsupported);
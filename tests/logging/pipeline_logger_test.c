@@ -133,4 +133,51 @@ static const char *expected_test_user_content[] =
     AWS_TEST_CASE(test_pipeline_logger_##test_name, s_pipeline_logger_##test_name);
 
 DEFINE_PIPELINE_LOGGER_TEST(unformatted_test, s_unformatted_pipeline_logger_test_callback)
-DEFINE_PIPELINE_LOGGER_TEST(formatted_test, s_formatted_pipeline_logger_test_callback)
\ No newline at end of file
+DEFINE_PIPELINE_LOGGER_TEST(formatted_test, s_formatted_pipeline_logger_test_callback)
+/*
+ * A subject can be turned up to TRACE while everything else stays at the default level
+ */
+static void s_subject_levels_pipeline_logger_test_callback(void) {
+    AWS_LOGF_TRACE(AWS_LS_IO_DNS, "dns trace call");
+    AWS_LOGF_TRACE(AWS_LS_IO_GENERAL, "general trace call");
+    AWS_LOGF_WARN(AWS_LS_IO_GENERAL, "general warn call");
+}
+
+static int s_pipeline_logger_subject_levels_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+
+    struct aws_logger_standard_options options = {.level = AWS_LL_WARN, .filename = s_test_file_name};
+
+    struct aws_logger logger;
+    ASSERT_SUCCESS(aws_logger_init_standard(&logger, allocator, &options));
+    ASSERT_SUCCESS(aws_logger_set_subject_log_level(&logger, AWS_LS_IO_DNS, AWS_LL_TRACE));
+
+    aws_logger_set(&logger);
+    s_subject_levels_pipeline_logger_test_callback();
+    aws_logger_set(NULL);
+
+    aws_logger_clean_up(&logger);
+
+    char buffer[TEST_PIPELINE_MAX_BUFFER_SIZE];
+    FILE *file = fopen(s_test_file_name, "r");
+    size_t bytes_read = 0;
+
+    if (file != NULL) {
+        bytes_read = fread(buffer, 1, TEST_PIPELINE_MAX_BUFFER_SIZE - 1, file);
+        fclose(file);
+    }
+
+    remove(s_test_file_name);
+
+    ASSERT_NOT_NULL(file);
+    buffer[bytes_read] = 0;
+
+    ASSERT_NOT_NULL(strstr(buffer, "dns trace call"));
+    ASSERT_NOT_NULL(strstr(buffer, "general warn call"));
+    ASSERT_NULL(strstr(buffer, "general trace call"));
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_pipeline_logger_subject_levels_test, s_pipeline_logger_subject_levels_test);
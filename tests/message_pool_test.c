@@ -0,0 +1,365 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/message_pool.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+/* passes everything through to the test's allocator, keeping track of what's live and how big the last block was */
+struct counting_allocator {
+    struct aws_allocator base;
+    struct aws_allocator *parent;
+    size_t live_allocations;
+    size_t allocation_count;
+    size_t last_allocation_size;
+};
+
+static void *s_counting_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    struct counting_allocator *counting = allocator->impl;
+    void *mem = aws_mem_acquire(counting->parent, size);
+    if (mem) {
+        counting->live_allocations++;
+        counting->allocation_count++;
+        counting->last_allocation_size = size;
+    }
+    return mem;
+}
+
+static void s_counting_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct counting_allocator *counting = allocator->impl;
+    counting->live_allocations--;
+    aws_mem_release(counting->parent, ptr);
+}
+
+static void s_counting_allocator_init(struct counting_allocator *counting, struct aws_allocator *parent) {
+    AWS_ZERO_STRUCT(*counting);
+    counting->base.mem_acquire = s_counting_mem_acquire;
+    counting->base.mem_release = s_counting_mem_release;
+    counting->base.impl = counting;
+    counting->parent = parent;
+}
+
+static int s_test_message_pool_default_size_classes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_message_pool_creation_args args = {
+        .application_data_msg_data_size = 16 * 1024,
+        .application_data_msg_count = 4,
+        .small_block_msg_data_size = 128,
+        .small_block_msg_count = 4,
+    };
+
+    struct aws_message_pool pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&pool, &counting.base, &args));
+
+    /* 128, 512, 2048, 8192 and the 16KB application data class */
+    ASSERT_UINT_EQUALS(5, pool.size_class_count);
+
+    struct aws_io_message *small = aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, 100);
+    ASSERT_NOT_NULL(small);
+    ASSERT_UINT_EQUALS(100, small->message_data.capacity);
+
+    /* a 2KB message comes out of the 2KB class, which starts out empty, not out of a preallocated 16KB block */
+    size_t allocations_before = counting.allocation_count;
+    struct aws_io_message *medium = aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, 2048);
+    ASSERT_NOT_NULL(medium);
+    ASSERT_UINT_EQUALS(2048, medium->message_data.capacity);
+    ASSERT_UINT_EQUALS(allocations_before + 1, counting.allocation_count);
+    ASSERT_TRUE(counting.last_allocation_size > 2048);
+    ASSERT_TRUE(counting.last_allocation_size < 8192);
+
+    /* anything bigger than the biggest class is capped to it */
+    struct aws_io_message *large = aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, 64 * 1024);
+    ASSERT_NOT_NULL(large);
+    ASSERT_UINT_EQUALS(16 * 1024, large->message_data.capacity);
+
+    aws_mem_release(medium->allocator, medium);
+
+    /* and once released, it's reused rather than allocated again */
+    allocations_before = counting.allocation_count;
+    struct aws_io_message *medium_again = aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1500);
+    ASSERT_PTR_EQUALS(medium, medium_again);
+    ASSERT_UINT_EQUALS(allocations_before, counting.allocation_count);
+
+    aws_mem_release(small->allocator, small);
+    aws_mem_release(medium_again->allocator, medium_again);
+    aws_mem_release(large->allocator, large);
+
+    aws_message_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_default_size_classes, s_test_message_pool_default_size_classes)
+
+static int s_test_message_pool_high_water_marks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_message_pool_size_class classes[] = {
+        {.msg_data_size = 64, .preallocated_msg_count = 2, .max_retained_msg_count = 2},
+        {.msg_data_size = 1024, .preallocated_msg_count = 1, .max_retained_msg_count = 3},
+    };
+
+    struct aws_message_pool_creation_args args = {
+        .size_classes = classes,
+        .size_class_count = AWS_ARRAY_SIZE(classes),
+    };
+
+    struct aws_message_pool pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&pool, &counting.base, &args));
+    ASSERT_UINT_EQUALS(2, pool.size_class_count);
+
+    /* one stack and one slab per class, nothing else */
+    ASSERT_UINT_EQUALS(4, counting.live_allocations);
+
+    struct aws_io_message *messages[6];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(messages); ++i) {
+        messages[i] = aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1000);
+        ASSERT_NOT_NULL(messages[i]);
+    }
+
+    /* the first came from the slab */
+    ASSERT_UINT_EQUALS(4 + 5, counting.live_allocations);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(messages); ++i) {
+        aws_mem_release(messages[i]->allocator, messages[i]);
+    }
+
+    /* the class keeps 3 idle messages: the slab one and two others */
+    ASSERT_UINT_EQUALS(4 + 2, counting.live_allocations);
+
+    aws_message_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_high_water_marks, s_test_message_pool_high_water_marks)
+
+static int s_test_memory_pool_keeps_slab_segments(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_memory_pool pool;
+    ASSERT_SUCCESS(aws_memory_pool_init_with_slab(&pool, &counting.base, 1, 1, 256));
+    ASSERT_UINT_EQUALS(2, counting.live_allocations);
+
+    void *from_slab = aws_memory_pool_acquire(&pool);
+    void *from_heap = aws_memory_pool_acquire(&pool);
+    ASSERT_NOT_NULL(from_slab);
+    ASSERT_NOT_NULL(from_heap);
+    ASSERT_UINT_EQUALS(3, counting.live_allocations);
+
+    /* the heap segment fills the pool, then has to make way for the slab one, which can't be freed */
+    aws_memory_pool_release(&pool, from_heap);
+    ASSERT_UINT_EQUALS(3, counting.live_allocations);
+    aws_memory_pool_release(&pool, from_slab);
+    ASSERT_UINT_EQUALS(2, counting.live_allocations);
+
+    ASSERT_PTR_EQUALS(from_slab, aws_memory_pool_acquire(&pool));
+    aws_memory_pool_release(&pool, from_slab);
+
+    aws_memory_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_keeps_slab_segments, s_test_memory_pool_keeps_slab_segments)
+
+static int s_test_message_pool_rejects_bad_size_classes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_message_pool_size_class unsorted[] = {
+        {.msg_data_size = 1024, .preallocated_msg_count = 1, .max_retained_msg_count = 1},
+        {.msg_data_size = 64, .preallocated_msg_count = 1, .max_retained_msg_count = 1},
+    };
+
+    struct aws_message_pool_creation_args args = {
+        .size_classes = unsorted,
+        .size_class_count = AWS_ARRAY_SIZE(unsorted),
+    };
+
+    struct aws_message_pool pool;
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_message_pool_init(&pool, &counting.base, &args));
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    struct aws_message_pool_size_class over_preallocated[] = {
+        {.msg_data_size = 64, .preallocated_msg_count = 2, .max_retained_msg_count = 1},
+    };
+    args.size_classes = over_preallocated;
+    args.size_class_count = AWS_ARRAY_SIZE(over_preallocated);
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_message_pool_init(&pool, &counting.base, &args));
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_rejects_bad_size_classes, s_test_message_pool_rejects_bad_size_classes)
+
+/* the window an adaptive pool looks at, in acquisitions */
+enum { TEST_ADAPT_WINDOW = 256 };
+
+static int s_test_memory_pool_grows_with_demand(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_memory_pool pool;
+    ASSERT_SUCCESS(aws_memory_pool_init(&pool, &counting.base, 1, 64));
+    ASSERT_SUCCESS(aws_memory_pool_set_bounds(&pool, 1, 16));
+
+    /* 8 in use at a time, but only 1 kept, so 7 of each 8 acquisitions miss */
+    void *segments[8];
+    for (size_t round = 0; round < TEST_ADAPT_WINDOW / AWS_ARRAY_SIZE(segments); ++round) {
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+            segments[i] = aws_memory_pool_acquire(&pool);
+            ASSERT_NOT_NULL(segments[i]);
+        }
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+            aws_memory_pool_release(&pool, segments[i]);
+        }
+    }
+    ASSERT_UINT_EQUALS(1, pool.ideal_segment_count);
+
+    /* the next acquisition closes the window and the pool grows, up to its bound */
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&pool);
+    }
+    ASSERT_UINT_EQUALS(16, pool.ideal_segment_count);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&pool, segments[i]);
+    }
+
+    /* all 8 were kept this time, so the round after that doesn't allocate at all */
+    size_t allocations_before = counting.allocation_count;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&pool);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&pool, segments[i]);
+    }
+    ASSERT_UINT_EQUALS(allocations_before, counting.allocation_count);
+
+    aws_memory_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_grows_with_demand, s_test_memory_pool_grows_with_demand)
+
+static int s_test_memory_pool_trims_when_idle(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_memory_pool pool;
+    ASSERT_SUCCESS(aws_memory_pool_init_with_slab(&pool, &counting.base, 0, 16, 64));
+
+    void *segments[16];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&pool);
+        ASSERT_NOT_NULL(segments[i]);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&pool, segments[i]);
+    }
+
+    ASSERT_SUCCESS(aws_memory_pool_set_bounds(&pool, 2, 16));
+    /* the stack, and 16 idle segments */
+    ASSERT_UINT_EQUALS(17, counting.live_allocations);
+
+    /* only ever one in use, so 15 sit idle for the whole window, and the pool gives back half of them */
+    for (size_t i = 0; i < TEST_ADAPT_WINDOW + 1; ++i) {
+        aws_memory_pool_release(&pool, aws_memory_pool_acquire(&pool));
+    }
+    ASSERT_UINT_EQUALS(8, pool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(1 + 8, counting.live_allocations);
+
+    /* and keeps going down to its lower bound */
+    for (size_t i = 0; i < 4 * TEST_ADAPT_WINDOW; ++i) {
+        aws_memory_pool_release(&pool, aws_memory_pool_acquire(&pool));
+    }
+    ASSERT_UINT_EQUALS(2, pool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(1 + 2, counting.live_allocations);
+
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_memory_pool_set_bounds(&pool, 4, 2));
+
+    aws_memory_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_trims_when_idle, s_test_memory_pool_trims_when_idle)
+
+static int s_test_memory_pool_adapts_without_acquisitions(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting;
+    s_counting_allocator_init(&counting, allocator);
+
+    struct aws_memory_pool pool;
+    ASSERT_SUCCESS(aws_memory_pool_init_with_slab(&pool, &counting.base, 0, 16, 64));
+
+    void *segments[16];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&pool);
+        ASSERT_NOT_NULL(segments[i]);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&pool, segments[i]);
+    }
+
+    /* without bounds there's nothing to adapt */
+    aws_memory_pool_adapt(&pool);
+    ASSERT_UINT_EQUALS(16, pool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(1 + 16, counting.live_allocations);
+
+    ASSERT_SUCCESS(aws_memory_pool_set_bounds(&pool, 2, 16));
+
+    /* nothing is acquired, so the window never fills, but ending it early still gives back half of what sat idle */
+    aws_memory_pool_adapt(&pool);
+    ASSERT_UINT_EQUALS(8, pool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(1 + 8, counting.live_allocations);
+
+    for (size_t i = 0; i < 4; ++i) {
+        aws_memory_pool_adapt(&pool);
+    }
+    ASSERT_UINT_EQUALS(2, pool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(1 + 2, counting.live_allocations);
+
+    aws_memory_pool_clean_up(&pool);
+    ASSERT_UINT_EQUALS(0, counting.live_allocations);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_adapts_without_acquisitions, s_test_memory_pool_adapts_without_acquisitions)
@@ -19,6 +19,7 @@
 
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/thread.h>
 
 #include <aws/testing/aws_test_harness.h>
 
@@ -484,3 +485,1060 @@ static int s_socket_close_test(struct aws_allocator *allocator, void *ctx) {
 }
 
 AWS_TEST_CASE(socket_handler_close, s_socket_close_test)
+
+enum {
+    MULTI_MESSAGE_CHUNK_SIZE = 8 * 1024,
+    MULTI_MESSAGE_CHUNK_COUNT = 32,
+};
+
+static int s_socket_multi_message_reads_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    /* every chunk gets its own byte pattern, so anything read out of order or twice shows up. */
+    static uint8_t s_sent[MULTI_MESSAGE_CHUNK_COUNT][MULTI_MESSAGE_CHUNK_SIZE];
+    static uint8_t s_received[MULTI_MESSAGE_CHUNK_COUNT * MULTI_MESSAGE_CHUNK_SIZE];
+    struct aws_byte_buf chunks[MULTI_MESSAGE_CHUNK_COUNT];
+    for (size_t i = 0; i < MULTI_MESSAGE_CHUNK_COUNT; ++i) {
+        for (size_t j = 0; j < MULTI_MESSAGE_CHUNK_SIZE; ++j) {
+            s_sent[i][j] = (uint8_t)(i * 7 + j);
+        }
+        chunks[i] = aws_byte_buf_from_array(s_sent[i], MULTI_MESSAGE_CHUNK_SIZE);
+    }
+
+    struct socket_test_rw_args incoming_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_empty_array(s_received, sizeof(s_received)),
+        .expected_read = sizeof(s_received),
+    };
+
+    uint8_t outgoing_received_message[128];
+    struct socket_test_rw_args outgoing_rw_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .received_message = aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+    };
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, sizeof(s_received), &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = outgoing_rw_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    /* a big per-tick budget, spread over several messages per read. */
+    struct aws_socket_handler_options handler_options = {
+        .max_read_size = 128 * 1024,
+        .max_messages_per_read = 8,
+    };
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    ASSERT_SUCCESS(aws_server_bootstrap_set_socket_handler_options(server_bootstrap, &handler_options));
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    /* this should not get used for a unix domain socket. */
+    struct aws_host_resolver dummy_resolver;
+    AWS_ZERO_STRUCT(dummy_resolver);
+    struct aws_client_bootstrap *client_bootstrap =
+        aws_client_bootstrap_new(allocator, &el_group, &dummy_resolver, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+    ASSERT_SUCCESS(aws_client_bootstrap_set_socket_handler_options(client_bootstrap, &handler_options));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    /* wait for both ends to setup */
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    for (size_t i = 0; i < MULTI_MESSAGE_CHUNK_COUNT; ++i) {
+        rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &chunks[i]);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_BIN_ARRAYS_EQUALS(
+        s_sent, sizeof(s_sent), incoming_rw_args.received_message.buffer, incoming_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+
+    aws_mutex_unlock(&mutex);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_release(client_bootstrap);
+    aws_server_bootstrap_release(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_multi_message_reads, s_socket_multi_message_reads_test)
+
+/*
+ * The datagram tests run a channel with a datagram socket handler and a capture handler on top. The channel's socket
+ * is connected to a peer socket that isn't in any channel, the test reads and writes it directly.
+ */
+enum {
+    DATAGRAM_TEST_MAX_SIZE = 64,
+    DATAGRAM_TEST_MAX_PER_READ = 4,
+    DATAGRAM_TEST_CAPTURE_COUNT = 16,
+    DATAGRAM_TEST_MAX_WRITES = 1040,
+};
+
+struct datagram_channel_test_args;
+
+struct datagram_test_write {
+    struct datagram_channel_test_args *args;
+    size_t index;
+};
+
+struct datagram_channel_test_args {
+    struct aws_allocator *allocator;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *loop;
+    struct aws_socket socket;
+    struct aws_socket peer;
+    size_t initial_window;
+    struct aws_channel *channel;
+    struct aws_channel_slot *capture_slot;
+    bool connect_completed;
+    bool setup_completed;
+    bool shutdown_completed;
+    int error_code;
+
+    /* datagrams read up the channel */
+    uint8_t received[DATAGRAM_TEST_CAPTURE_COUNT][DATAGRAM_TEST_MAX_SIZE];
+    size_t received_len[DATAGRAM_TEST_CAPTURE_COUNT];
+    size_t received_count;
+
+    /* datagrams written down the channel, and the order their writes completed in */
+    struct datagram_test_write writes[DATAGRAM_TEST_MAX_WRITES];
+    size_t write_count;
+    size_t completion_order[DATAGRAM_TEST_MAX_WRITES];
+    size_t completed_count;
+    int completion_error;
+
+    /* the next write batch, and how many writes had completed when it was written */
+    size_t batch_count;
+    size_t completed_before_batch;
+    size_t completed_after_batch;
+    bool writable_after_batch;
+
+    /* how many of the written datagrams the peer has read back, in order */
+    size_t peer_read_count;
+
+    /* the result of the last s_run_on_loop() call */
+    bool task_done;
+    int task_result;
+};
+
+static void s_fill_test_datagram(struct aws_byte_buf *buf, size_t index, size_t size) {
+    uint32_t tag = (uint32_t)index;
+    memcpy(buf->buffer, &tag, sizeof(tag));
+    for (size_t i = sizeof(tag); i < size; ++i) {
+        buf->buffer[i] = (uint8_t)(index + i);
+    }
+    buf->len = size;
+}
+
+static int s_check_test_datagram(const uint8_t *data, size_t len, size_t index, size_t size) {
+    uint8_t expected[2 * DATAGRAM_TEST_MAX_SIZE];
+    struct aws_byte_buf expected_buf = aws_byte_buf_from_empty_array(expected, sizeof(expected));
+    s_fill_test_datagram(&expected_buf, index, size);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_buf.buffer, expected_buf.len, data, len);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_datagram_capture_process_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+
+    struct datagram_channel_test_args *args = handler->impl;
+    int result = AWS_OP_SUCCESS;
+
+    aws_mutex_lock(&args->mutex);
+    if (args->received_count < DATAGRAM_TEST_CAPTURE_COUNT && message->message_data.len <= DATAGRAM_TEST_MAX_SIZE) {
+        memcpy(args->received[args->received_count], message->message_data.buffer, message->message_data.len);
+        args->received_len[args->received_count] = message->message_data.len;
+        args->received_count++;
+    } else {
+        result = aws_raise_error(AWS_ERROR_INVALID_BUFFER_SIZE);
+    }
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+
+    /* the window isn't given back, the test does that itself. */
+    aws_mem_release(message->allocator, message);
+    return result;
+}
+
+static int s_datagram_capture_process_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_datagram_capture_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    (void)slot;
+    (void)size;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_datagram_capture_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_datagram_capture_initial_window_size(struct aws_channel_handler *handler) {
+    struct datagram_channel_test_args *args = handler->impl;
+    return args->initial_window;
+}
+
+static size_t s_datagram_capture_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_datagram_capture_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler_vtable s_datagram_capture_vtable = {
+    .process_read_message = s_datagram_capture_process_read,
+    .process_write_message = s_datagram_capture_process_write,
+    .increment_read_window = s_datagram_capture_increment_read_window,
+    .shutdown = s_datagram_capture_shutdown,
+    .initial_window_size = s_datagram_capture_initial_window_size,
+    .message_overhead = s_datagram_capture_message_overhead,
+    .destroy = s_datagram_capture_destroy,
+};
+
+static int s_install_datagram_handlers(struct datagram_channel_test_args *args, struct aws_channel *channel) {
+    struct aws_channel_slot *socket_slot = aws_channel_slot_new(channel);
+    if (!socket_slot) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *socket_handler = aws_socket_handler_new_datagram(
+        args->allocator, &args->socket, socket_slot, DATAGRAM_TEST_MAX_SIZE, DATAGRAM_TEST_MAX_PER_READ);
+    if (!socket_handler || aws_channel_slot_set_handler(socket_slot, socket_handler)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_slot *capture_slot = aws_channel_slot_new(channel);
+    if (!capture_slot || aws_channel_slot_insert_end(channel, capture_slot)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *capture_handler = aws_mem_acquire(args->allocator, sizeof(struct aws_channel_handler));
+    if (!capture_handler) {
+        return AWS_OP_ERR;
+    }
+    capture_handler->alloc = args->allocator;
+    capture_handler->vtable = &s_datagram_capture_vtable;
+    capture_handler->impl = args;
+    if (aws_channel_slot_set_handler(capture_slot, capture_handler)) {
+        return AWS_OP_ERR;
+    }
+
+    args->capture_slot = capture_slot;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_datagram_channel_setup(struct aws_channel *channel, int error_code, void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+
+    if (!error_code && s_install_datagram_handlers(args, channel)) {
+        error_code = aws_last_error();
+    }
+
+    aws_mutex_lock(&args->mutex);
+    args->channel = channel;
+    args->error_code = error_code;
+    args->setup_completed = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_datagram_channel_shutdown(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct datagram_channel_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->shutdown_completed = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static void s_datagram_socket_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+    struct datagram_channel_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    args->error_code = error_code;
+    args->connect_completed = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_datagram_connect_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->connect_completed;
+}
+
+static bool s_datagram_setup_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->setup_completed;
+}
+
+static bool s_datagram_shutdown_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->shutdown_completed;
+}
+
+static bool s_datagram_task_done_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->task_done;
+}
+
+static bool s_datagram_writes_completed_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->completed_count == args->write_count;
+}
+
+struct datagram_loop_task {
+    struct aws_task task;
+    struct datagram_channel_test_args *args;
+    int (*fn)(struct datagram_channel_test_args *args);
+};
+
+static void s_datagram_loop_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct datagram_loop_task *loop_task = arg;
+    struct datagram_channel_test_args *args = loop_task->args;
+
+    int result = status == AWS_TASK_STATUS_RUN_READY ? loop_task->fn(args) : AWS_OP_ERR;
+
+    aws_mutex_lock(&args->mutex);
+    args->task_result = result;
+    args->task_done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+/* runs fn on the channel's event loop and waits for it. Called with the mutex held. */
+static int s_run_on_loop(struct datagram_channel_test_args *args, int (*fn)(struct datagram_channel_test_args *args)) {
+    struct datagram_loop_task loop_task = {.args = args, .fn = fn};
+    aws_task_init(&loop_task.task, s_datagram_loop_task, &loop_task);
+
+    args->task_done = false;
+    aws_event_loop_schedule_task_now(args->loop, &loop_task.task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_datagram_task_done_pred, args));
+    return args->task_result;
+}
+
+static void s_on_test_datagram_written(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+
+    struct datagram_test_write *write = user_data;
+    struct datagram_channel_test_args *args = write->args;
+
+    aws_mutex_lock(&args->mutex);
+    args->completion_order[args->completed_count++] = write->index;
+    if (err_code) {
+        args->completion_error = err_code;
+    }
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+/* writes batch_count datagrams down the channel, all during one tick. */
+static int s_write_datagram_batch(struct datagram_channel_test_args *args) {
+    aws_mutex_lock(&args->mutex);
+    args->completed_before_batch = args->completed_count;
+    aws_mutex_unlock(&args->mutex);
+
+    for (size_t i = 0; i < args->batch_count; ++i) {
+        ASSERT_TRUE(args->write_count < DATAGRAM_TEST_MAX_WRITES);
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            args->channel, AWS_IO_MESSAGE_APPLICATION_DATA, DATAGRAM_TEST_MAX_SIZE);
+        ASSERT_NOT_NULL(message);
+
+        struct datagram_test_write *write = &args->writes[args->write_count];
+        write->args = args;
+        write->index = args->write_count++;
+        s_fill_test_datagram(&message->message_data, write->index, DATAGRAM_TEST_MAX_SIZE);
+        message->on_completion = s_on_test_datagram_written;
+        message->user_data = write;
+
+        ASSERT_SUCCESS(aws_channel_slot_send_message(args->capture_slot, message, AWS_CHANNEL_DIR_WRITE));
+    }
+
+    aws_mutex_lock(&args->mutex);
+    args->completed_after_batch = args->completed_count;
+    aws_mutex_unlock(&args->mutex);
+
+    args->writable_after_batch = aws_channel_slot_downstream_is_writable(args->capture_slot);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* one queued datagram is enough to take the socket, and so the channel, over its high watermark. */
+static int s_set_datagram_watermarks(struct datagram_channel_test_args *args) {
+    return aws_socket_set_write_watermarks(&args->socket, 0, DATAGRAM_TEST_MAX_SIZE, NULL, NULL);
+}
+
+/* reads whatever the peer has waiting, each datagram has to be the next one written down the channel. */
+static int s_peer_read_datagrams(struct datagram_channel_test_args *args) {
+    uint8_t storage[DATAGRAM_TEST_CAPTURE_COUNT][DATAGRAM_TEST_MAX_SIZE];
+    struct aws_byte_buf bufs[DATAGRAM_TEST_CAPTURE_COUNT];
+    struct aws_socket_datagram datagrams[DATAGRAM_TEST_CAPTURE_COUNT];
+
+    while (true) {
+        AWS_ZERO_ARRAY(datagrams);
+        for (size_t i = 0; i < DATAGRAM_TEST_CAPTURE_COUNT; ++i) {
+            bufs[i] = aws_byte_buf_from_empty_array(storage[i], sizeof(storage[i]));
+            datagrams[i].buffer = &bufs[i];
+        }
+
+        size_t read = 0;
+        if (aws_socket_read_datagrams(&args->peer, datagrams, DATAGRAM_TEST_CAPTURE_COUNT, &read)) {
+            ASSERT_INT_EQUALS(AWS_IO_READ_WOULD_BLOCK, aws_last_error());
+            return AWS_OP_SUCCESS;
+        }
+
+        for (size_t i = 0; i < read; ++i) {
+            ASSERT_FALSE(datagrams[i].truncated);
+            ASSERT_SUCCESS(
+                s_check_test_datagram(bufs[i].buffer, bufs[i].len, args->peer_read_count, DATAGRAM_TEST_MAX_SIZE));
+            args->peer_read_count++;
+        }
+    }
+}
+
+/* polls the peer until it has read back every datagram written down the channel. Called with the mutex held. */
+static int s_wait_for_peer_reads(struct datagram_channel_test_args *args) {
+    for (size_t attempt = 0; attempt < 5000 && args->peer_read_count < args->write_count; ++attempt) {
+        ASSERT_SUCCESS(s_run_on_loop(args, s_peer_read_datagrams));
+        if (args->peer_read_count < args->write_count) {
+            aws_mutex_unlock(&args->mutex);
+            aws_thread_current_sleep(1000000);
+            aws_mutex_lock(&args->mutex);
+        }
+    }
+
+    ASSERT_UINT_EQUALS(args->write_count, args->peer_read_count);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_check_write_completions(struct datagram_channel_test_args *args) {
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args->condition_variable, &args->mutex, s_datagram_writes_completed_pred, args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, args->completion_error);
+    for (size_t i = 0; i < args->completed_count; ++i) {
+        ASSERT_UINT_EQUALS(i, args->completion_order[i]);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Connects the channel's socket to a peer bound at peer_endpoint and sets up the channel. Returns with the mutex held.
+ */
+static int s_datagram_channel_test_setup(
+    struct datagram_channel_test_args *args,
+    struct aws_allocator *allocator,
+    const struct aws_socket_options *options,
+    const struct aws_socket_endpoint *peer_endpoint,
+    size_t initial_window) {
+
+    AWS_ZERO_STRUCT(*args);
+    args->allocator = allocator;
+    args->mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    args->condition_variable = (struct aws_condition_variable)AWS_CONDITION_VARIABLE_INIT;
+    args->initial_window = initial_window;
+
+    args->loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(args->loop);
+    ASSERT_SUCCESS(aws_event_loop_run(args->loop));
+
+    ASSERT_SUCCESS(aws_socket_init(&args->peer, allocator, options));
+    ASSERT_SUCCESS(aws_socket_bind(&args->peer, peer_endpoint));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&args->peer, args->loop));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args->mutex));
+
+    ASSERT_SUCCESS(aws_socket_init(&args->socket, allocator, options));
+    ASSERT_SUCCESS(aws_socket_connect(&args->socket, peer_endpoint, args->loop, s_datagram_socket_connected, args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_datagram_connect_pred, args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, args->error_code);
+
+    struct aws_channel_creation_callbacks callbacks = {
+        .on_setup_completed = s_datagram_channel_setup,
+        .setup_user_data = args,
+        .on_shutdown_completed = s_datagram_channel_shutdown,
+        .shutdown_user_data = args,
+    };
+    ASSERT_NOT_NULL(aws_channel_new(allocator, args->loop, &callbacks));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_datagram_setup_pred, args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, args->error_code);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_close_peer(struct datagram_channel_test_args *args) {
+    return aws_socket_close(&args->peer);
+}
+
+/* Shuts the channel down and releases everything s_datagram_channel_test_setup() made. Called with the mutex held. */
+static int s_datagram_channel_test_clean_up(struct datagram_channel_test_args *args) {
+    ASSERT_SUCCESS(aws_channel_shutdown(args->channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_datagram_shutdown_pred, args));
+    ASSERT_SUCCESS(s_run_on_loop(args, s_close_peer));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args->mutex));
+
+    aws_channel_destroy(args->channel);
+    aws_socket_clean_up(&args->socket);
+    aws_socket_clean_up(&args->peer);
+    aws_event_loop_destroy(args->loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+enum { DATAGRAM_TEST_TRUNCATED_INDEX = 99 };
+
+/* sends d0, d1, a datagram too big for the handler, then d2 to d4, from the peer up the channel. */
+static int s_peer_send_datagrams(struct datagram_channel_test_args *args) {
+    uint8_t storage[6][2 * DATAGRAM_TEST_MAX_SIZE];
+    struct aws_byte_buf bufs[6];
+    struct aws_socket_datagram datagrams[6];
+    AWS_ZERO_ARRAY(datagrams);
+
+    size_t index = 0;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(datagrams); ++i) {
+        bufs[i] = aws_byte_buf_from_empty_array(storage[i], sizeof(storage[i]));
+        if (i == 2) {
+            s_fill_test_datagram(&bufs[i], DATAGRAM_TEST_TRUNCATED_INDEX, DATAGRAM_TEST_MAX_SIZE + 1);
+        } else {
+            s_fill_test_datagram(&bufs[i], index++, DATAGRAM_TEST_MAX_SIZE);
+        }
+        datagrams[i].buffer = &bufs[i];
+        datagrams[i].endpoint = args->socket.local_endpoint;
+    }
+
+    size_t written = 0;
+    ASSERT_SUCCESS(aws_socket_write_datagrams(&args->peer, datagrams, AWS_ARRAY_SIZE(datagrams), &written));
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(datagrams), written);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_open_read_window(struct datagram_channel_test_args *args) {
+    return aws_channel_slot_increment_read_window(args->capture_slot, 2 * DATAGRAM_TEST_MAX_SIZE);
+}
+
+static bool s_datagram_received_pred(void *user_data) {
+    struct datagram_channel_test_args *args = user_data;
+    return args->received_count >= args->batch_count;
+}
+
+/* waits for expected datagrams to come up the channel, then a bit longer to make sure no more do. */
+static int s_wait_for_received(struct datagram_channel_test_args *args, size_t expected) {
+    args->batch_count = expected;
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args->condition_variable, &args->mutex, s_datagram_received_pred, args));
+
+    aws_mutex_unlock(&args->mutex);
+    aws_thread_current_sleep(100000000);
+    aws_mutex_lock(&args->mutex);
+
+    ASSERT_UINT_EQUALS(expected, args->received_count);
+    return AWS_OP_SUCCESS;
+}
+
+/* Round trips datagrams over UDP through a channel with a datagram socket handler. */
+static int s_socket_handler_datagram_round_trip_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint peer_endpoint = {.address = "127.0.0.1", .port = 8134};
+
+    /* room for two datagrams, so reads stop there until the test opens the window again */
+    struct datagram_channel_test_args args;
+    ASSERT_SUCCESS(
+        s_datagram_channel_test_setup(&args, allocator, &options, &peer_endpoint, 2 * DATAGRAM_TEST_MAX_SIZE));
+
+    /* everything written during a tick goes out together, after the tick's other tasks, in the order written */
+    args.batch_count = 8;
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_write_datagram_batch));
+    ASSERT_UINT_EQUALS(0, args.completed_after_batch);
+    ASSERT_SUCCESS(s_check_write_completions(&args));
+    ASSERT_SUCCESS(s_wait_for_peer_reads(&args));
+
+    /* reads only take as many datagrams as fit the window */
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_peer_send_datagrams));
+    ASSERT_SUCCESS(s_wait_for_received(&args, 2));
+
+    /* the datagram that doesn't fit in a message is dropped, and takes none of the window */
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_open_read_window));
+    ASSERT_SUCCESS(s_wait_for_received(&args, 4));
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_open_read_window));
+    ASSERT_SUCCESS(s_wait_for_received(&args, 5));
+
+    for (size_t i = 0; i < args.received_count; ++i) {
+        ASSERT_SUCCESS(s_check_test_datagram(args.received[i], args.received_len[i], i, DATAGRAM_TEST_MAX_SIZE));
+    }
+
+    ASSERT_SUCCESS(s_datagram_channel_test_clean_up(&args));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_datagram_round_trip, s_socket_handler_datagram_round_trip_test)
+
+/*
+ * Fills the send buffer of a datagram socket handler, so that what doesn't fit goes through aws_socket_write(), and
+ * checks that everything still arrives and completes in the order it was written. Loopback UDP never fills the send
+ * buffer, so this runs over local datagram sockets, where a peer that doesn't read holds the writer back.
+ */
+static int s_socket_handler_datagram_queued_writes_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint peer_endpoint;
+    AWS_ZERO_STRUCT(peer_endpoint);
+    snprintf(
+        peer_endpoint.address,
+        sizeof(peer_endpoint.address),
+        LOCAL_SOCK_TEST_PATTERN,
+        (long long unsigned)timestamp);
+
+    struct datagram_channel_test_args args;
+    ASSERT_SUCCESS(s_datagram_channel_test_setup(&args, allocator, &options, &peer_endpoint, SIZE_MAX));
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_set_datagram_watermarks));
+
+    /* far more than the peer's queue takes while it isn't reading */
+    args.batch_count = DATAGRAM_TEST_MAX_WRITES - 16;
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_write_datagram_batch));
+
+    /* by now the batch has been flushed, and whatever didn't fit is waiting in the socket's write queue. Until that's
+     * out, this batch has to wait behind it. */
+    args.batch_count = 16;
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_write_datagram_batch));
+    ASSERT_TRUE(args.completed_before_batch < DATAGRAM_TEST_MAX_WRITES - 16);
+    ASSERT_FALSE(args.writable_after_batch);
+
+    ASSERT_SUCCESS(s_wait_for_peer_reads(&args));
+    ASSERT_SUCCESS(s_check_write_completions(&args));
+
+    /* everything's out, so an empty batch finds the channel writable again */
+    args.batch_count = 0;
+    ASSERT_SUCCESS(s_run_on_loop(&args, s_write_datagram_batch));
+    ASSERT_TRUE(args.writable_after_batch);
+
+    ASSERT_SUCCESS(s_datagram_channel_test_clean_up(&args));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_datagram_queued_writes, s_socket_handler_datagram_queued_writes_test)
+
+enum {
+    WATERMARK_TEST_HIGH = 64 * 1024,
+    WATERMARK_TEST_LOW = 16 * 1024,
+    WATERMARK_TEST_MESSAGE_SIZE = 16 * 1024,
+    /* a lot more than the kernel's socket buffers and the high watermark together */
+    WATERMARK_TEST_MAX_MESSAGES = 4096,
+};
+
+struct watermark_test_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_channel_slot *writer_slot;
+    struct aws_channel_task write_task;
+    size_t bytes_written;
+    size_t bytes_read;
+    bool write_done;
+    bool blocked;
+    size_t on_writable_count;
+    bool writable_in_on_writable;
+};
+
+static int s_watermark_writer_process_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_watermark_writer_process_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_watermark_writer_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    (void)slot;
+    (void)size;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_watermark_writer_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_watermark_writer_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_watermark_writer_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_watermark_writer_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler);
+}
+
+static void s_watermark_writer_on_writable(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    struct watermark_test_args *args = handler->impl;
+
+    aws_mutex_lock(args->mutex);
+    args->on_writable_count++;
+    args->writable_in_on_writable = aws_channel_slot_downstream_is_writable(slot);
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static struct aws_channel_handler_vtable s_watermark_writer_vtable = {
+    .process_read_message = s_watermark_writer_process_read,
+    .process_write_message = s_watermark_writer_process_write,
+    .increment_read_window = s_watermark_writer_increment_read_window,
+    .shutdown = s_watermark_writer_shutdown,
+    .initial_window_size = s_watermark_writer_initial_window_size,
+    .message_overhead = s_watermark_writer_message_overhead,
+    .destroy = s_watermark_writer_destroy,
+    .on_writable = s_watermark_writer_on_writable,
+};
+
+/* writes until the socket handler says to hold off, all during one tick. */
+static void s_watermark_write_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct watermark_test_args *args = arg;
+    struct aws_channel_slot *slot = args->writer_slot;
+
+    size_t bytes_written = 0;
+    bool blocked = false;
+    for (size_t i = 0; i < WATERMARK_TEST_MAX_MESSAGES; ++i) {
+        if (!aws_channel_slot_downstream_is_writable(slot)) {
+            blocked = true;
+            break;
+        }
+
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, WATERMARK_TEST_MESSAGE_SIZE);
+        if (!message) {
+            break;
+        }
+
+        size_t message_size = message->message_data.capacity;
+        memset(message->message_data.buffer, 'w', message_size);
+        message->message_data.len = message_size;
+        if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            aws_mem_release(message->allocator, message);
+            break;
+        }
+        bytes_written += message_size;
+    }
+
+    aws_mutex_lock(args->mutex);
+    args->bytes_written = bytes_written;
+    args->blocked = blocked;
+    args->write_done = true;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static struct aws_byte_buf s_watermark_test_handle_read(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+
+    (void)handler;
+    (void)slot;
+
+    struct watermark_test_args *args = user_data;
+
+    aws_mutex_lock(args->mutex);
+    args->bytes_read += data_read->len;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+
+    return (struct aws_byte_buf){0};
+}
+
+static bool s_watermark_write_done_predicate(void *user_data) {
+    struct watermark_test_args *args = user_data;
+    return args->write_done;
+}
+
+static bool s_watermark_drained_predicate(void *user_data) {
+    struct watermark_test_args *args = user_data;
+    return args->bytes_read == args->bytes_written && args->on_writable_count > 0;
+}
+
+/*
+ * Writes past the client socket handler's high watermark to a server that doesn't read, then lets the server read
+ * everything. The writer must be told to hold off, and its on_writable must fire exactly once after the drain.
+ */
+static int s_socket_handler_write_watermarks_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_group el_group;
+    ASSERT_SUCCESS(aws_event_loop_group_default_init(&el_group, allocator, 0));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct watermark_test_args watermark_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    /* the server doesn't read anything until the test opens its window. */
+    struct aws_channel_handler *incoming_rw_handler =
+        rw_handler_new(allocator, s_watermark_test_handle_read, s_socket_test_handle_write, true, 0, &watermark_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct aws_channel_handler *writer_handler = aws_mem_acquire(allocator, sizeof(struct aws_channel_handler));
+    ASSERT_NOT_NULL(writer_handler);
+    AWS_ZERO_STRUCT(*writer_handler);
+    writer_handler->alloc = allocator;
+    writer_handler->vtable = &s_watermark_writer_vtable;
+    writer_handler->impl = &watermark_args;
+
+    struct socket_test_args incoming_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = incoming_rw_handler,
+    };
+
+    struct socket_test_args outgoing_args = {
+        .mutex = &mutex,
+        .allocator = allocator,
+        .condition_variable = &condition_variable,
+        .rw_handler = writer_handler,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+
+    struct aws_socket_endpoint endpoint;
+
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, &el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(
+        server_bootstrap,
+        &endpoint,
+        &options,
+        s_socket_handler_test_server_setup_callback,
+        s_socket_handler_test_server_shutdown_callback,
+        &incoming_args);
+    ASSERT_NOT_NULL(listener);
+
+    /* this should never get used for this case. */
+    struct aws_host_resolver dummy_resolver;
+    AWS_ZERO_STRUCT(dummy_resolver);
+    struct aws_client_bootstrap *client_bootstrap =
+        aws_client_bootstrap_new(allocator, &el_group, &dummy_resolver, NULL);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_handler_options handler_options = {
+        .max_read_size = g_aws_channel_max_fragment_size,
+        .max_messages_per_read = 1,
+        .write_high_watermark = WATERMARK_TEST_HIGH,
+        .write_low_watermark = WATERMARK_TEST_LOW,
+    };
+    ASSERT_SUCCESS(aws_client_bootstrap_set_socket_handler_options(client_bootstrap, &handler_options));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(
+        client_bootstrap,
+        endpoint.address,
+        0,
+        &options,
+        s_socket_handler_test_client_setup_callback,
+        s_socket_handler_test_client_shutdown_callback,
+        &outgoing_args));
+
+    /* wait for both ends to setup */
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_setup_predicate, &outgoing_args));
+
+    watermark_args.writer_slot = outgoing_args.rw_slot;
+    aws_channel_task_init(&watermark_args.write_task, s_watermark_write_task, &watermark_args);
+    aws_channel_schedule_task_now(outgoing_args.channel, &watermark_args.write_task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_watermark_write_done_predicate, &watermark_args));
+
+    ASSERT_TRUE(watermark_args.blocked);
+    ASSERT_TRUE(watermark_args.bytes_written >= WATERMARK_TEST_HIGH);
+    ASSERT_UINT_EQUALS(0, watermark_args.on_writable_count);
+
+    /* nothing is read while the server's window is closed, so nothing drains either. */
+    aws_mutex_unlock(&mutex);
+    aws_thread_current_sleep(100000000);
+    aws_mutex_lock(&mutex);
+    ASSERT_UINT_EQUALS(0, watermark_args.bytes_read);
+    ASSERT_UINT_EQUALS(0, watermark_args.on_writable_count);
+
+    rw_handler_trigger_increment_read_window(incoming_args.rw_handler, incoming_args.rw_slot, SIZE_MAX / 2);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_watermark_drained_predicate, &watermark_args));
+
+    /* everything has been read, so nothing is left to drain that could call on_writable again. */
+    aws_mutex_unlock(&mutex);
+    aws_thread_current_sleep(100000000);
+    aws_mutex_lock(&mutex);
+    ASSERT_UINT_EQUALS(1, watermark_args.on_writable_count);
+    ASSERT_TRUE(watermark_args.writable_in_on_writable);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_channel_shutdown_predicate, &outgoing_args));
+
+    aws_mutex_unlock(&mutex);
+    ASSERT_SUCCESS(aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener));
+    aws_client_bootstrap_release(client_bootstrap);
+    aws_server_bootstrap_release(server_bootstrap);
+    aws_event_loop_group_clean_up(&el_group);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_write_watermarks, s_socket_handler_write_watermarks_test)
@@ -24,6 +24,15 @@
 #include <aws/io/host_resolver.h>
 #include <aws/io/socket.h>
 
+#ifndef _WIN32
+#    include <arpa/inet.h>
+#    include <ifaddrs.h>
+#    include <net/if.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#endif
+
 #ifdef _WIN32
 #    define LOCAL_SOCK_TEST_PATTERN "\\\\.\\pipe\\testsock%llu"
 #else
@@ -1111,6 +1120,1175 @@ static int s_cleanup_in_write_cb_doesnt_explode(struct aws_allocator *allocator,
 }
 AWS_TEST_CASE(cleanup_in_write_cb_doesnt_explode, s_cleanup_in_write_cb_doesnt_explode)
 
+enum {
+    QUEUED_WRITE_COUNT = 200,
+    QUEUED_WRITE_SIZE = 7,
+    BLOCKING_WRITE_SIZE = 4 * 1024 * 1024,
+};
+
+struct queued_writes_args {
+    struct aws_socket *writer;
+    struct aws_socket *reader;
+    struct aws_byte_buf blocking_data;
+    struct aws_byte_buf queued_data;
+    struct aws_byte_buf received;
+    bool vectored;
+    bool watermarks;
+    bool writable_after_writes;
+    size_t writable_count;
+    size_t pending_when_writable;
+    size_t expected_completions;
+    size_t completed_count;
+    size_t completion_order[QUEUED_WRITE_COUNT + 1];
+    size_t completion_amounts[QUEUED_WRITE_COUNT + 1];
+    int last_error;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+};
+
+struct queued_write_user_data {
+    struct queued_writes_args *args;
+    size_t index;
+};
+
+static struct queued_write_user_data s_queued_write_user_data[QUEUED_WRITE_COUNT + 1];
+
+static void s_on_queued_write(struct aws_socket *socket, int error_code, size_t amount_written, void *user_data) {
+    (void)socket;
+    struct queued_write_user_data *write_data = user_data;
+    struct queued_writes_args *args = write_data->args;
+
+    aws_mutex_lock(args->mutex);
+    if (error_code) {
+        args->last_error = error_code;
+    }
+    args->completion_order[args->completed_count] = write_data->index;
+    args->completion_amounts[args->completed_count] = amount_written;
+    args->completed_count++;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static void s_on_queued_writes_writable(struct aws_socket *socket, void *user_data) {
+    struct queued_writes_args *args = user_data;
+
+    aws_mutex_lock(args->mutex);
+    args->writable_count++;
+    args->pending_when_writable = aws_socket_get_pending_write_bytes(socket);
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+/*
+ * fills the socket buffer with one big write, then queues lots of tiny ones behind it, either one at a time or as a
+ * single vectored write.
+ */
+static void s_queued_writes_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct queued_writes_args *args = arg;
+
+    if (args->watermarks) {
+        /* whatever's left of the big write plus the tiny ones is over the high watermark, and only fully drained
+         * counts as writable again. */
+        aws_socket_set_write_watermarks(
+            args->writer, 0, QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE, s_on_queued_writes_writable, args);
+    }
+
+    s_queued_write_user_data[0].args = args;
+    s_queued_write_user_data[0].index = 0;
+    struct aws_byte_cursor blocking_cursor = aws_byte_cursor_from_buf(&args->blocking_data);
+    aws_socket_write(args->writer, &blocking_cursor, s_on_queued_write, &s_queued_write_user_data[0]);
+
+    struct aws_byte_cursor cursors[QUEUED_WRITE_COUNT];
+    for (size_t i = 1; i <= QUEUED_WRITE_COUNT; ++i) {
+        s_queued_write_user_data[i].args = args;
+        s_queued_write_user_data[i].index = i;
+        cursors[i - 1] =
+            aws_byte_cursor_from_array(args->queued_data.buffer + (i - 1) * QUEUED_WRITE_SIZE, QUEUED_WRITE_SIZE);
+        if (!args->vectored) {
+            aws_socket_write(args->writer, &cursors[i - 1], s_on_queued_write, &s_queued_write_user_data[i]);
+        }
+    }
+
+    if (args->vectored) {
+        aws_socket_write_vectored(
+            args->writer,
+            cursors,
+            QUEUED_WRITE_COUNT,
+            s_on_queued_write,
+            &s_queued_write_user_data[QUEUED_WRITE_COUNT]);
+    }
+
+    aws_mutex_lock(args->mutex);
+    args->writable_after_writes = aws_socket_is_writable(args->writer);
+    aws_mutex_unlock(args->mutex);
+}
+
+static void s_on_queued_writes_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)error_code;
+    struct queued_writes_args *args = user_data;
+
+    aws_mutex_lock(args->mutex);
+    size_t amount_read = 0;
+    do {
+        amount_read = 0;
+        if (aws_socket_read(socket, &args->received, &amount_read)) {
+            break;
+        }
+    } while (amount_read > 0 && args->received.len < args->received.capacity);
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static bool s_queued_writes_done_predicate(void *arg) {
+    struct queued_writes_args *args = arg;
+    return args->completed_count == args->expected_completions && args->received.len == args->received.capacity &&
+           (!args->watermarks || args->writable_count > 0);
+}
+
+/*
+ * Writes one big buffer followed by lots of tiny ones over a connection to `endpoint`, and checks that they all
+ * complete, in order, with their full size, and that the bytes arrive in the order they were written. If `vectored`
+ * is set, the tiny ones go out as one aws_socket_write_vectored() call, which completes once. If `watermarks` is set,
+ * also checks that the writer stops being writable once they're queued, and is told when it's writable again.
+ */
+static int s_queued_writes_round_trip(
+    struct aws_allocator *allocator,
+    struct aws_socket_options *options,
+    struct aws_socket_endpoint *endpoint,
+    bool vectored,
+    bool watermarks) {
+
+    /* the reader gets its own loop so that it can keep draining while the writer's loop is busy */
+    struct aws_event_loop *write_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    struct aws_event_loop *read_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(write_loop);
+    ASSERT_NOT_NULL(read_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(write_loop));
+    ASSERT_SUCCESS(aws_event_loop_run(read_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, read_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, endpoint, write_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    struct queued_writes_args args = {
+        .writer = &outgoing,
+        .reader = server_sock,
+        .vectored = vectored,
+        .watermarks = watermarks,
+        .expected_completions = vectored ? 2 : QUEUED_WRITE_COUNT + 1,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.blocking_data, allocator, BLOCKING_WRITE_SIZE));
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.queued_data, allocator, QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE));
+    ASSERT_SUCCESS(aws_byte_buf_init(
+        &args.received, allocator, BLOCKING_WRITE_SIZE + QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE));
+
+    for (size_t i = 0; i < BLOCKING_WRITE_SIZE; ++i) {
+        args.blocking_data.buffer[i] = (uint8_t)(i % 251);
+    }
+    args.blocking_data.len = BLOCKING_WRITE_SIZE;
+
+    for (size_t i = 0; i < QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE; ++i) {
+        args.queued_data.buffer[i] = (uint8_t)('a' + (i / QUEUED_WRITE_SIZE) % 26);
+    }
+    args.queued_data.len = QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE;
+
+    /* readable events are edge triggered, so the callback has to be in place before the loop can see any data */
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(server_sock, s_on_queued_writes_readable, &args));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, read_loop));
+
+    struct aws_task write_task;
+    aws_task_init(&write_task, s_queued_writes_task, &args);
+    aws_event_loop_schedule_task_now(write_loop, &write_task);
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_queued_writes_done_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, args.last_error);
+    ASSERT_UINT_EQUALS(0, args.completion_order[0]);
+    ASSERT_UINT_EQUALS(BLOCKING_WRITE_SIZE, args.completion_amounts[0]);
+    if (vectored) {
+        ASSERT_UINT_EQUALS(QUEUED_WRITE_COUNT, args.completion_order[1]);
+        ASSERT_UINT_EQUALS(QUEUED_WRITE_SIZE, args.completion_amounts[1]);
+    } else {
+        for (size_t i = 1; i <= QUEUED_WRITE_COUNT; ++i) {
+            ASSERT_UINT_EQUALS(i, args.completion_order[i]);
+            ASSERT_UINT_EQUALS(QUEUED_WRITE_SIZE, args.completion_amounts[i]);
+        }
+    }
+
+    ASSERT_BIN_ARRAYS_EQUALS(
+        args.blocking_data.buffer, args.blocking_data.len, args.received.buffer, BLOCKING_WRITE_SIZE);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        args.queued_data.buffer,
+        args.queued_data.len,
+        args.received.buffer + BLOCKING_WRITE_SIZE,
+        args.received.len - BLOCKING_WRITE_SIZE);
+
+    if (watermarks) {
+        ASSERT_FALSE(args.writable_after_writes);
+        ASSERT_UINT_EQUALS(1, args.writable_count);
+        ASSERT_UINT_EQUALS(0, args.pending_when_writable);
+        ASSERT_TRUE(aws_socket_is_writable(&outgoing));
+    } else {
+        ASSERT_TRUE(args.writable_after_writes);
+    }
+    ASSERT_UINT_EQUALS(0, aws_socket_get_pending_write_bytes(&outgoing));
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    io_args.socket = server_sock;
+    aws_event_loop_schedule_task_now(read_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+
+    io_args.socket = &outgoing;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(write_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+
+    io_args.socket = &listener;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(read_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+    aws_socket_clean_up(&outgoing);
+    aws_socket_clean_up(&listener);
+
+    aws_byte_buf_clean_up(&args.blocking_data);
+    aws_byte_buf_clean_up(&args.queued_data);
+    aws_byte_buf_clean_up(&args.received);
+
+    aws_event_loop_destroy(write_loop);
+    aws_event_loop_destroy(read_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_socket_queued_writes_complete_in_order(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    return s_queued_writes_round_trip(allocator, &options, &endpoint, false, false);
+}
+
+AWS_TEST_CASE(socket_queued_writes_complete_in_order, s_test_socket_queued_writes_complete_in_order)
+
+/*
+ * Same as above, but over TCP with the big write above the zero-copy threshold. Where MSG_ZEROCOPY is supported its
+ * completion has to wait on the kernel's notification, and the small writes queued behind it still have to complete
+ * after it. Elsewhere the option is ignored and this is a plain TCP round trip.
+ */
+static int s_test_socket_zero_copy_writes_complete_in_order(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.zero_copy_threshold = 64 * 1024;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8128};
+
+    return s_queued_writes_round_trip(allocator, &options, &endpoint, false, false);
+}
+
+AWS_TEST_CASE(socket_zero_copy_writes_complete_in_order, s_test_socket_zero_copy_writes_complete_in_order)
+
+/* a local address that isn't loopback, so the connection goes through a real interface's route where there is one. */
+static void s_get_non_loopback_ipv4_address(char *address, size_t address_size) {
+    snprintf(address, address_size, "127.0.0.1");
+#ifndef _WIN32
+    struct ifaddrs *interfaces = NULL;
+    if (getifaddrs(&interfaces)) {
+        return;
+    }
+
+    for (struct ifaddrs *iter = interfaces; iter; iter = iter->ifa_next) {
+        if (!iter->ifa_addr || iter->ifa_addr->sa_family != AF_INET || !(iter->ifa_flags & IFF_UP) ||
+            iter->ifa_flags & IFF_LOOPBACK) {
+            continue;
+        }
+
+        struct sockaddr_in *interface_address = (struct sockaddr_in *)iter->ifa_addr;
+        if (inet_ntop(AF_INET, &interface_address->sin_addr, address, (socklen_t)address_size)) {
+            break;
+        }
+        snprintf(address, address_size, "127.0.0.1");
+    }
+
+    freeifaddrs(interfaces);
+#endif
+}
+
+#define ZERO_COPY_CLOSE_WRITE_SIZE (8 * 1024 * 1024)
+#define ZERO_COPY_CLOSE_POISON 0xff
+
+struct zero_copy_close_args {
+    struct aws_socket *writer;
+    struct aws_socket *reader;
+    struct aws_byte_buf data;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    int write_error;
+    bool write_completed;
+    size_t amount_received;
+    bool poison_received;
+    bool read_done;
+};
+
+static void s_zero_copy_close_on_written(struct aws_socket *socket, int error_code, size_t amount, void *user_data) {
+    (void)socket;
+    (void)amount;
+    struct zero_copy_close_args *args = user_data;
+
+    aws_mutex_lock(args->mutex);
+    args->write_error = error_code;
+    args->write_completed = true;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static bool s_zero_copy_close_write_completed_predicate(void *arg) {
+    struct zero_copy_close_args *args = arg;
+    return args->write_completed;
+}
+
+static bool s_zero_copy_close_read_done_predicate(void *arg) {
+    struct zero_copy_close_args *args = arg;
+    return args->read_done;
+}
+
+/* the reader doesn't read until the writer is gone, so that most of the write is still queued in the kernel. */
+static void s_zero_copy_close_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+    (void)error_code;
+    (void)user_data;
+}
+
+/* writes far more than the peer can take, then closes with most of it still queued. */
+static void s_zero_copy_close_write_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct zero_copy_close_args *args = arg;
+
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&args->data);
+    if (aws_socket_write(args->writer, &cursor, s_zero_copy_close_on_written, args)) {
+        s_zero_copy_close_on_written(args->writer, aws_last_error(), 0, args);
+        return;
+    }
+
+    aws_socket_close(args->writer);
+}
+
+static void s_zero_copy_close_read_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct zero_copy_close_args *args = arg;
+
+    uint8_t read_storage[64 * 1024];
+    size_t idle_reads = 0;
+    for (;;) {
+        struct aws_byte_buf read_buf = aws_byte_buf_from_empty_array(read_storage, sizeof(read_storage));
+        size_t amount_read = 0;
+        if (aws_socket_read(args->reader, &read_buf, &amount_read)) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK || ++idle_reads > 1000) {
+                break;
+            }
+            aws_thread_current_sleep(1000000);
+            continue;
+        }
+
+        idle_reads = 0;
+        for (size_t i = 0; i < amount_read; ++i) {
+            if (read_storage[i] == ZERO_COPY_CLOSE_POISON) {
+                args->poison_received = true;
+            }
+        }
+        args->amount_received += amount_read;
+    }
+
+    aws_mutex_lock(args->mutex);
+    args->read_done = true;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+/*
+ * Closes a socket while the kernel still holds the buffer of a zero-copy write. The write completes as cancelled, so
+ * its buffer is overwritten right away, and none of the overwritten bytes may reach the peer afterwards. Where
+ * MSG_ZEROCOPY isn't supported the write was copied and this can't happen anyway.
+ */
+static int s_test_socket_zero_copy_close_stops_sending(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.zero_copy_threshold = 64 * 1024;
+
+    struct aws_socket_endpoint endpoint = {.port = 8129};
+    s_get_non_loopback_ipv4_address(endpoint.address, sizeof(endpoint.address));
+
+    struct aws_event_loop *write_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    struct aws_event_loop *read_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(write_loop);
+    ASSERT_NOT_NULL(read_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(write_loop));
+    ASSERT_SUCCESS(aws_event_loop_run(read_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, read_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, write_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    struct zero_copy_close_args args = {
+        .writer = &outgoing,
+        .reader = server_sock,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.data, allocator, ZERO_COPY_CLOSE_WRITE_SIZE));
+    for (size_t i = 0; i < ZERO_COPY_CLOSE_WRITE_SIZE; ++i) {
+        args.data.buffer[i] = (uint8_t)(i % 251);
+    }
+    args.data.len = ZERO_COPY_CLOSE_WRITE_SIZE;
+
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(server_sock, s_zero_copy_close_readable, &args));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, read_loop));
+
+    struct aws_task write_task;
+    aws_task_init(&write_task, s_zero_copy_close_write_task, &args);
+    aws_event_loop_schedule_task_now(write_loop, &write_task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_zero_copy_close_write_completed_predicate, &args));
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_CLOSED, args.write_error);
+
+    /* the write is over as far as the caller is concerned, so its buffer is theirs again. */
+    memset(args.data.buffer, ZERO_COPY_CLOSE_POISON, args.data.len);
+
+    struct aws_task read_task;
+    aws_task_init(&read_task, s_zero_copy_close_read_task, &args);
+    aws_event_loop_schedule_task_now(read_loop, &read_task);
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_zero_copy_close_read_done_predicate, &args));
+    ASSERT_FALSE(args.poison_received);
+    ASSERT_TRUE(args.amount_received < ZERO_COPY_CLOSE_WRITE_SIZE);
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    io_args.socket = server_sock;
+    aws_event_loop_schedule_task_now(read_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+
+    io_args.socket = &listener;
+    io_args.close_completed = false;
+    aws_event_loop_schedule_task_now(read_loop, &close_task);
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+    aws_socket_clean_up(&outgoing);
+    aws_socket_clean_up(&listener);
+    aws_byte_buf_clean_up(&args.data);
+
+    aws_event_loop_destroy(write_loop);
+    aws_event_loop_destroy(read_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_zero_copy_close_stops_sending, s_test_socket_zero_copy_close_stops_sending)
+
+/* Same as socket_queued_writes_complete_in_order, but the tiny writes are handed over as one vectored write. */
+static int s_test_socket_vectored_write_completes_once(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    return s_queued_writes_round_trip(allocator, &options, &endpoint, true, false);
+}
+
+AWS_TEST_CASE(socket_vectored_write_completes_once, s_test_socket_vectored_write_completes_once)
+
+#ifndef _WIN32
+/* Same as socket_queued_writes_complete_in_order, with write watermarks on the writer. */
+static int s_test_socket_write_watermarks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    return s_queued_writes_round_trip(allocator, &options, &endpoint, false, true);
+}
+
+AWS_TEST_CASE(socket_write_watermarks, s_test_socket_write_watermarks)
+
+enum {
+    CALLBACK_WATERMARK_HIGH = 1024,
+    CALLBACK_WRITE_SIZE = 4 * 1024,
+};
+
+struct callback_watermark_args {
+    struct aws_socket *writer;
+    struct aws_byte_buf data;
+    struct aws_byte_buf blocking_data;
+    bool blocked_in_callback;
+    bool writable_after_write;
+    size_t pending_after_write;
+    bool blocked_before_close;
+    bool writable_after_close;
+    size_t writable_count;
+    bool done;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+};
+
+static void s_on_callback_watermark_writable(struct aws_socket *socket, void *user_data) {
+    (void)socket;
+    struct callback_watermark_args *args = user_data;
+    args->writable_count++;
+}
+
+static void s_on_callback_watermark_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)error_code;
+    (void)amount_written;
+    (void)user_data;
+    (void)socket;
+}
+
+/* the first write's completion callback runs inside aws_socket_write(), and queues a write over the high watermark. */
+static void s_on_first_callback_watermark_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)error_code;
+    (void)amount_written;
+    struct callback_watermark_args *args = user_data;
+
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&args->data);
+    aws_socket_write(socket, &cursor, s_on_callback_watermark_written, args);
+    args->blocked_in_callback = !aws_socket_is_writable(socket);
+}
+
+static void s_callback_watermark_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct callback_watermark_args *args = arg;
+
+    aws_socket_set_write_watermarks(
+        args->writer, 0, CALLBACK_WATERMARK_HIGH, s_on_callback_watermark_writable, args);
+
+    struct aws_byte_cursor first = aws_byte_cursor_from_array(args->data.buffer, 8);
+    aws_socket_write(args->writer, &first, s_on_first_callback_watermark_written, args);
+    args->writable_after_write = aws_socket_is_writable(args->writer);
+    args->pending_after_write = aws_socket_get_pending_write_bytes(args->writer);
+
+    /* nobody reads, so most of this stays queued until the close throws it away. */
+    struct aws_byte_cursor blocking = aws_byte_cursor_from_buf(&args->blocking_data);
+    aws_socket_write(args->writer, &blocking, s_on_callback_watermark_written, args);
+    args->blocked_before_close = !aws_socket_is_writable(args->writer);
+    aws_socket_close(args->writer);
+    args->writable_after_close = aws_socket_is_writable(args->writer);
+
+    aws_mutex_lock(args->mutex);
+    args->done = true;
+    aws_condition_variable_notify_one(args->condition_variable);
+    aws_mutex_unlock(args->mutex);
+}
+
+static bool s_callback_watermark_done_predicate(void *arg) {
+    struct callback_watermark_args *args = arg;
+    return args->done;
+}
+
+/*
+ * A write made from a completion callback inside aws_socket_write() takes the writer over its high watermark, and the
+ * same aws_socket_write() call then drains it. The writer has to come out of that writable, having been told so.
+ * Closing a blocked writer leaves it not blocked either.
+ */
+static int s_test_socket_write_watermarks_in_write_callback(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+
+    struct callback_watermark_args args = {
+        .writer = &outgoing,
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.data, allocator, CALLBACK_WRITE_SIZE));
+    memset(args.data.buffer, 'a', CALLBACK_WRITE_SIZE);
+    args.data.len = CALLBACK_WRITE_SIZE;
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.blocking_data, allocator, BLOCKING_WRITE_SIZE));
+    memset(args.blocking_data.buffer, 'b', BLOCKING_WRITE_SIZE);
+    args.blocking_data.len = BLOCKING_WRITE_SIZE;
+
+    struct aws_task task;
+    aws_task_init(&task, s_callback_watermark_task, &args);
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_callback_watermark_done_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_TRUE(args.blocked_in_callback);
+    ASSERT_TRUE(args.writable_after_write);
+    ASSERT_UINT_EQUALS(0, args.pending_after_write);
+    ASSERT_UINT_EQUALS(1, args.writable_count);
+
+    /* a closed socket isn't reported writable again, it just stops reporting itself blocked. */
+    ASSERT_TRUE(args.blocked_before_close);
+    ASSERT_TRUE(args.writable_after_close);
+    ASSERT_UINT_EQUALS(1, args.writable_count);
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_task close_task;
+    aws_task_init(&close_task, s_socket_close_task, &io_args);
+
+    struct aws_socket *server_sock = listener_args.incoming;
+    struct aws_socket *to_close[] = {server_sock, &listener};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(to_close); ++i) {
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        io_args.socket = to_close[i];
+        io_args.close_completed = false;
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args));
+        ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    }
+
+    aws_socket_clean_up(server_sock);
+    aws_mem_release(allocator, server_sock);
+    aws_socket_clean_up(&outgoing);
+    aws_socket_clean_up(&listener);
+
+    aws_byte_buf_clean_up(&args.data);
+    aws_byte_buf_clean_up(&args.blocking_data);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_write_watermarks_in_write_callback, s_test_socket_write_watermarks_in_write_callback)
+#endif
+
+#ifndef _WIN32
+enum { DATAGRAM_BATCH_COUNT = 100 };
+
+struct datagram_test_args {
+    struct aws_socket *sender;
+    struct aws_socket *receiver;
+    struct aws_socket_endpoint *receiver_endpoint;
+    struct aws_socket_endpoint *sender_endpoint;
+    /* runs on the event loop once both sockets are bound. */
+    int (*round_trip)(struct datagram_test_args *args);
+    int result;
+    bool done;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static int s_datagram_batch_round_trip(struct datagram_test_args *args) {
+    uint8_t send_storage[DATAGRAM_BATCH_COUNT][16];
+    struct aws_byte_buf send_bufs[DATAGRAM_BATCH_COUNT];
+    struct aws_socket_datagram datagrams[DATAGRAM_BATCH_COUNT];
+    AWS_ZERO_ARRAY(datagrams);
+
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        send_bufs[i] = aws_byte_buf_from_empty_array(send_storage[i], sizeof(send_storage[i]));
+        send_bufs[i].len = (size_t)snprintf((char *)send_storage[i], sizeof(send_storage[i]), "datagram %zu", i);
+        datagrams[i].buffer = &send_bufs[i];
+        datagrams[i].endpoint = *args->receiver_endpoint;
+    }
+
+    size_t written = 0;
+    ASSERT_SUCCESS(aws_socket_write_datagrams(args->sender, datagrams, DATAGRAM_BATCH_COUNT, &written));
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, written);
+
+    /* room for more than were sent, the read has to stop once the socket is drained. */
+    uint8_t read_storage[DATAGRAM_BATCH_COUNT + 10][16];
+    struct aws_byte_buf read_bufs[DATAGRAM_BATCH_COUNT + 10];
+    struct aws_socket_datagram received[DATAGRAM_BATCH_COUNT + 10];
+    AWS_ZERO_ARRAY(received);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(received); ++i) {
+        read_bufs[i] = aws_byte_buf_from_empty_array(read_storage[i], sizeof(read_storage[i]));
+        received[i].buffer = &read_bufs[i];
+    }
+
+    /* loopback delivers synchronously, so everything is already waiting. */
+    size_t read = 0;
+    ASSERT_SUCCESS(aws_socket_read_datagrams(args->receiver, received, AWS_ARRAY_SIZE(received), &read));
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, read);
+
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(send_bufs[i].buffer, send_bufs[i].len, read_bufs[i].buffer, read_bufs[i].len);
+        ASSERT_FALSE(received[i].truncated);
+        ASSERT_STR_EQUALS("127.0.0.1", received[i].endpoint.address);
+        ASSERT_UINT_EQUALS(args->sender_endpoint->port, received[i].endpoint.port);
+    }
+
+    ASSERT_ERROR(AWS_IO_READ_WOULD_BLOCK, aws_socket_read_datagrams(args->receiver, received, 1, &read));
+    ASSERT_UINT_EQUALS(0, read);
+
+    /* a datagram that doesn't fit is cut off and flagged. */
+    struct aws_byte_buf small_buf = aws_byte_buf_from_empty_array(read_storage[0], 4);
+    received[0].buffer = &small_buf;
+    ASSERT_SUCCESS(aws_socket_write_datagrams(args->sender, datagrams, 1, &written));
+    ASSERT_SUCCESS(aws_socket_read_datagrams(args->receiver, received, 1, &read));
+    ASSERT_UINT_EQUALS(1, read);
+    ASSERT_UINT_EQUALS(4, small_buf.len);
+    ASSERT_TRUE(received[0].truncated);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_datagram_test_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct datagram_test_args *args = arg;
+
+    int result = args->round_trip(args);
+
+    aws_mutex_lock(&args->mutex);
+    args->result = result;
+    args->done = true;
+    aws_condition_variable_notify_one(&args->condition_variable);
+    aws_mutex_unlock(&args->mutex);
+}
+
+static bool s_datagram_test_done_pred(void *arg) {
+    struct datagram_test_args *args = arg;
+    return args->done;
+}
+
+/* Binds a receiver and a sender socket to loopback and runs round_trip on their event loop. */
+static int s_run_datagram_test(
+    struct aws_allocator *allocator,
+    const struct aws_socket_options *receiver_options,
+    const struct aws_socket_options *sender_options,
+    int (*round_trip)(struct datagram_test_args *args)) {
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_socket_endpoint receiver_endpoint = {.address = "127.0.0.1", .port = 8131};
+    struct aws_socket_endpoint sender_endpoint = {.address = "127.0.0.1", .port = 8132};
+
+    struct aws_socket receiver;
+    ASSERT_SUCCESS(aws_socket_init(&receiver, allocator, receiver_options));
+    ASSERT_SUCCESS(aws_socket_bind(&receiver, &receiver_endpoint));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&receiver, event_loop));
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(&receiver, s_on_readable, NULL));
+
+    struct aws_socket sender;
+    ASSERT_SUCCESS(aws_socket_init(&sender, allocator, sender_options));
+    ASSERT_SUCCESS(aws_socket_bind(&sender, &sender_endpoint));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&sender, event_loop));
+
+    struct datagram_test_args args = {
+        .sender = &sender,
+        .receiver = &receiver,
+        .receiver_endpoint = &receiver_endpoint,
+        .sender_endpoint = &sender_endpoint,
+        .round_trip = round_trip,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task task;
+    aws_task_init(&task, s_datagram_test_task, &args);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_datagram_test_done_pred, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&args.mutex));
+    ASSERT_SUCCESS(args.result);
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_socket *sockets[] = {&sender, &receiver};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(sockets); ++i) {
+        struct socket_io_args io_args = {
+            .socket = sockets[i],
+            .mutex = &mutex,
+            .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        };
+        struct aws_task close_task;
+        aws_task_init(&close_task, s_socket_close_task, &io_args);
+
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args));
+        ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    }
+
+    aws_socket_clean_up(&sender);
+    aws_socket_clean_up(&receiver);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Sends a batch of datagrams to a bound (not connected) socket, which reads them back with their sender's address. */
+static int s_test_socket_datagram_batch_read_write(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    return s_run_datagram_test(allocator, &options, &options, s_datagram_batch_round_trip);
+}
+
+AWS_TEST_CASE(socket_datagram_batch_read_write, s_test_socket_datagram_batch_read_write)
+
+enum {
+    SEGMENT_SIZE = 100,
+    SEGMENT_COUNT = 10,
+};
+
+/* Reads until all SEGMENT_COUNT segments arrived, whether or not the kernel coalesced them, checking their contents. */
+static int s_read_segments(struct datagram_test_args *args) {
+    uint8_t storage[SEGMENT_SIZE * SEGMENT_COUNT];
+    struct aws_byte_buf read_buf = aws_byte_buf_from_empty_array(storage, sizeof(storage));
+    size_t segments_read = 0;
+
+    while (read_buf.len < read_buf.capacity) {
+        size_t start = read_buf.len;
+        struct aws_socket_datagram datagram;
+        AWS_ZERO_STRUCT(datagram);
+        datagram.buffer = &read_buf;
+
+        size_t read = 0;
+        ASSERT_SUCCESS(aws_socket_read_datagrams(args->receiver, &datagram, 1, &read));
+        ASSERT_UINT_EQUALS(1, read);
+        ASSERT_FALSE(datagram.truncated);
+        ASSERT_UINT_EQUALS(SEGMENT_SIZE, datagram.segment_size);
+        ASSERT_UINT_EQUALS(0, (read_buf.len - start) % SEGMENT_SIZE);
+        segments_read += (read_buf.len - start) / SEGMENT_SIZE;
+    }
+
+    ASSERT_UINT_EQUALS(SEGMENT_COUNT, segments_read);
+    for (size_t i = 0; i < sizeof(storage); ++i) {
+        ASSERT_UINT_EQUALS(i / SEGMENT_SIZE, storage[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_segmentation_offload_round_trip(struct datagram_test_args *args) {
+    uint8_t storage[SEGMENT_SIZE * SEGMENT_COUNT];
+    for (size_t i = 0; i < sizeof(storage); ++i) {
+        storage[i] = (uint8_t)(i / SEGMENT_SIZE);
+    }
+
+    /* the socket's udp_segment_size splits this one write into SEGMENT_COUNT datagrams. */
+    struct aws_byte_buf send_buf = aws_byte_buf_from_array(storage, sizeof(storage));
+    struct aws_socket_datagram datagram;
+    AWS_ZERO_STRUCT(datagram);
+    datagram.buffer = &send_buf;
+    datagram.endpoint = *args->receiver_endpoint;
+
+    size_t written = 0;
+    ASSERT_SUCCESS(aws_socket_write_datagrams(args->sender, &datagram, 1, &written));
+    ASSERT_UINT_EQUALS(1, written);
+    ASSERT_SUCCESS(s_read_segments(args));
+
+    /* and so does a segment size on the datagram itself. */
+    datagram.segment_size = SEGMENT_SIZE;
+    ASSERT_SUCCESS(aws_socket_write_datagrams(args->sender, &datagram, 1, &written));
+    ASSERT_UINT_EQUALS(1, written);
+    ASSERT_SUCCESS(s_read_segments(args));
+
+    size_t read = 0;
+    ASSERT_ERROR(AWS_IO_READ_WOULD_BLOCK, aws_socket_read_datagrams(args->receiver, &datagram, 1, &read));
+
+    return AWS_OP_SUCCESS;
+}
+
+/* One write of SEGMENT_COUNT * SEGMENT_SIZE bytes arrives as SEGMENT_COUNT datagrams, or coalesced again with GRO. */
+static int s_test_socket_udp_segmentation_offload(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_options sender_options = options;
+    sender_options.udp_segment_size = SEGMENT_SIZE;
+
+    /* nothing to test where the kernel can't do it. */
+    struct aws_socket probe;
+    if (aws_socket_init(&probe, allocator, &sender_options)) {
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+        return AWS_OP_SUCCESS;
+    }
+    aws_socket_clean_up(&probe);
+
+    ASSERT_SUCCESS(s_run_datagram_test(allocator, &options, &sender_options, s_segmentation_offload_round_trip));
+
+    struct aws_socket_options gro_options = options;
+    gro_options.udp_gro = true;
+    ASSERT_SUCCESS(s_run_datagram_test(allocator, &gro_options, &sender_options, s_segmentation_offload_round_trip));
+
+    /* segmenting only makes sense for UDP. */
+    struct aws_socket_options stream_options = options;
+    stream_options.type = AWS_SOCKET_STREAM;
+    stream_options.udp_segment_size = SEGMENT_SIZE;
+    ASSERT_ERROR(AWS_IO_SOCKET_INVALID_OPTIONS, aws_socket_init(&probe, allocator, &stream_options));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_udp_segmentation_offload, s_test_socket_udp_segmentation_offload)
+
+static int s_get_int_option(struct aws_socket *socket, int level, int option) {
+    int value = -1;
+    socklen_t value_len = sizeof(value);
+    if (getsockopt(socket->io_handle.data.fd, level, option, &value, &value_len)) {
+        return -1;
+    }
+    return value;
+}
+
+/* The TCP tuning options end up on the socket, and setting the options again can switch the toggles back off. */
+static int s_test_socket_tcp_tuning_options(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.tcp_nodelay = true;
+    options.tcp_cork = true;
+    options.send_buffer_size = 64 * 1024;
+    options.receive_buffer_size = 64 * 1024;
+    options.tcp_not_sent_low_watermark = 16 * 1024;
+    options.tcp_user_timeout_ms = 5000;
+    /* reno is built into every kernel and unprivileged processes are always allowed it. */
+    snprintf(options.tcp_congestion_control, sizeof(options.tcp_congestion_control), "reno");
+
+    struct aws_socket socket;
+    ASSERT_SUCCESS(aws_socket_init(&socket, allocator, &options));
+
+    ASSERT_TRUE(s_get_int_option(&socket, IPPROTO_TCP, TCP_NODELAY) != 0);
+    /* Linux doubles the buffer sizes it's given, others take them as they are. */
+    ASSERT_TRUE(s_get_int_option(&socket, SOL_SOCKET, SO_SNDBUF) >= (int)options.send_buffer_size);
+    ASSERT_TRUE(s_get_int_option(&socket, SOL_SOCKET, SO_RCVBUF) >= (int)options.receive_buffer_size);
+#    if defined(TCP_CORK)
+    ASSERT_TRUE(s_get_int_option(&socket, IPPROTO_TCP, TCP_CORK) != 0);
+#    elif defined(TCP_NOPUSH)
+    ASSERT_TRUE(s_get_int_option(&socket, IPPROTO_TCP, TCP_NOPUSH) != 0);
+#    endif
+#    if defined(TCP_NOTSENT_LOWAT)
+    ASSERT_INT_EQUALS(options.tcp_not_sent_low_watermark, s_get_int_option(&socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT));
+#    endif
+#    if defined(TCP_USER_TIMEOUT)
+    ASSERT_INT_EQUALS(options.tcp_user_timeout_ms, s_get_int_option(&socket, IPPROTO_TCP, TCP_USER_TIMEOUT));
+#    endif
+#    if defined(TCP_CONGESTION)
+    char congestion_control[AWS_SOCKET_TCP_CONGESTION_CONTROL_MAX_LEN] = {0};
+    socklen_t congestion_control_len = sizeof(congestion_control);
+    ASSERT_SUCCESS(getsockopt(
+        socket.io_handle.data.fd, IPPROTO_TCP, TCP_CONGESTION, congestion_control, &congestion_control_len));
+    ASSERT_STR_EQUALS("reno", congestion_control);
+#    endif
+
+    options.tcp_nodelay = false;
+    options.tcp_cork = false;
+    ASSERT_SUCCESS(aws_socket_set_options(&socket, &options));
+    ASSERT_INT_EQUALS(0, s_get_int_option(&socket, IPPROTO_TCP, TCP_NODELAY));
+#    if defined(TCP_CORK)
+    ASSERT_INT_EQUALS(0, s_get_int_option(&socket, IPPROTO_TCP, TCP_CORK));
+#    elif defined(TCP_NOPUSH)
+    ASSERT_INT_EQUALS(0, s_get_int_option(&socket, IPPROTO_TCP, TCP_NOPUSH));
+#    endif
+
+    aws_socket_clean_up(&socket);
+
+    /* the tuning options still leave a socket that can talk. */
+    options.tcp_quickack = true;
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8133};
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(socket_tcp_tuning_options, s_test_socket_tcp_tuning_options)
+#endif /* _WIN32 */
+
 #ifdef _WIN32
 static int s_local_socket_pipe_connected_race(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/io/private/timing_wheel.h>
+
+#include <aws/common/task_scheduler.h>
+#include <aws/testing/aws_test_harness.h>
+
+/* 8 slots of 10ns, and anything at least 20ns out goes on the wheel */
+enum {
+    TEST_TICK_NS = 10,
+    TEST_SLOT_COUNT = 8,
+    TEST_MIN_DELAY_NS = 20,
+};
+
+static void s_noop_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)arg;
+    (void)status;
+}
+
+static size_t s_list_size(const struct aws_linked_list *list) {
+    size_t count = 0;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(list); node != aws_linked_list_end(list);
+         node = aws_linked_list_next(node)) {
+        ++count;
+    }
+    return count;
+}
+
+static bool s_list_contains(const struct aws_linked_list *list, const struct aws_task *task) {
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(list); node != aws_linked_list_end(list);
+         node = aws_linked_list_next(node)) {
+        if (node == &task->node) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int s_test_timing_wheel_expires_in_tick_order(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_SUCCESS(aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, TEST_SLOT_COUNT, TEST_MIN_DELAY_NS, 100));
+
+    /* too close, belongs in the scheduler */
+    struct aws_task near_task;
+    aws_task_init(&near_task, s_noop_task, NULL);
+    ASSERT_FALSE(aws_timing_wheel_try_schedule(&wheel, &near_task, 115));
+    ASSERT_TRUE(aws_timing_wheel_is_empty(&wheel));
+
+    struct aws_task task_a;
+    aws_task_init(&task_a, s_noop_task, NULL);
+    struct aws_task task_b;
+    aws_task_init(&task_b, s_noop_task, NULL);
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &task_b, 165));
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &task_a, 125));
+    ASSERT_UINT_EQUALS(165, task_b.timestamp);
+
+    uint64_t next_tick_ns = 0;
+    ASSERT_TRUE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+    ASSERT_UINT_EQUALS(120, next_tick_ns);
+    /* nothing is due before the limit */
+    ASSERT_FALSE(aws_timing_wheel_next_tick_time(&wheel, 115, &next_tick_ns));
+
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+
+    aws_timing_wheel_expire(&wheel, 119, &expired);
+    ASSERT_TRUE(aws_linked_list_empty(&expired));
+
+    /* the whole tick comes out, even though the task itself is due a little later in it */
+    aws_timing_wheel_expire(&wheel, 120, &expired);
+    ASSERT_UINT_EQUALS(1, s_list_size(&expired));
+    ASSERT_TRUE(s_list_contains(&expired, &task_a));
+
+    ASSERT_TRUE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+    ASSERT_UINT_EQUALS(160, next_tick_ns);
+
+    aws_timing_wheel_expire(&wheel, 170, &expired);
+    ASSERT_UINT_EQUALS(2, s_list_size(&expired));
+    ASSERT_TRUE(s_list_contains(&expired, &task_b));
+    ASSERT_TRUE(aws_timing_wheel_is_empty(&wheel));
+    ASSERT_FALSE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+
+    aws_timing_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_expires_in_tick_order, s_test_timing_wheel_expires_in_tick_order)
+
+static int s_test_timing_wheel_keeps_later_rotations(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_SUCCESS(aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, TEST_SLOT_COUNT, TEST_MIN_DELAY_NS, 0));
+
+    /* both land in slot 3, one and three rotations out */
+    struct aws_task soon_task;
+    aws_task_init(&soon_task, s_noop_task, NULL);
+    struct aws_task later_task;
+    aws_task_init(&later_task, s_noop_task, NULL);
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &soon_task, 30));
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &later_task, 190));
+
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+
+    aws_timing_wheel_expire(&wheel, 35, &expired);
+    ASSERT_UINT_EQUALS(1, s_list_size(&expired));
+    ASSERT_TRUE(s_list_contains(&expired, &soon_task));
+    ASSERT_FALSE(aws_timing_wheel_is_empty(&wheel));
+
+    /* one rotation later, the slot comes around again but the task isn't due yet */
+    aws_timing_wheel_expire(&wheel, 115, &expired);
+    ASSERT_UINT_EQUALS(1, s_list_size(&expired));
+
+    /* sleep far past the deadline, a single call still finds it */
+    aws_timing_wheel_expire(&wheel, 10000, &expired);
+    ASSERT_UINT_EQUALS(2, s_list_size(&expired));
+    ASSERT_TRUE(s_list_contains(&expired, &later_task));
+
+    /* and the wheel picks up from the new time */
+    struct aws_task stale_task;
+    aws_task_init(&stale_task, s_noop_task, NULL);
+    ASSERT_FALSE(aws_timing_wheel_try_schedule(&wheel, &stale_task, 5000));
+
+    aws_timing_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_keeps_later_rotations, s_test_timing_wheel_keeps_later_rotations)
+
+static int s_test_timing_wheel_remove(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_SUCCESS(aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, TEST_SLOT_COUNT, TEST_MIN_DELAY_NS, 0));
+
+    struct aws_task kept_task;
+    aws_task_init(&kept_task, s_noop_task, NULL);
+    struct aws_task removed_task;
+    aws_task_init(&removed_task, s_noop_task, NULL);
+    struct aws_task never_scheduled_task;
+    aws_task_init(&never_scheduled_task, s_noop_task, NULL);
+
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &kept_task, 50));
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &removed_task, 50));
+
+    struct aws_timing_wheel other_wheel;
+    ASSERT_SUCCESS(
+        aws_timing_wheel_init(&other_wheel, allocator, TEST_TICK_NS, TEST_SLOT_COUNT, TEST_MIN_DELAY_NS, 0));
+
+    ASSERT_FALSE(aws_timing_wheel_remove(&wheel, &never_scheduled_task));
+    /* a task on one wheel isn't on any other */
+    ASSERT_FALSE(aws_timing_wheel_remove(&other_wheel, &kept_task));
+    aws_timing_wheel_clean_up(&other_wheel);
+
+    ASSERT_TRUE(aws_timing_wheel_remove(&wheel, &removed_task));
+    /* second time around it's no longer ours */
+    ASSERT_FALSE(aws_timing_wheel_remove(&wheel, &removed_task));
+
+    struct aws_linked_list expired;
+    aws_linked_list_init(&expired);
+    aws_timing_wheel_expire(&wheel, 60, &expired);
+    ASSERT_UINT_EQUALS(1, s_list_size(&expired));
+    ASSERT_TRUE(s_list_contains(&expired, &kept_task));
+
+    /* expired tasks aren't on the wheel anymore either */
+    ASSERT_FALSE(aws_timing_wheel_remove(&wheel, &kept_task));
+
+    aws_timing_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_remove, s_test_timing_wheel_remove)
+
+static int s_test_timing_wheel_take_all(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_SUCCESS(aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, TEST_SLOT_COUNT, TEST_MIN_DELAY_NS, 0));
+
+    struct aws_task tasks[5];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); ++i) {
+        aws_task_init(&tasks[i], s_noop_task, NULL);
+        ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &tasks[i], 40 + i * 35));
+    }
+
+    struct aws_linked_list out;
+    aws_linked_list_init(&out);
+    aws_timing_wheel_take_all(&wheel, &out);
+
+    ASSERT_TRUE(aws_timing_wheel_is_empty(&wheel));
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(tasks), s_list_size(&out));
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); ++i) {
+        ASSERT_TRUE(s_list_contains(&out, &tasks[i]));
+        ASSERT_FALSE(aws_timing_wheel_remove(&wheel, &tasks[i]));
+    }
+
+    aws_timing_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_take_all, s_test_timing_wheel_take_all)
+
+/* more slots than one bitmap word covers, starting near the end so the next occupied slot is found after wrapping */
+static int s_test_timing_wheel_next_tick_wraps_around(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_SUCCESS(aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, 256, TEST_MIN_DELAY_NS, 2500));
+
+    struct aws_task far_task;
+    aws_task_init(&far_task, s_noop_task, NULL);
+    struct aws_task near_task;
+    aws_task_init(&near_task, s_noop_task, NULL);
+
+    /* ticks 350 and 300, slots 94 and 44 */
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &far_task, 3505));
+    ASSERT_TRUE(aws_timing_wheel_try_schedule(&wheel, &near_task, 3000));
+
+    uint64_t next_tick_ns = 0;
+    ASSERT_TRUE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+    ASSERT_UINT_EQUALS(3000, next_tick_ns);
+    ASSERT_FALSE(aws_timing_wheel_next_tick_time(&wheel, 2999, &next_tick_ns));
+
+    ASSERT_TRUE(aws_timing_wheel_remove(&wheel, &near_task));
+    ASSERT_TRUE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+    ASSERT_UINT_EQUALS(3500, next_tick_ns);
+    ASSERT_FALSE(aws_timing_wheel_next_tick_time(&wheel, 3499, &next_tick_ns));
+
+    ASSERT_TRUE(aws_timing_wheel_remove(&wheel, &far_task));
+    ASSERT_FALSE(aws_timing_wheel_next_tick_time(&wheel, UINT64_MAX, &next_tick_ns));
+
+    aws_timing_wheel_clean_up(&wheel);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_next_tick_wraps_around, s_test_timing_wheel_next_tick_wraps_around)
+
+static int s_test_timing_wheel_rejects_bad_slot_count(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_timing_wheel wheel;
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_timing_wheel_init(&wheel, allocator, TEST_TICK_NS, 6, 0, 0));
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_timing_wheel_init(&wheel, allocator, 0, TEST_SLOT_COUNT, 0, 0));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timing_wheel_rejects_bad_slot_count, s_test_timing_wheel_rejects_bad_slot_count)